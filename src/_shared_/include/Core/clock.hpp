@@ -0,0 +1,219 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+// Standard includes
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Project includes
+#include <common.hpp>
+
+namespace Core {
+
+/**
+ * @brief The source of the current time and the means to wait for a point in
+ * time. The participants of the messaging core take the time and wait through
+ * the clock, that is returned by getClock(), so a simulated clock can be
+ * injected with setClock().
+ */
+class Clock {
+public:
+  virtual ~Clock() {}
+
+  /**
+   * @brief Returns the current time of the clock.
+   * @return The current time.
+   */
+  virtual TimePoint now() = 0;
+
+  /**
+   * @brief Waits until the predicate is fulfilled or the time point has been
+   * reached. Like std::condition_variable::wait_until(), the lock is released
+   * while waiting.
+   * @param lock The lock of the mutex, that guards the predicate. Must be
+   * locked.
+   * @param condition The condition, that is notified, when the predicate
+   * changes.
+   * @param timePoint The time point, until which is waited at most.
+   * @param predicate The predicate.
+   * @return The result of the predicate.
+   */
+  virtual bool waitUntil(std::unique_lock<std::mutex> &lock,
+                         std::condition_variable &condition,
+                         TimePoint timePoint,
+                         std::function<bool()> predicate) = 0;
+
+  /**
+   * @brief Blocks the calling thread until the time point has been reached.
+   * @param timePoint The time point.
+   */
+  virtual void sleepUntil(TimePoint timePoint);
+
+  /**
+   * @brief Blocks the calling thread for the given duration.
+   * @param duration The duration.
+   */
+  void sleepFor(Duration duration);
+};
+
+/**
+ * @brief The wall clock. Is used, unless another clock has been set.
+ */
+class SystemClock : public Clock {
+public:
+  TimePoint now() override;
+
+  bool waitUntil(std::unique_lock<std::mutex> &lock,
+                 std::condition_variable &condition, TimePoint timePoint,
+                 std::function<bool()> predicate) override;
+
+  void sleepUntil(TimePoint timePoint) override;
+};
+
+/**
+ * @brief A clock, whose time only moves, when it is advanced. Waiting threads
+ * are woken up, once the time has reached their time point, so schedules of
+ * hours run as fast as the threads can follow.
+ *
+ * The clock is either advanced manually with advance() and advanceTo() or, if
+ * a thread count is given, automatically: As soon as the given count of
+ * threads waits on the clock, the time jumps to the earliest time point, that
+ * is waited for. The thread count has to match the threads, that wait on the
+ * clock, e.g. the thread of the message distributor and the worker threads of
+ * mockup devices. Threads, that are only woken up by other threads, are not
+ * counted. With a single thread, e.g. a message distributor in polling mode,
+ * the simulation is deterministic.
+ */
+class SimulatedClock : public Clock {
+public:
+  /**
+   * @brief Creates a clock, that starts at the given time.
+   * @param start The start time.
+   * @param threadCount The count of threads, that have to wait on the clock,
+   * before it advances automatically. 0 disables the automatic advance.
+   */
+  explicit SimulatedClock(TimePoint start, unsigned int threadCount = 0);
+
+  TimePoint now() override;
+
+  bool waitUntil(std::unique_lock<std::mutex> &lock,
+                 std::condition_variable &condition, TimePoint timePoint,
+                 std::function<bool()> predicate) override;
+
+  /**
+   * @brief Moves the time forward by the given duration and wakes up the
+   * threads, whose time point has been reached.
+   * @param duration The duration.
+   */
+  void advance(Duration duration);
+
+  /**
+   * @brief Moves the time forward to the given time point and wakes up the
+   * threads, whose time point has been reached. Time points in the past are
+   * ignored.
+   * @param timePoint The time point.
+   */
+  void advanceTo(TimePoint timePoint);
+
+  /**
+   * @brief Sets the count of threads, that have to wait on the clock, before
+   * it advances automatically. Has to be lowered, when a thread stops to wait
+   * on the clock for good, or the others wait forever.
+   * @param threadCount The count of threads. 0 disables the automatic advance.
+   */
+  void setThreadCount(unsigned int threadCount);
+
+  /**
+   * @brief Returns the count of threads, that wait on the clock.
+   * @return The count of waiting threads.
+   */
+  unsigned int getWaitingCount();
+
+private:
+  /**
+   * @brief A thread, that waits on the clock.
+   */
+  struct Sleeper {
+    /// The time point, the thread waits for.
+    TimePoint timePoint;
+
+    /// The mutex, that is released by the thread while waiting.
+    std::mutex *mutex;
+
+    /// The condition, the thread waits on.
+    std::condition_variable *condition;
+
+    /// Set by the clock, once the time point has been reached. Is guarded by
+    /// the mutex of the thread.
+    bool notified;
+  };
+
+  /**
+   * @brief Advances to the earliest time point, that is waited for, if the
+   * expected count of threads waits. The clock mutex must be locked.
+   * @return The sleepers, that have to be woken up.
+   */
+  std::vector<Sleeper *> advanceAutomaticallyLocked();
+
+  /**
+   * @brief Moves the time forward and takes the sleepers, whose time point has
+   * been reached. The clock mutex must be locked.
+   * @param timePoint The new time.
+   * @return The sleepers, that have to be woken up.
+   */
+  std::vector<Sleeper *> advanceLocked(TimePoint timePoint);
+
+  /**
+   * @brief Wakes up the given sleepers. The clock mutex must not be locked.
+   * The sleepers must not be accessed afterwards.
+   * @param sleepers The sleepers.
+   */
+  void wake(const std::vector<Sleeper *> &sleepers);
+
+  /// The current time in milliseconds since the epoch.
+  std::atomic<Duration::rep> currentTime;
+
+  /// The count of threads, that trigger the automatic advance.
+  unsigned int threadCount;
+
+  /// Guards the sleepers.
+  std::mutex clockMutex;
+
+  /// The threads, that wait on the clock.
+  std::list<Sleeper *> sleepers;
+};
+
+/**
+ * @brief Returns the clock of the process.
+ * @return The clock. The system clock, unless another clock has been set.
+ */
+Clock &getClock();
+
+/**
+ * @brief Replaces the clock of the process. Must not be called, while
+ * participants are running.
+ * @param clock The new clock. Null restores the system clock.
+ */
+void setClock(std::shared_ptr<Clock> clock);
+
+/**
+ * @brief Blocks the calling thread on the clock of the process until the time
+ * point has been reached.
+ * @param timePoint The time point.
+ */
+void sleepUntil(TimePoint timePoint);
+
+/**
+ * @brief Blocks the calling thread on the clock of the process for the given
+ * duration.
+ * @param duration The duration.
+ */
+void sleepFor(Duration duration);
+} // namespace Core
+
+#endif
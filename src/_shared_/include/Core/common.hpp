@@ -9,6 +9,9 @@
 #include <string>
 #include <tuple>
 
+// Project includes
+#include <object_pool.hpp>
+
 namespace Core {
 
 /// @brief Shortcut to a type that holds electric impedances.
@@ -19,8 +22,10 @@ typedef std::complex<double> Impedance;
 /// complex impedance in Ohm.
 typedef std::tuple<double, Impedance> ImpedancePoint;
 
-/// Shortcut to the definition of a discrete impedance spectrum.
-typedef std::list<ImpedancePoint> ImpedanceSpectrum;
+/// Shortcut to the definition of a discrete impedance spectrum. The points are
+/// allocated from the object pool.
+typedef std::list<ImpedancePoint, Utilities::PoolAllocator<ImpedancePoint>>
+    ImpedanceSpectrum;
 
 /// Defines a time span.
 using Duration = std::chrono::duration<long long, std::milli>;
@@ -29,7 +34,8 @@ using Duration = std::chrono::duration<long long, std::milli>;
 using TimePoint = std::chrono::time_point<std::chrono::system_clock, Duration>;
 
 /**
- * @brief Returns a timepoint object that represents the current time.
+ * @brief Returns a timepoint object that represents the current time. The time
+ * is taken from the clock of the process, see getClock().
  * @return A timepoint object that represents the current time.
  */
 TimePoint getNow();
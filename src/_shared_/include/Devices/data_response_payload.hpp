@@ -47,6 +47,21 @@ public:
       TimePoint from, TimePoint to, std::string key,
       std::vector<TimePoint> &timestamps, std::vector<Value> &values);
 
+  /**
+   * @brief Constructs a single data response payload, that takes over the
+   * given vectors without copying them. Used for decoded payloads. Elements
+   * beyond SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH are dropped.
+   * @param from The start of the queried time frame.
+   * @param to The end of the queried
+   * @param key The key that has been queried
+   * @param timestamps The timestamps that shall be held by the payload
+   * @param values The values that shall be held by the payload.
+   * @return Pointer to the response payload.
+   */
+  static DataResponsePayload *constructSingleDataResponsePayload(
+      TimePoint from, TimePoint to, std::string key,
+      std::vector<TimePoint> &&timestamps, std::vector<Value> &&values);
+
   /**
    * @brief Serializes the payload into a human readable string.
    * @return The payload in string representation.
@@ -59,6 +74,14 @@ public:
    */
   virtual std::vector<unsigned char> bytes() override;
 
+  /**
+   * @brief Serializes the payload directly into the given builder, without
+   * intermediate objects.
+   * @param builder An empty builder.
+   * @return TRUE
+   */
+  virtual bool encode(flatbuffers::FlatBufferBuilder &builder) override;
+
   /**
    * @brief Returns the magic number of the payload. This number is used to
    * identify the payload type when encoding and decoding payload. This number
@@ -88,8 +111,8 @@ private:
    * @param byteVector The byte vector which shall be held by this payload.
    */
   DataResponsePayload(TimePoint from, TimePoint to, const std::string &key,
-                      size_t count, const std::vector<TimePoint> &timestamps,
-                      const std::vector<Value> &values);
+                      size_t count, std::vector<TimePoint> timestamps,
+                      std::vector<Value> values);
 };
 } // namespace Devices
 
@@ -6,19 +6,19 @@
 
 namespace Devices {
 class Isx3PayloadDecoder : public PayloadDecoder {
-  virtual InitPayload *decodeInitPayload(const std::vector<unsigned char> &data,
+  virtual InitPayload *decodeInitPayload(const PayloadBuffer &data,
                                          int magicNumber = 0) override;
 
   virtual ConfigurationPayload *
-  decodeConfigPayload(const std::vector<unsigned char> &data,
-                      int magicNumber = 0) override;
+  decodeConfigPayload(const PayloadBuffer &data, int magicNumber = 0) override;
 
-  virtual ReadPayload *decodeReadPayload(const std::vector<unsigned char> &data,
+  virtual ReadPayload *decodeReadPayload(const PayloadBuffer &data,
                                          int magicNumber = 0) override;
 
   virtual WritePayload *
-  decodeWritePayload(const std::vector<unsigned char> &data,
-                     int magicNumber = 0) override;
+  decodeWritePayload(const PayloadBuffer &data, int magicNumber = 0) override;
+
+  virtual std::span<const int> getMagicNumbers() const override;
 };
 
 } // namespace Devices
@@ -4,6 +4,9 @@
 // Standard includes
 #include <vector>
 
+// 3rd party includes
+#include <flatbuffers/flatbuffers.h>
+
 namespace Devices {
 /**
  * @brief A generic payload that may be used for device initialization,
@@ -17,6 +20,17 @@ public:
    */
   virtual std::vector<unsigned char> bytes() = 0;
 
+  /**
+   * @brief Serializes the payload directly into the given builder and
+   * finishes it. Payloads, that are sent often or are large, should implement
+   * this, so the message factory can encode them with a reused builder instead
+   * of a temporary vector.
+   * @param builder An empty builder.
+   * @return TRUE if the payload has been serialized. FALSE if the payload does
+   * not support it. bytes() is used then.
+   */
+  virtual bool encode(flatbuffers::FlatBufferBuilder &builder) { return false; }
+
   /**
    * @brief Returns the magic number of the payload. This number is used to
    * identify the payload type when encoding and decoding payload. This number
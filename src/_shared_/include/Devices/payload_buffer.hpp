@@ -0,0 +1,95 @@
+#ifndef PAYLOAD_BUFFER_HPP
+#define PAYLOAD_BUFFER_HPP
+
+// Standard includes
+#include <memory>
+#include <span>
+#include <vector>
+
+// 3rd party includes
+#include <flatbuffers/flatbuffers.h>
+
+namespace Devices {
+
+/**
+ * @brief The bytes of a serialized payload. The bytes are a view into a
+ * reference-counted buffer, usually the received message the payload has been
+ * part of. Copies of a payload buffer and buffers of nested payloads share that
+ * buffer, so the bytes are neither copied nor freed while any of them exists.
+ */
+class PayloadBuffer {
+public:
+  /**
+   * @brief Creates an empty payload buffer.
+   */
+  PayloadBuffer();
+
+  /**
+   * @brief Creates a payload buffer, that holds a copy of the given bytes.
+   * @param bytes The bytes of the payload.
+   */
+  PayloadBuffer(const std::vector<unsigned char> &bytes);
+
+  /**
+   * @brief Creates a payload buffer, that views a part of a shared buffer.
+   * @param storage The shared buffer.
+   * @param bytes The bytes of the payload. Have to lie within the storage.
+   */
+  PayloadBuffer(std::shared_ptr<const std::vector<unsigned char>> storage,
+                std::span<const unsigned char> bytes);
+
+  /**
+   * @brief Creates a payload buffer of a payload, that is nested in this one.
+   * The nested payload shares the buffer with this one.
+   * @param bytes The serialized nested payload. Null creates an empty buffer.
+   * @return The payload buffer of the nested payload.
+   */
+  PayloadBuffer slice(const flatbuffers::Vector<uint8_t> *bytes) const;
+
+  /**
+   * @brief Verifies the bytes as flatbuffer with the given root table and
+   * returns the root table. The tables and vectors, that are reachable from
+   * the root, are backed by the buffer. Nothing is unpacked or copied.
+   * @return Pointer to the root table. Null if the bytes are no valid
+   * flatbuffer of the given type.
+   */
+  template <typename T> const T *getRoot() const {
+    if (this->bytes.empty()) {
+      return nullptr;
+    }
+    flatbuffers::Verifier verifier(this->bytes.data(), this->bytes.size());
+    if (!verifier.VerifyBuffer<T>(nullptr)) {
+      return nullptr;
+    }
+
+    return flatbuffers::GetRoot<T>(this->bytes.data());
+  }
+
+  /**
+   * @brief Returns the bytes of the payload.
+   * @return The bytes. Valid as long as this buffer exists.
+   */
+  std::span<const unsigned char> getBytes() const;
+
+  /**
+   * @brief Copies the bytes of the payload into a vector.
+   * @return The bytes.
+   */
+  std::vector<unsigned char> toVector() const;
+
+  /**
+   * @brief Checks if the payload has no bytes.
+   * @return TRUE if the payload is empty. FALSE otherwise.
+   */
+  bool empty() const;
+
+private:
+  /// The buffer, that is shared by all views.
+  std::shared_ptr<const std::vector<unsigned char>> storage;
+
+  /// The bytes of the payload within the storage.
+  std::span<const unsigned char> bytes;
+};
+} // namespace Devices
+
+#endif
@@ -3,11 +3,13 @@
 
 // Standard includes
 #include <memory>
+#include <span>
 #include <vector>
 
 // Project includes
 #include <configuration_payload.hpp>
 #include <init_payload.hpp>
+#include <payload_buffer.hpp>
 #include <read_payload.hpp>
 #include <write_payload.hpp>
 
@@ -15,24 +17,39 @@ namespace Devices {
 /**
  * @brief Superclass of a payload decoder. Decodes a byte array into a device
  * specific payload. Each device has to implement its payload decoder.
+ *
+ * The payload is handed over as view into the received message. Decoders
+ * should access it with PayloadBuffer::getRoot(), which verifies the bytes
+ * before any field is read, and read the fields from the returned table.
+ * Nested payloads are passed on with PayloadBuffer::slice().
+ *
+ * Decoders should list the magic numbers of their payloads in
+ * getMagicNumbers(). The message factory then hands each payload directly to
+ * the decoder of its magic number, instead of trying every decoder in turn.
  */
 class PayloadDecoder {
 public:
   PayloadDecoder() {}
 
-  virtual InitPayload *decodeInitPayload(const std::vector<unsigned char> &data,
+  virtual InitPayload *decodeInitPayload(const PayloadBuffer &data,
                                          int magicNumber = 0) = 0;
 
   virtual ConfigurationPayload *
-  decodeConfigPayload(const std::vector<unsigned char> &data,
-                      int magicNumber = 0) = 0;
+  decodeConfigPayload(const PayloadBuffer &data, int magicNumber = 0) = 0;
 
-  virtual ReadPayload *decodeReadPayload(const std::vector<unsigned char> &data,
+  virtual ReadPayload *decodeReadPayload(const PayloadBuffer &data,
                                          int magicNumber = 0) = 0;
 
   virtual WritePayload *
-  decodeWritePayload(const std::vector<unsigned char> &data,
-                     int magicNumber = 0) = 0;
+  decodeWritePayload(const PayloadBuffer &data, int magicNumber = 0) = 0;
+
+  /**
+   * @brief Returns the magic numbers of the payloads, that this decoder is
+   * able to decode.
+   * @return The magic numbers. If empty, the decoder is tried for every
+   * payload, whose magic number no other decoder has claimed.
+   */
+  virtual std::span<const int> getMagicNumbers() const { return {}; }
 };
 } // namespace Devices
 
@@ -0,0 +1,117 @@
+#ifndef PAYLOAD_REGISTRY_HPP
+#define PAYLOAD_REGISTRY_HPP
+
+// Standard includes
+#include <functional>
+#include <memory>
+#include <vector>
+
+// 3rd party includes
+#include <flatbuffers/flatbuffers.h>
+
+// Project includes
+#include <payload.hpp>
+#include <payload_decoder.hpp>
+
+/// The largest magic number, that can be registered. Bounds the size of the
+/// table of the registry.
+#define PAYLOAD_REGISTRY_MAX_MAGIC_NUMBER 0xFFFF
+
+namespace Devices {
+
+/**
+ * @brief Serializes a payload into the given empty builder and finishes it.
+ * Returns FALSE if the payload could not be serialized.
+ */
+using PayloadEncoder =
+    std::function<bool(Payload &, flatbuffers::FlatBufferBuilder &)>;
+
+/**
+ * @brief The decoder and the encoder, that are registered for a magic number.
+ */
+struct PayloadRegistryEntry {
+  /// The decoder of the payloads. Null if none has been registered.
+  std::shared_ptr<PayloadDecoder> decoder;
+
+  /// The encoder of the payloads. Empty if none has been registered. The
+  /// payload encodes itself then.
+  PayloadEncoder encoder;
+};
+
+/**
+ * @brief Maps the magic numbers of the payloads to their decoder and encoder.
+ * The entries are stored in a flat table, that is indexed by the magic number,
+ * so a lookup takes constant time regardless of the count of registered
+ * device types.
+ *
+ * Decoders are registered for the magic numbers they list in
+ * PayloadDecoder::getMagicNumbers(). Decoders, that do not list any, are kept
+ * as fallback and tried in order of registration for all payloads without a
+ * registered decoder.
+ *
+ * The registry is filled before messages are exchanged and is read-only
+ * afterwards. It is not synchronized.
+ */
+class PayloadRegistry {
+public:
+  PayloadRegistry();
+
+  /**
+   * @brief Registers the given decoder for the magic numbers of its payloads.
+   * Magic numbers, that already have a decoder, keep it.
+   * @param decoder The decoder.
+   * @return TRUE if the decoder has been registered for all of its magic
+   * numbers or as fallback. FALSE otherwise.
+   */
+  bool registerDecoder(std::shared_ptr<PayloadDecoder> decoder);
+
+  /**
+   * @brief Registers an encoder for the payloads with the given magic number.
+   * Replaces an encoder, that has been registered before.
+   * @param magicNumber The magic number of the payloads.
+   * @param encoder The encoder.
+   * @return TRUE if the encoder has been registered. FALSE if the magic number
+   * is out of range.
+   */
+  bool registerEncoder(int magicNumber, PayloadEncoder encoder);
+
+  /**
+   * @brief Returns the decoder, that is registered for the given magic number.
+   * @param magicNumber The magic number.
+   * @return Pointer to the decoder. Null if none has been registered.
+   */
+  PayloadDecoder *getDecoder(int magicNumber) const;
+
+  /**
+   * @brief Returns the encoder, that is registered for the given magic number.
+   * @param magicNumber The magic number.
+   * @return Pointer to the encoder. Null if none has been registered.
+   */
+  const PayloadEncoder *getEncoder(int magicNumber) const;
+
+  /**
+   * @brief Returns the decoders, that have not listed their magic numbers.
+   * @return The decoders in order of registration.
+   */
+  const std::vector<std::shared_ptr<PayloadDecoder>> &
+  getFallbackDecoders() const;
+
+private:
+  /**
+   * @brief Returns the entry of the given magic number and grows the table, if
+   * it does not contain the entry yet.
+   * @param magicNumber The magic number.
+   * @return Pointer to the entry. Null if the magic number is out of range.
+   */
+  PayloadRegistryEntry *getOrCreateEntry(int magicNumber);
+
+  /// The entries. The index is the magic number.
+  std::vector<PayloadRegistryEntry> entries;
+
+  /// The decoders, that are tried if no decoder has been registered for a
+  /// magic number.
+  std::vector<std::shared_ptr<PayloadDecoder>> fallbackDecoders;
+};
+} // namespace Devices
+
+#endif
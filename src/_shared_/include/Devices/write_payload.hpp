@@ -5,14 +5,16 @@
 #include <string>
 
 // Project includes
+#include <object_pool.hpp>
 #include <payload.hpp>
 
 namespace Devices {
 
 /**
- * @brief Base class for a write data package.
+ * @brief Base class for a write data package. Is allocated from the object
+ * pool.
  */
-class WritePayload : public Payload {
+class WritePayload : public Payload, public Utilities::PoolAllocated {
 public:
   /**
    * @brief Construct a new ReadPayload object.
@@ -41,15 +41,16 @@ private:
   QwtInterval intervals[3];
 
   /// The container that holds the data. Maps from timestamp to a vector
-  /// containing impedances.
-  QMap<double, std::vector<Impedance>> dataMap;
+  /// containing the magnitudes of the impedances. The magnitudes are
+  /// calculated once per spectrum, as value() is called for every pixel.
+  QMap<double, std::vector<double>> dataMap;
 
   /// Holds the frequencies that shall be displayed.
   std::vector<double> frequencies;
 
-  /// Caches the maximum impedance value. Used for calculation of the data
+  /// Caches the maximum impedance magnitude. Used for calculation of the data
   /// intervals.
-  Impedance impedanceMax;
+  double magnitudeMax;
 
   /// Data that is older than the retention period is discarded.
   std::chrono::seconds retentionPeriod;
@@ -2,6 +2,8 @@
 #define DEVICE_MESSAGE_HPP
 
 // Project includes
+#include <mpsc_queue.hpp>
+#include <object_pool.hpp>
 #include <user_id.hpp>
 
 // Standard includes
@@ -15,17 +17,57 @@ namespace Messages {
 /// would lead to a circular dependency.
 class MessageInterface;
 
+/**
+ * @brief Identifies the concrete type of a device message. Allows to dispatch
+ * on the type of a message without a cast, see visitMessage().
+ */
+enum DeviceMessageKind {
+  DEVICE_MESSAGE_KIND_WRITE = 0x01,
+
+  DEVICE_MESSAGE_KIND_READ = 0x02,
+
+  DEVICE_MESSAGE_KIND_HANDSHAKE = 0x03,
+
+  DEVICE_MESSAGE_KIND_INIT = 0x04,
+
+  DEVICE_MESSAGE_KIND_CONFIG = 0x05
+};
+
+/**
+ * @brief The priority class of a message. Queues on the path of a message
+ * serve higher classes first. Lower values are served first.
+ */
+enum MessagePriority {
+  /// Commands and state changes, that have to reach their destination quickly.
+  MESSAGE_PRIORITY_CONTROL = 0x00,
+
+  /// Requests and responses of regular size.
+  MESSAGE_PRIORITY_NORMAL = 0x01,
+
+  /// Transfers of measurement data.
+  MESSAGE_PRIORITY_BULK = 0x02
+};
+
+/// The count of priority classes.
+#define MESSAGE_PRIORITY_COUNT 3
+
 /**
  * @brief Base class for messages that are sent or received from or by devices.
+ * Can be queued in the outgoing queue of a message interface without an
+ * allocation. Is allocated from the object pool.
  */
-class DeviceMessage {
+class DeviceMessage : public Utilities::MpscQueueHook<DeviceMessage>,
+                      public Utilities::PoolAllocated {
 public:
   /**
    * @brief Constructs the object.
    * @param source The id of the object this message originates from.
    * @param destination The id of the object this message shall be sent to.
+   * @param kind The concrete type of the message.
+   * @param priority The priority class of the message.
    */
-  DeviceMessage(UserId source, UserId destination);
+  DeviceMessage(UserId source, UserId destination, DeviceMessageKind kind,
+                MessagePriority priority = MESSAGE_PRIORITY_NORMAL);
 
   /**
    * @brief Destroy the Device Message object
@@ -65,6 +107,25 @@ public:
    */
   UserId getDestination();
 
+  /**
+   * @brief Returns the concrete type of this message.
+   * @return The concrete type of this message.
+   */
+  DeviceMessageKind getKind() const;
+
+  /**
+   * @brief Returns the priority class of this message.
+   * @return The priority class of this message.
+   */
+  MessagePriority getPriority() const;
+
+  /**
+   * @brief Sets the priority class of this message. Is not transmitted over the
+   * network. The receiving end derives the class from the message again.
+   * @param priority The priority class.
+   */
+  void setPriority(MessagePriority priority);
+
 protected:
   void setSource(UserId source);
   void setDestination(UserId destination);
@@ -79,6 +140,12 @@ private:
   /// The id of the object this message shall be sent to.
   UserId destination;
 
+  /// The concrete type of the message.
+  DeviceMessageKind kind;
+
+  /// The priority class of the message.
+  MessagePriority priority;
+
   /**
    * @brief Generates an unique id.
    * @return An unique id.
@@ -0,0 +1,172 @@
+#ifndef FRAME_DECODER_HPP
+#define FRAME_DECODER_HPP
+
+// Standard includes
+#include <cstddef>
+#include <span>
+#include <vector>
+
+/// The initial capacity of the receive buffer of a frame decoder in bytes.
+#define FRAME_DECODER_DEFAULT_CAPACITY 65536
+/// Frames, whose length field exceeds this count of bytes, are taken as
+/// garbage. Otherwise a corrupted length would stall the stream, until that
+/// many bytes have been received.
+#define FRAME_DECODER_MAX_FRAME_LENGTH (64 * 1024 * 1024)
+/// The count of bytes of a frame, that do not belong to the content. One
+/// opening tag, four length bytes and one closing tag.
+#define FRAME_DECODER_FRAME_OVERHEAD 6
+
+namespace Messages {
+
+/**
+ * @brief Identifies the top level message types and their identifier byte.
+ */
+enum MessageType {
+  INVALID_MESSAGE_TYPE = 0x00,
+
+  WRITE_DEVICE_MESSAGE = 0x01,
+
+  READ_DEVICE_MESSAGE = 0x02,
+
+  HANDSHAKE_MESSAGE = 0x03,
+
+  INIT_DEVICE_MESSAGE = 0x04,
+
+  CONFIG_DEVICE_MESSAGE = 0x05
+};
+
+/**
+ * @brief Outcome of the search for a frame within a sequence of bytes.
+ */
+enum FrameScanResult {
+  /// A complete frame has been found.
+  FRAME_SCAN_RESULT_FOUND = 0x01,
+  /// No complete frame is contained. More bytes have to be received.
+  FRAME_SCAN_RESULT_INCOMPLETE = 0x02,
+};
+
+/**
+ * @brief Extracts message frames from a stream of received bytes. A frame
+ * consists of the message type tag, the length of the content as four
+ * little-endian bytes, the content and the message type tag again.
+ *
+ * The received bytes are kept in one contiguous buffer, that is reused across
+ * calls. Consumed bytes are dropped by advancing the start of the buffer, and
+ * only the bytes of a partially received frame are moved back to the front,
+ * once the free space at the end runs out. The decoder remembers the size of a
+ * partially received frame, so bytes are not scanned again while waiting for
+ * its remainder. Frames are returned as views into the buffer, hence there are
+ * no allocations per frame or byte.
+ */
+class FrameDecoder {
+public:
+  /**
+   * @brief Creates a decoder with an empty buffer.
+   * @param capacity The initial capacity of the buffer in bytes. The buffer
+   * grows, if a frame does not fit.
+   */
+  explicit FrameDecoder(size_t capacity = FRAME_DECODER_DEFAULT_CAPACITY);
+
+  /**
+   * @brief Returns writable memory at the end of the buffer, e.g. for a socket
+   * to receive into. The bytes have to be committed afterwards. Invalidates
+   * the frames, that have been extracted before.
+   * @param size The count of bytes, that shall be writable.
+   * @return The writable memory.
+   */
+  std::span<unsigned char> prepare(size_t size);
+
+  /**
+   * @brief Appends bytes, that have been written to the memory returned by
+   * prepare(), to the received bytes.
+   * @param size The count of bytes. Must not exceed the size passed to
+   * prepare().
+   */
+  void commit(size_t size);
+
+  /**
+   * @brief Appends received bytes. Invalidates the frames, that have been
+   * extracted before.
+   * @param bytes The bytes.
+   */
+  void append(std::span<const unsigned char> bytes);
+
+  /**
+   * @brief Extracts the next complete frame.
+   * @param frame Will contain a view of the frame, including its tags and
+   * length bytes. Stays valid until the next call of prepare(), append() or
+   * clear().
+   * @return TRUE if a frame has been extracted. FALSE if no complete frame has
+   * been received yet.
+   */
+  bool extractFrame(std::span<const unsigned char> &frame);
+
+  /**
+   * @brief Extracts all complete frames.
+   * @param frames Will contain views of the frames in the order of reception.
+   * They stay valid until the next call of prepare(), append() or clear().
+   * @return The count of extracted frames.
+   */
+  size_t extractFrames(std::vector<std::span<const unsigned char>> &frames);
+
+  /**
+   * @brief Drops all received bytes, e.g. after the connection has been lost.
+   */
+  void clear();
+
+  /**
+   * @brief Returns the count of received bytes, that have not been extracted
+   * as frame or discarded yet.
+   * @return The count of bytes.
+   */
+  size_t getBufferedByteCount() const;
+
+  /**
+   * @brief Returns the count of bytes, that have been discarded, because they
+   * did not belong to a frame.
+   * @return The count of bytes.
+   */
+  size_t getDiscardedByteCount() const;
+
+  /**
+   * @brief Searches the first complete frame within the given bytes.
+   * @param bytes The bytes.
+   * @param frameStart Will contain the index of the first byte of the frame.
+   * If no complete frame is found, the index of the first byte, that may
+   * start a frame. All bytes before are garbage.
+   * @param frameSize Will contain the size of the frame. If no complete frame
+   * is found, the size of the started frame, or 0 if its length has not been
+   * received yet.
+   * @return Whether a complete frame has been found.
+   */
+  static FrameScanResult scanFrame(std::span<const unsigned char> bytes,
+                                   size_t &frameStart, size_t &frameSize);
+
+  /**
+   * @brief Checks if the given byte is an message type tag.
+   * @param byte The byte that shall be analyzed.
+   * @return TRUE if the given byte is a message type tag. FALSE otherwise.
+   */
+  static bool isMessageTypeTag(unsigned char byte);
+
+private:
+  /// The memory of the buffer. Only the bytes within [head, tail) are valid.
+  std::vector<unsigned char> buffer;
+
+  /// Index of the first received byte, that has not been consumed yet.
+  size_t head;
+
+  /// Index behind the last received byte.
+  size_t tail;
+
+  /// The size of the frame, that starts at head and has not been received
+  /// completely. 0 if unknown.
+  size_t pendingFrameSize;
+
+  /// The count of bytes, that did not belong to a frame.
+  size_t discardedByteCount;
+};
+
+} // namespace Messages
+
+#endif
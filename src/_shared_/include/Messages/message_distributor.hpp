@@ -2,26 +2,98 @@
 #define MESSAGE_DISTRIBUTOR_HPP
 
 // Standard includes
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 
 // Project includes
 #include <message_interface.hpp>
+#include <message_lanes.hpp>
+#include <mpsc_queue.hpp>
+#include <thread_pool.hpp>
 
 namespace Messages {
 
+/**
+ * @brief Determines when the message distributor runs a cycle.
+ */
+enum MessageDistributorMode {
+  /// A cycle is run once per loop interval.
+  MESSAGE_DISTRIBUTOR_MODE_POLLING = 0x01,
+  /// A cycle is run as soon as a participant queues a message, and at least
+  /// once per loop interval, so participants can poll their hardware.
+  MESSAGE_DISTRIBUTOR_MODE_EVENT_DRIVEN = 0x02
+};
+
+/**
+ * @brief A participant, that is run as actor. Messages to the participant are
+ * queued in its mailbox and taken by a task on the worker pool of the message
+ * distributor. At most one task of an actor runs at a time.
+ */
+struct ParticipantActor {
+  /**
+   * @brief Constructs the actor of the given participant.
+   * @param participant The participant.
+   */
+  ParticipantActor(std::shared_ptr<MessageInterface> participant);
+
+  /// The participant.
+  std::shared_ptr<MessageInterface> participant;
+
+  /// The messages to the participant in order of delivery. Messages of higher
+  /// priority classes are taken first.
+  MessageMailbox mailbox;
+
+  /// Set when the participant shall be read by the next task.
+  std::atomic<bool> readPending;
+
+  /// Set while a task of the actor is queued or running.
+  std::atomic<bool> scheduled;
+};
+
+/**
+ * @brief Delivers the messages between its participants. The participants are
+ * found by a routing table, that maps the ids of the participants and their
+ * proxy ids to the participants. So the cost of routing a message does not
+ * depend on the count of participants and proxies.
+ */
 class MessageDistributor {
 public:
+  friend class MessageInterface;
+
   /**
    * @brief Construct a new MessageDistributor object
    * @param loopInterval The interval of the run loop.
+   * @param mode Whether the distributor waits for the interval only, or wakes
+   * up when messages are queued.
+   * @param workerCount The count of threads, the participants are run on as
+   * actors. If zero, the participants are read and take their messages one
+   * after another on the thread of run(). Otherwise, a slow participant only
+   * delays its own messages. In both cases, messages from one participant to
+   * another, that have the same priority class, are taken in the order they
+   * have been sent. Messages of different priority classes are not: a
+   * message of a higher class may overtake a message of a lower class, that
+   * has been sent before, as MessageMailbox::drain() and sortByPriority()
+   * put the higher classes first. With workers, the handlers of a
+   * participant still run one at a time, but on changing pool threads and
+   * concurrently to the other participants. See MessageInterface for the
+   * requirements on the participants.
    */
-  MessageDistributor(int loopInterval);
-  MessageDistributor(std::chrono::milliseconds loopInterval);
+  MessageDistributor(
+      int loopInterval,
+      MessageDistributorMode mode = MESSAGE_DISTRIBUTOR_MODE_POLLING,
+      unsigned int workerCount = 0);
+  MessageDistributor(
+      std::chrono::milliseconds loopInterval,
+      MessageDistributorMode mode = MESSAGE_DISTRIBUTOR_MODE_POLLING,
+      unsigned int workerCount = 0);
 
   /**
-   * @brief Takes the given message. It will be delivered on the next call of
-   * deliverMessages().
+   * @brief Takes the given message. It is delivered in the next cycle of
+   * run(). May be called from any thread.
    * @param message The message that shall be taken.
    */
   void takeMessage(std::shared_ptr<DeviceMessage> message);
@@ -50,7 +122,9 @@ public:
   std::list<UserId> getParticipants();
 
   /**
-   * @brief Returns the status of all participants.
+   * @brief Returns the status of all participants. May be called from any
+   * thread, including the participants, while run() executes. Participants
+   * must not be added meanwhile.
    * @return std::list containing the status of all participants.
    */
   std::list<std::shared_ptr<StatusPayload>> getStatus();
@@ -71,22 +145,146 @@ public:
    */
   bool isRunning() const;
 
+  /**
+   * @brief Signals that messages have been queued. In event-driven mode, the
+   * distributor runs its next cycle immediately. May be called from any
+   * thread.
+   */
+  void notify();
+
+  /**
+   * @brief Returns the count of messages, whose destination has not been
+   * found.
+   * @return The count of misrouted messages.
+   */
+  size_t getMisroutedMessageCount() const;
+
+  /**
+   * @brief Returns the count of messages, that the targeted participant was
+   * not able to process.
+   * @return The count of failed deliveries.
+   */
+  size_t getFailedDeliveryCount() const;
+
 private:
+  /**
+   * @brief Routes the messages with the given destination to the given
+   * participant. Existing routes are kept.
+   * @param destination The own id or a proxy id of the participant.
+   * @param participant The participant.
+   * @return TRUE if the route has been added. FALSE if the destination is
+   * already routed to another participant.
+   */
+  bool addRoute(UserId destination,
+                std::shared_ptr<MessageInterface> participant);
+
+  /**
+   * @brief Removes the route of the given destination, if it leads to the
+   * given participant.
+   * @param destination The destination.
+   * @param participant The participant.
+   * @return TRUE if the route has been removed. FALSE otherwise.
+   */
+  bool removeRoute(UserId destination, MessageInterface *participant);
+
+  /**
+   * @brief Looks up the participant, that is targeted by the given id.
+   * @param destination The destination of a message.
+   * @return Pointer to the actor of the participant. Null if the destination
+   * is unknown.
+   */
+  std::shared_ptr<ParticipantActor> findRoute(UserId destination);
+
+  /**
+   * @brief Delivers the message to its destination. Without a worker pool,
+   * the destination takes the message right away. Otherwise, the message is
+   * queued in the mailbox of the destination. If the destination is unknown, a
+   * failed response is queued for the next cycle. May be called from the
+   * tasks of the actors.
+   * @param message The message.
+   */
+  void deliverMessage(std::shared_ptr<DeviceMessage> message);
+
+  /**
+   * @brief Lets the participant take the message and counts failures.
+   * @param participant The participant.
+   * @param message The message.
+   */
+  void processMessage(const std::shared_ptr<MessageInterface> &participant,
+                      std::shared_ptr<DeviceMessage> message);
+
+  /**
+   * @brief Queues a task of the actor on the worker pool, unless one is queued
+   * or running already.
+   * @param actor The actor.
+   */
+  void scheduleActor(const std::shared_ptr<ParticipantActor> &actor);
+
+  /**
+   * @brief The task of an actor. Lets the participant take the messages of its
+   * mailbox, then reads it if requested and delivers the read messages.
+   * Exceptions of the participant are logged, and messages, that it threw on,
+   * are counted as failed deliveries.
+   * @param actor The actor.
+   */
+  void runActor(std::shared_ptr<ParticipantActor> actor);
+
   /// Chaches messages until the next call to deliverMessages().
   std::list<std::shared_ptr<DeviceMessage>> messageCache;
 
+  /// Messages, that have been taken from outside by takeMessage(). Is filled
+  /// by any thread and drained into the message cache at the start of each
+  /// cycle.
+  MpscQueue<DeviceMessage> incomingMessages;
+
   /// Chaches messages that indicate a failed response until they can be added
-  /// to the message cache.
-  std::list<std::shared_ptr<DeviceMessage>> failedResponseCache;
+  /// to the message cache. Is filled by the tasks of the actors, too.
+  MpscQueue<DeviceMessage> failedResponseCache;
 
   /// std::list of participants.
   std::list<std::shared_ptr<MessageInterface>> participants;
 
+  /// The actors of the participants.
+  std::unordered_map<MessageInterface *, std::shared_ptr<ParticipantActor>>
+      actors;
+
+  /// Maps the ids of the participants and their proxy ids to the actors of
+  /// the participants.
+  std::unordered_map<size_t, std::shared_ptr<ParticipantActor>> routingTable;
+
+  /// Guards the routing table and the actors. Proxy ids are added and removed
+  /// by the threads of the participants.
+  std::mutex routingTableMutex;
+
+  /// The count of messages, whose destination has not been found.
+  std::atomic<size_t> misroutedMessageCount;
+
+  /// The count of messages, that the targeted participant was not able to
+  /// process.
+  std::atomic<size_t> failedDeliveryCount;
+
   /// Flag that tells the message distributor to run.
   bool doRun;
 
   /// The loop interval. In milli seconds.
   Duration loopInterval;
+
+  /// Determines when a cycle is run.
+  MessageDistributorMode mode;
+
+  /// Set when messages have been queued since the last cycle.
+  bool wakeupPending;
+
+  /// Guards the wakeup flag.
+  std::mutex wakeupMutex;
+
+  /// Wakes up the run loop in event-driven mode.
+  std::condition_variable wakeupCondition;
+
+  /// The threads, the actors are run on. Null if the participants are run on
+  /// the thread of run(). Is declared last, so the running tasks are finished
+  /// before the other members are destroyed.
+  std::unique_ptr<ThreadPool> workerPool;
 };
 }; // namespace Messages
 
@@ -3,37 +3,30 @@
 
 // Standard includes
 #include <list>
+#include <span>
 #include <string>
+#include <vector>
 
 // Project includes
 #include <device_message.hpp>
+#include <frame_decoder.hpp>
 #include <payload_decoder.hpp>
+#include <payload_registry.hpp>
 #include <read_payload.hpp>
 
 // Generated includes
 #include <device_message_generated.h>
 
+/// The initial size of the builders, that are used for encoding, in bytes.
+#define MESSAGE_FACTORY_INITIAL_BUILDER_SIZE 4096
+/// The alignment of serialized payloads within an encoded message in bytes.
+/// Matches the largest scalar, so payloads can be read in place.
+#define MESSAGE_FACTORY_PAYLOAD_ALIGNMENT 8
+
 using namespace Devices;
 
 namespace Messages {
 
-/**
- * @brief Identifies the top level message types and their identifier byte.
- */
-enum MessageType {
-  INVALID_MESSAGE_TYPE = 0x00,
-
-  WRITE_DEVICE_MESSAGE = 0x01,
-
-  READ_DEVICE_MESSAGE = 0x02,
-
-  HANDSHAKE_MESSAGE = 0x03,
-
-  INIT_DEVICE_MESSAGE = 0x04,
-
-  CONFIG_DEVICE_MESSAGE = 0x05
-};
-
 /**
  * @brief Identifies the payload types and their identifier byte.
  */
@@ -56,6 +49,26 @@ public:
   std::shared_ptr<DeviceMessage>
   decodeMessage(std::vector<unsigned char> &buffer);
 
+  /**
+   * @brief Decodes the next message, that has been received completely by the
+   * given frame decoder. Frames, that can not be decoded, are skipped.
+   * @param frameDecoder The frame decoder, that holds the received bytes.
+   * @return Pointer to a device message if a message has been decoded. Null
+   * pointer otherwise.
+   */
+  std::shared_ptr<DeviceMessage> decodeMessage(FrameDecoder &frameDecoder);
+
+  /**
+   * @brief Decodes all messages, that have been received completely by the
+   * given frame decoder. Frames, that can not be decoded, are skipped.
+   * @param frameDecoder The frame decoder, that holds the received bytes.
+   * @param messages Will contain the decoded messages in the order of
+   * reception.
+   * @return The count of decoded messages.
+   */
+  size_t decodeMessages(FrameDecoder &frameDecoder,
+                        std::vector<std::shared_ptr<DeviceMessage>> &messages);
+
   /**
    * @brief Encodes the given message into a byte vector.
    * @param msg The message that shall be ecnoded.
@@ -63,6 +76,19 @@ public:
    */
   std::vector<unsigned char> encodeMessage(std::shared_ptr<DeviceMessage> msg);
 
+  /**
+   * @brief Encodes the given message into a frame. The message is serialized
+   * with builders, that are reused by the calling thread, and the frame is
+   * written with a single copy. Passing the same frame again reuses its
+   * memory, so encoding does not allocate in the steady state.
+   * @param msg The message that shall be encoded.
+   * @param frame Will contain the encoded message. Empty if the message could
+   * not be encoded.
+   * @return TRUE if the message has been encoded. FALSE otherwise.
+   */
+  bool encodeMessage(std::shared_ptr<DeviceMessage> msg,
+                     std::vector<unsigned char> &frame);
+
   /**
    * @brief Create an instance of the message factory, if there is not already
    * one existing.
@@ -88,57 +114,73 @@ public:
    */
   std::string getVersion() const;
 
-  ReadPayload *decodeReadPayload(std::vector<unsigned char> payload,
+  /**
+   * @brief Registers a decoder for payloads, e.g. of an external device type.
+   * Has to be called before messages are decoded.
+   * @param payloadDecoder The decoder.
+   * @return TRUE if the decoder has been registered. FALSE otherwise.
+   */
+  bool registerPayloadDecoder(std::shared_ptr<PayloadDecoder> payloadDecoder);
+
+  /**
+   * @brief Registers an encoder for the payloads with the given magic number.
+   * It takes precedence over the encoding of the payload itself. Has to be
+   * called before messages are encoded.
+   * @param magicNumber The magic number of the payloads.
+   * @param payloadEncoder The encoder.
+   * @return TRUE if the encoder has been registered. FALSE otherwise.
+   */
+  bool registerPayloadEncoder(int magicNumber, PayloadEncoder payloadEncoder);
+
+  ReadPayload *decodeReadPayload(const PayloadBuffer &payload,
                                  int magicNumber);
-  WritePayload *decodeWritePayload(std::vector<unsigned char> payload,
+  WritePayload *decodeWritePayload(const PayloadBuffer &payload,
                                    int magicNumber);
-  InitPayload *decodeInitPayload(std::vector<unsigned char> payload,
+  InitPayload *decodeInitPayload(const PayloadBuffer &payload,
                                  int magicNumber);
-  ConfigurationPayload *
-  decodeConfigurationPayload(std::vector<unsigned char> payload,
-                             int magicNumber);
+  ConfigurationPayload *decodeConfigurationPayload(const PayloadBuffer &payload,
+                                                   int magicNumber);
 
 private:
   /**
-   * @brief Checks if the given byte is an message type tag.
-   * @param byte The byte that shall be analyzed.
-   * @return TRUE if the given byte is a message type tag. FALSE otherwise.
+   * @brief Decodes a single frame. The flatbuffer is copied once into a
+   * shared buffer and verified. The payloads are decoded from views into that
+   * buffer.
+   * @param frame The frame, including its tags and length bytes.
+   * @return Pointer to a device message if decoding was successfull. Null
+   * pointer otherwise.
    */
-  bool isMessageTypeTag(char byte) const;
-
-  std::vector<unsigned char> *extractFrame(std::list<unsigned char> &buffer);
-
-  std::shared_ptr<DeviceMessage> decodeFrame(std::vector<unsigned char> *buffer,
-                                             MessageType &msgTypeHint);
+  std::shared_ptr<DeviceMessage>
+  decodeFrame(std::span<const unsigned char> frame);
 
   std::shared_ptr<DeviceMessage> translateMessageContent(
       UserId sourceId, UserId destinationId,
-      const Serialization::Messages::HandshakeMessageContentT
+      const Serialization::Messages::HandshakeMessageContent
           *handshakeContent);
 
   std::shared_ptr<DeviceMessage> translateMessageContent(
       UserId sourceId, UserId destinationId,
-      const Serialization::Messages::ReadDeviceMessageContentT
+      const Serialization::Messages::ReadDeviceMessageContent
           *readDeviceContent,
-      int magicNumber);
+      const PayloadBuffer &buffer);
 
   std::shared_ptr<DeviceMessage> translateMessageContent(
       UserId sourceId, UserId destinationId,
-      const Serialization::Messages::InitDeviceMessageContentT
+      const Serialization::Messages::InitDeviceMessageContent
           *initDeviceContent,
-      int magicNumber);
+      const PayloadBuffer &buffer);
 
   std::shared_ptr<DeviceMessage> translateMessageContent(
       UserId sourceId, UserId destinationId,
-      const Serialization::Messages::ConfigDeviceMessageContentT
+      const Serialization::Messages::ConfigDeviceMessageContent
           *configDeviceContent,
-      int magicNumber);
+      const PayloadBuffer &buffer);
 
   std::shared_ptr<DeviceMessage> translateMessageContent(
       UserId sourceId, UserId destinationId,
-      const Serialization::Messages::WriteDeviceMessageContentT
+      const Serialization::Messages::WriteDeviceMessageContent
           *writeDeviceContent,
-      int magicNumber);
+      const PayloadBuffer &buffer);
 
   /**
    * @brief Construct a new Message Factory object
@@ -148,9 +190,9 @@ private:
   /// @brief The only instance of the class.
   static MessageFactory *instance;
 
-  /// @brief std::list of payload decoders, that are available to the message
-  /// factory.
-  std::list<std::shared_ptr<PayloadDecoder>> payloadDecoders;
+  /// @brief The payload decoders and encoders, that are available to the
+  /// message factory.
+  PayloadRegistry payloadRegistry;
 };
 
 } // namespace Messages
@@ -3,9 +3,11 @@
 #define MESSAGE_INTERFACE_HPP
 
 // Standard includes
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <queue>
 
 // Project includes
@@ -13,6 +15,7 @@
 #include <data_manager.hpp>
 #include <handshake_message.hpp>
 #include <init_device_message.hpp>
+#include <message_lanes.hpp>
 #include <read_device_message.hpp>
 #include <user_id.hpp>
 #include <utilities.hpp>
@@ -22,11 +25,23 @@ using namespace Utilities;
 
 namespace Messages {
 
-class MessgeDistributor;
+class MessageDistributor;
 
 /**
  * @brief Declares an interface that allows reading, writing and
  * subscription to messages.
+ *
+ * The message distributor calls read(), takeMessage() and thereby write() and
+ * handleResponse() of a participant one at a time. If the distributor runs its
+ * participants on a worker pool, these calls may be made from a different
+ * thread each time, while other participants run concurrently. State, that is
+ * shared between these calls and threads of the participant itself, has to be
+ * guarded by the participant.
+ *
+ * constructStatus() may be called from any thread at any time, e.g. by
+ * MessageDistributor::getStatus() on behalf of another participant. It may
+ * only read the device state, the proxy ids and, while holding statusMutex,
+ * the init and config payloads of this class.
  */
 class MessageInterface {
 public:
@@ -37,7 +52,8 @@ public:
    * @param deviceType The type of device this message interface is
    * representing.
    * @param dataManagerType The type of the underlying data manager, that shall
-   * be used.
+   * be used. If the session store has been opened beforehand, HDF data
+   * managers are replaced by data managers that write into the session file.
    */
   MessageInterface(
       DeviceType deviceType, unsigned int dataManagerMeasurementLevel,
@@ -117,8 +133,9 @@ public:
   UserId getUserId() const;
 
   /**
-   * @brief Returns the Ids this object is the proxy of.
-   * @return The std::list of proxy ids of this object.
+   * @brief Returns the Ids this object is the proxy of. May be called from any
+   * thread.
+   * @return A copy of the std::list of proxy ids of this object.
    */
   std::list<UserId> getProxyUserIds() const;
 
@@ -150,7 +167,8 @@ public:
   bool isExactTarget(UserId id);
 
   /**
-   * @brief Constructs the current status of the object.
+   * @brief Constructs the current status of the object. May be called from
+   * any thread, see the class description for the state, that may be read.
    * @return Pointer to the current status of the object.
    */
   virtual std::shared_ptr<StatusPayload> constructStatus() = 0;
@@ -215,19 +233,23 @@ protected:
   void clearProxyIds();
 
   /**
-   * @brief Pushes the given message to the outgoing queue.
+   * @brief Pushes the given message to the outgoing queue. Does not lock and
+   * may be called from any thread. A message can only be queued once at a
+   * time.
    * @param msg The message that shall be pushed to the outgoing message queue.
    */
   void pushMessageQueue(std::shared_ptr<DeviceMessage> msg);
 
   /**
-   * @brief Pushes multiple messages to the outgoing queue.
+   * @brief Pushes multiple messages to the outgoing queue at once. Does not
+   * lock and may be called from any thread.
    * @param msg The messages that shall be pushed to the outgoing message queue.
    */
   void pushMessageQueue(const std::vector<std::shared_ptr<DeviceMessage>> &msg);
 
   /**
    * @brief Removes messages from the queue, that have the given destinations.
+   * Must only be called by the consumer of the queue.
    * @param destinations Vector of destinations.
    * @return Count of messages that have been removed.
    */
@@ -266,7 +288,8 @@ protected:
                     const SpectrumMapping &spectrumMapping);
 
   /**
-   * @brief Pops a message from the internal message queue.
+   * @brief Pops a message from the internal message queue. Must only be called
+   * by the consumer of the queue.
    * @return Pointer to a message. May be a nullptr, if there was no message in
    * the queue.
    */
@@ -316,11 +339,17 @@ protected:
   std::vector<UserId> eventResponseId;
 
   /// The payload this interface has been initialized with. May be empty.
+  /// Is only changed while holding statusMutex.
   std::shared_ptr<InitPayload> initPayload;
 
   /// The payload this interface has been configured with. May be empty.
+  /// Is only changed while holding statusMutex.
   std::shared_ptr<ConfigurationPayload> configPayload;
 
+  /// Guards the init and config payload against constructStatus(), that may
+  /// be called from other threads.
+  std::mutex statusMutex;
+
   /// Reference to the message distributor this object belongs to. Is set when
   /// the message interface object is added to the distributor as participant.
   MessageDistributor *messageDistributor;
@@ -329,8 +358,9 @@ protected:
   /// the message interface object is added to the distributor as participant.
   std::shared_ptr<MessageInterface> self;
 
-  /// The state of the device.
-  DeviceStatus deviceState;
+  /// The state of the device. Is atomic, as it is read by constructStatus()
+  /// and the threads of the device.
+  std::atomic<DeviceStatus> deviceState;
 
   /// The type of the device.
   DeviceType deviceType;
@@ -345,11 +375,23 @@ private:
   /// The unique ids of the objects that are represented by this object.
   std::list<UserId> proxyIds;
 
-  /// Queue for outgoing messages.
-  std::queue<std::shared_ptr<DeviceMessage>> messageOut;
+  /// Guards the proxy ids. They are changed by the thread of the participant
+  /// and read by the message distributor.
+  mutable std::mutex proxyIdsMutex;
+
+  /// Queue for outgoing messages. Is filled by any thread and drained by the
+  /// message distributor. Messages of higher priority classes are drained
+  /// first.
+  MessageMailbox messageOut;
+
+  /// Messages, that have been drained from messageOut, but have not been
+  /// popped yet. Is only accessed by the consumer of messageOut.
+  std::list<std::shared_ptr<DeviceMessage>> messageOutPending;
 
-  /// Mutex that guards the messageOut queue.
-  std::mutex messageOutMutex;
+  /**
+   * @brief Signals the message distributor, that messages have been queued.
+   */
+  void notifyMessageDistributor();
 };
 
 } // namespace Messages
@@ -0,0 +1,120 @@
+#ifndef MESSAGE_LANES_HPP
+#define MESSAGE_LANES_HPP
+
+// Standard includes
+#include <list>
+#include <memory>
+#include <queue>
+#include <vector>
+
+// Project includes
+#include <device_message.hpp>
+#include <mpsc_queue.hpp>
+
+/// The count of messages, that may be taken from other lanes, while a lane
+/// with waiting messages is passed over. Then, the lane is served once.
+#define MESSAGE_LANES_STARVATION_LIMIT 8
+
+namespace Messages {
+
+/**
+ * @brief Queues messages in one lane per priority class. Messages are taken
+ * from the lane of the highest class, that holds messages. Lanes, that have
+ * been passed over MESSAGE_LANES_STARVATION_LIMIT times, are served once, so
+ * bulk transfers keep going while control messages are sent. Within a lane,
+ * messages keep their order.
+ *
+ * The lanes are not synchronized.
+ */
+class MessageLanes {
+public:
+  MessageLanes();
+
+  /**
+   * @brief Queues the message in the lane of its priority class.
+   * @param message The message.
+   */
+  void push(std::shared_ptr<DeviceMessage> message);
+
+  /**
+   * @brief Takes the next message.
+   * @return The message. Null if all lanes are empty.
+   */
+  std::shared_ptr<DeviceMessage> pop();
+
+  /**
+   * @brief Indicates, whether all lanes are empty.
+   * @return TRUE if no message is queued. FALSE otherwise.
+   */
+  bool empty() const;
+
+  /**
+   * @brief Returns the count of queued messages.
+   * @return The count of queued messages.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Removes all messages.
+   */
+  void clear();
+
+private:
+  /// The lanes. The index is the priority class.
+  std::queue<std::shared_ptr<DeviceMessage>> lanes[MESSAGE_PRIORITY_COUNT];
+
+  /// How often each lane has been passed over, while it held messages.
+  unsigned int passedOverCounts[MESSAGE_PRIORITY_COUNT];
+};
+
+/**
+ * @brief Lock-free lanes for many producers and a single consumer. Holds one
+ * MpscQueue per priority class. As the consumer always takes all messages at
+ * once, no lane can starve.
+ */
+class MessageMailbox {
+public:
+  /**
+   * @brief Queues the message in the lane of its priority class. May be called
+   * from any thread.
+   * @param message The message.
+   * @return TRUE if the message has been queued. FALSE if it is null or
+   * already queued.
+   */
+  bool push(std::shared_ptr<DeviceMessage> message);
+
+  /**
+   * @brief Queues the messages in the lanes of their priority classes. May be
+   * called from any thread.
+   * @param messages The messages.
+   * @return TRUE if all messages have been queued. FALSE otherwise.
+   */
+  bool push(const std::vector<std::shared_ptr<DeviceMessage>> &messages);
+
+  /**
+   * @brief Takes all queued messages. Must only be called by the consumer.
+   * @param messages The list, the messages are appended to. Messages of higher
+   * classes come first. Within a class, the messages keep their order.
+   */
+  void drain(std::list<std::shared_ptr<DeviceMessage>> &messages);
+
+  /**
+   * @brief Indicates, whether all lanes are empty.
+   * @return TRUE if no message is queued. FALSE otherwise.
+   */
+  bool empty() const;
+
+private:
+  /// The lanes. The index is the priority class.
+  Utilities::MpscQueue<DeviceMessage> lanes[MESSAGE_PRIORITY_COUNT];
+};
+
+/**
+ * @brief Orders the messages by their priority class. Messages of the same
+ * class keep their order.
+ * @param messages The messages.
+ */
+void sortByPriority(std::list<std::shared_ptr<DeviceMessage>> &messages);
+} // namespace Messages
+
+#endif
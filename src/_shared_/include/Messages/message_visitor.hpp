@@ -0,0 +1,73 @@
+#ifndef MESSAGE_VISITOR_HPP
+#define MESSAGE_VISITOR_HPP
+
+// Standard includes
+#include <memory>
+#include <type_traits>
+
+// Project includes
+#include <config_device_message.hpp>
+#include <device_message.hpp>
+#include <handshake_message.hpp>
+#include <init_device_message.hpp>
+#include <read_device_message.hpp>
+#include <write_device_message.hpp>
+
+namespace Messages {
+
+/**
+ * @brief Combines several callables, usually lambdas, into one visitor, that
+ * can be passed to visitMessage(). Each callable handles one or more kinds of
+ * messages.
+ */
+template <typename... Handlers> struct MessageVisitor : Handlers... {
+  using Handlers::operator()...;
+};
+
+template <typename... Handlers>
+MessageVisitor(Handlers...) -> MessageVisitor<Handlers...>;
+
+/**
+ * @brief Calls the visitor with the message cast down to its concrete type.
+ * The type is taken from the kind of the message, so no runtime type
+ * information is needed. The visitor has to accept every kind of message with
+ * the same return type. Otherwise the call does not compile.
+ * @param message The message. Must not be null.
+ * @param visitor The visitor.
+ * @return The result of the visitor.
+ */
+template <typename Visitor>
+auto visitMessage(const std::shared_ptr<DeviceMessage> &message,
+                  Visitor &&visitor) {
+  using Result =
+      std::invoke_result_t<Visitor, std::shared_ptr<WriteDeviceMessage>>;
+  static_assert(
+      std::is_invocable_r_v<Result, Visitor,
+                            std::shared_ptr<ReadDeviceMessage>> &&
+          std::is_invocable_r_v<Result, Visitor,
+                                std::shared_ptr<HandshakeMessage>> &&
+          std::is_invocable_r_v<Result, Visitor,
+                                std::shared_ptr<InitDeviceMessage>> &&
+          std::is_invocable_r_v<Result, Visitor,
+                                std::shared_ptr<ConfigDeviceMessage>>,
+      "The visitor has to handle every kind of message.");
+
+  switch (message->getKind()) {
+  case DEVICE_MESSAGE_KIND_WRITE:
+    return visitor(std::static_pointer_cast<WriteDeviceMessage>(message));
+  case DEVICE_MESSAGE_KIND_READ:
+    return visitor(std::static_pointer_cast<ReadDeviceMessage>(message));
+  case DEVICE_MESSAGE_KIND_HANDSHAKE:
+    return visitor(std::static_pointer_cast<HandshakeMessage>(message));
+  case DEVICE_MESSAGE_KIND_INIT:
+    return visitor(std::static_pointer_cast<InitDeviceMessage>(message));
+  case DEVICE_MESSAGE_KIND_CONFIG:
+    return visitor(std::static_pointer_cast<ConfigDeviceMessage>(message));
+  }
+
+  // Not reached. Every message is constructed with one of the kinds above.
+  return Result();
+}
+} // namespace Messages
+
+#endif
@@ -92,6 +92,15 @@ public:
    */
   ReadDeviceTopic getTopic();
 
+  /**
+   * @brief Returns the priority class of messages with the given topic. Status
+   * messages and failed responses are control messages, data responses are
+   * bulk messages.
+   * @param topic The topic.
+   * @return The priority class.
+   */
+  static MessagePriority getTopicPriority(ReadDeviceTopic topic);
+
 private:
   /// Reference to the messsage this message is the response to.
   std::shared_ptr<WriteDeviceMessage> originalMessage;
@@ -92,6 +92,15 @@ public:
    */
   WriteDeviceTopic getTopic();
 
+  /**
+   * @brief Returns the priority class of messages with the given topic. Run,
+   * stop, state queries and device specific commands, like set points, are
+   * control messages.
+   * @param topic The topic.
+   * @return The priority class.
+   */
+  static MessagePriority getTopicPriority(WriteDeviceTopic topic);
+
   /**
    * @brief Serializes the contents of the message into a human-readable string.
    * @return The string representation of the message.
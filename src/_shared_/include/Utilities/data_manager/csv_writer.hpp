@@ -0,0 +1,128 @@
+#ifndef CSV_WRITER_HPP
+#define CSV_WRITER_HPP
+
+// Standard includes
+#include <deque>
+#include <fstream>
+#include <future>
+#include <string>
+#include <vector>
+
+// Project includes
+#include <thread_pool.hpp>
+
+namespace Utilities {
+
+/**
+ * @brief Streams numeric rows into a CSV file. Rows are handed over in blocks.
+ * Each block is formatted by a thread pool, while the blocks are written to
+ * the file in the order they have been handed over. Only a limited count of
+ * blocks is kept in memory at once.
+ *
+ * Every row consists of a timestamp followed by a fixed count of values. Each
+ * field is terminated by the separator.
+ */
+class CsvWriter {
+public:
+  /**
+   * @brief Construct the object.
+   * @param threadPool The pool, that formats the blocks.
+   * @param separator The CSV separator.
+   * @param maxPendingBlocks The count of blocks, that may be formatted or
+   * waiting to be written at once.
+   */
+  CsvWriter(ThreadPool &threadPool, char separator, size_t maxPendingBlocks);
+
+  /**
+   * @brief Writes the pending blocks and closes the file.
+   */
+  ~CsvWriter();
+
+  /**
+   * @brief Opens the output file.
+   * @param fileName The name of the file.
+   * @param append Whether rows shall be appended to an existing file.
+   * @return TRUE if the file has been opened. FALSE otherwise.
+   */
+  bool open(const std::string &fileName, bool append = false);
+
+  /**
+   * @brief Writes a header line. Skipped, if rows are appended to a file,
+   * that already contains a header.
+   * @param columns The names of the columns.
+   * @return TRUE if the header has been written. FALSE otherwise.
+   */
+  bool writeHeader(const std::vector<std::string> &columns);
+
+  /**
+   * @brief Queues a block of rows for formatting and writing. Blocks if the
+   * maximum count of pending blocks has been reached, until the oldest block
+   * has been written.
+   * @param timestamps The timestamps of the rows.
+   * @param values The values of the rows. Holds width values per row.
+   * @param width The count of values per row.
+   * @param polar Whether consecutive pairs of values are real and imaginary
+   * parts, that shall be written as magnitude and phase.
+   * @return TRUE if the block has been queued. FALSE if writing an earlier
+   * block failed.
+   */
+  bool writeBlock(std::vector<long long> &&timestamps,
+                  std::vector<double> &&values, size_t width,
+                  bool polar = false);
+
+  /**
+   * @brief Writes the pending blocks and closes the file.
+   * @return TRUE if all blocks have been written. FALSE otherwise.
+   */
+  bool close();
+
+  /**
+   * @brief Appends the shortest representation of a number to a string.
+   * @param str The string.
+   * @param value The number.
+   */
+  static void appendNumber(std::string &str, double value);
+
+  /**
+   * @brief Appends a number to a string.
+   * @param str The string.
+   * @param value The number.
+   */
+  static void appendNumber(std::string &str, long long value);
+
+private:
+  /**
+   * @brief Formats a block of rows.
+   * @return The formatted rows.
+   */
+  static std::string formatBlock(const std::vector<long long> &timestamps,
+                                 const std::vector<double> &values,
+                                 size_t width, bool polar, char separator);
+
+  /**
+   * @brief Waits for the oldest pending block and writes it to the file.
+   * @return TRUE if the block has been written. FALSE otherwise.
+   */
+  bool writeFront();
+
+  /// The pool, that formats the blocks.
+  ThreadPool &threadPool;
+
+  /// The CSV separator.
+  char separator;
+
+  /// The count of blocks, that may be pending at once.
+  size_t maxPendingBlocks;
+
+  /// The formatted blocks in the order they have to be written.
+  std::deque<std::future<std::string>> pendingBlocks;
+
+  /// The output file.
+  std::ofstream file;
+
+  /// Whether the output file already contains a header.
+  bool hasHeader = false;
+};
+} // namespace Utilities
+
+#endif
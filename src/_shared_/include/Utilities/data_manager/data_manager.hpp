@@ -20,6 +20,10 @@ enum DataManagerType {
   DATAMANAGER_TYPE_INVALID = 0x00,
   /// Data manager with HDF backend.
   DATAMANAGER_TYPE_HDF = 0x01,
+  /// Read-only data manager on top of a memory mapped columnar archive.
+  DATAMANAGER_TYPE_COLUMNAR = 0x02,
+  /// Data manager, that writes into the shared session file of the process.
+  DATAMANAGER_TYPE_SESSION = 0x03,
 };
 
 /**
@@ -53,6 +57,57 @@ typedef std::map<std::string, std::vector<double>> SpectrumMapping;
 /// oldest and most recent timestamps of a data key.
 typedef std::map<std::string, std::pair<TimePoint, TimePoint>> TimerangeMapping;
 
+/// The count of rows, that are read and formatted at once during an export.
+#define DEFAULT_EXPORT_BLOCK_SIZE 4096
+
+/**
+ * @brief Identifies how the rows of an export are decimated.
+ */
+enum ExportDecimation {
+  /// All rows are exported.
+  EXPORT_DECIMATION_NONE = 0x00,
+  /// Only every n-th row is exported.
+  EXPORT_DECIMATION_NTH = 0x01,
+  /// The mean of every n consecutive rows is exported. The timestamp of a mean
+  /// is the timestamp of its first row.
+  EXPORT_DECIMATION_MEAN = 0x02,
+};
+
+/**
+ * @brief Options, that control the export of a data manager's content.
+ */
+struct ExportOptions {
+  /// The CSV separator.
+  char separator = ',';
+  /// The format of impedances. Either "cartesian" or "polar".
+  std::string impedanceFormat = "cartesian";
+  /// The count of threads, that format the output. 0 selects the count of
+  /// hardware threads.
+  unsigned int jobCount = 0;
+  /// The count of rows, that are read and formatted at once.
+  size_t blockSize = DEFAULT_EXPORT_BLOCK_SIZE;
+  /// Regular expression, that has to be found in the name of a measurement
+  /// for it to be exported. The name is given relative to the data root.
+  /// Empty exports all measurements.
+  std::string keyFilter;
+  /// Only measurements of this device type are exported. INVALID exports all
+  /// device types.
+  Devices::DeviceType deviceType = Devices::DeviceType::INVALID;
+  /// Rows older than this time point are not exported.
+  TimePoint from = TimePoint::min();
+  /// Rows more recent than this time point are not exported.
+  TimePoint to = TimePoint::max();
+  /// How the rows are decimated.
+  ExportDecimation decimation = EXPORT_DECIMATION_NONE;
+  /// The count of rows, that are decimated into one.
+  size_t decimationFactor = 1;
+  /// File, that records the last exported timestamp of every CSV output. If
+  /// given, outputs of earlier exports are continued by appending the rows,
+  /// that are more recent than the recorded timestamp. Empty exports
+  /// everything.
+  std::string checkpointFile;
+};
+
 /**
  * @brief Class interface to a class that manages data read and write operations
  * to persistant storage.
@@ -218,14 +273,14 @@ public:
   virtual TimerangeMapping getTimerangeMapping() const = 0;
 
   /**
-   * @brief Writes the current content of the data manager to a CSV file.
-   * @param file Path to the file.
-   * @param separator The CSV separator that shall be used.
+   * @brief Writes the current content of the data manager to CSV files. One
+   * file is written per measurement.
+   * @param directory The directory the files are written to.
+   * @param options The options of the export.
    * @return Whether the operation was successfull.
    */
-  virtual bool writeToCsv(std::map<std::string, std::stringstream *> &ss,
-                          char separator,
-                          const std::string &impedanceFormat) = 0;
+  virtual bool writeToCsv(const std::string &directory,
+                          const ExportOptions &options) = 0;
 
 protected:
   /**
@@ -0,0 +1,320 @@
+#ifndef DATA_MANAGER_COLUMNAR
+#define DATA_MANAGER_COLUMNAR
+
+// Standard includes
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+
+// Project includes
+#include <data_manager.hpp>
+#include <mapped_file.hpp>
+
+namespace Utilities {
+
+/**
+ * @brief Writes a columnar archive. A columnar archive is a directory, that
+ * holds one flat little-endian file per key column and a manifest. The
+ * manifest lists the keys with their types, row counts and time ranges.
+ *
+ * Per key with index n, following files are written:
+ * * n.timestamps - 64 bit integers, milliseconds since epoch, ascending.
+ * * n.values - 32 bit integers for int and string keys, 64 bit floats for
+ * double, complex and spectrum keys. Complex values are stored as real/imag
+ * pairs, spectra as frequency count real/imag pairs per row.
+ * * n.dictionary - Only for string keys. Length prefixed strings, whose index
+ * is the code that is stored in n.values.
+ * * n.frequencies - Only for spectrum keys. 64 bit floats.
+ */
+class ColumnarArchiveWriter {
+public:
+  /// Name of the manifest file within the archive directory.
+  static const std::string MANIFEST_FILE_NAME;
+  /// First line of the manifest. Identifies the format and its version.
+  static const std::string MANIFEST_HEADER;
+
+  /**
+   * @brief Creates the archive directory and prepares writing to it.
+   * @param directory The directory of the archive. Is created, if it does not
+   * exist.
+   * @return TRUE if the archive can be written. FALSE otherwise.
+   */
+  bool open(const std::string &directory);
+
+  /**
+   * @brief Starts a new key. Values that are appended afterwards belong to
+   * this key.
+   * @param key The name of the key.
+   * @param dataType The data type of the key.
+   * @param frequencies The frequencies of a spectrum key. Has to be empty for
+   * all other keys.
+   * @return TRUE if the key has been started. FALSE otherwise.
+   */
+  bool beginKey(const std::string &key, DataManagerDataType dataType,
+                const std::vector<double> &frequencies = {});
+
+  /**
+   * @brief Appends timestamps to the current key.
+   * @param timestamps The timestamps in milliseconds since epoch.
+   * @return TRUE if the timestamps have been written. FALSE otherwise.
+   */
+  bool appendTimestamps(const std::vector<long long> &timestamps);
+
+  /**
+   * @brief Appends integer values or string codes to the current key.
+   * @param values The values.
+   * @return TRUE if the values have been written. FALSE otherwise.
+   */
+  bool appendValues(const std::vector<int> &values);
+
+  /**
+   * @brief Appends floating point values to the current key.
+   * @param values The values.
+   * @return TRUE if the values have been written. FALSE otherwise.
+   */
+  bool appendValues(const std::vector<double> &values);
+
+  /**
+   * @brief Sets the dictionary of the current string key.
+   * @param dictionary The dictionary. The index of a string is its code.
+   * @return TRUE if the dictionary has been written. FALSE otherwise.
+   */
+  bool writeDictionary(const std::vector<std::string> &dictionary);
+
+  /**
+   * @brief Finishes the current key.
+   * @return TRUE if the key has been finished. FALSE otherwise.
+   */
+  bool endKey();
+
+  /**
+   * @brief Writes the manifest and finishes the archive.
+   * @return TRUE if the archive has been finished. FALSE otherwise.
+   */
+  bool close();
+
+private:
+  /**
+   * @brief Holds the manifest entry of a key.
+   */
+  struct ManifestEntry {
+    std::string key;
+    DataManagerDataType dataType;
+    size_t rowCount;
+    long long firstTimestamp;
+    long long lastTimestamp;
+  };
+
+  /// The directory of the archive.
+  std::filesystem::path directory;
+
+  /// The manifest entries of the finished keys.
+  std::vector<ManifestEntry> entries;
+
+  /// The manifest entry of the current key.
+  ManifestEntry currentEntry;
+
+  /// Whether a key has been started and not finished yet.
+  bool keyOpen = false;
+
+  /// Stream to the timestamps file of the current key.
+  std::ofstream timestampStream;
+
+  /// Stream to the value file of the current key.
+  std::ofstream valueStream;
+};
+
+/**
+ * @brief Read-only data manager on top of a columnar archive. The columns of
+ * the archive are mapped into memory, so ranges can be accessed without
+ * copying them. Archives are created by DataManagerHdf::writeToColumnar().
+ */
+class DataManagerColumnar : public DataManager {
+public:
+  /**
+   * @brief Destroy the Data Manager object
+   */
+  virtual ~DataManagerColumnar() override;
+
+  /**
+   * @brief Queries the data manager with the given timestamp and key.
+   *
+   * @param timestamp The timestamp that shall be queried.
+   * @param key The key that shall be queried.
+   * @param value WIll contain the value.
+   * @return TRUE if data has been retrieved succesfully. FALSE otherwise.
+   */
+  virtual bool read(TimePoint timestamp, const std::string &key,
+                    Value &value) override;
+
+  /**
+   * @brief Queries the data manager with the given time frame and key.
+   *
+   * @param from The start of the time frame, that shall be queried.
+   * @param to The end of the time frame, that shall be queried.
+   * @param key The key that shall be queried.
+   * @param timestamps Will contain the timestamps that correspond to the
+   * values..
+   * @param value Will contain the value.
+   * @return TRUE if data has been retrieved succesfully. FALSE otherwise.
+   */
+  virtual bool read(TimePoint from, TimePoint to, const std::string &key,
+                    std::vector<TimePoint> &timestamps,
+                    std::vector<Value> &value) override;
+
+  /**
+   * @brief Returns views into the mapped columns of the given key, that cover
+   * the given time frame. The views stay valid until the data manager is
+   * closed.
+   *
+   * @param from The start of the time frame, that shall be queried.
+   * @param to The end of the time frame, that shall be queried.
+   * @param key The key that shall be queried.
+   * @param timestamps Will contain the timestamps in milliseconds since epoch.
+   * @param values Will contain the values. Holds getValueWidth() elements per
+   * timestamp. Has to be of type int for int and string keys and of type
+   * double otherwise.
+   * @return TRUE if the views have been retrieved succesfully. FALSE
+   * otherwise.
+   */
+  template <class T>
+  bool readColumns(TimePoint from, TimePoint to, const std::string &key,
+                   std::span<const long long> &timestamps,
+                   std::span<const T> &values);
+
+  /**
+   * @brief Returns the count of value elements per timestamp of the given key.
+   * @param key The name of the key.
+   * @return The count of value elements per timestamp. 0 if the key is
+   * unknown.
+   */
+  size_t getValueWidth(const std::string &key) const;
+
+  /**
+   * @brief Returns the dictionary of a string key.
+   * @param key The name of the key.
+   * @return The dictionary. Empty if the key is unknown or not a string key.
+   */
+  std::vector<std::string> getDictionary(const std::string &key) const;
+
+  /**
+   * @brief Not supported, as the archive is read-only.
+   * @return FALSE.
+   */
+  virtual bool write(TimePoint timestamp, const std::string &key,
+                     const Value &value) override;
+
+  /**
+   * @brief Not supported, as the archive is read-only.
+   * @return FALSE.
+   */
+  virtual bool write(const std::vector<TimePoint> &timestamp,
+                     const std::string &key,
+                     const std::vector<Value> &value) override;
+
+  /**
+   * @brief Opens the columnar archive and maps its columns into memory.
+   * @param name The directory of the archive.
+   * @return TRUE if the archive has been opened. False otherwise.
+   */
+  virtual bool open(std::string name) override;
+
+  /**
+   * @brief Not supported, as the archive is read-only.
+   * @return FALSE.
+   */
+  virtual bool open(std::string name, KeyMapping keyMapping,
+                    bool force = false) override;
+
+  /**
+   * @brief Unmaps the archive.
+   *
+   * @return TRUE if the archive has been closed successfully. FALSE otherwise.
+   */
+  virtual bool close() override;
+
+  /**
+   * @brief Returns the type of the data manager.
+   * @return The data manager type.
+   */
+  virtual DataManagerType getDataManagerType() const override;
+
+  /**
+   * @brief Not supported, as the archive is read-only.
+   * @return FALSE.
+   */
+  virtual bool createKey(std::string key,
+                         DataManagerDataType dataType) override;
+
+  /**
+   * @brief Not supported, as the archive is read-only.
+   * @return FALSE.
+   */
+  virtual bool
+  createGroup(const std::string &groupName,
+              const std::map<std::string, int> &intProps = {},
+              const std::map<std::string, double> &doubleProps = {},
+              const std::map<std::string, std::string> &strProps = {}) override;
+
+  /**
+   * @brief Returns the timerange mapping of the data manager. The timerange
+   * mapping contains the oldest and the most recent timestamp per data key.
+   * @return The timerange mapping.
+   */
+  virtual TimerangeMapping getTimerangeMapping() const override;
+
+  /**
+   * @brief Not supported. Export the original HDF file instead.
+   * @return FALSE.
+   */
+  virtual bool writeToCsv(const std::string &directory,
+                          const ExportOptions &options) override;
+
+protected:
+  /**
+   * @brief Not supported, as the archive is read-only.
+   * @return FALSE.
+   */
+  virtual bool setupSpectrumSpecific(std::string key,
+                                     std::vector<double> frequencies) override;
+
+private:
+  /**
+   * @brief Holds the mapped columns of a key.
+   */
+  struct Column {
+    /// The mapped timestamps.
+    MappedFile timestamps;
+    /// The mapped values.
+    MappedFile values;
+    /// The count of value elements per timestamp.
+    size_t valueWidth;
+    /// The count of rows of the key.
+    size_t rowCount;
+    /// The dictionary of a string key.
+    std::vector<std::string> dictionary;
+  };
+
+  /**
+   * @brief Finds the rows of the given key, whose timestamps lie within the
+   * given time frame.
+   * @param column The column that shall be searched.
+   * @param from The start of the time frame.
+   * @param to The end of the time frame.
+   * @return The index of the first row and the count of rows.
+   */
+  std::pair<size_t, size_t> findRows(const Column &column, TimePoint from,
+                                     TimePoint to) const;
+
+  /**
+   * @brief Constructs a value of the given key from the given row.
+   */
+  Value getValue(const std::string &key, const Column &column, size_t row);
+
+  /// The mapped columns per key.
+  std::map<std::string, std::unique_ptr<Column>> columns;
+};
+} // namespace Utilities
+
+#endif
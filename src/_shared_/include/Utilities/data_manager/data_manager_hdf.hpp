@@ -3,12 +3,15 @@
 
 // Standard includes
 #include <memory>
+#include <unordered_map>
 
 // 3rd party includes
 #include <highfive/H5File.hpp>
 
 // Project includes
+#include <csv_writer.hpp>
 #include <data_manager.hpp>
+#include <numpy_writer.hpp>
 
 namespace Utilities {
 class DataManagerHdf : public DataManager {
@@ -127,9 +130,119 @@ public:
    */
   virtual TimerangeMapping getTimerangeMapping() const override;
 
-  virtual bool writeToCsv(std::map<std::string, std::stringstream *> &ss,
-                          char separator,
-                          const std::string &impedanceFormat) override;
+  /**
+   * @brief Streams all measurements into CSV files. Blocks of rows are read
+   * sequentially and formatted on a pool of threads, so the memory usage does
+   * not depend on the size of the file.
+   * @param directory The directory the files are written to.
+   * @param options The options of the export.
+   * @return Whether the operation was successfull.
+   */
+  virtual bool writeToCsv(const std::string &directory,
+                          const ExportOptions &options) override;
+
+  /**
+   * @brief Converts the content of the data manager into a columnar archive,
+   * that can be opened with DataManagerColumnar. The data is streamed chunk by
+   * chunk, so memory usage does not depend on the size of the file.
+   * @param directory The directory of the archive.
+   * @return Whether the operation was successfull.
+   */
+  bool writeToColumnar(const std::string &directory);
+
+  /**
+   * @brief Exports the measurements as NumPy arrays. Each impedance
+   * spectrometer measurement contains the arrays "frequencies", "timestamps"
+   * and "values", a complex matrix with one row per spectrum. Each pump
+   * controller channel contains the timestamps and values of the current
+   * pressures and of the setpoints. The data is streamed block by block.
+   * @param directory The directory the outputs are written to.
+   * @param options The options of the export. The separator, impedance format
+   * and job count are ignored.
+   * @param archive Whether each measurement is written as .npz archive, or as
+   * directory of .npy files, that can be memory-mapped.
+   * @return Whether the operation was successfull.
+   */
+  bool writeToNumpy(const std::string &directory, const ExportOptions &options,
+                    bool archive = true);
+
+  /**
+   * @brief Writes all buffered data to the file.
+   * @return TRUE if the file has been flushed. FALSE otherwise.
+   */
+  bool flush();
+
+  /**
+   * @brief Sets whether open(std::string) opens the file read-only. A file,
+   * that has been opened read-only, can not be modified, but may be opened by
+   * other readers at the same time.
+   * @param readOnly Whether the file shall be opened read-only.
+   */
+  void setReadOnly(bool readOnly);
+
+  /**
+   * @brief Determines the rows of a key, whose timestamps lie within the given
+   * time frame. The rows are found by a binary search over the timestamps, so
+   * only a logarithmic count of timestamps is read.
+   * @param key The key.
+   * @param from The start of the time frame.
+   * @param to The end of the time frame.
+   * @param firstRow Will contain the index of the first row.
+   * @param rowCount Will contain the count of rows.
+   * @return TRUE if the rows have been determined. FALSE if the key does not
+   * exist or has no data yet.
+   */
+  bool findRows(const std::string &key, TimePoint from, TimePoint to,
+                size_t &firstRow, size_t &rowCount);
+
+  /**
+   * @brief Returns the shape of the values of a single row of a key. Integer,
+   * double and string keys have an empty shape, complex keys the shape {2}
+   * and spectra the shape {frequency count, 2}, with real and imaginary part
+   * in the last dimension.
+   * @param key The key.
+   * @param shape Will contain the shape.
+   * @return TRUE if the shape has been determined. FALSE if the key does not
+   * exist or has no data yet.
+   */
+  bool getRowShape(const std::string &key, std::vector<size_t> &shape);
+
+  /**
+   * @brief Reads the timestamps of consecutive rows of a key into the given
+   * memory. Together with readValues(), this allows to fill memory owned by
+   * the caller, e.g. NumPy arrays, without intermediate copies.
+   * @param key The key.
+   * @param firstRow The index of the first row.
+   * @param rowCount The count of rows.
+   * @param timestamps Has to hold rowCount timestamps in milliseconds.
+   * @return TRUE if the timestamps have been read. FALSE otherwise.
+   */
+  bool readTimestamps(const std::string &key, size_t firstRow, size_t rowCount,
+                      long long *timestamps);
+
+  /**
+   * @brief Reads the values of consecutive rows of a key into the given
+   * memory. The values are converted into T by the HDF library. String keys
+   * are not supported, as their values are not stored contiguously.
+   * @param key The key.
+   * @param firstRow The index of the first row.
+   * @param rowCount The count of rows.
+   * @param values Has to hold rowCount rows of the shape returned by
+   * getRowShape(), in C order. Instantiated for int, long long and double.
+   * @return TRUE if the values have been read. FALSE otherwise.
+   */
+  template <class T>
+  bool readValues(const std::string &key, size_t firstRow, size_t rowCount,
+                  T *values);
+
+  /**
+   * @brief Sets whether the file is flushed after every modification. If
+   * disabled, the owner has to call flush() itself. This allows to coalesce
+   * the flushes of many small writes.
+   * @param autoFlush Whether the file shall be flushed after every
+   * modification.
+   */
+  void setAutoFlush(bool autoFlush);
 
 protected:
   /**
@@ -140,24 +253,136 @@ protected:
                                      std::vector<double> frequencies) override;
 
 private:
+  /**
+   * @brief The datasets of a key. Releasing a dataset calls into the HDF5
+   * library, hence the handles are released under the data manager lock.
+   */
+  struct KeyDataSets {
+    ~KeyDataSets();
+
+    /// The timestamps dataset.
+    HighFive::DataSet timestamps;
+
+    /// The values dataset.
+    HighFive::DataSet values;
+  };
+
   void traverseNodes(HighFive::Group &node,
                      std::vector<std::string> &nodeNames);
 
   std::map<std::string, Devices::DeviceType>
   filterMeasurements(std::vector<std::string> &groupNames);
 
-  void printImpdedanceSpectrum(std::stringstream &ss,
-                               HighFive::DataSet &spectrumMapping,
-                               HighFive::DataSet &timestamp,
-                               HighFive::DataSet &spectra,
-                               const std::string &impdenaceFormat,
-                               char separator);
+  /**
+   * @brief Determines the measurements, that pass the filters of an export.
+   * @param options The options of the export.
+   * @param measurements Will contain the paths of the measurements and their
+   * device types.
+   * @return TRUE if the measurements have been determined. FALSE if the
+   * filters are invalid.
+   */
+  bool
+  selectMeasurements(const ExportOptions &options,
+                     std::map<std::string, Devices::DeviceType> &measurements);
 
-  void printPumpData(std::stringstream &ss,
-                     HighFive::DataSet &currPressureValues,
-                     HighFive::DataSet &currPressureTimestamps,
-                     HighFive::DataSet &setPressureValue,
-                     HighFive::DataSet &setPressureTimestamps, char separator);
+  /**
+   * @brief Streams the spectra of an impedance spectrometer measurement into a
+   * CSV file.
+   * @param measurement The path of the measurement group.
+   * @param writer The writer of the CSV file.
+   * @param options The options of the export.
+   * @param lastTimestamp Will contain the timestamp of the last exported row.
+   * Stays unchanged, if no row has been exported.
+   * @return TRUE if all spectra have been handed to the writer. FALSE
+   * otherwise.
+   */
+  bool exportImpedanceSpectrum(const std::string &measurement,
+                               CsvWriter &writer, const ExportOptions &options,
+                               long long &lastTimestamp);
+
+  /**
+   * @brief Streams a channel of a pump controller measurement into a CSV file.
+   * Current pressures and setpoints are merged by their timestamps.
+   * @param channel The path of the channel group.
+   * @param writer The writer of the CSV file.
+   * @param options The options of the export.
+   * @param lastTimestamp Will contain the timestamp of the last exported row.
+   * Stays unchanged, if no row has been exported.
+   * @return TRUE if all values have been handed to the writer. FALSE
+   * otherwise.
+   */
+  bool exportPumpData(const std::string &channel, CsvWriter &writer,
+                      const ExportOptions &options, long long &lastTimestamp);
+
+  /**
+   * @brief Streams a series of timestamps and values into two NumPy arrays,
+   * named <prefix>timestamps and <prefix>values.
+   * @param writer The writer of the NumPy output.
+   * @param prefix The prefix of the array names.
+   * @param timestamps The timestamps dataset.
+   * @param values The values dataset.
+   * @param descr The NumPy type descriptor of the values.
+   * @param rowShape The shape of the values of a single timestamp.
+   * @param options The options of the export.
+   * @return TRUE if both arrays have been written. FALSE otherwise.
+   */
+  bool exportNumpySeries(NumpyWriter &writer, const std::string &prefix,
+                         HighFive::DataSet &timestamps,
+                         HighFive::DataSet &values, const std::string &descr,
+                         const std::vector<size_t> &rowShape,
+                         const ExportOptions &options);
+
+  /**
+   * @brief Reads consecutive rows of a dataset into a flat vector.
+   * @param dataset The dataset.
+   * @param offset The index of the first row.
+   * @param count The count of rows.
+   * @param values Will contain the elements of the rows.
+   */
+  template <class T>
+  void readRows(HighFive::DataSet &dataset, size_t offset, size_t count,
+                std::vector<T> &values);
+
+  /**
+   * @brief Reads consecutive rows of a dataset into the given memory.
+   * @param dataset The dataset.
+   * @param offset The index of the first row.
+   * @param count The count of rows.
+   * @param values Has to hold the elements of the rows.
+   */
+  template <class T>
+  void readRows(HighFive::DataSet &dataset, size_t offset, size_t count,
+                T *values);
+
+  /**
+   * @brief Returns the datasets of a key, that has data.
+   * @param key The key.
+   * @param dataSets Will contain the datasets.
+   * @return TRUE if the datasets exist. FALSE otherwise.
+   */
+  bool getDataSets(const std::string &key, KeyDataSets &dataSets);
+
+  /**
+   * @brief Searches the first row of a timestamps dataset, whose timestamp is
+   * not older than the given one.
+   * @param timestamps The timestamps dataset. Has to be sorted.
+   * @param rowCount The count of rows of the dataset.
+   * @param timestamp The timestamp in milliseconds.
+   * @return The index of the row. rowCount, if there is no such row.
+   */
+  size_t lowerBound(HighFive::DataSet &timestamps, size_t rowCount,
+                    long long timestamp);
+
+  /**
+   * @brief Searches the rows of a timestamps dataset, that lie within the
+   * given time frame.
+   * @param timestamps The timestamps dataset. Has to be sorted.
+   * @param from The start of the time frame.
+   * @param to The end of the time frame.
+   * @return The index of the first row and the index behind the last row.
+   */
+  std::pair<size_t, size_t> findRows(HighFive::DataSet &timestamps,
+                                     TimePoint from, TimePoint to);
 
   /**
    * @brief Extends the given dataset by the given count of elements.
@@ -198,12 +423,75 @@ private:
   bool transformTimestampVector(const std::vector<TimePoint> &origVec,
                                 std::vector<long long> &transformedVec);
 
+  /**
+   * @brief Creates the datasets of a dictionary encoded string key. The values
+   * of the key are stored as integer codes, that index into a per-key
+   * dictionary dataset.
+   * @param key The name of the key.
+   * @param props The creation properties of the datasets.
+   */
+  void createStringDataSets(const std::string &key,
+                            const HighFive::DataSetCreateProps &props);
+
+  /**
+   * @brief Reads the dictionary of the given string key from the file into
+   * memory. Keys that have been written by older versions do not have a
+   * dictionary and are left untouched.
+   * @param key The name of the key.
+   */
+  void loadStringDictionary(const std::string &key);
+
+  /**
+   * @brief Translates the given strings into dictionary codes. Strings, that
+   * are not yet part of the dictionary, are appended to it.
+   * @param key The name of the key.
+   * @param origVec The strings that shall be encoded.
+   * @param codes Will contain the codes of the strings.
+   * @return TRUE if encoding was succesfull. FALSE otherwise.
+   */
+  bool encodeStrings(const std::string &key, const std::vector<Value> &origVec,
+                     std::vector<int> &codes);
+
+  /**
+   * @brief Translates the given dictionary codes back into strings.
+   * @param key The name of the key.
+   * @param codes The codes that shall be decoded.
+   * @param strings Will contain the decoded strings.
+   * @return TRUE if all codes could be decoded. FALSE otherwise.
+   */
+  bool decodeStrings(const std::string &key, const std::vector<int> &codes,
+                     std::vector<std::string> &strings);
+
+  /**
+   * @brief Returns whether the given key stores its values dictionary encoded.
+   * @param key The name of the key.
+   * @return Whether the given key stores its values dictionary encoded.
+   */
+  bool isDictionaryEncoded(const std::string &key) const;
+
   /// Pointer to the file.
   std::unique_ptr<HighFive::File> hdfFile;
 
   /// The default chunking size.
   const hsize_t defaultChunkingSize = 1024;
 
+  /// Whether the file is flushed after every modification.
+  bool autoFlush = true;
+
+  /// Whether open(std::string) opens the file read-only.
+  bool readOnly = false;
+
+  /// The chunking size of string dictionaries. Dictionaries are expected to
+  /// stay small, hence a smaller chunk size than for the data is used.
+  const hsize_t dictionaryChunkingSize = 64;
+
+  /// Maps from a string key to its dictionary. The index of a string within
+  /// the vector is the code that is stored in the file.
+  std::map<std::string, std::vector<std::string>> stringDictionaries;
+
+  /// Maps from a string key to the reverse lookup of its dictionary.
+  std::map<std::string, std::unordered_map<std::string, int>> stringCodes;
+
   /// Guard for reads and writes to the data manager. It has to be static, as
   /// HD5 does not allow to read/write to multiple files simultaneously.
   static std::mutex dataManagerMutex;
@@ -0,0 +1,279 @@
+#ifndef DATA_MANAGER_SESSION
+#define DATA_MANAGER_SESSION
+
+// Standard includes
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Project includes
+#include <data_manager_hdf.hpp>
+
+/// The default interval in milliseconds, at which the session file is flushed.
+#define DEFAULT_SESSION_FLUSH_INTERVAL 1000
+
+namespace Utilities {
+
+/**
+ * @brief Process-wide storage, that is shared by all participants of a
+ * process. All participants write into one HDF file, each one into its own
+ * group. Writes are serialized through a single writer and the file is
+ * flushed periodically by a background thread, so the flushes of all
+ * participants are coalesced into one.
+ *
+ * The store is optional. As long as it is not opened, every participant
+ * manages its own file.
+ */
+class SessionStore {
+public:
+  /**
+   * @brief Opens the session store of the process.
+   * @param name The name of the session file (without file extension). An
+   * existing file is continued.
+   * @param flushInterval The interval at which modifications are flushed to
+   * the file.
+   * @return TRUE if the session store has been opened. FALSE otherwise.
+   */
+  static bool open(const std::string &name,
+                   Duration flushInterval =
+                       Duration(DEFAULT_SESSION_FLUSH_INTERVAL));
+
+  /**
+   * @brief Closes the session store of the process. The file is closed as soon
+   * as the last data manager, that is attached to it, has been closed.
+   * @return TRUE if the session store has been closed. FALSE if it was not
+   * open.
+   */
+  static bool close();
+
+  /**
+   * @brief Returns whether the session store of the process is open.
+   * @return TRUE if the session store is open. FALSE otherwise.
+   */
+  static bool isOpen();
+
+  /**
+   * @brief Returns the session store of the process.
+   * @return Pointer to the session store. May be a nullptr, if the session
+   * store has not been opened.
+   */
+  static std::shared_ptr<SessionStore> getInstance();
+
+  /**
+   * @brief Stops the flush thread and closes the session file.
+   */
+  ~SessionStore();
+
+  /**
+   * @brief Immediately flushes all pending modifications to the file.
+   * @return TRUE if the file has been flushed. FALSE otherwise.
+   */
+  bool flush();
+
+private:
+  friend class DataManagerSession;
+
+  /**
+   * @brief Construct the object.
+   * @param flushInterval The interval at which modifications are flushed.
+   */
+  SessionStore(Duration flushInterval);
+
+  /**
+   * @brief Worker that periodically flushes the file, if it has been modified.
+   */
+  void flushWorker();
+
+  /**
+   * @brief Marks the file as modified, so that it is flushed with the next
+   * period of the flush worker.
+   */
+  void markDirty();
+
+  /// The data manager, that writes the session file.
+  DataManagerHdf dataManager;
+
+  /// Serializes all accesses of the attached data managers, so that there is
+  /// only a single writer to the session file.
+  std::mutex writerMutex;
+
+  /// The interval at which modifications are flushed.
+  Duration flushInterval;
+
+  /// Guards the flush state.
+  std::mutex flushMutex;
+
+  /// Wakes up the flush worker, when it shall stop.
+  std::condition_variable flushCondition;
+
+  /// Whether the file has been modified since the last flush.
+  bool dirty = false;
+
+  /// Whether the flush worker shall stop.
+  bool stopFlag = false;
+
+  /// Thread that executes the flush worker.
+  std::thread flushThread;
+
+  /// Guards the instance of the process.
+  static std::mutex instanceMutex;
+
+  /// The session store of the process.
+  static std::shared_ptr<SessionStore> instance;
+};
+
+/**
+ * @brief Data manager, that stores the data of one participant within the
+ * session store of the process. The name given to open() names the group of
+ * the participant. All keys are stored relative to that group, hence
+ * participants are free to use the same key names.
+ */
+class DataManagerSession : public DataManager {
+public:
+  /**
+   * @brief Destroy the Data Manager object
+   */
+  virtual ~DataManagerSession() override;
+
+  /**
+   * @brief Queries the data manager with the given timestamp and key.
+   *
+   * @param timestamp The timestamp that shall be queried.
+   * @param key The key that shall be queried.
+   * @param value WIll contain the value.
+   * @return TRUE if data has been retrieved succesfully. FALSE otherwise.
+   */
+  virtual bool read(TimePoint timestamp, const std::string &key,
+                    Value &value) override;
+
+  /**
+   * @brief Queries the data manager with the given time frame and key.
+   *
+   * @param from The start of the time frame, that shall be queried.
+   * @param to The end of the time frame, that shall be queried.
+   * @param key The key that shall be queried.
+   * @param timestamps Will contain the timestamps that correspond to the
+   * values..
+   * @param value Will contain the value.
+   * @return TRUE if data has been retrieved succesfully. FALSE otherwise.
+   */
+  virtual bool read(TimePoint from, TimePoint to, const std::string &key,
+                    std::vector<TimePoint> &timestamps,
+                    std::vector<Value> &value) override;
+
+  /**
+   * @brief Writes the given data to the session file.
+   *
+   * @param timestamp The timestamp that shall be stored with the given data.
+   * @param key The under which the data shall be stored.
+   * @param value The value that shall be stored.
+   * @return TRUE if write operation was succesfull. False otherwise.
+   */
+  virtual bool write(TimePoint timestamp, const std::string &key,
+                     const Value &value) override;
+
+  /**
+   * @brief Writes the given data to the session file.
+   *
+   * @param timestamp The timestamp that shall be stored with the given data.
+   * @param key The under which the data shall be stored.
+   * @param value The value that shall be stored.
+   * @return TRUE if write operation was succesfull. False otherwise.
+   */
+  virtual bool write(const std::vector<TimePoint> &timestamp,
+                     const std::string &key,
+                     const std::vector<Value> &value) override;
+
+  /**
+   * @brief Attaches to the session store. Keys, that already exist within the
+   * group, are taken over.
+   * @param name The name of the group of the participant.
+   * @return TRUE if the data manager has been attached. False otherwise.
+   */
+  virtual bool open(std::string name) override;
+
+  /**
+   * @brief Attaches to the session store and creates the given keys within
+   * the group of the participant.
+   * @param name The name of the group of the participant.
+   * @param keyMapping The Key mapping that shall be used.
+   * @param force Ignored. Groups within the session file are never
+   * overwritten.
+   * @return TRUE if the data manager has been attached. False otherwise.
+   */
+  virtual bool open(std::string name, KeyMapping keyMapping,
+                    bool force = false) override;
+
+  /**
+   * @brief Detaches from the session store. The session file stays open for
+   * the other participants.
+   *
+   * @return TRUE if the data manager has been detached. FALSE otherwise.
+   */
+  virtual bool close() override;
+
+  /**
+   * @brief Returns the type of the data manager.
+   * @return The data manager type.
+   */
+  virtual DataManagerType getDataManagerType() const override;
+
+  /**
+   * @brief Creates a key with the given name and data type.
+   * @param key The name of the key.
+   * @param dataType The datatype this key is associated with.
+   * @return Whether the creation of the key succeded.
+   */
+  virtual bool createKey(std::string key,
+                         DataManagerDataType dataType) override;
+
+  /**
+   * @brief Creates a group within the group of the participant and assigns
+   * properties to it.
+   */
+  virtual bool
+  createGroup(const std::string &groupName,
+              const std::map<std::string, int> &intProps = {},
+              const std::map<std::string, double> &doubleProps = {},
+              const std::map<std::string, std::string> &strProps = {}) override;
+
+  /**
+   * @brief Returns the timerange mapping of the keys of the participant.
+   * @return The timerange mapping at the time this method is called.
+   */
+  virtual TimerangeMapping getTimerangeMapping() const override;
+
+  /**
+   * @brief Not supported. Export the session file instead.
+   * @return FALSE.
+   */
+  virtual bool writeToCsv(const std::string &directory,
+                          const ExportOptions &options) override;
+
+protected:
+  /**
+   * @brief Sets up the spectrum within the session file. If the spectrum
+   * already exists, its frequencies have to match.
+   * @return TRUE if setup was successfull. False otherwise.
+   */
+  virtual bool setupSpectrumSpecific(std::string key,
+                                     std::vector<double> frequencies) override;
+
+private:
+  /**
+   * @brief Returns the name of the given key within the session file.
+   * @param key The name of the key within the group of the participant.
+   * @return The name of the key within the session file.
+   */
+  std::string getSessionKey(const std::string &key) const;
+
+  /// The session store this data manager is attached to.
+  std::shared_ptr<SessionStore> store;
+
+  /// The name of the group of the participant.
+  std::string groupName;
+};
+} // namespace Utilities
+
+#endif
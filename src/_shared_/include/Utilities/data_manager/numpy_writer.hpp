@@ -0,0 +1,140 @@
+#ifndef NUMPY_WRITER_HPP
+#define NUMPY_WRITER_HPP
+
+// Standard includes
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Utilities {
+
+/**
+ * @brief Writes arrays in the NumPy format. The arrays are either written as
+ * separate .npy files into a directory, or bundled into a single uncompressed
+ * .npz archive. Both can be loaded with numpy.load(), the .npy files also
+ * memory-mapped.
+ *
+ * Arrays are streamed: the shape of an array is given up front and its
+ * elements are appended in any count of pieces, in C order.
+ */
+class NumpyWriter {
+public:
+  /// Type descriptor of 64 bit integers.
+  static const std::string DESCR_INT64;
+  /// Type descriptor of 64 bit floating point numbers.
+  static const std::string DESCR_FLOAT64;
+  /// Type descriptor of complex numbers of two 64 bit floating point numbers.
+  static const std::string DESCR_COMPLEX128;
+
+  /**
+   * @brief Finishes the current array and closes the output.
+   */
+  ~NumpyWriter();
+
+  /**
+   * @brief Opens the output.
+   * @param name The name of the .npz archive or of the directory, that shall
+   * contain the .npy files.
+   * @param archive Whether a .npz archive shall be written.
+   * @return TRUE if the output has been opened. FALSE otherwise.
+   */
+  bool open(const std::string &name, bool archive);
+
+  /**
+   * @brief Starts a new array. Elements that are appended afterwards belong to
+   * this array.
+   * @param name The name of the array. numpy.load() returns it under this
+   * name.
+   * @param descr The type descriptor of the elements.
+   * @param shape The shape of the array.
+   * @return TRUE if the array has been started. FALSE otherwise.
+   */
+  bool beginArray(const std::string &name, const std::string &descr,
+                  const std::vector<size_t> &shape);
+
+  /**
+   * @brief Appends elements to the current array.
+   * @param values The elements in C order. Their size has to match the type
+   * descriptor of the array.
+   * @return TRUE if the elements have been written. FALSE otherwise.
+   */
+  template <class T> bool append(const std::vector<T> &values) {
+    return this->appendBytes(reinterpret_cast<const char *>(values.data()),
+                             values.size() * sizeof(T));
+  }
+
+  /**
+   * @brief Finishes the current array.
+   * @return TRUE if the array has been finished and contains as many elements
+   * as given by its shape. FALSE otherwise.
+   */
+  bool endArray();
+
+  /**
+   * @brief Closes the output. A .npz archive is only valid once it has been
+   * closed.
+   * @return TRUE if the output has been closed. FALSE otherwise.
+   */
+  bool close();
+
+  /**
+   * @brief Returns the header of a .npy file.
+   * @param descr The type descriptor of the elements.
+   * @param shape The shape of the array.
+   * @return The header, including the magic string. Its length is a multiple
+   * of 64 bytes, so that the data is aligned.
+   */
+  static std::string getHeader(const std::string &descr,
+                               const std::vector<size_t> &shape);
+
+private:
+  /**
+   * @brief Appends raw bytes to the current array.
+   */
+  bool appendBytes(const char *data, size_t size);
+
+  /**
+   * @brief Writes the central directory of the .npz archive.
+   */
+  bool writeCentralDirectory();
+
+  /// An array, that has been written into the .npz archive.
+  struct ArchiveEntry {
+    std::string fileName;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t crc;
+  };
+
+  /// Whether a .npz archive is written.
+  bool archive = false;
+
+  /// Whether the output is open.
+  bool openFlag = false;
+
+  /// Whether an array has been started and not yet finished.
+  bool arrayOpen = false;
+
+  /// The directory of the .npy files.
+  std::filesystem::path directory;
+
+  /// The current .npy file resp. the .npz archive.
+  std::ofstream stream;
+
+  /// The count of bytes, the current array has to contain.
+  uint64_t expectedSize = 0;
+
+  /// The count of bytes, that have been written to the current array.
+  uint64_t writtenSize = 0;
+
+  /// The entry of the current array within the .npz archive.
+  ArchiveEntry currentEntry;
+
+  /// The arrays of the .npz archive.
+  std::vector<ArchiveEntry> entries;
+};
+} // namespace Utilities
+
+#endif
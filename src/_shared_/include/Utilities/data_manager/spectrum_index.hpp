@@ -0,0 +1,257 @@
+#ifndef SPECTRUM_INDEX_HPP
+#define SPECTRUM_INDEX_HPP
+
+// Standard includes
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Project includes
+#include <data_manager_hdf.hpp>
+#include <mapped_file.hpp>
+#include <thread_pool.hpp>
+
+/// The count of spectra, that are read from the HDF file at once, while an
+/// index is built.
+#define SPECTRUM_INDEX_READ_BLOCK_SIZE 4096
+/// The maximal count of inverted lists per key.
+#define SPECTRUM_INDEX_MAX_LIST_COUNT 4096
+/// The count of k-means iterations, that place the centroids of the lists.
+#define SPECTRUM_INDEX_KMEANS_ITERATIONS 10
+/// The count of training spectra per list, that k-means is run on.
+#define SPECTRUM_INDEX_SAMPLES_PER_LIST 32
+
+namespace Utilities {
+
+/**
+ * @brief A spectrum, that has been found by a similarity query.
+ */
+struct SpectrumMatch {
+  /// The timestamp of the spectrum in milliseconds since epoch.
+  long long timestamp;
+  /// The squared euclidean distance of the features. Within [0, 4], up to the
+  /// quantization error of the index.
+  float distance;
+};
+
+/**
+ * @brief Options, that control a similarity query.
+ */
+struct SpectrumQueryOptions {
+  /// The count of matches, that shall be returned.
+  size_t k = 10;
+  /// The count of inverted lists, that are searched. More lists find more of
+  /// the true nearest neighbours, but take longer.
+  size_t probes = 8;
+  /// The minimal time in milliseconds between two matches. Consecutive
+  /// spectra tend to be alike, so without a separation the matches are often
+  /// neighbours in time of the best one. 0 returns the nearest spectra.
+  long long minSeparation = 0;
+};
+
+/**
+ * @brief Similarity index over the spectrum keys of a SCIMon HDF file. It
+ * answers, which spectra of a recording look like a given one.
+ *
+ * Every spectrum is described by a feature vector, that consists of the
+ * magnitudes in decibel minus their mean and the phases. Both halves are
+ * normalized to a length of 1/sqrt(2), so the features are independent of the
+ * absolute impedance level and shape and phase weigh equally. Similarity is
+ * the euclidean distance of the features.
+ *
+ * The features of a key are grouped into inverted lists by k-means (IVF). A
+ * query only compares the centroids of the lists and the spectra of the
+ * nearest lists, instead of every spectrum of the recording.
+ *
+ * Only the centroids are stored as floats. A spectrum is stored as the
+ * difference of its features to the centroid of its list, quantized to int8
+ * with a scale per list. This takes a quarter of the memory of float features.
+ * The differences are small compared to the features, so the distances are
+ * off by far less than the distances between different spectra.
+ *
+ * The index is stored as a sidecar file next to the HDF file. Its layout is
+ * little-endian and 8 byte aligned:
+ * * "SCIMSPIX", uint32 version, uint32 key count
+ * * Per key: uint32 name length, name, padding, uint64 frequency count, row
+ * count and list count, double frequencies, uint64 list offsets (list count +
+ * 1), int64 timestamps, float centroids, float scales (list count), int8
+ * codes, padding.
+ *
+ * Timestamps and features are ordered by list. Loaded files are mapped into
+ * memory, so opening an index does not depend on its size.
+ */
+class SpectrumIndex {
+public:
+  /// The extension, that is appended to the name of the HDF file.
+  static const std::string FILE_EXTENSION;
+
+  /**
+   * @brief Returns the name of the sidecar file of an HDF file.
+   * @param hdfFileName The name of the HDF file.
+   * @return The name of the sidecar file.
+   */
+  static std::string getIndexFileName(const std::string &hdfFileName);
+
+  /**
+   * @brief Calculates the feature vector of a spectrum.
+   * @param spectrum The impedances as interleaved real and imaginary parts.
+   * @param frequencyCount The count of impedances.
+   * @param features Has to hold 2 * frequencyCount elements.
+   */
+  static void computeFeatures(const double *spectrum, size_t frequencyCount,
+                              float *features);
+
+  /**
+   * @brief Indexes the spectrum keys of an opened HDF file. The spectra are
+   * read block by block, so memory usage is dominated by the features.
+   * @param dataManager The data manager of the HDF file.
+   * @param keyFilter Regular expression, that has to be found in the name of a
+   * key for it to be indexed. Empty indexes all spectrum keys.
+   * @param listCount The count of inverted lists per key. 0 selects the
+   * square root of the count of spectra.
+   * @param jobCount The count of threads, that run k-means. 0 selects the
+   * count of hardware threads.
+   * @return TRUE if all selected keys have been indexed. FALSE otherwise.
+   */
+  bool build(DataManagerHdf &dataManager, const std::string &keyFilter = "",
+             size_t listCount = 0, unsigned int jobCount = 0);
+
+  /**
+   * @brief Indexes the given features as a key. Replaces an existing key of
+   * the same name.
+   * @param key The name of the key.
+   * @param frequencies The frequencies of the spectra.
+   * @param timestamps The timestamps of the spectra.
+   * @param features 2 * frequency count features per spectrum, as calculated
+   * by computeFeatures().
+   * @param listCount The count of inverted lists. 0 selects the square root of
+   * the count of spectra.
+   * @param jobCount The count of threads, that run k-means. 0 selects the
+   * count of hardware threads.
+   * @return TRUE if the key has been indexed. FALSE if the sizes do not match.
+   */
+  bool addKey(const std::string &key, const std::vector<double> &frequencies,
+              const std::vector<long long> &timestamps,
+              const std::vector<float> &features, size_t listCount = 0,
+              unsigned int jobCount = 0);
+
+  /**
+   * @brief Writes the index to a file.
+   * @param fileName The name of the file.
+   * @return TRUE if the index has been written. FALSE otherwise.
+   */
+  bool save(const std::string &fileName) const;
+
+  /**
+   * @brief Maps an index file into memory. Replaces the current content.
+   * @param fileName The name of the file.
+   * @return TRUE if the index has been loaded. FALSE if the file is missing or
+   * malformed.
+   */
+  bool load(const std::string &fileName);
+
+  /**
+   * @brief Returns the names of the indexed keys.
+   * @return The names of the keys.
+   */
+  std::vector<std::string> getKeys() const;
+
+  /**
+   * @brief Returns the frequencies of an indexed key.
+   * @param key The name of the key.
+   * @return The frequencies. Empty if the key is not indexed.
+   */
+  std::vector<double> getFrequencies(const std::string &key) const;
+
+  /**
+   * @brief Returns the count of spectra of an indexed key. Allows to detect,
+   * that the HDF file has grown since the index has been built.
+   * @param key The name of the key.
+   * @return The count of spectra. 0 if the key is not indexed.
+   */
+  size_t getRowCount(const std::string &key) const;
+
+  /**
+   * @brief Searches the spectra of a key, that are most similar to the given
+   * one.
+   * @param key The name of the key.
+   * @param spectrum The impedances as interleaved real and imaginary parts.
+   * Has to hold as many impedances as the key has frequencies.
+   * @param options The options of the query.
+   * @param matches Will contain the matches, ordered by ascending distance.
+   * @return TRUE if the query has been executed. FALSE if the key is not
+   * indexed.
+   */
+  bool query(const std::string &key, const double *spectrum,
+             const SpectrumQueryOptions &options,
+             std::vector<SpectrumMatch> &matches) const;
+
+private:
+  /**
+   * @brief The index of a single key. The spans either point into the storage
+   * vectors of a built index or into the mapped file of a loaded one.
+   */
+  struct KeyIndex {
+    size_t rowCount = 0;
+    size_t listCount = 0;
+    size_t dimension = 0;
+    std::span<const double> frequencies;
+    /// Rows of list i are [listOffsets[i], listOffsets[i + 1]).
+    std::span<const uint64_t> listOffsets;
+    std::span<const long long> timestamps;
+    std::span<const float> centroids;
+    /// The scale of the codes of each list.
+    std::span<const float> scales;
+    /// The quantized differences of the features to their centroid.
+    std::span<const int8_t> codes;
+
+    std::vector<double> frequencyStorage;
+    std::vector<uint64_t> listOffsetStorage;
+    std::vector<long long> timestampStorage;
+    std::vector<float> centroidStorage;
+    std::vector<float> scaleStorage;
+    std::vector<int8_t> codeStorage;
+  };
+
+  /**
+   * @brief Places the centroids of the lists by k-means on a sample of the
+   * features.
+   * @param features The features.
+   * @param rowCount The count of feature vectors.
+   * @param dimension The length of a feature vector.
+   * @param listCount The count of lists.
+   * @param pool The threads, that assign the features to the centroids.
+   * @return The centroids.
+   */
+  static std::vector<float> trainCentroids(const std::vector<float> &features,
+                                           size_t rowCount, size_t dimension,
+                                           size_t listCount, ThreadPool &pool);
+
+  /**
+   * @brief Determines the nearest centroid of every feature vector.
+   * @param features The feature vectors.
+   * @param rowCount The count of feature vectors.
+   * @param centroids The centroids.
+   * @param listCount The count of centroids.
+   * @param dimension The length of a feature vector.
+   * @param pool The threads, that calculate the distances.
+   * @return The index of the nearest centroid per feature vector.
+   */
+  static std::vector<uint32_t> assignLists(const float *features,
+                                           size_t rowCount,
+                                           const std::vector<float> &centroids,
+                                           size_t listCount, size_t dimension,
+                                           ThreadPool &pool);
+
+  /// The indexes of the keys.
+  std::map<std::string, std::unique_ptr<KeyIndex>> keys;
+
+  /// The mapped file of a loaded index.
+  std::unique_ptr<MappedFile> mappedFile;
+};
+} // namespace Utilities
+
+#endif
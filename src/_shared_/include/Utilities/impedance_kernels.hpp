@@ -0,0 +1,104 @@
+#ifndef IMPEDANCE_KERNELS_HPP
+#define IMPEDANCE_KERNELS_HPP
+
+// Standard includes
+#include <cstddef>
+
+namespace Utilities {
+
+/**
+ * @brief Identifies the instruction set, that the impedance kernels use.
+ */
+enum KernelInstructionSet {
+  /// Plain C++.
+  KERNEL_INSTRUCTION_SET_SCALAR = 0x00,
+  /// Two doubles per instruction.
+  KERNEL_INSTRUCTION_SET_SSE2 = 0x01,
+  /// Four doubles per instruction.
+  KERNEL_INSTRUCTION_SET_AVX2 = 0x02,
+};
+
+/**
+ * @brief Returns the widest instruction set, that is supported by the CPU.
+ * @return The instruction set.
+ */
+KernelInstructionSet getSupportedKernelInstructionSet();
+
+/**
+ * @brief Returns the instruction set, that the impedance kernels currently
+ * use. Defaults to the widest supported one.
+ * @return The instruction set.
+ */
+KernelInstructionSet getKernelInstructionSet();
+
+/**
+ * @brief Selects the instruction set, that the impedance kernels shall use.
+ * Mainly useful to compare the implementations.
+ * @param instructionSet The instruction set.
+ * @return TRUE if the instruction set has been selected. FALSE if it is not
+ * supported by the CPU.
+ */
+bool setKernelInstructionSet(KernelInstructionSet instructionSet);
+
+/**
+ * @brief Calculates the magnitudes of impedances.
+ * @param real The real parts.
+ * @param imag The imaginary parts.
+ * @param magnitudes Will contain the magnitudes.
+ * @param count The count of impedances.
+ */
+void computeMagnitudes(const double *real, const double *imag,
+                       double *magnitudes, size_t count);
+
+/**
+ * @brief Calculates the phases of impedances in radians, as done by atan2().
+ * @param real The real parts.
+ * @param imag The imaginary parts.
+ * @param phases Will contain the phases within [-pi, pi].
+ * @param count The count of impedances.
+ */
+void computePhases(const double *real, const double *imag, double *phases,
+                   size_t count);
+
+/**
+ * @brief Calculates the magnitudes of impedances in decibel, i.e.
+ * 20 * log10(|Z|).
+ * @param real The real parts.
+ * @param imag The imaginary parts.
+ * @param decibels Will contain the magnitudes in decibel.
+ * @param count The count of impedances.
+ */
+void computeMagnitudesDb(const double *real, const double *imag,
+                         double *decibels, size_t count);
+
+/**
+ * @brief Normalizes impedances to a baseline spectrum by dividing each
+ * impedance by the baseline impedance of the same frequency.
+ * @param real The real parts.
+ * @param imag The imaginary parts.
+ * @param baselineReal The real parts of the baseline.
+ * @param baselineImag The imaginary parts of the baseline.
+ * @param normalizedReal Will contain the real parts of the quotients. May be
+ * the same as real.
+ * @param normalizedImag Will contain the imaginary parts of the quotients. May
+ * be the same as imag.
+ * @param count The count of impedances.
+ */
+void normalizeToBaseline(const double *real, const double *imag,
+                         const double *baselineReal, const double *baselineImag,
+                         double *normalizedReal, double *normalizedImag,
+                         size_t count);
+
+/**
+ * @brief Converts interleaved pairs of real and imaginary parts into
+ * interleaved pairs of magnitude and phase.
+ * @param cartesian The real and imaginary parts.
+ * @param polar Will contain the magnitudes and phases. May be the same as
+ * cartesian.
+ * @param count The count of impedances.
+ */
+void cartesianToPolar(const double *cartesian, double *polar, size_t count);
+
+} // namespace Utilities
+
+#endif
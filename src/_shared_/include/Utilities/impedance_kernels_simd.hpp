@@ -0,0 +1,240 @@
+#ifndef IMPEDANCE_KERNELS_SIMD_HPP
+#define IMPEDANCE_KERNELS_SIMD_HPP
+
+// Internal header of the impedance kernels. The kernels are written once
+// against a set of vector operations, that is provided for every instruction
+// set by the translation unit, that is compiled for it.
+
+// Standard includes
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__x86_64__)
+/// Whether the SSE2 and AVX2 kernels are available.
+#define IMPEDANCE_KERNELS_X86
+#endif
+
+namespace Utilities {
+namespace KernelDetail {
+
+/// Coefficients of the rational approximation of atan() on [0, 0.66] (Cephes).
+constexpr double ATAN_P[] = {-8.750608600031904122785E-1,
+                             -1.615753718733365076637E1,
+                             -7.500855792314704667340E1,
+                             -1.228866684490136173410E2,
+                             -6.485021904942025371773E1};
+constexpr double ATAN_Q[] = {2.485846490142306297962E1,
+                             1.650270098316988542046E2,
+                             4.328810604912902668951E2,
+                             4.853903996359136964868E2,
+                             1.945506571482613964425E2};
+/// The part of pi/4, that is not representable by a double.
+constexpr double ATAN_MOREBITS = 6.123233995736765886130E-17;
+
+/// Coefficients of the rational approximation of log() on [sqrt(0.5) - 1,
+/// sqrt(2) - 1] (Cephes).
+constexpr double LOG_P[] = {
+    1.01875663804580931796E-4, 4.97494994976747001425E-1,
+    4.70579119878881725854E0,  1.44989225341610930846E1,
+    1.79368678507819816313E1,  7.70838733755885391666E0};
+constexpr double LOG_Q[] = {
+    1.12873587189167450590E1, 4.52279145837532221105E1,
+    8.29875266912776603211E1, 7.11544750618563894466E1,
+    2.31251620126765340583E1};
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double SQRT_HALF = 0.70710678118654752440;
+/// 10 / ln(10). Converts the natural logarithm of |Z|^2 into decibel.
+constexpr double DB_PER_LOG = 4.34294481903251827651;
+
+/**
+ * @brief Calculates the magnitudes. Ops provides the vector operations.
+ */
+template <class Ops>
+void magnitudeKernel(const double *real, const double *imag,
+                     double *magnitudes, size_t count) {
+  size_t i = 0;
+  for (; i + Ops::WIDTH <= count; i += Ops::WIDTH) {
+    auto re = Ops::load(real + i);
+    auto im = Ops::load(imag + i);
+    Ops::store(magnitudes + i,
+               Ops::sqrt(Ops::add(Ops::mul(re, re), Ops::mul(im, im))));
+  }
+  for (; i < count; i++) {
+    magnitudes[i] = std::sqrt(real[i] * real[i] + imag[i] * imag[i]);
+  }
+}
+
+/**
+ * @brief Calculates atan(a) for a within [0, 1].
+ */
+template <class Ops> typename Ops::Vector atanUnit(typename Ops::Vector a) {
+  // Reduce arguments above 0.66 by atan(a) = pi/4 + atan((a - 1) / (a + 1)).
+  auto one = Ops::set1(1.0);
+  auto reduced = Ops::cmpgt(a, Ops::set1(0.66));
+  auto x = Ops::blend(
+      a, Ops::div(Ops::sub(a, one), Ops::add(a, one)), reduced);
+  auto offset = Ops::blend(Ops::set1(0.0), Ops::set1(PI / 4), reduced);
+
+  auto z = Ops::mul(x, x);
+  auto p = Ops::set1(ATAN_P[0]);
+  for (int k = 1; k < 5; k++) {
+    p = Ops::add(Ops::mul(p, z), Ops::set1(ATAN_P[k]));
+  }
+  auto q = Ops::add(z, Ops::set1(ATAN_Q[0]));
+  for (int k = 1; k < 5; k++) {
+    q = Ops::add(Ops::mul(q, z), Ops::set1(ATAN_Q[k]));
+  }
+  auto r = Ops::add(Ops::mul(x, Ops::div(Ops::mul(z, p), q)), x);
+  r = Ops::add(r, Ops::blend(Ops::set1(0.0), Ops::set1(0.5 * ATAN_MOREBITS),
+                             reduced));
+
+  return Ops::add(offset, r);
+}
+
+/**
+ * @brief Calculates the phases. Lanes with a zero or non-finite part are
+ * handed to std::atan2(), to reproduce its handling of signed zeros,
+ * infinities and NaN.
+ */
+template <class Ops>
+void phaseKernel(const double *real, const double *imag, double *phases,
+                 size_t count) {
+  auto zero = Ops::set1(0.0);
+  size_t i = 0;
+  for (; i + Ops::WIDTH <= count; i += Ops::WIDTH) {
+    auto re = Ops::load(real + i);
+    auto im = Ops::load(imag + i);
+    auto absRe = Ops::abs(re);
+    auto absIm = Ops::abs(im);
+
+    auto r = atanUnit<Ops>(
+        Ops::div(Ops::min(absRe, absIm), Ops::max(absRe, absIm)));
+    r = Ops::blend(r, Ops::sub(Ops::set1(PI / 2), r),
+                   Ops::cmpgt(absIm, absRe));
+    r = Ops::blend(r, Ops::sub(Ops::set1(PI), r), Ops::cmpgt(zero, re));
+    r = Ops::copysign(r, im);
+    Ops::store(phases + i, r);
+
+    auto special = Ops::orMask(
+        Ops::cmpeq(re, zero),
+        Ops::cmpunord(Ops::mul(re, zero), Ops::mul(im, zero)));
+    int specialLanes = Ops::movemask(special);
+    for (size_t lane = 0; specialLanes != 0; lane++, specialLanes >>= 1) {
+      if (specialLanes & 1) {
+        phases[i + lane] = std::atan2(imag[i + lane], real[i + lane]);
+      }
+    }
+  }
+  for (; i < count; i++) {
+    phases[i] = std::atan2(imag[i], real[i]);
+  }
+}
+
+/**
+ * @brief Calculates the magnitudes in decibel as 10 * log10(|Z|^2). Lanes,
+ * whose squared magnitude is zero, subnormal or not finite are handed to
+ * std::log10().
+ */
+template <class Ops>
+void magnitudeDbKernel(const double *real, const double *imag,
+                       double *decibels, size_t count) {
+  auto one = Ops::set1(1.0);
+  size_t i = 0;
+  for (; i + Ops::WIDTH <= count; i += Ops::WIDTH) {
+    auto re = Ops::load(real + i);
+    auto im = Ops::load(imag + i);
+    auto s = Ops::add(Ops::mul(re, re), Ops::mul(im, im));
+
+    // Split s into mantissa m within [0.5, 1) and exponent e.
+    auto e = Ops::sub(Ops::exponent(s), Ops::set1(1022.0));
+    auto m = Ops::mantissa(s);
+    auto small = Ops::cmpgt(Ops::set1(SQRT_HALF), m);
+    e = Ops::sub(e, Ops::blend(Ops::set1(0.0), one, small));
+    auto x = Ops::blend(Ops::sub(m, one), Ops::sub(Ops::add(m, m), one),
+                        small);
+
+    auto z = Ops::mul(x, x);
+    auto p = Ops::set1(LOG_P[0]);
+    for (int k = 1; k < 6; k++) {
+      p = Ops::add(Ops::mul(p, x), Ops::set1(LOG_P[k]));
+    }
+    auto q = Ops::add(x, Ops::set1(LOG_Q[0]));
+    for (int k = 1; k < 5; k++) {
+      q = Ops::add(Ops::mul(q, x), Ops::set1(LOG_Q[k]));
+    }
+    auto y = Ops::mul(x, Ops::div(Ops::mul(z, p), q));
+    y = Ops::sub(y, Ops::mul(e, Ops::set1(2.121944400546905827679e-4)));
+    y = Ops::sub(y, Ops::mul(Ops::set1(0.5), z));
+    auto ln = Ops::add(Ops::add(x, y), Ops::mul(e, Ops::set1(0.693359375)));
+    Ops::store(decibels + i, Ops::mul(ln, Ops::set1(DB_PER_LOG)));
+
+    auto special = Ops::orMask(Ops::cmpnge(s, Ops::set1(DBL_MIN)),
+                               Ops::cmpgt(s, Ops::set1(DBL_MAX)));
+    int specialLanes = Ops::movemask(special);
+    for (size_t lane = 0; specialLanes != 0; lane++, specialLanes >>= 1) {
+      if (specialLanes & 1) {
+        double re = real[i + lane];
+        double im = imag[i + lane];
+        decibels[i + lane] = 10.0 * std::log10(re * re + im * im);
+      }
+    }
+  }
+  for (; i < count; i++) {
+    decibels[i] = 10.0 * std::log10(real[i] * real[i] + imag[i] * imag[i]);
+  }
+}
+
+/**
+ * @brief Divides the impedances by the baseline impedances.
+ */
+template <class Ops>
+void normalizeKernel(const double *real, const double *imag,
+                     const double *baselineReal, const double *baselineImag,
+                     double *normalizedReal, double *normalizedImag,
+                     size_t count) {
+  size_t i = 0;
+  for (; i + Ops::WIDTH <= count; i += Ops::WIDTH) {
+    auto a = Ops::load(real + i);
+    auto b = Ops::load(imag + i);
+    auto c = Ops::load(baselineReal + i);
+    auto d = Ops::load(baselineImag + i);
+    auto denominator = Ops::add(Ops::mul(c, c), Ops::mul(d, d));
+    Ops::store(normalizedReal + i,
+               Ops::div(Ops::add(Ops::mul(a, c), Ops::mul(b, d)), denominator));
+    Ops::store(normalizedImag + i,
+               Ops::div(Ops::sub(Ops::mul(b, c), Ops::mul(a, d)), denominator));
+  }
+  for (; i < count; i++) {
+    double a = real[i];
+    double b = imag[i];
+    double c = baselineReal[i];
+    double d = baselineImag[i];
+    double denominator = c * c + d * d;
+    normalizedReal[i] = (a * c + b * d) / denominator;
+    normalizedImag[i] = (b * c - a * d) / denominator;
+  }
+}
+
+/// The kernels of one instruction set.
+struct KernelTable {
+  void (*magnitude)(const double *, const double *, double *, size_t);
+  void (*phase)(const double *, const double *, double *, size_t);
+  void (*magnitudeDb)(const double *, const double *, double *, size_t);
+  void (*normalize)(const double *, const double *, const double *,
+                    const double *, double *, double *, size_t);
+};
+
+#ifdef IMPEDANCE_KERNELS_X86
+/**
+ * @brief Returns the kernels, that use AVX2. Defined by the translation unit,
+ * that is compiled for AVX2.
+ */
+const KernelTable &getAvx2Kernels();
+#endif
+
+} // namespace KernelDetail
+} // namespace Utilities
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+// Standard includes
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace Utilities {
+
+/**
+ * @brief Maps a file read-only into memory. The content of the file can be
+ * accessed without copying it, as long as the object is alive.
+ */
+class MappedFile {
+public:
+  /**
+   * @brief Constructs an object, that does not map a file yet.
+   */
+  MappedFile();
+
+  /**
+   * @brief Unmaps the file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /**
+   * @brief Maps the given file into memory.
+   * @param fileName The path of the file, that shall be mapped.
+   * @return TRUE if the file has been mapped. FALSE otherwise.
+   */
+  bool open(const std::string &fileName);
+
+  /**
+   * @brief Unmaps the file. Views that have been handed out before become
+   * invalid.
+   */
+  void close();
+
+  /**
+   * @brief Returns whether a file is mapped.
+   * @return Whether a file is mapped.
+   */
+  bool isOpen() const;
+
+  /**
+   * @brief Returns the size of the mapped file in bytes.
+   * @return The size of the mapped file in bytes.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Returns a view of the mapped file, interpreted as an array of T.
+   * Trailing bytes, that do not make up a whole element, are not part of the
+   * view.
+   * @return View of the mapped file.
+   */
+  template <class T> std::span<const T> view() const {
+    if (this->mappedData == nullptr) {
+      return std::span<const T>();
+    }
+    return std::span<const T>(reinterpret_cast<const T *>(this->mappedData),
+                              this->mappedSize / sizeof(T));
+  }
+
+private:
+  /// Pointer to the start of the mapping. nullptr if nothing is mapped or the
+  /// file is empty.
+  const std::byte *mappedData;
+
+  /// The size of the mapping in bytes.
+  size_t mappedSize;
+
+  /// Whether a file is mapped.
+  bool openFlag;
+
+#ifdef WIN32
+  /// Handle to the mapped file.
+  void *fileHandle;
+
+  /// Handle to the file mapping object.
+  void *mappingHandle;
+#else
+  /// Descriptor of the mapped file.
+  int fileDescriptor;
+#endif
+};
+
+} // namespace Utilities
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+// Standard includes
+#include <atomic>
+#include <list>
+#include <memory>
+#include <vector>
+
+namespace Utilities {
+
+template <typename T> class MpscQueue;
+
+/**
+ * @brief Links an element into a MpscQueue. Elements derive from it, so
+ * queueing them does not allocate. An element can only be queued in one queue
+ * at a time.
+ */
+template <typename T> class MpscQueueHook {
+public:
+  MpscQueueHook() : queueNext(nullptr) {}
+
+  /**
+   * @brief Copies do not inherit the queue state of the original.
+   */
+  MpscQueueHook(const MpscQueueHook &) : queueNext(nullptr) {}
+  MpscQueueHook &operator=(const MpscQueueHook &) { return *this; }
+
+private:
+  friend class MpscQueue<T>;
+
+  /// Keeps the element alive, while it is queued.
+  std::shared_ptr<T> queueOwner;
+
+  /// The element, that has been queued before this one.
+  T *queueNext;
+
+  /// Set while the element is queued.
+  std::atomic_flag queued = ATOMIC_FLAG_INIT;
+};
+
+/**
+ * @brief A lock-free queue for many producers and a single consumer. The
+ * elements are linked intrusively through their MpscQueueHook. Producers push
+ * with a single compare-and-swap, the consumer takes all queued elements at
+ * once with drain().
+ */
+template <typename T> class MpscQueue {
+public:
+  MpscQueue() : head(nullptr) {}
+
+  /**
+   * @brief Releases the elements, that are still queued.
+   */
+  ~MpscQueue() { this->drain(); }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  /**
+   * @brief Appends the element to the queue. May be called from any thread.
+   * @param element The element.
+   * @return TRUE if the element has been queued. FALSE if it is null or
+   * already queued.
+   */
+  bool push(std::shared_ptr<T> element) {
+    T *node = element.get();
+    if (!node || node->MpscQueueHook<T>::queued.test_and_set(
+                     std::memory_order_acquire)) {
+      return false;
+    }
+    node->MpscQueueHook<T>::queueOwner = std::move(element);
+    this->link(node, node);
+
+    return true;
+  }
+
+  /**
+   * @brief Appends the elements to the queue in the given order. They are
+   * published at once, so elements of other producers do not end up in
+   * between. May be called from any thread.
+   * @param elements The elements.
+   * @return TRUE if all elements have been queued. FALSE if an element is null
+   * or already queued. These elements are skipped.
+   */
+  bool push(const std::vector<std::shared_ptr<T>> &elements) {
+    bool success = true;
+    T *first = nullptr;
+    T *last = nullptr;
+    for (auto &element : elements) {
+      T *node = element.get();
+      if (!node || node->MpscQueueHook<T>::queued.test_and_set(
+                       std::memory_order_acquire)) {
+        success = false;
+        continue;
+      }
+      node->MpscQueueHook<T>::queueOwner = element;
+      // The chain is linked from the newest element to the oldest one.
+      node->MpscQueueHook<T>::queueNext = last;
+      if (!first) {
+        first = node;
+      }
+      last = node;
+    }
+    if (last) {
+      this->link(last, first);
+    }
+
+    return success;
+  }
+
+  /**
+   * @brief Takes all queued elements. Must only be called by the consumer.
+   * @param elements The list, the elements are appended to in the order they
+   * have been queued.
+   */
+  void drain(std::list<std::shared_ptr<T>> &elements) {
+    T *node = this->head.exchange(nullptr, std::memory_order_acquire);
+    // The queue is linked from the newest element to the oldest one.
+    auto position = elements.end();
+    while (node) {
+      T *next = node->MpscQueueHook<T>::queueNext;
+      node->MpscQueueHook<T>::queueNext = nullptr;
+      position = elements.insert(
+          position, std::move(node->MpscQueueHook<T>::queueOwner));
+      // The element may be queued again from now on.
+      node->MpscQueueHook<T>::queued.clear(std::memory_order_release);
+      node = next;
+    }
+  }
+
+  /**
+   * @brief Takes all queued elements. Must only be called by the consumer.
+   * @return The elements in the order they have been queued.
+   */
+  std::list<std::shared_ptr<T>> drain() {
+    std::list<std::shared_ptr<T>> elements;
+    this->drain(elements);
+
+    return elements;
+  }
+
+  /**
+   * @brief Indicates, whether the queue is empty. The result may be outdated
+   * as soon as it is returned, if producers are active.
+   * @return TRUE if no element is queued. FALSE otherwise.
+   */
+  bool empty() const {
+    return this->head.load(std::memory_order_acquire) == nullptr;
+  }
+
+private:
+  /**
+   * @brief Publishes a chain of elements, that are linked from newest to
+   * oldest.
+   * @param newest The newest element of the chain. Becomes the head.
+   * @param oldest The oldest element of the chain. Is linked to the old head.
+   */
+  void link(T *newest, T *oldest) {
+    T *oldHead = this->head.load(std::memory_order_relaxed);
+    do {
+      oldest->MpscQueueHook<T>::queueNext = oldHead;
+    } while (!this->head.compare_exchange_weak(oldHead, newest,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+  }
+
+  /// The newest element. Null if the queue is empty.
+  std::atomic<T *> head;
+};
+} // namespace Utilities
+
+#endif
@@ -0,0 +1,364 @@
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+// Standard includes
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+/// The granularity of the block sizes. Objects are served from the pool of
+/// the next multiple of this size.
+#define OBJECT_POOL_SIZE_GRANULARITY 16
+
+/// The largest block size, that is pooled. Larger objects are allocated on
+/// the heap directly.
+#define OBJECT_POOL_MAX_BLOCK_SIZE 512
+
+/// The count of free blocks per block size, a thread keeps for itself.
+#define OBJECT_POOL_THREAD_CACHE_SIZE 128
+
+/// The count of blocks, that are moved between a thread and the shared pool at
+/// once. Blocks are also taken from the heap in chunks of this count.
+#define OBJECT_POOL_TRANSFER_SIZE 32
+
+namespace Utilities {
+
+/**
+ * @brief Counts the operations of the object pool since the start of the
+ * program. In a steady state, heapAllocations and unpooledAllocations do not
+ * grow anymore.
+ */
+struct ObjectPoolStatistics {
+  /// The count of blocks, that have been handed out.
+  size_t allocations;
+
+  /// The count of blocks, that have been given back.
+  size_t deallocations;
+
+  /// The count of chunks, that have been taken from the heap to fill the pool.
+  size_t heapAllocations;
+
+  /// The count of allocations, that have been too large or too strictly
+  /// aligned for the pool and have been passed to the heap.
+  size_t unpooledAllocations;
+};
+
+namespace ObjectPool {
+
+/// The count of block sizes.
+constexpr size_t sizeClassCount =
+    OBJECT_POOL_MAX_BLOCK_SIZE / OBJECT_POOL_SIZE_GRANULARITY;
+
+/**
+ * @brief A free block. Is stored in the block itself.
+ */
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+/**
+ * @brief The free blocks of one block size, that are shared between all
+ * threads.
+ */
+struct SharedPool {
+  std::mutex mutex;
+  FreeBlock *head = nullptr;
+};
+
+/**
+ * @brief The free blocks of one block size, that are owned by a thread.
+ */
+struct ThreadCache {
+  FreeBlock *head = nullptr;
+  size_t count = 0;
+};
+
+/**
+ * @brief The counters of the pool.
+ */
+struct Counters {
+  std::atomic<size_t> allocations{0};
+  std::atomic<size_t> deallocations{0};
+  std::atomic<size_t> heapAllocations{0};
+  std::atomic<size_t> unpooledAllocations{0};
+};
+
+inline Counters &getCounters() {
+  static Counters counters;
+  return counters;
+}
+
+/**
+ * @brief Returns the shared pools. They are never destroyed, as pooled objects
+ * may be released during the destruction of static objects.
+ */
+inline SharedPool *getSharedPools() {
+  static SharedPool *sharedPools = new SharedPool[sizeClassCount];
+  return sharedPools;
+}
+
+/**
+ * @brief Set, once the caches of the calling thread have been destroyed.
+ * Blocks, that are released afterwards, go to the shared pools directly.
+ */
+inline bool &getThreadCachesDestroyed() {
+  thread_local bool threadCachesDestroyed = false;
+  return threadCachesDestroyed;
+}
+
+/**
+ * @brief Moves up to the given count of blocks from one list to another.
+ * @return The count of moved blocks.
+ */
+inline size_t moveBlocks(FreeBlock *&from, FreeBlock *&to, size_t count) {
+  size_t moved = 0;
+  while (from && moved < count) {
+    FreeBlock *block = from;
+    from = block->next;
+    block->next = to;
+    to = block;
+    moved++;
+  }
+
+  return moved;
+}
+
+/**
+ * @brief The caches of the calling thread. Hands their blocks to the shared
+ * pools, when the thread exits.
+ */
+struct ThreadCaches {
+  ThreadCache caches[sizeClassCount];
+
+  ~ThreadCaches() {
+    getThreadCachesDestroyed() = true;
+    SharedPool *sharedPools = getSharedPools();
+    for (size_t sizeClass = 0; sizeClass < sizeClassCount; sizeClass++) {
+      std::lock_guard<std::mutex> lock(sharedPools[sizeClass].mutex);
+      moveBlocks(this->caches[sizeClass].head, sharedPools[sizeClass].head,
+                 this->caches[sizeClass].count);
+    }
+  }
+};
+
+inline ThreadCache *getThreadCaches() {
+  thread_local ThreadCaches threadCaches;
+  return threadCaches.caches;
+}
+
+/**
+ * @brief Returns the size class of the given size. Sizes, that are not pooled,
+ * yield sizeClassCount.
+ */
+inline size_t getSizeClass(size_t size) {
+  if (0 == size || size > OBJECT_POOL_MAX_BLOCK_SIZE) {
+    return sizeClassCount;
+  }
+
+  return (size - 1) / OBJECT_POOL_SIZE_GRANULARITY;
+}
+
+/**
+ * @brief Refills the given cache from the shared pool or, if it is empty, with
+ * a chunk from the heap.
+ */
+inline void refill(ThreadCache &cache, size_t sizeClass) {
+  SharedPool &sharedPool = getSharedPools()[sizeClass];
+  {
+    std::lock_guard<std::mutex> lock(sharedPool.mutex);
+    cache.count +=
+        moveBlocks(sharedPool.head, cache.head, OBJECT_POOL_TRANSFER_SIZE);
+  }
+  if (cache.head) {
+    return;
+  }
+
+  // Chunks are never released. Their blocks stay in the pools.
+  size_t blockSize = (sizeClass + 1) * OBJECT_POOL_SIZE_GRANULARITY;
+  unsigned char *chunk = static_cast<unsigned char *>(
+      ::operator new(blockSize * OBJECT_POOL_TRANSFER_SIZE));
+  getCounters().heapAllocations.fetch_add(1, std::memory_order_relaxed);
+  for (size_t i = 0; i < OBJECT_POOL_TRANSFER_SIZE; i++) {
+    FreeBlock *block = reinterpret_cast<FreeBlock *>(chunk + i * blockSize);
+    block->next = cache.head;
+    cache.head = block;
+  }
+  cache.count += OBJECT_POOL_TRANSFER_SIZE;
+}
+} // namespace ObjectPool
+
+/**
+ * @brief Allocates a block of the given size from the pool of the calling
+ * thread. Blocks are aligned like blocks of operator new.
+ * @param size The size of the block in bytes.
+ * @return Pointer to the block. Never null.
+ */
+inline void *allocatePooled(size_t size) {
+  using namespace ObjectPool;
+  size_t sizeClass = getSizeClass(size);
+  if (sizeClassCount == sizeClass) {
+    getCounters().unpooledAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+  if (getThreadCachesDestroyed()) {
+    // The thread exits. The block is taken from the heap, but can be pooled
+    // once it is released. It is counted as allocation, as its release is
+    // counted as deallocation.
+    getCounters().heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    getCounters().allocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new((sizeClass + 1) * OBJECT_POOL_SIZE_GRANULARITY);
+  }
+
+  ThreadCache &cache = getThreadCaches()[sizeClass];
+  if (!cache.head) {
+    refill(cache, sizeClass);
+  }
+  FreeBlock *block = cache.head;
+  cache.head = block->next;
+  cache.count--;
+  getCounters().allocations.fetch_add(1, std::memory_order_relaxed);
+
+  return block;
+}
+
+/**
+ * @brief Gives a block back to the pool of the calling thread. The block may
+ * have been allocated by another thread.
+ * @param block The block. May be null.
+ * @param size The size, that has been passed to allocatePooled().
+ */
+inline void deallocatePooled(void *block, size_t size) {
+  using namespace ObjectPool;
+  if (!block) {
+    return;
+  }
+  size_t sizeClass = getSizeClass(size);
+  if (sizeClassCount == sizeClass) {
+    ::operator delete(block);
+    return;
+  }
+  getCounters().deallocations.fetch_add(1, std::memory_order_relaxed);
+
+  FreeBlock *freeBlock = static_cast<FreeBlock *>(block);
+  SharedPool &sharedPool = getSharedPools()[sizeClass];
+  if (getThreadCachesDestroyed()) {
+    std::lock_guard<std::mutex> lock(sharedPool.mutex);
+    freeBlock->next = sharedPool.head;
+    sharedPool.head = freeBlock;
+    return;
+  }
+
+  ThreadCache &cache = getThreadCaches()[sizeClass];
+  freeBlock->next = cache.head;
+  cache.head = freeBlock;
+  cache.count++;
+  if (cache.count > OBJECT_POOL_THREAD_CACHE_SIZE) {
+    // Blocks, that are allocated by one thread and released by another one,
+    // flow back through the shared pool.
+    std::lock_guard<std::mutex> lock(sharedPool.mutex);
+    cache.count -=
+        moveBlocks(cache.head, sharedPool.head, OBJECT_POOL_TRANSFER_SIZE);
+  }
+}
+
+/**
+ * @brief Returns the counters of the object pool.
+ * @return The counters.
+ */
+inline ObjectPoolStatistics getObjectPoolStatistics() {
+  ObjectPool::Counters &counters = ObjectPool::getCounters();
+  return ObjectPoolStatistics{
+      counters.allocations.load(std::memory_order_relaxed),
+      counters.deallocations.load(std::memory_order_relaxed),
+      counters.heapAllocations.load(std::memory_order_relaxed),
+      counters.unpooledAllocations.load(std::memory_order_relaxed)};
+}
+
+/**
+ * @brief An allocator, that serves single objects from the object pool. Can
+ * be used with containers, that allocate one node per element, and with
+ * std::allocate_shared().
+ */
+template <typename T> class PoolAllocator {
+public:
+  using value_type = T;
+
+  PoolAllocator() noexcept {}
+
+  template <typename U> PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+  T *allocate(size_t count) {
+    if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ObjectPool::getCounters().unpooledAllocations.fetch_add(
+          1, std::memory_order_relaxed);
+      return static_cast<T *>(::operator new(
+          count * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    return static_cast<T *>(allocatePooled(count * sizeof(T)));
+  }
+
+  void deallocate(T *object, size_t count) {
+    if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(object, std::align_val_t(alignof(T)));
+      return;
+    }
+
+    deallocatePooled(object, count * sizeof(T));
+  }
+
+  template <typename U> bool operator==(const PoolAllocator<U> &) const {
+    return true;
+  }
+
+  template <typename U> bool operator!=(const PoolAllocator<U> &) const {
+    return false;
+  }
+};
+
+/**
+ * @brief Base class of objects, that are allocated from the object pool with
+ * new. Deleting an object through a base class pointer requires a virtual
+ * destructor, so the size of the object is known.
+ */
+class PoolAllocated {
+public:
+  static void *operator new(size_t size) { return allocatePooled(size); }
+
+  static void operator delete(void *object, size_t size) {
+    deallocatePooled(object, size);
+  }
+};
+
+/**
+ * @brief Constructs an object, whose memory and reference count are taken
+ * from the object pool at once.
+ * @param arguments The arguments of the constructor.
+ * @return The shared pointer to the object.
+ */
+template <typename T, typename... Arguments>
+std::shared_ptr<T> makePooled(Arguments &&...arguments) {
+  return std::allocate_shared<T>(PoolAllocator<T>(),
+                                 std::forward<Arguments>(arguments)...);
+}
+
+/**
+ * @brief Takes ownership of the given object. The reference count is taken from
+ * the object pool.
+ * @param object The object. May be null.
+ * @return The shared pointer to the object.
+ */
+template <typename T> std::shared_ptr<T> sharePooled(T *object) {
+  if (!object) {
+    return std::shared_ptr<T>();
+  }
+
+  return std::shared_ptr<T>(object, std::default_delete<T>(),
+                            PoolAllocator<T>());
+}
+} // namespace Utilities
+
+#endif
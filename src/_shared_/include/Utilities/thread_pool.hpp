@@ -0,0 +1,88 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+// Standard includes
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Utilities {
+
+/**
+ * @brief A fixed count of threads, that execute submitted tasks in the order
+ * of submission.
+ */
+class ThreadPool {
+public:
+  /**
+   * @brief Starts the threads of the pool.
+   * @param threadCount The count of threads. At least one thread is started.
+   */
+  explicit ThreadPool(unsigned int threadCount);
+
+  /**
+   * @brief Executes the remaining tasks and joins the threads.
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Queues a task for execution.
+   * @param task The task. Is called without arguments.
+   * @return A future, that holds the result of the task once it has been
+   * executed.
+   */
+  template <class F>
+  std::future<std::invoke_result_t<F>> submit(F &&task) {
+    using ResultType = std::invoke_result_t<F>;
+
+    auto packagedTask = std::make_shared<std::packaged_task<ResultType()>>(
+        std::forward<F>(task));
+    std::future<ResultType> future = packagedTask->get_future();
+    {
+      std::lock_guard<std::mutex> lockGuard(this->taskMutex);
+      this->tasks.emplace([packagedTask]() { (*packagedTask)(); });
+    }
+    this->taskCondition.notify_one();
+
+    return future;
+  }
+
+  /**
+   * @brief Returns the count of threads of the pool.
+   * @return The count of threads.
+   */
+  unsigned int getThreadCount() const;
+
+private:
+  /**
+   * @brief Executes queued tasks, until the pool is destroyed.
+   */
+  void worker();
+
+  /// The threads of the pool.
+  std::vector<std::thread> threads;
+
+  /// The queued tasks.
+  std::queue<std::function<void()>> tasks;
+
+  /// Guards the task queue and the stop flag.
+  std::mutex taskMutex;
+
+  /// Wakes up the threads, when a task has been queued.
+  std::condition_variable taskCondition;
+
+  /// Whether the threads shall stop, once the queue is empty.
+  bool stopFlag = false;
+};
+} // namespace Utilities
+
+#endif
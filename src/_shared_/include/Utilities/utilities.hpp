@@ -27,6 +27,25 @@ std::vector<std::string> split(const std::string &str, unsigned char token);
 std::string join(const std::vector<std::string> &data, unsigned char token,
                  size_t num = -1);
 
+/**
+ * @brief Translates a glob pattern into an equivalent regular expression, that
+ * matches the whole string. '*' matches any sequence of characters, '?' any
+ * single character and '[...]' resp. '[!...]' a character class. All other
+ * characters match themselves.
+ * @param glob The glob pattern.
+ * @return The regular expression.
+ */
+std::string globToRegex(const std::string &glob);
+
+/**
+ * @brief Parses a time point, that is either given in milliseconds since epoch
+ * or as UTC date in the format YYYY-MM-DDTHH:MM:SS.
+ * @param str The string, that shall be parsed.
+ * @param timePoint Will contain the time point.
+ * @return TRUE if the string has been parsed. FALSE otherwise.
+ */
+bool parseTimePoint(const std::string &str, TimePoint &timePoint);
+
 /**
  * @brief Joins a 3D array into a vector of impedance spectra.
  * @param array The array that shall be joined.
@@ -12,24 +12,25 @@ namespace Utilities {
 /**
  * @brief Constructs a key mapping from the flatbuffers keymapping
  * implementations.
- * @param keyMapping The flatbuffers-style keymapping.
+ * @param fbKeyMapping The flatbuffers-style keymapping. May be null.
  * @return A proper key mapping.
  */
 KeyMapping buildKeyMappingFromFlatbuffers(
-    const std::vector<
-        std::unique_ptr<Serialization::Messages::KeyMappingEntryT>>
-        &fbKeyMapping);
+    const flatbuffers::Vector<
+        flatbuffers::Offset<Serialization::Messages::KeyMappingEntry>>
+        *fbKeyMapping);
 
 /**
  * @brief Constructs a spectrum mapping from the flatbuffers spectrum mapping
  * implementations.
- * @param fbSpectrumMapping The flatbuffers-style spectrum mapping.
+ * @param fbSpectrumMapping The flatbuffers-style spectrum mapping. May be
+ * null.
  * @return A proper spectrum mapping.
  */
 SpectrumMapping buildSpectrumMappingFromFlatbuffers(
-    const std::vector<
-        std::unique_ptr<Serialization::Messages::SpectrumMappingEntryT>>
-        &fbSpectrumMapping);
+    const flatbuffers::Vector<
+        flatbuffers::Offset<Serialization::Messages::SpectrumMappingEntry>>
+        *fbSpectrumMapping);
 
 } // namespace Utilities
 
@@ -17,6 +17,11 @@
 #include <ob1_payload_decoder.hpp>
 #include <sentry_payload_decoder.hpp>
 
+/// The count of threads, the participants of the message distributor are run
+/// on. Devices, that block while they are configured, only delay their own
+/// messages.
+#define CONTROL_WORKER_WRAPPER_DISTRIBUTOR_WORKER_COUNT 4
+
 using namespace Workers;
 /**
  * @brief Wrapper over the control worker that implements the Qt methods.
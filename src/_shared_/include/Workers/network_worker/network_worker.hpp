@@ -7,6 +7,7 @@
 
 // Project includes
 #include <message_factory.hpp>
+#include <message_lanes.hpp>
 #include <network_worker_init_payload.hpp>
 #include <socket_wrapper.hpp>
 #include <worker.hpp>
@@ -152,6 +153,14 @@ private:
    */
   void handleLostConnection();
 
+  /**
+   * @brief Reads from the socket and hands the received bytes to the frame
+   * decoder.
+   * @return The count of bytes that have been read from the socket. A negative
+   * value, if the connection has been closed.
+   */
+  int receive();
+
   std::shared_ptr<NetworkWorkerInitPayload> initPayload;
 
   std::shared_ptr<SocketWrapper> socketWrapper;
@@ -164,11 +173,20 @@ private:
 
   bool doComm;
 
-  /// The read buffer used by the comm thread.
+  /// The read buffer used by the comm thread. Only holds the bytes of a single
+  /// read, before they are handed to the frame decoder.
   std::vector<unsigned char> readBuffer;
 
-  /// Buffer for the messages that shall be sent over the network.
-  std::queue<std::shared_ptr<DeviceMessage>> outgoingNetworkMessages;
+  /// Extracts the frames of the messages from the received bytes.
+  FrameDecoder frameDecoder;
+
+  /// Buffer for the frames, that are written to the socket. Reused for every
+  /// outgoing message.
+  std::vector<unsigned char> writeBuffer;
+
+  /// Buffer for the messages that shall be sent over the network. Messages of
+  /// higher priority classes are sent first.
+  MessageLanes outgoingNetworkMessages;
 
   /// Mutex that guards the buffer for the outgoing messages.
   std::mutex outgoingNetworkMessagesMutex;
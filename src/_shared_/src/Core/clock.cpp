@@ -0,0 +1,206 @@
+// Standard includes
+#include <algorithm>
+#include <thread>
+
+// Project includes
+#include <clock.hpp>
+
+using namespace Core;
+
+namespace {
+/// Owns the clock, that has been set.
+std::shared_ptr<Clock> clockOwner;
+
+/// The clock of the process. Null, if the system clock is used.
+std::atomic<Clock *> processClock(nullptr);
+
+SystemClock &getSystemClock() {
+  static SystemClock systemClock;
+  return systemClock;
+}
+} // namespace
+
+void Clock::sleepUntil(TimePoint timePoint) {
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::unique_lock<std::mutex> lock(mutex);
+  this->waitUntil(lock, condition, timePoint, [] { return false; });
+}
+
+void Clock::sleepFor(Duration duration) {
+  this->sleepUntil(this->now() + duration);
+}
+
+TimePoint SystemClock::now() {
+  return TimePoint(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()));
+}
+
+bool SystemClock::waitUntil(std::unique_lock<std::mutex> &lock,
+                            std::condition_variable &condition,
+                            TimePoint timePoint,
+                            std::function<bool()> predicate) {
+  return condition.wait_until(lock, timePoint, predicate);
+}
+
+void SystemClock::sleepUntil(TimePoint timePoint) {
+  std::this_thread::sleep_until(timePoint);
+}
+
+SimulatedClock::SimulatedClock(TimePoint start, unsigned int threadCount)
+    : currentTime(start.time_since_epoch().count()),
+      threadCount(threadCount) {}
+
+TimePoint SimulatedClock::now() {
+  return TimePoint(Duration(this->currentTime.load(std::memory_order_acquire)));
+}
+
+bool SimulatedClock::waitUntil(std::unique_lock<std::mutex> &lock,
+                               std::condition_variable &condition,
+                               TimePoint timePoint,
+                               std::function<bool()> predicate) {
+  Sleeper sleeper{timePoint, lock.mutex(), &condition, false};
+  while (!predicate()) {
+    if (this->now() >= timePoint) {
+      return false;
+    }
+
+    // Register the thread. If it is the last one, that is expected to wait,
+    // nothing can happen before the earliest time point. Jump there.
+    sleeper.notified = false;
+    std::vector<Sleeper *> wokenSleepers;
+    {
+      std::lock_guard<std::mutex> clockLock(this->clockMutex);
+      this->sleepers.push_back(&sleeper);
+      wokenSleepers = this->advanceAutomaticallyLocked();
+    }
+    if (!wokenSleepers.empty()) {
+      // The sleepers are woken up without holding the lock, so no two locks
+      // of waiting threads are ever held at once.
+      lock.unlock();
+      this->wake(wokenSleepers);
+      lock.lock();
+    }
+
+    condition.wait(lock, [&sleeper, &predicate] {
+      return sleeper.notified || predicate();
+    });
+    if (sleeper.notified) {
+      continue;
+    }
+
+    // Woken up by the predicate. Unregister the thread. If the clock has
+    // taken it already, wait for the notification, so the sleeper is not
+    // accessed after it has been destroyed.
+    bool taken = false;
+    {
+      std::lock_guard<std::mutex> clockLock(this->clockMutex);
+      auto it = std::find(this->sleepers.begin(), this->sleepers.end(),
+                          &sleeper);
+      if (this->sleepers.end() == it) {
+        taken = true;
+      } else {
+        this->sleepers.erase(it);
+      }
+    }
+    if (taken) {
+      condition.wait(lock, [&sleeper] { return sleeper.notified; });
+    }
+  }
+
+  return true;
+}
+
+void SimulatedClock::advance(Duration duration) {
+  this->advanceTo(this->now() + duration);
+}
+
+void SimulatedClock::advanceTo(TimePoint timePoint) {
+  std::vector<Sleeper *> wokenSleepers;
+  {
+    std::lock_guard<std::mutex> clockLock(this->clockMutex);
+    wokenSleepers = this->advanceLocked(timePoint);
+  }
+  this->wake(wokenSleepers);
+}
+
+void SimulatedClock::setThreadCount(unsigned int threadCount) {
+  std::vector<Sleeper *> wokenSleepers;
+  {
+    std::lock_guard<std::mutex> clockLock(this->clockMutex);
+    this->threadCount = threadCount;
+    wokenSleepers = this->advanceAutomaticallyLocked();
+  }
+  this->wake(wokenSleepers);
+}
+
+unsigned int SimulatedClock::getWaitingCount() {
+  std::lock_guard<std::mutex> clockLock(this->clockMutex);
+  return static_cast<unsigned int>(this->sleepers.size());
+}
+
+std::vector<SimulatedClock::Sleeper *>
+SimulatedClock::advanceAutomaticallyLocked() {
+  if (0 == this->threadCount || this->sleepers.size() < this->threadCount) {
+    return std::vector<Sleeper *>();
+  }
+
+  auto earliest =
+      std::min_element(this->sleepers.begin(), this->sleepers.end(),
+                       [](Sleeper *first, Sleeper *second) {
+                         return first->timePoint < second->timePoint;
+                       });
+  return this->advanceLocked((*earliest)->timePoint);
+}
+
+std::vector<SimulatedClock::Sleeper *>
+SimulatedClock::advanceLocked(TimePoint timePoint) {
+  if (timePoint > this->now()) {
+    this->currentTime.store(timePoint.time_since_epoch().count(),
+                            std::memory_order_release);
+  }
+
+  std::vector<Sleeper *> wokenSleepers;
+  TimePoint now = this->now();
+  for (auto it = this->sleepers.begin(); it != this->sleepers.end();) {
+    if ((*it)->timePoint <= now) {
+      wokenSleepers.push_back(*it);
+      it = this->sleepers.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  return wokenSleepers;
+}
+
+void SimulatedClock::wake(const std::vector<Sleeper *> &sleepers) {
+  for (auto sleeper : sleepers) {
+    // The mutex of the sleeper is held while it is notified. So it either has
+    // not checked the flag yet or waits on its condition, and it can not be
+    // destroyed before the notification is done.
+    std::lock_guard<std::mutex> lock(*sleeper->mutex);
+    sleeper->notified = true;
+    sleeper->condition->notify_all();
+  }
+}
+
+Clock &Core::getClock() {
+  Clock *clock = processClock.load(std::memory_order_acquire);
+  if (!clock) {
+    return getSystemClock();
+  }
+
+  return *clock;
+}
+
+void Core::setClock(std::shared_ptr<Clock> clock) {
+  processClock.store(clock.get(), std::memory_order_release);
+  clockOwner = clock;
+}
+
+void Core::sleepUntil(TimePoint timePoint) {
+  getClock().sleepUntil(timePoint);
+}
+
+void Core::sleepFor(Duration duration) { getClock().sleepFor(duration); }
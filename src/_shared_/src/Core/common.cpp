@@ -2,12 +2,10 @@
 #include <format>
 
 // Project includes
+#include <clock.hpp>
 #include <common.hpp>
 
-Core::TimePoint Core::getNow() {
-  return Core::TimePoint(std::chrono::duration_cast<std::chrono::milliseconds>(
-      std::chrono::system_clock::now().time_since_epoch()));
-}
+Core::TimePoint Core::getNow() { return Core::getClock().now(); }
 
 Core::TimePoint Core::getTimeFromStr(const std::string &dateString,
                                      const std::string &formatString) {
@@ -1,10 +1,13 @@
+// Standard includes
+#include <algorithm>
+
 // Project includes
 #include <builtin_payload_decoder.hpp>
 #include <common.hpp>
 #include <data_response_payload.hpp>
 #include <generic_read_payload.hpp>
 #include <key_response_payload.hpp>
-#include <message_factory.hpp>>
+#include <message_factory.hpp>
 #include <request_data_payload.hpp>
 #include <request_key_payload.hpp>
 #include <set_device_status_payload.hpp>
@@ -26,59 +29,119 @@
 using namespace Devices;
 using namespace Messages;
 
+namespace {
+
+/// The values of a data response payload as they are stored in the buffer.
+using DataResponseValueTables = flatbuffers::Vector<flatbuffers::Offset<void>>;
+
+/**
+ * @brief Reads a single value of a data response payload.
+ * @param type The type of the value.
+ * @param tables The tables of the values.
+ * @param index The index of the value.
+ * @return The value. Holds the default value, if the type is unknown.
+ */
+Value decodeDataResponseValue(uint8_t type,
+                              const DataResponseValueTables *tables,
+                              flatbuffers::uoffset_t index) {
+  using namespace Serialization::Devices;
+
+  if (DataResponsePayloadValue_DataResponsePayloadValueInt == type) {
+    return Value(static_cast<int>(
+        tables->GetAs<DataResponsePayloadValueInt>(index)->value()));
+  } else if (DataResponsePayloadValue_DataResponsePayloadValueFloat == type) {
+    return Value(tables->GetAs<DataResponsePayloadValueFloat>(index)->value());
+  } else if (DataResponsePayloadValue_DataResponsePayloadValueString == type) {
+    return Value(flatbuffers::GetString(
+        tables->GetAs<DataResponsePayloadValueString>(index)->value()));
+  } else if (DataResponsePayloadValue_complex == type) {
+    const complex *valueComplex = tables->GetAs<complex>(index);
+    return Value(Impedance(valueComplex->real(), valueComplex->imaginary()));
+  } else if (DataResponsePayloadValue_IsPayload == type) {
+    // The spectrum is joined directly from the vectors in the buffer.
+    const IsPayload *isPayload = tables->GetAs<IsPayload>(index);
+    ImpedanceSpectrum impedanceSpectrum;
+    if (isPayload->frequencies() && isPayload->impedances()) {
+      flatbuffers::uoffset_t count = std::min(isPayload->frequencies()->size(),
+                                              isPayload->impedances()->size());
+      for (flatbuffers::uoffset_t i = 0; i < count; i++) {
+        const complex *impedance = isPayload->impedances()->Get(i);
+        impedanceSpectrum.emplace_back(
+            isPayload->frequencies()->Get(i),
+            Impedance(impedance->real(), impedance->imaginary()));
+      }
+    }
+    return Value(impedanceSpectrum);
+  }
+
+  return Value();
+}
+} // namespace
+
 InitPayload *
-BuiltinPayloadDecoder::decodeInitPayload(const std::vector<unsigned char> &data,
+BuiltinPayloadDecoder::decodeInitPayload(const PayloadBuffer &data,
                                          int magicNumber) {
   // No init payloads are built-in.
   return nullptr;
 }
 
 ConfigurationPayload *BuiltinPayloadDecoder::decodeConfigPayload(
-    const std::vector<unsigned char> &data, int magicNumber) {
+    const PayloadBuffer &data, int magicNumber) {
   // No config payloads are built-in.
   return nullptr;
 }
 
-ReadPayload *
-BuiltinPayloadDecoder::decodeReadPayload(const std::vector<unsigned char> &data,
-                                         int magicNumber) {
-  const unsigned char *buffer = data.data();
-
+ReadPayload *BuiltinPayloadDecoder::decodeReadPayload(const PayloadBuffer &data,
+                                                     int magicNumber) {
   if (MAGIC_NUMBER_GENERIC_READ_PAYLOAD == magicNumber) {
-    const Serialization::Devices::GenericReadPayload *genericReadPayload =
-        Serialization::Devices::GetGenericReadPayload(buffer);
-    std::vector<unsigned char> byteVector(
-        genericReadPayload->byteVector()->begin(),
-        genericReadPayload->byteVector()->end());
+    auto genericReadPayload =
+        data.getRoot<Serialization::Devices::GenericReadPayload>();
+    if (!genericReadPayload) {
+      return nullptr;
+    }
+    std::vector<unsigned char> byteVector;
+    if (genericReadPayload->byteVector()) {
+      byteVector.assign(genericReadPayload->byteVector()->begin(),
+                        genericReadPayload->byteVector()->end());
+    }
 
     return new GenericReadPayload(byteVector);
   }
 
   else if (MAGIC_NUMBER_STATUS_PAYLOAD == magicNumber) {
-    const Serialization::Devices::StatusPayloadT *statusPayload =
-        Serialization::Devices::GetStatusPayload(buffer)->UnPack();
+    auto statusPayload = data.getRoot<Serialization::Devices::StatusPayload>();
+    if (!statusPayload) {
+      return nullptr;
+    }
 
-    UserId deviceId(statusPayload->deviceId);
+    UserId deviceId(statusPayload->deviceId());
     DeviceStatus deviceStatus =
-        static_cast<DeviceStatus>(statusPayload->deviceStatus);
+        static_cast<DeviceStatus>(statusPayload->deviceStatus());
     std::list<UserId> proxyIds;
-    for (auto proxyIdRaw : statusPayload->proxyIds) {
-      proxyIds.emplace_back(UserId(proxyIdRaw));
+    if (statusPayload->proxyIds()) {
+      for (auto proxyIdRaw : *statusPayload->proxyIds()) {
+        proxyIds.emplace_back(UserId(proxyIdRaw));
+      }
     }
-    DeviceType deviceType = static_cast<DeviceType>(statusPayload->deviceType);
-    std::string deviceName = statusPayload->deviceName;
+    DeviceType deviceType =
+        static_cast<DeviceType>(statusPayload->deviceType());
+    std::string deviceName =
+        flatbuffers::GetString(statusPayload->deviceName());
 
+    // The nested payloads are decoded from the same buffer.
     InitPayload *initPayload = nullptr;
-    if (!statusPayload->initPayload.empty()) {
+    PayloadBuffer initPayloadBuffer = data.slice(statusPayload->initPayload());
+    if (!initPayloadBuffer.empty()) {
       initPayload = MessageFactory::getInstace()->decodeInitPayload(
-          statusPayload->initPayload, statusPayload->initPayloadMagicNumber);
+          initPayloadBuffer, statusPayload->initPayloadMagicNumber());
     }
 
     ConfigurationPayload *configPayload = nullptr;
-    if (!statusPayload->configPayload.empty()) {
+    PayloadBuffer configPayloadBuffer =
+        data.slice(statusPayload->configPayload());
+    if (!configPayloadBuffer.empty()) {
       configPayload = MessageFactory::getInstace()->decodeConfigurationPayload(
-          statusPayload->configPayload,
-          statusPayload->configPayloadMagicNumber);
+          configPayloadBuffer, statusPayload->configPayloadMagicNumber());
     }
 
     return new StatusPayload(deviceId, deviceStatus, proxyIds, deviceType,
@@ -86,92 +149,78 @@ BuiltinPayloadDecoder::decodeReadPayload(const std::vector<unsigned char> &data,
   }
 
   else if (MAGIC_NUMBER_DATA_RESPONSE_PAYLOAD == magicNumber) {
-    const Serialization::Devices::DataResponsePayloadT *dataResponsePayload =
-        Serialization::Devices::GetDataResponsePayload(buffer)->UnPack();
+    auto dataResponsePayload =
+        data.getRoot<Serialization::Devices::DataResponsePayload>();
+    if (!dataResponsePayload) {
+      return nullptr;
+    }
 
     TimePoint from =
-        TimePoint(std::chrono::milliseconds(dataResponsePayload->from));
+        TimePoint(std::chrono::milliseconds(dataResponsePayload->from()));
     TimePoint to =
-        TimePoint(std::chrono::milliseconds(dataResponsePayload->to));
-    std::string key = dataResponsePayload->key;
-    size_t count = dataResponsePayload->count;
+        TimePoint(std::chrono::milliseconds(dataResponsePayload->to()));
+    std::string key = flatbuffers::GetString(dataResponsePayload->key());
+
+    // The elements are read directly from the buffer into the vectors of the
+    // payload. Apart from strings and spectra, no element allocates.
     std::vector<TimePoint> timestamps;
-    timestamps.reserve(dataResponsePayload->count);
-    for (auto timestamp : dataResponsePayload->timestamps) {
-      timestamps.push_back(TimePoint(std::chrono::milliseconds(timestamp)));
+    if (dataResponsePayload->timestamps()) {
+      timestamps.reserve(dataResponsePayload->timestamps()->size());
+      for (auto timestamp : *dataResponsePayload->timestamps()) {
+        timestamps.emplace_back(std::chrono::milliseconds(timestamp));
+      }
     }
 
     std::vector<Value> values;
-    values.reserve(count);
-    for (auto valueUnion : dataResponsePayload->values) {
-      Value value;
-      if (Serialization::Devices::DataResponsePayloadValue::
-              DataResponsePayloadValue_DataResponsePayloadValueInt ==
-          valueUnion.type) {
-        value = Value(static_cast<int>(
-            valueUnion.AsDataResponsePayloadValueInt()->value));
-      } else if (Serialization::Devices::DataResponsePayloadValue::
-                     DataResponsePayloadValue_DataResponsePayloadValueFloat ==
-                 valueUnion.type) {
-        value = Value(valueUnion.AsDataResponsePayloadValueFloat()->value);
-      } else if (Serialization::Devices::DataResponsePayloadValue::
-                     DataResponsePayloadValue_DataResponsePayloadValueString ==
-                 valueUnion.type) {
-        value = Value(valueUnion.AsDataResponsePayloadValueString()->value);
-      } else if (Serialization::Devices::DataResponsePayloadValue::
-                     DataResponsePayloadValue_complex == valueUnion.type) {
-
-        Serialization::Devices::complex *valueComplex = valueUnion.Ascomplex();
-        value =
-            Value(Impedance(valueComplex->real(), valueComplex->imaginary()));
-      } else if (Serialization::Devices::DataResponsePayloadValue::
-                     DataResponsePayloadValue_IsPayload == valueUnion.type) {
-
-        Serialization::Devices::IsPayloadT *isPayload =
-            valueUnion.AsIsPayload();
-        std::vector<double> frequencies = isPayload->frequencies;
-        std::vector<Serialization::Devices::complex> complexValues =
-            isPayload->impedances;
-        std::vector<Impedance> impedances;
-        impedances.reserve(complexValues.size());
-        for (auto &complexValue : complexValues) {
-          impedances.emplace_back(
-              Impedance(complexValue.real(), complexValue.imaginary()));
-        }
-
-        ImpedanceSpectrum impedanceSpectrum;
-        Utilities::joinImpedanceSpectrum(frequencies, impedances,
-                                         impedanceSpectrum);
-
-        value = Value(impedanceSpectrum);
+    auto valueTypes = dataResponsePayload->values_type();
+    auto valueTables = dataResponsePayload->values();
+    if (valueTypes && valueTables) {
+      values.reserve(valueTables->size());
+      for (flatbuffers::uoffset_t i = 0; i < valueTables->size(); i++) {
+        values.push_back(
+            decodeDataResponseValue(valueTypes->Get(i), valueTables, i));
       }
-
-      values.push_back(value);
     }
 
     return DataResponsePayload::constructSingleDataResponsePayload(
-        from, to, key, timestamps, values);
+        from, to, key, std::move(timestamps), std::move(values));
   }
 
   else if (MAGIC_NUMBER_KEY_RESPONSE_PAYLOAD == magicNumber) {
-    const Serialization::Devices::KeyResponsePayloadT *keyResponsePayload =
-        Serialization::Devices::GetKeyResponsePayload(buffer)->UnPack();
+    auto keyResponsePayload =
+        data.getRoot<Serialization::Devices::KeyResponsePayload>();
+    if (!keyResponsePayload) {
+      return nullptr;
+    }
 
     KeyMapping keyMapping;
-    for (auto &entry : keyResponsePayload->typeMappings) {
-      keyMapping[entry->key] = static_cast<DataManagerDataType>(entry->type);
+    if (keyResponsePayload->typeMappings()) {
+      for (auto entry : *keyResponsePayload->typeMappings()) {
+        keyMapping[flatbuffers::GetString(entry->key())] =
+            static_cast<DataManagerDataType>(entry->type());
+      }
     }
 
     SpectrumMapping spectrumMapping;
-    for (auto &entry : keyResponsePayload->spectrumMapping) {
-      spectrumMapping[entry->key] = entry->frequencies;
+    if (keyResponsePayload->spectrumMapping()) {
+      for (auto entry : *keyResponsePayload->spectrumMapping()) {
+        std::vector<double> &frequencies =
+            spectrumMapping[flatbuffers::GetString(entry->key())];
+        if (entry->frequencies()) {
+          frequencies.assign(entry->frequencies()->begin(),
+                             entry->frequencies()->end());
+        }
+      }
     }
 
     TimerangeMapping timerangeMapping;
-    for (auto &entry : keyResponsePayload->timerangeMapping) {
-      timerangeMapping[entry->key] = std::make_pair(
-          TimePoint(std::chrono::milliseconds(entry->timerangeBegin)),
-          TimePoint(std::chrono::milliseconds(entry->timerangeEnd)));
+    if (keyResponsePayload->timerangeMapping()) {
+      for (auto entry : *keyResponsePayload->timerangeMapping()) {
+        timerangeMapping[flatbuffers::GetString(entry->key())] =
+            std::make_pair(
+                TimePoint(std::chrono::milliseconds(entry->timerangeBegin())),
+                TimePoint(std::chrono::milliseconds(entry->timerangeEnd())));
+      }
     }
 
     return new KeyResponsePayload(keyMapping, spectrumMapping,
@@ -183,37 +232,48 @@ BuiltinPayloadDecoder::decodeReadPayload(const std::vector<unsigned char> &data,
   }
 }
 
-WritePayload *BuiltinPayloadDecoder::decodeWritePayload(
-    const std::vector<unsigned char> &data, int magicNumber) {
-
-  const unsigned char *buffer = data.data();
-
+WritePayload *
+BuiltinPayloadDecoder::decodeWritePayload(const PayloadBuffer &data,
+                                          int magicNumber) {
   if (MAGIC_NUMBER_SET_PRESSURE_PAYLOAD == magicNumber) {
-    const Serialization::Devices::SetPressurePayloadT *setPressurePayload =
-        Serialization::Devices::GetSetPressurePayload(buffer)->UnPack();
+    auto setPressurePayload =
+        data.getRoot<Serialization::Devices::SetPressurePayload>();
+    if (!setPressurePayload) {
+      return nullptr;
+    }
+    std::vector<double> pressures;
+    if (setPressurePayload->pressures()) {
+      pressures.assign(setPressurePayload->pressures()->begin(),
+                       setPressurePayload->pressures()->end());
+    }
 
     return new SetPressurePayload(
-        setPressurePayload->pressures,
-        static_cast<PressureUnit>(setPressurePayload->pressureUnit));
+        pressures,
+        static_cast<PressureUnit>(setPressurePayload->pressureUnit()));
   }
 
   else if (MAGIC_NUMBER_REQUEST_DATA_PAYLOAD == magicNumber) {
-    const Serialization::Devices::RequestDataPayloadT *requestDataPayload =
-        Serialization::Devices::GetRequestDataPayload(buffer)->UnPack();
+    auto requestDataPayload =
+        data.getRoot<Serialization::Devices::RequestDataPayload>();
+    if (!requestDataPayload) {
+      return nullptr;
+    }
 
     return new RequestDataPayload(
-        TimePoint(std::chrono::milliseconds(requestDataPayload->from)),
-        TimePoint(std::chrono::milliseconds(requestDataPayload->to)),
-        requestDataPayload->key);
+        TimePoint(std::chrono::milliseconds(requestDataPayload->from())),
+        TimePoint(std::chrono::milliseconds(requestDataPayload->to())),
+        flatbuffers::GetString(requestDataPayload->key()));
   }
 
   else if (MAGIC_NUMBER_SET_DEVICE_STATUS_PAYLOAD == magicNumber) {
-    const Serialization::Devices::SetDeviceStatePayloadT
-        *setDeviceStatePayload =
-            Serialization::Devices::GetSetDeviceStatePayload(buffer)->UnPack();
+    auto setDeviceStatePayload =
+        data.getRoot<Serialization::Devices::SetDeviceStatePayload>();
+    if (!setDeviceStatePayload) {
+      return nullptr;
+    }
 
-    return new SetDeviceStatusPayload(setDeviceStatePayload->setStatus,
-                                      setDeviceStatePayload->targetDeviceId);
+    return new SetDeviceStatusPayload(setDeviceStatePayload->setStatus(),
+                                      setDeviceStatePayload->targetDeviceId());
   }
 
   else if (MAGIC_NUMBER_REQUEST_KEY_PAYLOAD == magicNumber) {
@@ -226,3 +286,13 @@ WritePayload *BuiltinPayloadDecoder::decodeWritePayload(
     return nullptr;
   }
 }
+
+std::span<const int> BuiltinPayloadDecoder::getMagicNumbers() const {
+  static constexpr int magicNumbers[] = {
+      MAGIC_NUMBER_GENERIC_READ_PAYLOAD, MAGIC_NUMBER_STATUS_PAYLOAD,
+      MAGIC_NUMBER_DATA_RESPONSE_PAYLOAD, MAGIC_NUMBER_KEY_RESPONSE_PAYLOAD,
+      MAGIC_NUMBER_SET_PRESSURE_PAYLOAD, MAGIC_NUMBER_REQUEST_DATA_PAYLOAD,
+      MAGIC_NUMBER_SET_DEVICE_STATUS_PAYLOAD, MAGIC_NUMBER_REQUEST_KEY_PAYLOAD};
+
+  return magicNumbers;
+}
@@ -79,6 +79,21 @@ DataResponsePayload *DataResponsePayload::constructSingleDataResponsePayload(
                                  timepointVec, valueVec);
 }
 
+DataResponsePayload *DataResponsePayload::constructSingleDataResponsePayload(
+    TimePoint from, TimePoint to, std::string key,
+    std::vector<TimePoint> &&timestamps, std::vector<Value> &&values) {
+  if (timestamps.size() > SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH) {
+    timestamps.resize(SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH);
+  }
+  if (values.size() > SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH) {
+    values.resize(SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH);
+  }
+  size_t count = timestamps.size();
+
+  return new DataResponsePayload(from, to, key, count, std::move(timestamps),
+                                 std::move(values));
+}
+
 std::string DataResponsePayload::serialize() {
   std::stringstream sstream;
 
@@ -101,89 +116,123 @@ std::string DataResponsePayload::serialize() {
 }
 
 std::vector<unsigned char> DataResponsePayload::DataResponsePayload::bytes() {
-
   flatbuffers::FlatBufferBuilder builder;
+  this->encode(builder);
+  uint8_t *buffer = builder.GetBufferPointer();
 
-  Serialization::Devices::DataResponsePayloadT intermediateObject;
-  intermediateObject.from = this->from.time_since_epoch().count();
-  intermediateObject.to = this->to.time_since_epoch().count();
-  intermediateObject.key = this->key;
-  intermediateObject.count = static_cast<long long>(this->count);
+  return std::vector<unsigned char>(buffer, buffer + builder.GetSize());
+}
 
-  intermediateObject.timestamps.reserve(intermediateObject.count);
-  for (auto timestamp : this->timestamps) {
-    intermediateObject.timestamps.push_back(
-        timestamp.time_since_epoch().count());
-  }
+bool DataResponsePayload::encode(flatbuffers::FlatBufferBuilder &builder) {
+  using namespace Serialization::Devices;
 
-  intermediateObject.values.reserve(intermediateObject.count);
-  for (auto &value : this->values) {
+  // The offsets of the value tables. Reused across calls, so encoding does
+  // not allocate once the vector has grown.
+  thread_local std::vector<flatbuffers::Offset<void>> valueOffsets;
+  valueOffsets.clear();
+  valueOffsets.reserve(this->values.size());
 
-    Serialization::Devices::DataResponsePayloadValueUnion valueUnion;
+  // Tables can not be nested while they are built, hence the values are
+  // serialized first.
+  for (auto &value : this->values) {
     size_t variantIdx = value.index();
     // int
     if (variantIdx == 0) {
-      Serialization::Devices::DataResponsePayloadValueIntT intVal;
-      intVal.value = std::get<int>(value);
-      valueUnion.Set(intVal);
+      valueOffsets.push_back(
+          CreateDataResponsePayloadValueInt(builder, std::get<int>(value))
+              .Union());
     }
     // double
     else if (variantIdx == 1) {
-      Serialization::Devices::DataResponsePayloadValueFloatT floatVal;
-      floatVal.value = std::get<double>(value);
-      valueUnion.Set(floatVal);
+      valueOffsets.push_back(
+          CreateDataResponsePayloadValueFloat(builder, std::get<double>(value))
+              .Union());
     }
     // impedance
     else if (variantIdx == 2) {
-      Impedance valueImpedance = std::get<Impedance>(value);
-      Serialization::Devices::complex valueComplex{valueImpedance.real(),
-                                                   valueImpedance.imag()};
-      valueUnion.Set(valueComplex);
+      const Impedance &valueImpedance = std::get<Impedance>(value);
+      valueOffsets.push_back(
+          builder.CreateStruct(complex(valueImpedance.real(),
+                                       valueImpedance.imag()))
+              .Union());
     }
     // string
     else if (variantIdx == 3) {
-      std::string valueStr = std::get<std::string>(value);
-      valueUnion.Set(builder.CreateString(valueStr));
+      auto valueStr = builder.CreateString(std::get<std::string>(value));
+      valueOffsets.push_back(
+          CreateDataResponsePayloadValueString(builder, valueStr).Union());
     }
     // spectrum
     else if (variantIdx == 4) {
-      ImpedanceSpectrum is = std::get<ImpedanceSpectrum>(value);
-
-      Serialization::Devices::IsPayloadT isPayload;
-      isPayload.channelNumber = 0;
-      isPayload.timestamp = 0.0;
-      std::vector<double> frequencies;
-      std::vector<Impedance> impedances;
-      Utilities::splitImpedanceSpectrum(is, frequencies, impedances);
-      std::vector<Serialization::Devices::complex> complexVec;
-      complexVec.reserve(impedances.size());
-      for (auto impedance : impedances) {
-        complexVec.emplace_back(Serialization::Devices::complex(
-            impedance.real(), impedance.imag()));
+      // The vectors are written directly into the builder. Each pointer is
+      // only valid until the next vector is created.
+      const ImpedanceSpectrum &is = std::get<ImpedanceSpectrum>(value);
+      double *frequencyData = nullptr;
+      auto frequencies =
+          builder.CreateUninitializedVector(is.size(), &frequencyData);
+      for (auto &impedancePoint : is) {
+        flatbuffers::WriteScalar(frequencyData++, std::get<0>(impedancePoint));
       }
-
-      isPayload.frequencies = frequencies;
-      isPayload.impedances = complexVec;
-
-      valueUnion.Set(isPayload);
+      complex *impedanceData = nullptr;
+      auto impedances =
+          builder.CreateUninitializedVectorOfStructs(is.size(), &impedanceData);
+      for (auto &impedancePoint : is) {
+        *impedanceData++ = complex(std::get<1>(impedancePoint).real(),
+                                   std::get<1>(impedancePoint).imag());
+      }
+      IsPayloadBuilder isPayloadBuilder(builder);
+      isPayloadBuilder.add_frequencies(frequencies);
+      isPayloadBuilder.add_impedances(impedances);
+      valueOffsets.push_back(isPayloadBuilder.Finish().Union());
     }
-
-    intermediateObject.values.push_back(valueUnion);
   }
 
-  builder.Finish(Serialization::Devices::DataResponsePayload::Pack(
-      builder, &intermediateObject));
-  uint8_t *buffer = builder.GetBufferPointer();
+  // The value types follow the order of the variant.
+  static const uint8_t valueTypes[] = {
+      DataResponsePayloadValue_DataResponsePayloadValueInt,
+      DataResponsePayloadValue_DataResponsePayloadValueFloat,
+      DataResponsePayloadValue_complex,
+      DataResponsePayloadValue_DataResponsePayloadValueString,
+      DataResponsePayloadValue_IsPayload};
+  uint8_t *typeData = nullptr;
+  auto types =
+      builder.CreateUninitializedVector(valueOffsets.size(), &typeData);
+  for (auto &value : this->values) {
+    if (value.index() < sizeof(valueTypes)) {
+      *typeData++ = valueTypes[value.index()];
+    }
+  }
+  auto values = builder.CreateVector(valueOffsets);
 
-  return std::vector<unsigned char>(buffer, buffer + builder.GetSize());
+  int64_t *timestampData = nullptr;
+  auto timestamps = builder.CreateUninitializedVector(this->timestamps.size(),
+                                                      &timestampData);
+  for (auto timestamp : this->timestamps) {
+    flatbuffers::WriteScalar<int64_t>(timestampData++,
+                                      timestamp.time_since_epoch().count());
+  }
+  auto key = builder.CreateString(this->key);
+
+  DataResponsePayloadBuilder payloadBuilder(builder);
+  payloadBuilder.add_from(this->from.time_since_epoch().count());
+  payloadBuilder.add_to(this->to.time_since_epoch().count());
+  payloadBuilder.add_key(key);
+  payloadBuilder.add_count(static_cast<int64_t>(this->count));
+  payloadBuilder.add_timestamps(timestamps);
+  payloadBuilder.add_values_type(types);
+  payloadBuilder.add_values(values);
+  builder.Finish(payloadBuilder.Finish());
+
+  return true;
 }
 
 int DataResponsePayload::getMagicNumber() {
   return MAGIC_NUMBER_DATA_RESPONSE_PAYLOAD;
 }
 
-DataResponsePayload::DataResponsePayload(
-    TimePoint from, TimePoint to, const std::string &key, size_t count,
-    const std::vector<TimePoint> &timestamps, const std::vector<Value> &values)
-    : from(from), to(to), key(key), count(count), timestamps(timestamps),
-      values(values) {}
+DataResponsePayload::DataResponsePayload(TimePoint from, TimePoint to,
+                                         const std::string &key, size_t count,
+                                         std::vector<TimePoint> timestamps,
+                                         std::vector<Value> values)
+    : from(from), to(to), key(key), count(count),
+      timestamps(std::move(timestamps)), values(std::move(values)) {}
@@ -47,10 +47,11 @@ std::string Device::deviceStatusToString(DeviceStatus deviceStatus) {
 }
 
 std::shared_ptr<StatusPayload> Device::constructStatus() {
-  return std::shared_ptr<StatusPayload>(new StatusPayload(
+  std::lock_guard<std::mutex> lock(this->statusMutex);
+  return Utilities::makePooled<StatusPayload>(
       this->getUserId(), this->getDeviceStatus(), this->getProxyUserIds(),
       this->getDeviceType(), this->getDeviceTypeName(), this->initPayload,
-      this->configPayload));
+      this->configPayload);
 }
 
 } // namespace Devices
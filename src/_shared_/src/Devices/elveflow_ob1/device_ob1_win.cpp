@@ -2,6 +2,7 @@
 #include <Elveflow64_shim.h>
 
 // Project includes
+#include <clock.hpp>
 #include <device_ob1_win.hpp>
 #include <easylogging++.h>
 #include <ob1_conf_payload.hpp>
@@ -235,7 +236,7 @@ DeviceOb1Win::specificRead(TimePoint timestamp) {
   ReadPayloadOb1 *readPayload = new ReadPayloadOb1(
       std::make_tuple(pressureCh1, pressureCh2, pressureCh3, pressureCh4));
   std::list<std::shared_ptr<DeviceMessage>> retVal;
-  retVal.emplace_back(new ReadDeviceMessage(
+  retVal.emplace_back(Utilities::makePooled<ReadDeviceMessage>(
       this->self->getUserId(), this->startMessageCache->getSource(),
       ReadDeviceTopic::READ_TOPIC_DEVICE_SPECIFIC_MSG, readPayload,
       this->startMessageCache));
@@ -306,7 +307,7 @@ void DeviceOb1Win::worker() {
         this->currentMeasurementTimestamp + "/channel4/currPressure";
     this->dataManager->write(now, keyChannel4, Value(pressureCh4));
 
-    std::this_thread::sleep_for(this->workerThreadPeriod);
+    Core::sleepFor(this->workerThreadPeriod);
   }
 }
 
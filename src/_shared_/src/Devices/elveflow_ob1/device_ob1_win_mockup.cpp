@@ -5,6 +5,7 @@
 #include <Elveflow64_shim.h>
 
 // Project includes
+#include <clock.hpp>
 #include <device_ob1_win.hpp>
 #include <easylogging++.h>
 #include <ob1_conf_payload.hpp>
@@ -259,7 +260,7 @@ void DeviceOb1Win::worker() {
           Value(unif(re)));
       counter = 0;
     }
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    Core::sleepFor(std::chrono::seconds(1));
   }
 }
 
@@ -16,20 +16,20 @@
 using namespace Devices;
 
 InitPayload *
-Ob1PayloadDecoder::decodeInitPayload(const std::vector<unsigned char> &data,
+Ob1PayloadDecoder::decodeInitPayload(const PayloadBuffer &data,
                                      int magicNumber) {
-  const unsigned char *buffer = data.data();
-
   if (MAGIC_NUMBER_OB1_INIT_PAYLOAD == magicNumber) {
-    const Serialization::Devices::Ob1InitPayloadT *ob1Payload =
-        Serialization::Devices::GetOb1InitPayload(buffer)->UnPack();
+    auto ob1Payload = data.getRoot<Serialization::Devices::Ob1InitPayload>();
+    if (!ob1Payload || !ob1Payload->channelconfiguration()) {
+      return nullptr;
+    }
 
-    std::string deviceName = ob1Payload->deviceName;
+    std::string deviceName = flatbuffers::GetString(ob1Payload->deviceName());
     ChannelConfiguration channelConfiguration{
-        ob1Payload->channelconfiguration->channel1(),
-        ob1Payload->channelconfiguration->channel2(),
-        ob1Payload->channelconfiguration->channel3(),
-        ob1Payload->channelconfiguration->channel4()};
+        ob1Payload->channelconfiguration()->channel1(),
+        ob1Payload->channelconfiguration()->channel2(),
+        ob1Payload->channelconfiguration()->channel3(),
+        ob1Payload->channelconfiguration()->channel4()};
 
     return new Ob1InitPayload(deviceName, channelConfiguration);
   } else {
@@ -38,17 +38,17 @@ Ob1PayloadDecoder::decodeInitPayload(const std::vector<unsigned char> &data,
 }
 
 ConfigurationPayload *
-Ob1PayloadDecoder::decodeConfigPayload(const std::vector<unsigned char> &data,
+Ob1PayloadDecoder::decodeConfigPayload(const PayloadBuffer &data,
                                        int magicNumber) {
-  const unsigned char *buffer = data.data();
-
   if (MAGIC_NUMBER_OB1_CONF_PAYLOAD == magicNumber) {
-    const Serialization::Devices::Ob1ConfPayloadT *ob1Payload =
-        Serialization::Devices::GetOb1ConfPayload(buffer)->UnPack();
+    auto ob1Payload = data.getRoot<Serialization::Devices::Ob1ConfPayload>();
+    if (!ob1Payload) {
+      return nullptr;
+    }
 
     ChannelPressures channelPressures =
-        std::make_tuple(ob1Payload->pressureCh1, ob1Payload->pressureCh2,
-                        ob1Payload->pressureCh3, ob1Payload->pressureCh4);
+        std::make_tuple(ob1Payload->pressureCh1(), ob1Payload->pressureCh2(),
+                        ob1Payload->pressureCh3(), ob1Payload->pressureCh4());
 
     return new Ob1ConfPayload(channelPressures);
   } else {
@@ -57,18 +57,19 @@ Ob1PayloadDecoder::decodeConfigPayload(const std::vector<unsigned char> &data,
 }
 
 ReadPayload *
-Ob1PayloadDecoder::decodeReadPayload(const std::vector<unsigned char> &data,
+Ob1PayloadDecoder::decodeReadPayload(const PayloadBuffer &data,
                                      int magicNumber) {
-  const unsigned char *buffer = data.data();
-
   if (MAGIC_NUMBER_OB1_READ_PAYLOAD == magicNumber) {
-    const Serialization::Devices::Ob1ReadPayloadT *ob1Payload =
-        Serialization::Devices::GetOb1ReadPayload(buffer)->UnPack();
+    auto ob1Payload = data.getRoot<Serialization::Devices::Ob1ReadPayload>();
+    if (!ob1Payload || !ob1Payload->ob1Pressures()) {
+      return nullptr;
+    }
 
-    Ob1ChannelPressures channelPressures(ob1Payload->ob1Pressures->channel1(),
-                                         ob1Payload->ob1Pressures->channel2(),
-                                         ob1Payload->ob1Pressures->channel3(),
-                                         ob1Payload->ob1Pressures->channel4());
+    Ob1ChannelPressures channelPressures(
+        ob1Payload->ob1Pressures()->channel1(),
+        ob1Payload->ob1Pressures()->channel2(),
+        ob1Payload->ob1Pressures()->channel3(),
+        ob1Payload->ob1Pressures()->channel4());
 
     return new ReadPayloadOb1(channelPressures);
   } else {
@@ -79,7 +80,15 @@ Ob1PayloadDecoder::decodeReadPayload(const std::vector<unsigned char> &data,
 }
 
 WritePayload *
-Ob1PayloadDecoder::decodeWritePayload(const std::vector<unsigned char> &data,
+Ob1PayloadDecoder::decodeWritePayload(const PayloadBuffer &data,
                                       int magicNumber) {
   return nullptr;
 }
+
+std::span<const int> Ob1PayloadDecoder::getMagicNumbers() const {
+  static constexpr int magicNumbers[] = {
+      MAGIC_NUMBER_OB1_INIT_PAYLOAD, MAGIC_NUMBER_OB1_CONF_PAYLOAD,
+      MAGIC_NUMBER_OB1_READ_PAYLOAD};
+
+  return magicNumbers;
+}
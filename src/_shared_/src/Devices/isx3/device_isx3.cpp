@@ -410,16 +410,18 @@ bool DeviceIsx3::handleReadPayload(std::shared_ptr<ReadPayload> readPayload) {
       IsPayload copyIsPayload = *isPayload;
       this->impedanceSpectrumBuffer.push_back(copyIsPayload);
       if (coalescedIsPayload != nullptr) {
+        // All messages share the payload. It is released with the last one.
+        std::shared_ptr<ReadPayload> sharedIsPayload =
+            Utilities::sharePooled(coalescedIsPayload);
         // Determine the destination. If there are event response ids, send
         // the messages to the response ids. In any case, save the spectrum to
         // the local data manager.
         if (!this->eventResponseId.empty()) {
           for (auto &responseId : this->eventResponseId) {
-            this->pushMessageQueue(
-                std::shared_ptr<DeviceMessage>(new ReadDeviceMessage(
-                    this->self->getUserId(), responseId,
-                    ReadDeviceTopic::READ_TOPIC_DEVICE_SPECIFIC_MSG,
-                    coalescedIsPayload, this->startMessageCache)));
+            this->pushMessageQueue(Utilities::makePooled<ReadDeviceMessage>(
+                this->self->getUserId(), responseId,
+                ReadDeviceTopic::READ_TOPIC_DEVICE_SPECIFIC_MSG,
+                sharedIsPayload, this->startMessageCache));
           }
         }
         // Write the impedance spectrum.
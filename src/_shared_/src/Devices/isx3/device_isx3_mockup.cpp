@@ -6,6 +6,7 @@
 #include <easylogging++.h>
 
 // Project includes
+#include <clock.hpp>
 #include <common.hpp>
 #include <device_isx3.hpp>
 #include <is_configuration.hpp>
@@ -33,7 +34,7 @@ void writeThreadWorker(DataManager *dataManager, DeviceIsx3 *device) {
     dataManager->write(Core::getNow(), device->getCurrentSpectrumKey(),
                        Value(impedanceSpectrum));
 
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    Core::sleepFor(std::chrono::seconds(1));
   }
 }
 
@@ -251,11 +252,10 @@ bool DeviceIsx3::handleReadPayload(std::shared_ptr<ReadPayload> readPayload) {
         UserId destinationId = this->startMessageCache->getSource();
         ;
 
-        this->pushMessageQueue(
-            std::shared_ptr<DeviceMessage>(new ReadDeviceMessage(
-                this->self->getUserId(), destinationId,
-                ReadDeviceTopic::READ_TOPIC_DEVICE_SPECIFIC_MSG,
-                coalescedIsPayload, this->startMessageCache)));
+        this->pushMessageQueue(Utilities::makePooled<ReadDeviceMessage>(
+            this->self->getUserId(), destinationId,
+            ReadDeviceTopic::READ_TOPIC_DEVICE_SPECIFIC_MSG, coalescedIsPayload,
+            this->startMessageCache));
       } else {
         LOG(WARNING) << "Was not able to coalesce impedance spectrums.";
       }
@@ -287,7 +287,10 @@ bool DeviceIsx3::initialize(std::shared_ptr<InitPayload> initPayload) {
     return false;
   }
 
-  this->initPayload = isx3InitPayload;
+  {
+    std::lock_guard<std::mutex> lock(this->statusMutex);
+    this->initPayload = isx3InitPayload;
+  }
   this->deviceState = DeviceStatus::INITIALIZING;
 
   this->onInitialized("isx3mockup", Utilities::KeyMapping(),
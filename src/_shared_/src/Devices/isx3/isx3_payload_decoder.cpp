@@ -14,43 +14,51 @@
 using namespace Devices;
 
 InitPayload *
-Isx3PayloadDecoder::decodeInitPayload(const std::vector<unsigned char> &data,
+Isx3PayloadDecoder::decodeInitPayload(const PayloadBuffer &data,
                                       int magicNumber) {
   if (magicNumber == MAGIC_NUMBER_ISX3_INIT_PAYLOAD) {
-    const Serialization::Devices::Isx3InitPayloadT *payload =
-        Serialization::Devices::GetIsx3InitPayload(data.data())->UnPack();
+    auto payload = data.getRoot<Serialization::Devices::Isx3InitPayload>();
+    if (!payload) {
+      return nullptr;
+    }
 
-    return new Isx3InitPayload(payload->comPort, payload->baudRate);
+    return new Isx3InitPayload(flatbuffers::GetString(payload->comPort()),
+                               payload->baudRate());
   } else {
     return nullptr;
   }
 }
 
 ConfigurationPayload *
-Isx3PayloadDecoder::decodeConfigPayload(const std::vector<unsigned char> &data,
+Isx3PayloadDecoder::decodeConfigPayload(const PayloadBuffer &data,
                                         int magicNumber) {
   if (magicNumber == MAGIC_NUMBER_ISX3_IS_CONF_PAYLOAD) {
-    const Serialization::Devices::Isx3IsConfPayloadT *payload =
-        Serialization::Devices::GetIsx3IsConfPayload(data.data())->UnPack();
+    auto payload = data.getRoot<Serialization::Devices::Isx3IsConfPayload>();
+    if (!payload) {
+      return nullptr;
+    }
 
     // Transform the channel mapping.
     std::map<ChannelFunction, int> channelFunctionMapping;
-    for (auto keyValuePair : payload->channelFunctionMapping) {
-      channelFunctionMapping[static_cast<ChannelFunction>(
-          keyValuePair.channelFunction())] = keyValuePair.channel();
+    if (payload->channelFunctionMapping()) {
+      for (auto keyValuePair : *payload->channelFunctionMapping()) {
+        channelFunctionMapping[static_cast<ChannelFunction>(
+            keyValuePair->channelFunction())] = keyValuePair->channel();
+      }
     }
 
-    return new Isx3IsConfPayload(payload->frequencyFrom, payload->frequencyTo,
-                                 payload->measurementPoints,
-                                 payload->repetitions, channelFunctionMapping,
-                                 static_cast<IsScale>(payload->isScale),
+    return new Isx3IsConfPayload(payload->frequencyFrom(),
+                                 payload->frequencyTo(),
+                                 payload->measurementPoints(),
+                                 payload->repetitions(), channelFunctionMapping,
+                                 static_cast<IsScale>(payload->isScale()),
                                  static_cast<MeasurmentConfigurationRange>(
-                                     payload->measurementConfigurationRage),
+                                     payload->measurementConfigurationRage()),
                                  static_cast<MeasurmentConfigurationChannel>(
-                                     payload->measurmentConfigurationChannel),
+                                     payload->measurmentConfigurationChannel()),
                                  static_cast<MeasurementConfiguration>(
-                                     payload->measurementConfiguration),
-                                 payload->precision, payload->amplitude);
+                                     payload->measurementConfiguration()),
+                                 payload->precision(), payload->amplitude());
   }
 
   else {
@@ -59,13 +67,20 @@ Isx3PayloadDecoder::decodeConfigPayload(const std::vector<unsigned char> &data,
 }
 
 ReadPayload *
-Isx3PayloadDecoder::decodeReadPayload(const std::vector<unsigned char> &data,
+Isx3PayloadDecoder::decodeReadPayload(const PayloadBuffer &data,
                                       int magicNumber) {
   return nullptr;
 }
 
 WritePayload *
-Isx3PayloadDecoder::decodeWritePayload(const std::vector<unsigned char> &data,
+Isx3PayloadDecoder::decodeWritePayload(const PayloadBuffer &data,
                                        int magicNumber) {
   return nullptr;
 }
+
+std::span<const int> Isx3PayloadDecoder::getMagicNumbers() const {
+  static constexpr int magicNumbers[] = {
+      MAGIC_NUMBER_ISX3_INIT_PAYLOAD, MAGIC_NUMBER_ISX3_IS_CONF_PAYLOAD};
+
+  return magicNumbers;
+}
@@ -0,0 +1,35 @@
+// Project includes
+#include <payload_buffer.hpp>
+
+using namespace Devices;
+
+PayloadBuffer::PayloadBuffer() {}
+
+PayloadBuffer::PayloadBuffer(const std::vector<unsigned char> &bytes)
+    : storage(std::make_shared<const std::vector<unsigned char>>(bytes)),
+      bytes(*this->storage) {}
+
+PayloadBuffer::PayloadBuffer(
+    std::shared_ptr<const std::vector<unsigned char>> storage,
+    std::span<const unsigned char> bytes)
+    : storage(storage), bytes(bytes) {}
+
+PayloadBuffer
+PayloadBuffer::slice(const flatbuffers::Vector<uint8_t> *bytes) const {
+  if (!bytes) {
+    return PayloadBuffer();
+  }
+
+  return PayloadBuffer(this->storage, std::span<const unsigned char>(
+                                          bytes->data(), bytes->size()));
+}
+
+std::span<const unsigned char> PayloadBuffer::getBytes() const {
+  return this->bytes;
+}
+
+std::vector<unsigned char> PayloadBuffer::toVector() const {
+  return std::vector<unsigned char>(this->bytes.begin(), this->bytes.end());
+}
+
+bool PayloadBuffer::empty() const { return this->bytes.empty(); }
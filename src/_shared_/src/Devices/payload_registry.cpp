@@ -0,0 +1,89 @@
+// Project includes
+#include <payload_registry.hpp>
+
+// 3rd party includes
+#include <easylogging++.h>
+
+using namespace Devices;
+
+PayloadRegistry::PayloadRegistry() {}
+
+bool PayloadRegistry::registerDecoder(std::shared_ptr<PayloadDecoder> decoder) {
+  if (!decoder) {
+    return false;
+  }
+
+  std::span<const int> magicNumbers = decoder->getMagicNumbers();
+  if (magicNumbers.empty()) {
+    this->fallbackDecoders.push_back(decoder);
+    return true;
+  }
+
+  bool success = true;
+  for (int magicNumber : magicNumbers) {
+    PayloadRegistryEntry *entry = this->getOrCreateEntry(magicNumber);
+    if (!entry) {
+      LOG(ERROR) << "Payload registry can not register a decoder for the "
+                    "magic number "
+                 << magicNumber << ". It is out of range.";
+      success = false;
+    } else if (entry->decoder) {
+      LOG(WARNING) << "Payload registry already has a decoder for the magic "
+                      "number "
+                   << magicNumber << ". Keeping it.";
+      success = false;
+    } else {
+      entry->decoder = decoder;
+    }
+  }
+
+  return success;
+}
+
+bool PayloadRegistry::registerEncoder(int magicNumber, PayloadEncoder encoder) {
+  PayloadRegistryEntry *entry = this->getOrCreateEntry(magicNumber);
+  if (!entry) {
+    LOG(ERROR) << "Payload registry can not register an encoder for the magic "
+                  "number "
+               << magicNumber << ". It is out of range.";
+    return false;
+  }
+  entry->encoder = encoder;
+
+  return true;
+}
+
+PayloadDecoder *PayloadRegistry::getDecoder(int magicNumber) const {
+  if (magicNumber < 0 ||
+      static_cast<size_t>(magicNumber) >= this->entries.size()) {
+    return nullptr;
+  }
+
+  return this->entries[magicNumber].decoder.get();
+}
+
+const PayloadEncoder *PayloadRegistry::getEncoder(int magicNumber) const {
+  if (magicNumber < 0 ||
+      static_cast<size_t>(magicNumber) >= this->entries.size() ||
+      !this->entries[magicNumber].encoder) {
+    return nullptr;
+  }
+
+  return &this->entries[magicNumber].encoder;
+}
+
+const std::vector<std::shared_ptr<PayloadDecoder>> &
+PayloadRegistry::getFallbackDecoders() const {
+  return this->fallbackDecoders;
+}
+
+PayloadRegistryEntry *PayloadRegistry::getOrCreateEntry(int magicNumber) {
+  if (magicNumber < 0 || magicNumber > PAYLOAD_REGISTRY_MAX_MAGIC_NUMBER) {
+    return nullptr;
+  }
+  if (static_cast<size_t>(magicNumber) >= this->entries.size()) {
+    this->entries.resize(magicNumber + 1);
+  }
+
+  return &this->entries[magicNumber];
+}
@@ -1,4 +1,5 @@
 // Project includes
+#include <impedance_kernels.hpp>
 #include <spectroplot_data.hpp>
 #include <utilities.hpp>
 
@@ -6,7 +7,7 @@ namespace Gui {
 
 SpectrogramData::SpectrogramData(std::vector<double> frequencies,
                                  std::chrono::seconds retentionPeriod)
-    : frequencies(frequencies), impedanceMax(0.0, 0.0) {
+    : frequencies(frequencies), magnitudeMax(0.0) {
 
   this->intervals[Qt::XAxis] =
       QwtInterval(0, *std::max_element(frequencies.begin(), frequencies.end()));
@@ -43,7 +44,7 @@ double SpectrogramData::value(double x, double y) const {
   }
   size_t i = std::distance(this->frequencies.begin(), itFreq);
 
-  return std::abs(this->dataMap[nearestTimestamp][i]);
+  return this->dataMap[nearestTimestamp][i];
 }
 
 bool SpectrogramData::pushSpectrum(TimePoint timestamp,
@@ -64,17 +65,23 @@ bool SpectrogramData::pushSpectrum(TimePoint timestamp,
                                          this->frequencies.end()));
     this->intervals[Qt::YAxis] = QwtInterval(0.0, 0.0);
     this->intervals[Qt::ZAxis] = QwtInterval(0.0, 0.0);
-    this->impedanceMax = Impedance(0.0, 0.0);
+    this->magnitudeMax = 0.0;
   }
 
-  // Add the spectrum to the data container.
+  // Add the magnitudes of the spectrum to the data container.
+  std::vector<double> realParts;
+  std::vector<double> imagParts;
+  Utilities::splitImpedance(impedances, realParts, imagParts);
+  std::vector<double> magnitudes(impedances.size());
+  Utilities::computeMagnitudes(realParts.data(), imagParts.data(),
+                               magnitudes.data(), magnitudes.size());
   double timestampDouble =
       static_cast<double>(timestamp.time_since_epoch().count());
-  this->dataMap[timestampDouble] = impedances;
+  this->dataMap[timestampDouble] = magnitudes;
 
 #if 0
   // Remove timestamp/value pairs that are beyond the retention period.
-  QMap<double, std::vector<Impedance>> tempMap;
+  QMap<double, std::vector<double>> tempMap;
   TimePoint now = Core::getNow();
 
   for(int i = 0; i < this->dataMap.size(); ) {
@@ -96,11 +103,13 @@ bool SpectrogramData::pushSpectrum(TimePoint timestamp,
   this->intervals[Qt::YAxis].setInterval(timestampMin, timestampMax);
   // Z axis - Impedance
   // Check if the new spectrum added a new maximum.
-  Impedance newMaxImpedance =
-      *std::max_element(impedances.begin(), impedances.end());
-  if (newMaxImpedance > this->impedanceMax) {
-    this->impedanceMax = newMaxImpedance;
-    this->intervals[Qt::ZAxis].setInterval(0.0, std::abs(this->impedanceMax));
+  if (!magnitudes.empty()) {
+    double newMaxMagnitude =
+        *std::max_element(magnitudes.begin(), magnitudes.end());
+    if (newMaxMagnitude > this->magnitudeMax) {
+      this->magnitudeMax = newMaxMagnitude;
+      this->intervals[Qt::ZAxis].setInterval(0.0, this->magnitudeMax);
+    }
   }
 
   return true;
@@ -114,7 +123,7 @@ int SpectrogramData::removeBefore(TimePoint timestamp) {
   // Remove entries that are older than the timestamp.
   int removeCount = this->dataMap.removeIf(
       [timestampDouble](
-          std::pair<const double &, std::vector<Impedance> &> entry) {
+          std::pair<const double &, std::vector<double> &> entry) {
         return entry.first < timestampDouble;
       });
 
@@ -5,14 +5,16 @@ namespace Messages {
 ConfigDeviceMessage::ConfigDeviceMessage(
     UserId source, UserId destination,
     ConfigurationPayload *deviceConfiguration, std::vector<UserId> responseIds)
-    : DeviceMessage(source, destination),
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_CONFIG,
+                    MESSAGE_PRIORITY_CONTROL),
       deviceConfiguration(deviceConfiguration), responseIds(responseIds) {}
 
 ConfigDeviceMessage::ConfigDeviceMessage(
     UserId source, UserId destination,
     std::shared_ptr<ConfigurationPayload> deviceConfiguration,
     std::vector<UserId> responseIds)
-    : DeviceMessage(source, destination),
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_CONFIG,
+                    MESSAGE_PRIORITY_CONTROL),
       deviceConfiguration(deviceConfiguration), responseIds(responseIds) {}
 
 ConfigDeviceMessage::~ConfigDeviceMessage() {}
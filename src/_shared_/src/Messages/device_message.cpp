@@ -9,8 +9,10 @@
 
 namespace Messages {
 
-DeviceMessage::DeviceMessage(UserId source, UserId destination)
-    : messageId(this->generateId()), source(source), destination(destination) {}
+DeviceMessage::DeviceMessage(UserId source, UserId destination,
+                             DeviceMessageKind kind, MessagePriority priority)
+    : messageId(this->generateId()), source(source), destination(destination),
+      kind(kind), priority(priority) {}
 
 DeviceMessage::~DeviceMessage() {}
 
@@ -35,6 +37,14 @@ UserId DeviceMessage::getSource() { return this->source; }
 
 UserId DeviceMessage::getDestination() { return this->destination; }
 
+DeviceMessageKind DeviceMessage::getKind() const { return this->kind; }
+
+MessagePriority DeviceMessage::getPriority() const { return this->priority; }
+
+void DeviceMessage::setPriority(MessagePriority priority) {
+  this->priority = priority;
+}
+
 void DeviceMessage::setSource(UserId source) { this->source = source; }
 
 void DeviceMessage::setDestination(UserId destination) {
@@ -0,0 +1,151 @@
+// Standard includes
+#include <algorithm>
+#include <cstring>
+
+// Project includes
+#include <frame_decoder.hpp>
+
+using namespace Messages;
+
+FrameDecoder::FrameDecoder(size_t capacity)
+    : buffer(std::max<size_t>(capacity, FRAME_DECODER_FRAME_OVERHEAD)),
+      head(0), tail(0), pendingFrameSize(0), discardedByteCount(0) {}
+
+std::span<unsigned char> FrameDecoder::prepare(size_t size) {
+  if (this->buffer.size() - this->tail < size) {
+    // Move the unconsumed bytes to the front. These are at most a partially
+    // received frame and some bytes, that have not been scanned yet.
+    std::memmove(this->buffer.data(), this->buffer.data() + this->head,
+                 this->tail - this->head);
+    this->tail -= this->head;
+    this->head = 0;
+    if (this->buffer.size() - this->tail < size) {
+      this->buffer.resize(
+          std::max(2 * this->buffer.size(), this->tail + size));
+    }
+  }
+
+  return std::span<unsigned char>(this->buffer.data() + this->tail, size);
+}
+
+void FrameDecoder::commit(size_t size) {
+  this->tail = std::min(this->tail + size, this->buffer.size());
+}
+
+void FrameDecoder::append(std::span<const unsigned char> bytes) {
+  std::span<unsigned char> target = this->prepare(bytes.size());
+  std::copy(bytes.begin(), bytes.end(), target.begin());
+  this->commit(bytes.size());
+}
+
+bool FrameDecoder::extractFrame(std::span<const unsigned char> &frame) {
+  size_t bufferedByteCount = this->tail - this->head;
+  // Do not scan again, while the remainder of a frame is missing.
+  if (bufferedByteCount < std::max<size_t>(this->pendingFrameSize,
+                                           FRAME_DECODER_FRAME_OVERHEAD)) {
+    return false;
+  }
+
+  size_t frameStart = 0;
+  size_t frameSize = 0;
+  FrameScanResult result = FrameDecoder::scanFrame(
+      std::span<const unsigned char>(this->buffer.data() + this->head,
+                                     bufferedByteCount),
+      frameStart, frameSize);
+  this->discardedByteCount += frameStart;
+  this->head += frameStart;
+  bool found = FRAME_SCAN_RESULT_FOUND == result;
+  if (found) {
+    frame = std::span<const unsigned char>(this->buffer.data() + this->head,
+                                           frameSize);
+    this->head += frameSize;
+    this->pendingFrameSize = 0;
+  } else {
+    this->pendingFrameSize = frameSize;
+  }
+  if (this->head == this->tail) {
+    // Start over at the front. This does not move any bytes, so the extracted
+    // frames stay valid.
+    this->head = 0;
+    this->tail = 0;
+  }
+
+  return found;
+}
+
+size_t FrameDecoder::extractFrames(
+    std::vector<std::span<const unsigned char>> &frames) {
+  frames.clear();
+  std::span<const unsigned char> frame;
+  while (this->extractFrame(frame)) {
+    frames.push_back(frame);
+  }
+
+  return frames.size();
+}
+
+void FrameDecoder::clear() {
+  this->head = 0;
+  this->tail = 0;
+  this->pendingFrameSize = 0;
+}
+
+size_t FrameDecoder::getBufferedByteCount() const {
+  return this->tail - this->head;
+}
+
+size_t FrameDecoder::getDiscardedByteCount() const {
+  return this->discardedByteCount;
+}
+
+FrameScanResult FrameDecoder::scanFrame(std::span<const unsigned char> bytes,
+                                        size_t &frameStart,
+                                        size_t &frameSize) {
+  size_t position = 0;
+  while (true) {
+    // Search for the next message type tag.
+    while (position < bytes.size() &&
+           !FrameDecoder::isMessageTypeTag(bytes[position])) {
+      position++;
+    }
+    frameStart = position;
+    frameSize = 0;
+
+    // The smallest possible frame is 6 bytes in length. Wait for the length
+    // bytes to arrive.
+    if (bytes.size() - position < FRAME_DECODER_FRAME_OVERHEAD) {
+      return FRAME_SCAN_RESULT_INCOMPLETE;
+    }
+
+    size_t length = static_cast<size_t>(bytes[position + 1]) |
+                    (static_cast<size_t>(bytes[position + 2]) << 8) |
+                    (static_cast<size_t>(bytes[position + 3]) << 16) |
+                    (static_cast<size_t>(bytes[position + 4]) << 24);
+    if (length > FRAME_DECODER_MAX_FRAME_LENGTH) {
+      // The tag did not start a frame.
+      position++;
+      continue;
+    }
+    frameSize = length + FRAME_DECODER_FRAME_OVERHEAD;
+    if (frameSize > bytes.size() - position) {
+      // The closing tag has not been received yet.
+      return FRAME_SCAN_RESULT_INCOMPLETE;
+    }
+    if (bytes[position + frameSize - 1] != bytes[position]) {
+      // Closing message type tag not found. The opening message type tag did
+      // not start a frame. Start interpretation again behind it.
+      position++;
+      continue;
+    }
+
+    return FRAME_SCAN_RESULT_FOUND;
+  }
+}
+
+bool FrameDecoder::isMessageTypeTag(unsigned char byte) {
+  return MessageType::WRITE_DEVICE_MESSAGE == byte ||
+         MessageType::READ_DEVICE_MESSAGE == byte ||
+         MessageType::HANDSHAKE_MESSAGE == byte ||
+         MessageType::INIT_DEVICE_MESSAGE == byte ||
+         MessageType::CONFIG_DEVICE_MESSAGE == byte;
+}
@@ -7,8 +7,9 @@ HandshakeMessage::HandshakeMessage(
     UserId source, UserId destination,
     std::list<std::shared_ptr<StatusPayload>> statusPayloads,
     std::string version)
-    : DeviceMessage(source, destination), statusPayloads(statusPayloads),
-      version(version) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_HANDSHAKE,
+                    MESSAGE_PRIORITY_CONTROL),
+      statusPayloads(statusPayloads), version(version) {}
 
 HandshakeMessage::~HandshakeMessage() {}
 
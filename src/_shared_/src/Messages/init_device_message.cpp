@@ -4,11 +4,15 @@
 namespace Messages {
 InitDeviceMessage::InitDeviceMessage(UserId source, UserId destination,
                                      InitPayload *initPayload)
-    : DeviceMessage(source, destination), initPayload(initPayload) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_INIT,
+                    MESSAGE_PRIORITY_CONTROL),
+      initPayload(initPayload) {}
 
 InitDeviceMessage::InitDeviceMessage(UserId source, UserId destination,
                                      std::shared_ptr<InitPayload> initPayload)
-    : DeviceMessage(source, destination), initPayload(initPayload) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_INIT,
+                    MESSAGE_PRIORITY_CONTROL),
+      initPayload(initPayload) {}
 
 InitDeviceMessage::~InitDeviceMessage() {}
 
@@ -1,20 +1,40 @@
+// Standard includes
+#include <exception>
+
 // 3rd party includes
 #include <easylogging++.h>
 
 // Project includes
+#include <clock.hpp>
 #include <common.hpp>
 #include <message_distributor.hpp>
 
 namespace Messages {
 
-MessageDistributor::MessageDistributor(int loopInterval)
-    : loopInterval(Duration(loopInterval)) {}
+ParticipantActor::ParticipantActor(
+    std::shared_ptr<MessageInterface> participant)
+    : participant(participant), readPending(false), scheduled(false) {}
+
+MessageDistributor::MessageDistributor(int loopInterval,
+                                       MessageDistributorMode mode,
+                                       unsigned int workerCount)
+    : MessageDistributor(std::chrono::milliseconds(loopInterval), mode,
+                         workerCount) {}
 
-MessageDistributor::MessageDistributor(std::chrono::milliseconds loopInterval)
-    : loopInterval(loopInterval) {}
+MessageDistributor::MessageDistributor(std::chrono::milliseconds loopInterval,
+                                       MessageDistributorMode mode,
+                                       unsigned int workerCount)
+    : misroutedMessageCount(0), failedDeliveryCount(0),
+      loopInterval(loopInterval), mode(mode), wakeupPending(false),
+      workerPool(workerCount > 0 ? new ThreadPool(workerCount) : nullptr) {}
 
 void MessageDistributor::takeMessage(std::shared_ptr<DeviceMessage> message) {
-  this->messageCache.push_back(message);
+  if (!this->incomingMessages.push(message)) {
+    LOG(ERROR) << "Message distributor can not take a message, that is null or "
+                  "already queued.";
+    return;
+  }
+  this->notify();
 }
 
 void MessageDistributor::takeMessage(
@@ -48,6 +68,18 @@ bool MessageDistributor::addParticipant(
   this->participants.push_back(participant);
   participant->messageDistributor = this;
   participant->self = participant;
+  {
+    std::lock_guard<std::mutex> lock(this->routingTableMutex);
+    this->actors.emplace(participant.get(),
+                         std::make_shared<ParticipantActor>(participant));
+  }
+
+  // Route the own id and the proxy ids, that have been added before, to the
+  // participant.
+  this->addRoute(participant->getUserId(), participant);
+  for (auto &proxyId : participant->getProxyUserIds()) {
+    this->addRoute(proxyId, participant);
+  }
   return true;
 }
 
@@ -63,8 +95,9 @@ std::list<UserId> MessageDistributor::getParticipants() {
 std::list<std::shared_ptr<StatusPayload>> MessageDistributor::getStatus() {
   std::list<std::shared_ptr<StatusPayload>> retVal;
 
+  // The participants guard the state, that constructStatus() reads, so they
+  // may keep running.
   for (auto participant : this->participants) {
-
     retVal.emplace_back(participant->constructStatus());
   }
 
@@ -77,43 +110,47 @@ void MessageDistributor::run() {
     // Get the current time.
     TimePoint now(Core::getNow());
 
-    // Get all messages from the participants.
-    for (auto participant : this->participants) {
-      std::list<std::shared_ptr<DeviceMessage>> gatheredMessages =
-          participant->read(now);
-      this->messageCache.splice(this->messageCache.end(), gatheredMessages);
+    if (MESSAGE_DISTRIBUTOR_MODE_EVENT_DRIVEN == this->mode) {
+      // Messages, that are queued from now on, are either gathered by this
+      // cycle or trigger the next one.
+      std::lock_guard<std::mutex> lock(this->wakeupMutex);
+      this->wakeupPending = false;
     }
 
-    // Send messages to recipients.
-    for (auto message : this->messageCache) {
-      // Find the target participant.
-      UserId destination = message->getDestination();
-      auto targetParticipant =
-          find_if(this->participants.begin(), this->participants.end(),
-                  [destination](std::shared_ptr<MessageInterface> value) {
-                    return value->isTarget(destination);
-                  });
-
-      if (targetParticipant == this->participants.end()) {
-        // Destination does not exist. Log this and add a failed response
-        // message to the cache.
-        LOG(WARNING) << "Message from " << message->getSource().id()
-                     << " could not be delivered. Destination does not exist.";
-        this->failedResponseCache.push_back(
-            std::shared_ptr<DeviceMessage>(new ReadDeviceMessage(
-                message->getDestination(), message->getSource(),
-                ReadDeviceTopic::READ_TOPIC_FAILED_RESPONSE, nullptr,
-                std::shared_ptr<WriteDeviceMessage>())));
-
-      } else {
-        // Destination found. Let the object take the message.
-        bool processSuccess = (*targetParticipant)->takeMessage(message);
-
-        if (!processSuccess) {
-          LOG(WARNING) << "Targeted participant  "
-                       << message->getDestination().id()
-                       << " was not able to process the message.";
+    // Add the messages, that have been taken from outside since the last
+    // cycle.
+    this->incomingMessages.drain(this->messageCache);
+
+    if (this->workerPool) {
+      // The participants are read and take their messages in the tasks of
+      // their actors. Deliver the messages, that have been taken from outside
+      // or failed before, and let all actors read their participant.
+      sortByPriority(this->messageCache);
+      for (auto message : this->messageCache) {
+        this->deliverMessage(message);
+      }
+      for (auto &participant : this->participants) {
+        std::shared_ptr<ParticipantActor> actor;
+        {
+          std::lock_guard<std::mutex> lock(this->routingTableMutex);
+          actor = this->actors[participant.get()];
         }
+        actor->readPending = true;
+        this->scheduleActor(actor);
+      }
+    } else {
+      // Get all messages from the participants.
+      for (auto participant : this->participants) {
+        std::list<std::shared_ptr<DeviceMessage>> gatheredMessages =
+            participant->read(now);
+        this->messageCache.splice(this->messageCache.end(), gatheredMessages);
+      }
+
+      // Send messages to recipients. Messages of higher priority classes
+      // first.
+      sortByPriority(this->messageCache);
+      for (auto message : this->messageCache) {
+        this->deliverMessage(message);
       }
     }
 
@@ -121,9 +158,21 @@ void MessageDistributor::run() {
     this->messageCache.clear();
     // Add the responses that failed to the cache, so that they are handled in
     // the next loop iteration.
-    this->messageCache.splice(messageCache.end(), this->failedResponseCache);
+    this->failedResponseCache.drain(this->messageCache);
 
     TimePoint nextTimepoint = now + this->loopInterval;
+    if (MESSAGE_DISTRIBUTOR_MODE_EVENT_DRIVEN == this->mode) {
+      // Sleep until a participant queues a message or the participants have
+      // to be polled again. Failed responses wait for the next cycle, as in
+      // polling mode, so undeliverable ones can not spin the loop.
+      std::unique_lock<std::mutex> lock(this->wakeupMutex);
+      Core::getClock().waitUntil(lock, this->wakeupCondition, nextTimepoint,
+                                 [this] {
+                                   return this->wakeupPending || !this->doRun;
+                                 });
+      continue;
+    }
+
     TimePoint newNow = Core::getNow();
     if (nextTimepoint < newNow) {
       LOG(WARNING) << "Can not keep up. Next loop iteration is scheduled at "
@@ -131,12 +180,182 @@ void MessageDistributor::run() {
                    << ".";
     }
 
-    std::this_thread::sleep_until(nextTimepoint);
+    Core::sleepUntil(nextTimepoint);
   }
 }
 
-void MessageDistributor::stop() { this->doRun = false; }
+void MessageDistributor::stop() {
+  this->doRun = false;
+  this->notify();
+}
 
 bool MessageDistributor::isRunning() const { return this->doRun; }
 
+void MessageDistributor::notify() {
+  if (MESSAGE_DISTRIBUTOR_MODE_EVENT_DRIVEN != this->mode) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->wakeupMutex);
+    this->wakeupPending = true;
+  }
+  this->wakeupCondition.notify_one();
+}
+
+size_t MessageDistributor::getMisroutedMessageCount() const {
+  return this->misroutedMessageCount;
+}
+
+size_t MessageDistributor::getFailedDeliveryCount() const {
+  return this->failedDeliveryCount;
+}
+
+bool MessageDistributor::addRoute(
+    UserId destination, std::shared_ptr<MessageInterface> participant) {
+  std::lock_guard<std::mutex> lock(this->routingTableMutex);
+  auto actorIt = this->actors.find(participant.get());
+  if (actorIt == this->actors.end()) {
+    return false;
+  }
+  auto result = this->routingTable.try_emplace(destination.id(),
+                                               actorIt->second);
+  if (!result.second && result.first->second != actorIt->second) {
+    LOG(WARNING) << "Message distributor already routes " << destination.id()
+                 << " to participant "
+                 << result.first->second->participant->getUserId().id()
+                 << ". Keeping the route.";
+    return false;
+  }
+
+  return true;
+}
+
+bool MessageDistributor::removeRoute(UserId destination,
+                                     MessageInterface *participant) {
+  std::lock_guard<std::mutex> lock(this->routingTableMutex);
+  auto it = this->routingTable.find(destination.id());
+  if (it == this->routingTable.end() ||
+      it->second->participant.get() != participant) {
+    return false;
+  }
+  this->routingTable.erase(it);
+
+  return true;
+}
+
+std::shared_ptr<ParticipantActor>
+MessageDistributor::findRoute(UserId destination) {
+  std::lock_guard<std::mutex> lock(this->routingTableMutex);
+  auto it = this->routingTable.find(destination.id());
+  if (it == this->routingTable.end()) {
+    return std::shared_ptr<ParticipantActor>();
+  }
+
+  return it->second;
+}
+
+void MessageDistributor::deliverMessage(
+    std::shared_ptr<DeviceMessage> message) {
+  // Find the target participant.
+  std::shared_ptr<ParticipantActor> target =
+      this->findRoute(message->getDestination());
+
+  if (!target) {
+    // Destination does not exist. Log this and add a failed response message
+    // to the cache.
+    this->misroutedMessageCount++;
+    LOG(WARNING) << "Message from " << message->getSource().id()
+                 << " could not be delivered. Destination does not exist.";
+    this->failedResponseCache.push(Utilities::makePooled<ReadDeviceMessage>(
+        message->getDestination(), message->getSource(),
+        ReadDeviceTopic::READ_TOPIC_FAILED_RESPONSE,
+        std::shared_ptr<ReadPayload>(), std::shared_ptr<WriteDeviceMessage>()));
+    return;
+  }
+
+  if (!this->workerPool) {
+    // Destination found. Let the object take the message.
+    this->processMessage(target->participant, message);
+    return;
+  }
+
+  // Let the actor of the destination take the message.
+  if (!target->mailbox.push(message)) {
+    this->failedDeliveryCount++;
+    LOG(WARNING) << "Message to " << message->getDestination().id()
+                 << " could not be delivered. It is queued already.";
+    return;
+  }
+  this->scheduleActor(target);
+}
+
+void MessageDistributor::processMessage(
+    const std::shared_ptr<MessageInterface> &participant,
+    std::shared_ptr<DeviceMessage> message) {
+  bool processSuccess = participant->takeMessage(message);
+
+  if (!processSuccess) {
+    this->failedDeliveryCount++;
+    LOG(WARNING) << "Targeted participant  " << message->getDestination().id()
+                 << " was not able to process the message.";
+  }
+}
+
+void MessageDistributor::scheduleActor(
+    const std::shared_ptr<ParticipantActor> &actor) {
+  if (actor->scheduled.exchange(true, std::memory_order_acq_rel)) {
+    // The running task takes care of the new work.
+    return;
+  }
+  this->workerPool->submit([this, actor]() { this->runActor(actor); });
+}
+
+void MessageDistributor::runActor(std::shared_ptr<ParticipantActor> actor) {
+  // The future of the task is dropped, so exceptions of the participant are
+  // caught here. Otherwise, the actor would stay scheduled for good and its
+  // mailbox would never be drained again.
+  std::list<std::shared_ptr<DeviceMessage>> messages;
+  actor->mailbox.drain(messages);
+  for (auto &message : messages) {
+    try {
+      this->processMessage(actor->participant, message);
+    } catch (const std::exception &e) {
+      this->failedDeliveryCount++;
+      LOG(ERROR) << "Participant " << actor->participant->getUserId().id()
+                 << " threw while taking a message: " << e.what();
+    } catch (...) {
+      this->failedDeliveryCount++;
+      LOG(ERROR) << "Participant " << actor->participant->getUserId().id()
+                 << " threw while taking a message.";
+    }
+  }
+
+  if (actor->readPending.exchange(false)) {
+    std::list<std::shared_ptr<DeviceMessage>> readMessages;
+    try {
+      readMessages = actor->participant->read(Core::getNow());
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "Participant " << actor->participant->getUserId().id()
+                 << " threw while being read: " << e.what();
+    } catch (...) {
+      LOG(ERROR) << "Participant " << actor->participant->getUserId().id()
+                 << " threw while being read.";
+    }
+
+    // The messages of a participant are delivered by one task at a time, so
+    // their order within a priority class is kept at the destination.
+    for (auto &message : readMessages) {
+      this->deliverMessage(message);
+    }
+  }
+
+  // Work, that has been added since the checks above, did not queue another
+  // task, as this one was still scheduled. The exchange synchronizes with the
+  // one in scheduleActor(), so that work is visible here.
+  actor->scheduled.exchange(false, std::memory_order_acq_rel);
+  if (!actor->mailbox.empty() || actor->readPending) {
+    this->scheduleActor(actor);
+  }
+}
+
 } // namespace Messages
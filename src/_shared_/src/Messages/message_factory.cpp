@@ -1,4 +1,5 @@
 // Standard includes
+#include <cstring>
 #include <list>
 #include <sstream>
 
@@ -9,6 +10,7 @@
 #include <init_device_message.hpp>
 #include <is_payload.hpp>
 #include <message_factory.hpp>
+#include <message_visitor.hpp>
 #include <read_device_message.hpp>
 #include <utilities.hpp>
 #include <utilities_flatbuffers.hpp>
@@ -23,323 +25,376 @@
 
 namespace Messages {
 
+namespace {
+
+/// The builder for the messages of the current thread.
+thread_local std::unique_ptr<flatbuffers::FlatBufferBuilder> messageBuilder;
+/// The builder for the payloads of the current thread.
+thread_local std::unique_ptr<flatbuffers::FlatBufferBuilder> payloadBuilder;
+
+/**
+ * @brief Returns the given builder of the current thread in a cleared state.
+ * The builders keep their memory, so encoding does not allocate, once they
+ * have grown to the size of the largest message.
+ * @param builder The builder of the current thread.
+ * @return The builder.
+ */
+flatbuffers::FlatBufferBuilder &
+getBuilder(std::unique_ptr<flatbuffers::FlatBufferBuilder> &builder) {
+  if (!builder) {
+    builder = std::make_unique<flatbuffers::FlatBufferBuilder>(
+        MESSAGE_FACTORY_INITIAL_BUILDER_SIZE);
+  }
+  builder->Clear();
+  return *builder;
+}
+
+/**
+ * @brief Serializes a payload and stores it as byte vector in the builder of
+ * the message.
+ * @param builder The builder of the message.
+ * @param payload The payload.
+ * @param payloadRegistry The registry of the payload encoders. Payloads without
+ * a registered encoder encode themselves.
+ * @return The offset of the byte vector.
+ */
+flatbuffers::Offset<flatbuffers::Vector<uint8_t>>
+encodePayload(flatbuffers::FlatBufferBuilder &builder, Payload &payload,
+              const PayloadRegistry &payloadRegistry) {
+  flatbuffers::FlatBufferBuilder &nestedBuilder = getBuilder(payloadBuilder);
+  const PayloadEncoder *payloadEncoder =
+      payloadRegistry.getEncoder(payload.getMagicNumber());
+  std::vector<unsigned char> bytes;
+  std::span<const unsigned char> payloadBytes;
+  if ((payloadEncoder && (*payloadEncoder)(payload, nestedBuilder)) ||
+      (!payloadEncoder && payload.encode(nestedBuilder))) {
+    payloadBytes = std::span<const unsigned char>(
+        nestedBuilder.GetBufferPointer(), nestedBuilder.GetSize());
+  } else {
+    bytes = payload.bytes();
+    payloadBytes = bytes;
+  }
+
+  // Align the nested flatbuffer like a buffer of its own, so its fields can
+  // be read in place after decoding.
+  builder.ForceVectorAlignment(payloadBytes.size(), sizeof(uint8_t),
+                               MESSAGE_FACTORY_PAYLOAD_ALIGNMENT);
+  return builder.CreateVector(payloadBytes.data(), payloadBytes.size());
+}
+} // namespace
+
 MessageFactory *MessageFactory::instance = nullptr;
 
 MessageFactory::MessageFactory(
-    std::list<std::shared_ptr<PayloadDecoder>> payloadDecoders)
-    : payloadDecoders(payloadDecoders) {
-  this->payloadDecoders.push_back(
+    std::list<std::shared_ptr<PayloadDecoder>> payloadDecoders) {
+  // The given decoders are registered first, so they take precedence over the
+  // builtin one.
+  for (auto &payloadDecoder : payloadDecoders) {
+    this->payloadRegistry.registerDecoder(payloadDecoder);
+  }
+  this->payloadRegistry.registerDecoder(
       std::shared_ptr<PayloadDecoder>(new BuiltinPayloadDecoder()));
 }
 
 std::shared_ptr<DeviceMessage>
 MessageFactory::decodeMessage(std::vector<unsigned char> &buffer) {
+  size_t frameStart = 0;
+  size_t frameSize = 0;
+  if (FRAME_SCAN_RESULT_FOUND !=
+      FrameDecoder::scanFrame(buffer, frameStart, frameSize)) {
+    // No frame has been found. Drop the bytes, that can not start a frame.
+    buffer.erase(buffer.begin(), buffer.begin() + frameStart);
+    return std::shared_ptr<DeviceMessage>();
+  }
 
-  // Transform the vector to a std::list.
-  std::list<unsigned char> bufferList(buffer.begin(), buffer.end());
+  // A frame has been found. Decode it and remove it from the buffer, together
+  // with the bytes in front of it.
+  std::shared_ptr<DeviceMessage> msg = this->decodeFrame(
+      std::span<const unsigned char>(buffer.data() + frameStart, frameSize));
+  buffer.erase(buffer.begin(), buffer.begin() + frameStart + frameSize);
 
-  // Try to extract a frame.
-  std::vector<unsigned char> *frame = this->extractFrame(bufferList);
+  return msg;
+}
 
-  // Has a frame been extracted?
-  if (frame == nullptr) {
-    // No frame has been extracted. Return nullptr.
-    return std::shared_ptr<DeviceMessage>();
+std::shared_ptr<DeviceMessage>
+MessageFactory::decodeMessage(FrameDecoder &frameDecoder) {
+  std::span<const unsigned char> frame;
+  while (frameDecoder.extractFrame(frame)) {
+    std::shared_ptr<DeviceMessage> msg = this->decodeFrame(frame);
+    if (msg) {
+      return msg;
+    }
+    LOG(WARNING) << "Message factory skipped a frame, that could not be "
+                    "decoded.";
   }
 
-  // A frame has been extracted. Remove the frame from the original buffer.
-  buffer.erase(buffer.begin(), buffer.begin() + frame->size());
+  return std::shared_ptr<DeviceMessage>();
+}
+
+size_t MessageFactory::decodeMessages(
+    FrameDecoder &frameDecoder,
+    std::vector<std::shared_ptr<DeviceMessage>> &messages) {
+  messages.clear();
+  std::shared_ptr<DeviceMessage> msg;
+  while ((msg = this->decodeMessage(frameDecoder))) {
+    messages.push_back(msg);
+  }
 
-  MessageType msgTypeHint;
-  return this->decodeFrame(frame, msgTypeHint);
+  return messages.size();
 }
 
 std::vector<unsigned char>
 MessageFactory::encodeMessage(std::shared_ptr<DeviceMessage> msg) {
-  Serialization::Messages::DeviceMessageT intermediateObject;
+  std::vector<unsigned char> frame;
+  this->encodeMessage(msg, frame);
+  return frame;
+}
 
-  intermediateObject.sourceId = msg->getSource().id();
-  intermediateObject.desinationId = msg->getDestination().id();
-  intermediateObject.msgId = msg->getMessageId();
+bool MessageFactory::encodeMessage(std::shared_ptr<DeviceMessage> msg,
+                                   std::vector<unsigned char> &frame) {
+  frame.clear();
+  if (!msg) {
+    LOG(ERROR) << "Message factory was presented an Unsupported message type.";
+    return false;
+  }
+  flatbuffers::FlatBufferBuilder &builder = getBuilder(messageBuilder);
 
-  // Cast down the message and encode the more specific parts.
+  // Encode the more specific parts of the message. The children of a table
+  // have to be created before the table is started.
   MessageType messageType;
-  // --------------------------------------------------- Write device message --
-  auto writeMsg = dynamic_pointer_cast<WriteDeviceMessage>(msg);
-  if (writeMsg) {
-    messageType = MessageType::WRITE_DEVICE_MESSAGE;
-    Serialization::Messages::WriteDeviceMessageContentT
-        writeDeviceMessageContent;
-    writeDeviceMessageContent.writeDeviceTopic =
-        static_cast<Serialization::Messages::WriteDeviceTopic>(
-            writeMsg->getTopic());
-    if (writeMsg->getPayload()) {
-      writeDeviceMessageContent.magicNumber =
-          writeMsg->getPayload()->getMagicNumber();
-      writeDeviceMessageContent.payload = writeMsg->getPayload()->bytes();
-    }
-
-    intermediateObject.content.Set(writeDeviceMessageContent);
-  } else {
-
-    // ---------------------------------------------------- Handshake message --
-    auto handshakeMsg = dynamic_pointer_cast<HandshakeMessage>(msg);
-    if (handshakeMsg) {
-      messageType = MessageType::HANDSHAKE_MESSAGE;
-
-      Serialization::Messages::HandshakeMessageContentT handshakeMessageContent;
-      handshakeMessageContent.version = this->getVersion();
-      for (auto statusPayload : handshakeMsg->getPayload()) {
-        Serialization::Devices::StatusPayloadT *intermediatePayload =
-            new Serialization::Devices::StatusPayloadT();
-        intermediatePayload->deviceId = statusPayload->getDeviceId().id();
-        intermediatePayload->deviceStatus =
-            static_cast<Serialization::Devices::DeviceStatus>(
-                statusPayload->getDeviceStatus());
-        intermediatePayload->deviceType =
-            static_cast<Serialization::Devices::DeviceType>(
-                statusPayload->getDeviceType());
-        intermediatePayload->deviceName = statusPayload->getDeviceName();
-        for (auto proxyId : statusPayload->getProxyIds()) {
-          intermediatePayload->proxyIds.push_back(proxyId.id());
-        }
-        handshakeMessageContent.statusPayloads.emplace_back(
-            std::unique_ptr<Serialization::Devices::StatusPayloadT>(
-                intermediatePayload));
-      }
-      intermediateObject.content.Set(handshakeMessageContent);
-    } else {
-
-      // ------------------------------------------------ Read device message --
-      auto readMsg = dynamic_pointer_cast<ReadDeviceMessage>(msg);
-      if (readMsg) {
-        messageType = MessageType::READ_DEVICE_MESSAGE;
-        Serialization::Messages::ReadDeviceMessageContentT
-            readDeviceMessageContent;
-        readDeviceMessageContent.readDeviceTopic =
-            static_cast<Serialization::Messages::ReadDeviceTopic>(
-                readMsg->getTopic());
-        readDeviceMessageContent.magicNumber =
-            readMsg->getReadPaylod()->getMagicNumber();
-        readDeviceMessageContent.readPayload =
-            readMsg->getReadPaylod()->bytes();
-        intermediateObject.content.Set(readDeviceMessageContent);
-      }
-
-      else {
-        // ---------------------------------------------- Init device message --
-        messageType = MessageType::INIT_DEVICE_MESSAGE;
-        auto initMsg = dynamic_pointer_cast<InitDeviceMessage>(msg);
-        if (initMsg) {
-          Serialization::Messages::InitDeviceMessageContentT
-              initDeviceMessageContent;
-          initDeviceMessageContent.initPayoad =
-              initMsg->returnPayload()->bytes();
-          initDeviceMessageContent.magicNumber =
-              initMsg->returnPayload()->getMagicNumber();
-          intermediateObject.content.Set(initDeviceMessageContent);
-        }
+  Serialization::Messages::Content contentType;
+  flatbuffers::Offset<void> content;
+  visitMessage(
+      msg,
+      MessageVisitor{
+          // ------------------------------------------- Write device message --
+          [&](std::shared_ptr<WriteDeviceMessage> writeMsg) {
+            messageType = MessageType::WRITE_DEVICE_MESSAGE;
+            contentType =
+                Serialization::Messages::Content_WriteDeviceMessageContent;
+            flatbuffers::Offset<flatbuffers::Vector<uint8_t>> payload;
+            if (writeMsg->getPayload()) {
+              payload = encodePayload(builder, *writeMsg->getPayload(),
+                                      this->payloadRegistry);
+            }
+            Serialization::Messages::WriteDeviceMessageContentBuilder
+                contentBuilder(builder);
+            contentBuilder.add_writeDeviceTopic(
+                static_cast<Serialization::Messages::WriteDeviceTopic>(
+                    writeMsg->getTopic()));
+            if (writeMsg->getPayload()) {
+              contentBuilder.add_magicNumber(
+                  writeMsg->getPayload()->getMagicNumber());
+              contentBuilder.add_payload(payload);
+            }
+            content = contentBuilder.Finish().Union();
+          },
+
+          // ---------------------------------------------- Handshake message --
+          [&](std::shared_ptr<HandshakeMessage> handshakeMsg) {
+            messageType = MessageType::HANDSHAKE_MESSAGE;
+            contentType =
+                Serialization::Messages::Content_HandshakeMessageContent;
+            std::vector<
+                flatbuffers::Offset<Serialization::Devices::StatusPayload>>
+                statusPayloadOffsets;
+            for (auto statusPayload : handshakeMsg->getPayload()) {
+              std::vector<uint64_t> proxyIds;
+              for (auto proxyId : statusPayload->getProxyIds()) {
+                proxyIds.push_back(proxyId.id());
+              }
+              auto proxyIdsOffset = builder.CreateVector(proxyIds);
+              auto deviceName =
+                  builder.CreateString(statusPayload->getDeviceName());
+              Serialization::Devices::StatusPayloadBuilder
+                  statusPayloadBuilder(builder);
+              statusPayloadBuilder.add_deviceId(
+                  statusPayload->getDeviceId().id());
+              statusPayloadBuilder.add_deviceStatus(
+                  static_cast<Serialization::Devices::DeviceStatus>(
+                      statusPayload->getDeviceStatus()));
+              statusPayloadBuilder.add_deviceType(
+                  static_cast<Serialization::Devices::DeviceType>(
+                      statusPayload->getDeviceType()));
+              statusPayloadBuilder.add_deviceName(deviceName);
+              statusPayloadBuilder.add_proxyIds(proxyIdsOffset);
+              statusPayloadOffsets.push_back(statusPayloadBuilder.Finish());
+            }
+            auto statusPayloads = builder.CreateVector(statusPayloadOffsets);
+            auto version = builder.CreateString(this->getVersion());
+            Serialization::Messages::HandshakeMessageContentBuilder
+                contentBuilder(builder);
+            contentBuilder.add_statusPayloads(statusPayloads);
+            contentBuilder.add_version(version);
+            content = contentBuilder.Finish().Union();
+          },
+
+          // -------------------------------------------- Read device message --
+          [&](std::shared_ptr<ReadDeviceMessage> readMsg) {
+            messageType = MessageType::READ_DEVICE_MESSAGE;
+            contentType =
+                Serialization::Messages::Content_ReadDeviceMessageContent;
+            auto payload = encodePayload(builder, *readMsg->getReadPaylod(),
+                                         this->payloadRegistry);
+            Serialization::Messages::ReadDeviceMessageContentBuilder
+                contentBuilder(builder);
+            contentBuilder.add_readDeviceTopic(
+                static_cast<Serialization::Messages::ReadDeviceTopic>(
+                    readMsg->getTopic()));
+            contentBuilder.add_magicNumber(
+                readMsg->getReadPaylod()->getMagicNumber());
+            contentBuilder.add_readPayload(payload);
+            content = contentBuilder.Finish().Union();
+          },
+
+          // -------------------------------------------- Init device message --
+          [&](std::shared_ptr<InitDeviceMessage> initMsg) {
+            messageType = MessageType::INIT_DEVICE_MESSAGE;
+            contentType =
+                Serialization::Messages::Content_InitDeviceMessageContent;
+            auto payload = encodePayload(builder, *initMsg->returnPayload(),
+                                         this->payloadRegistry);
+            Serialization::Messages::InitDeviceMessageContentBuilder
+                contentBuilder(builder);
+            contentBuilder.add_magicNumber(
+                initMsg->returnPayload()->getMagicNumber());
+            contentBuilder.add_initPayoad(payload);
+            content = contentBuilder.Finish().Union();
+          },
 
-        else {
           // ------------------------------------------ Config device message --
-          messageType = MessageType::CONFIG_DEVICE_MESSAGE;
-          auto configMsg = dynamic_pointer_cast<ConfigDeviceMessage>(msg);
-          if (configMsg) {
-            Serialization::Messages::ConfigDeviceMessageContentT
-                configDeviceMessageContent;
+          [&](std::shared_ptr<ConfigDeviceMessage> configMsg) {
+            messageType = MessageType::CONFIG_DEVICE_MESSAGE;
+            contentType =
+                Serialization::Messages::Content_ConfigDeviceMessageContent;
+            std::shared_ptr<ConfigurationPayload> configuration =
+                configMsg->getConfiguration();
+            auto payload =
+                encodePayload(builder, *configuration, this->payloadRegistry);
             std::vector<uint64_t> responseIdsUint;
             for (auto &userId : configMsg->getResponseIds()) {
               responseIdsUint.push_back(userId.id());
             }
-            configDeviceMessageContent.responseIds = responseIdsUint;
-            configDeviceMessageContent.configurationPayload =
-                configMsg->getConfiguration()->bytes();
-            configDeviceMessageContent.magicNumber =
-                configMsg->getConfiguration()->getMagicNumber();
-            // Parse the key mapping.
-            configDeviceMessageContent.keyMapping.reserve(
-                configMsg->getConfiguration()->getKeyMapping().size());
-            for (auto &keyValuePair :
-                 configMsg->getConfiguration()->getKeyMapping()) {
-              Serialization::Messages::KeyMappingEntryT *entry =
-                  new Serialization::Messages::KeyMappingEntryT();
-              entry->keys = keyValuePair.first;
-              entry->dataTypes =
-                  static_cast<Serialization::Messages::DataManagerDataType>(
-                      keyValuePair.second);
-              configDeviceMessageContent.keyMapping.emplace_back(
-                  std::unique_ptr<Serialization::Messages::KeyMappingEntryT>(
-                      entry));
+            auto responseIds = builder.CreateVector(responseIdsUint);
+            // Encode the key mapping.
+            std::vector<
+                flatbuffers::Offset<Serialization::Messages::KeyMappingEntry>>
+                keyMappingEntries;
+            for (auto &keyValuePair : configuration->getKeyMapping()) {
+              auto key = builder.CreateString(keyValuePair.first);
+              keyMappingEntries.push_back(
+                  Serialization::Messages::CreateKeyMappingEntry(
+                      builder, key,
+                      static_cast<Serialization::Messages::DataManagerDataType>(
+                          keyValuePair.second)));
             }
-            // Parse the spectrum mapping.
-            configDeviceMessageContent.spectrumMapping.reserve(
-                configMsg->getConfiguration()->getSpectrumMapping().size());
-            for (auto &keyValuePair :
-                 configMsg->getConfiguration()->getSpectrumMapping()) {
-              Serialization::Messages::SpectrumMappingEntryT *entry =
-                  new Serialization::Messages::SpectrumMappingEntryT();
-              entry->key = keyValuePair.first;
-              entry->frequencies = keyValuePair.second;
-              configDeviceMessageContent.spectrumMapping.emplace_back(
-                  std::unique_ptr<
-                      Serialization::Messages::SpectrumMappingEntryT>(entry));
+            auto keyMapping = builder.CreateVector(keyMappingEntries);
+            // Encode the spectrum mapping.
+            std::vector<flatbuffers::Offset<
+                Serialization::Messages::SpectrumMappingEntry>>
+                spectrumMappingEntries;
+            for (auto &keyValuePair : configuration->getSpectrumMapping()) {
+              auto key = builder.CreateString(keyValuePair.first);
+              auto frequencies = builder.CreateVector(keyValuePair.second);
+              spectrumMappingEntries.push_back(
+                  Serialization::Messages::CreateSpectrumMappingEntry(
+                      builder, key, frequencies));
             }
-
-            intermediateObject.content.Set(configDeviceMessageContent);
-
-          } else {
-            LOG(ERROR) << "Message factory was presented an Unsupported "
-                          "message type.";
-            return std::vector<unsigned char>();
-          }
-        }
-      }
-    }
+            auto spectrumMapping = builder.CreateVector(spectrumMappingEntries);
+
+            Serialization::Messages::ConfigDeviceMessageContentBuilder
+                contentBuilder(builder);
+            contentBuilder.add_magicNumber(configuration->getMagicNumber());
+            contentBuilder.add_responseIds(responseIds);
+            contentBuilder.add_keyMapping(keyMapping);
+            contentBuilder.add_spectrumMapping(spectrumMapping);
+            contentBuilder.add_configurationPayload(payload);
+            content = contentBuilder.Finish().Union();
+          }});
+
+  Serialization::Messages::DeviceMessageBuilder deviceMessageBuilder(builder);
+  deviceMessageBuilder.add_sourceId(msg->getSource().id());
+  deviceMessageBuilder.add_desinationId(msg->getDestination().id());
+  deviceMessageBuilder.add_msgId(msg->getMessageId());
+  deviceMessageBuilder.add_content_type(contentType);
+  deviceMessageBuilder.add_content(content);
+  builder.Finish(deviceMessageBuilder.Finish());
+
+  // Wrap the buffer with the message type and four length bytes. The frame is
+  // sized once, so it is written with a single copy.
+  uint32_t msgLen = builder.GetSize();
+  frame.resize(msgLen + FRAME_DECODER_FRAME_OVERHEAD);
+  frame[0] = messageType;
+  for (int i = 0; i < 4; i++) {
+    frame[1 + i] = (msgLen >> (8 * i)) & 0xFF;
   }
+  std::memcpy(frame.data() + 5, builder.GetBufferPointer(), msgLen);
+  frame.back() = messageType;
 
-  // Serialize the intermediate object.
-  flatbuffers::FlatBufferBuilder builder;
-  builder.Finish(Serialization::Messages::DeviceMessage::Pack(
-      builder, &intermediateObject));
-  uint8_t *buffer = builder.GetBufferPointer();
-
-  // Wrap the buffer with four length bytes and the message type.
-  unsigned int msgLen = builder.GetSize();
-  std::vector<unsigned char> bufferVect = std::vector<unsigned char>(
-      (const unsigned char *)buffer,
-      (const unsigned char *)buffer + builder.GetSize());
-  bufferVect.insert(bufferVect.begin(), (msgLen & 0xFF000000) >> 24);
-  bufferVect.insert(bufferVect.begin(), (msgLen & 0x00FF0000) >> 16);
-  bufferVect.insert(bufferVect.begin(), (msgLen & 0x0000FF00) >> 8);
-  bufferVect.insert(bufferVect.begin(), (msgLen & 0x000000FF));
-  bufferVect.insert(bufferVect.begin(), messageType);
-  bufferVect.push_back(messageType);
-
-  return bufferVect;
-}
-
-bool MessageFactory::isMessageTypeTag(char byte) const {
-  return MessageType::WRITE_DEVICE_MESSAGE == byte ||
-         MessageType::READ_DEVICE_MESSAGE == byte ||
-         MessageType::HANDSHAKE_MESSAGE == byte ||
-         MessageType::INIT_DEVICE_MESSAGE == byte ||
-         MessageType::CONFIG_DEVICE_MESSAGE == byte;
-}
-
-std::vector<unsigned char> *
-MessageFactory::extractFrame(std::list<unsigned char> &buffer) {
-  while (true) {
-    // Search for the next message type tag.
-    unsigned char msgTypeTag = 0x00;
-    bool msgTypeTagFound = false;
-    while (buffer.size() > 0 && !msgTypeTagFound) {
-      if (this->isMessageTypeTag((buffer.front()))) {
-        msgTypeTag = buffer.front();
-        msgTypeTagFound = true;
-      } else {
-        buffer.pop_front();
-      }
-    }
-    if (!msgTypeTagFound) {
-      return nullptr;
-    }
-
-    // The smallest possible message is 6 bytes in length. If the buffer is
-    // smaller than that, no message will ever be decodable.
-    if (buffer.size() < 6) {
-      return nullptr;
-    }
-
-    // Opening message type tag detected. The next four bytes should contain
-    // the length of the frame. Look ahead and find the closing message type
-    // tag.
-    auto bufferIt = buffer.begin();
-    unsigned int len = *(++bufferIt) + (*(++bufferIt) << 8) +
-                       (*(++bufferIt) << 16) + (*(++bufferIt) << 24);
-    if (len > (buffer.size() - 6)) {
-      // Buffer ends prematurely. It might be the case that the closing
-      // command tag has not been received yet. Return here and wait until
-      // more bytes have been received.
-      return nullptr;
-    }
-    std::advance(bufferIt, len + 1);
-    if (*bufferIt != msgTypeTag) {
-      // Closing message typte tag not found. The opening message type tag did
-      // not start a frame. Remove it from the buffer and start interpretation
-      // again.
-      buffer.pop_front();
-    } else {
-      // Found closing command tag. Remove the frame from the buffer and
-      // return.
-      std::vector<unsigned char> *extractedFrame =
-          new std::vector<unsigned char>(buffer.begin(), ++bufferIt);
-      buffer.erase(buffer.begin(), bufferIt);
-      return extractedFrame;
-    }
-  }
+  return true;
 }
 
 std::shared_ptr<DeviceMessage>
-MessageFactory::decodeFrame(std::vector<unsigned char> *buffer,
-                            MessageType &msgTypeHint) {
-  auto bufferIt = buffer->begin();
-
+MessageFactory::decodeFrame(std::span<const unsigned char> frame) {
   // Get the message type from the first byte.
-  MessageType messageType = static_cast<MessageType>(*bufferIt);
-
-  // Get the frame length from the next two bytes.
-  short msgLen = *(++bufferIt) + (*(++bufferIt) << 8) + (*(++bufferIt) << 16) +
-                 (*(++bufferIt) << 24);
-
-  // Create a new vector that only contains the flatbuffer payload. flatbuffer
-  // will take ownership of this pointer.
-  std::vector<unsigned char> *flatbufferPayload =
-      new std::vector<unsigned char>(++bufferIt, buffer->end() - 1);
+  MessageType messageType = static_cast<MessageType>(frame.front());
+
+  // Copy the flatbuffer out of the frame once. The frame is only valid until
+  // more bytes are received, whereas the payloads may keep views into the
+  // copy. The copy is also suitably aligned for the flatbuffer.
+  std::shared_ptr<const std::vector<unsigned char>> storage =
+      std::make_shared<const std::vector<unsigned char>>(frame.begin() + 5,
+                                                         frame.end() - 1);
+
+  // Verify the buffer, before any of its fields is read. Afterwards, the
+  // fields are read in place.
+  flatbuffers::Verifier verifier(storage->data(), storage->size());
+  if (!Serialization::Messages::VerifyDeviceMessageBuffer(verifier)) {
+    LOG(WARNING) << "Message factory received a malformed message.";
+    return std::shared_ptr<DeviceMessage>();
+  }
+  const Serialization::Messages::DeviceMessage *deviceMsg =
+      Serialization::Messages::GetDeviceMessage(storage->data());
+  UserId sourceId(static_cast<size_t>(deviceMsg->sourceId()));
+  UserId destinationId(static_cast<size_t>(deviceMsg->desinationId()));
+  PayloadBuffer buffer(storage, *storage);
 
-  // Decode the payload according to the message type.
-  const Serialization::Messages::DeviceMessageT *deviceMsg =
-      Serialization::Messages::GetDeviceMessage(flatbufferPayload->data())
-          ->UnPack();
   // ------------------------------------------------------ Handshake message --
-  if (MessageType::HANDSHAKE_MESSAGE == messageType) {
+  if (MessageType::HANDSHAKE_MESSAGE == messageType &&
+      deviceMsg->content_as_HandshakeMessageContent()) {
     return this->translateMessageContent(
-        UserId(static_cast<size_t>(deviceMsg->sourceId)),
-        UserId(static_cast<size_t>(deviceMsg->desinationId)),
-        deviceMsg->content.AsHandshakeMessageContent());
+        sourceId, destinationId,
+        deviceMsg->content_as_HandshakeMessageContent());
   }
   // --------------------------------------------------- Write device message --
-  else if (MessageType::WRITE_DEVICE_MESSAGE == messageType) {
+  else if (MessageType::WRITE_DEVICE_MESSAGE == messageType &&
+           deviceMsg->content_as_WriteDeviceMessageContent()) {
     return this->translateMessageContent(
-        UserId(static_cast<size_t>(deviceMsg->sourceId)),
-        UserId(static_cast<size_t>(deviceMsg->desinationId)),
-        deviceMsg->content.AsWriteDeviceMessageContent(),
-        deviceMsg->content.AsWriteDeviceMessageContent()->magicNumber);
+        sourceId, destinationId,
+        deviceMsg->content_as_WriteDeviceMessageContent(), buffer);
   }
 
   // ---------------------------------------------------- Read Device message --
-  else if (MessageType::READ_DEVICE_MESSAGE == messageType) {
+  else if (MessageType::READ_DEVICE_MESSAGE == messageType &&
+           deviceMsg->content_as_ReadDeviceMessageContent()) {
     return this->translateMessageContent(
-        UserId(static_cast<size_t>(deviceMsg->sourceId)),
-        UserId(static_cast<size_t>(deviceMsg->desinationId)),
-        deviceMsg->content.AsReadDeviceMessageContent(),
-        deviceMsg->content.AsReadDeviceMessageContent()->magicNumber);
+        sourceId, destinationId,
+        deviceMsg->content_as_ReadDeviceMessageContent(), buffer);
   }
 
   // -------------------------------------------------- Config Device message --
-  else if (MessageType::CONFIG_DEVICE_MESSAGE == messageType) {
+  else if (MessageType::CONFIG_DEVICE_MESSAGE == messageType &&
+           deviceMsg->content_as_ConfigDeviceMessageContent()) {
     return this->translateMessageContent(
-        UserId(static_cast<size_t>(deviceMsg->sourceId)),
-        UserId(static_cast<size_t>(deviceMsg->desinationId)),
-        deviceMsg->content.AsConfigDeviceMessageContent(),
-        deviceMsg->content.AsConfigDeviceMessageContent()->magicNumber);
+        sourceId, destinationId,
+        deviceMsg->content_as_ConfigDeviceMessageContent(), buffer);
   }
   // ---------------------------------------------------- Init Device message --
-  else if (MessageType::INIT_DEVICE_MESSAGE == messageType) {
+  else if (MessageType::INIT_DEVICE_MESSAGE == messageType &&
+           deviceMsg->content_as_InitDeviceMessageContent()) {
     return this->translateMessageContent(
-        UserId(static_cast<size_t>(deviceMsg->sourceId)),
-        UserId(static_cast<size_t>(deviceMsg->desinationId)),
-        deviceMsg->content.AsInitDeviceMessageContent(),
-        deviceMsg->content.AsInitDeviceMessageContent()->magicNumber);
+        sourceId, destinationId,
+        deviceMsg->content_as_InitDeviceMessageContent(), buffer);
   }
 
   else {
@@ -349,74 +404,80 @@ MessageFactory::decodeFrame(std::vector<unsigned char> *buffer,
 
 std::shared_ptr<DeviceMessage> MessageFactory::translateMessageContent(
     UserId sourceId, UserId destinationId,
-    const Serialization::Messages::HandshakeMessageContentT *handshakeContent) {
+    const Serialization::Messages::HandshakeMessageContent *handshakeContent) {
 
   std::list<std::shared_ptr<StatusPayload>> statusPayloads;
-  for (int i = 0; i < handshakeContent->statusPayloads.size(); i++) {
-    std::list<UserId> proxyIds;
+  if (handshakeContent->statusPayloads()) {
+    for (auto statusPayload : *handshakeContent->statusPayloads()) {
+      std::list<UserId> proxyIds;
+      if (statusPayload->proxyIds()) {
+        for (auto proxyId : *statusPayload->proxyIds()) {
+          proxyIds.emplace_back(UserId(static_cast<size_t>(proxyId)));
+        }
+      }
 
-    for (auto proxyId : handshakeContent->statusPayloads[i]->proxyIds) {
-      proxyIds.emplace_back(UserId(static_cast<size_t>(proxyId)));
+      statusPayloads.emplace_back(Utilities::makePooled<StatusPayload>(
+          UserId(static_cast<size_t>(statusPayload->deviceId())),
+          static_cast<DeviceStatus>(statusPayload->deviceStatus()), proxyIds,
+          static_cast<DeviceType>(statusPayload->deviceType()),
+          flatbuffers::GetString(statusPayload->deviceName()),
+          std::shared_ptr<InitPayload>(),
+          std::shared_ptr<ConfigurationPayload>()));
     }
-
-    statusPayloads.emplace_back(
-        std::shared_ptr<StatusPayload>(new StatusPayload(
-            UserId(static_cast<size_t>(
-                handshakeContent->statusPayloads[i]->deviceId)),
-            static_cast<DeviceStatus>(
-                handshakeContent->statusPayloads[i]->deviceStatus),
-            proxyIds,
-            static_cast<DeviceType>(
-                handshakeContent->statusPayloads[i]->deviceType),
-            handshakeContent->statusPayloads[i]->deviceName,
-            std::shared_ptr<InitPayload>(),
-            std::shared_ptr<ConfigurationPayload>())));
   }
 
-  return std::shared_ptr<HandshakeMessage>(new HandshakeMessage(
-      sourceId, destinationId, statusPayloads, handshakeContent->version));
+  return Utilities::makePooled<HandshakeMessage>(
+      sourceId, destinationId, statusPayloads,
+      flatbuffers::GetString(handshakeContent->version()));
 }
 
 std::shared_ptr<DeviceMessage> MessageFactory::translateMessageContent(
     UserId sourceId, UserId destinationId,
-    const Serialization::Messages::WriteDeviceMessageContentT
+    const Serialization::Messages::WriteDeviceMessageContent
         *writeDeviceContent,
-    int magicNumber) {
+    const PayloadBuffer &buffer) {
 
-  WritePayload *decodedPayload = this->decodeWritePayload(
-      writeDeviceContent->payload, writeDeviceContent->magicNumber);
+  WritePayload *decodedPayload =
+      this->decodeWritePayload(buffer.slice(writeDeviceContent->payload()),
+                               writeDeviceContent->magicNumber());
 
-  return std::shared_ptr<WriteDeviceMessage>(new WriteDeviceMessage(
+  return Utilities::makePooled<WriteDeviceMessage>(
       sourceId, destinationId,
-      static_cast<WriteDeviceTopic>(writeDeviceContent->writeDeviceTopic),
-      decodedPayload));
+      static_cast<WriteDeviceTopic>(writeDeviceContent->writeDeviceTopic()),
+      decodedPayload);
 }
 
 std::shared_ptr<DeviceMessage> MessageFactory::translateMessageContent(
     UserId sourceId, UserId destinationId,
-    const Serialization::Messages::ReadDeviceMessageContentT *readDeviceContent,
-    int magicNumber) {
+    const Serialization::Messages::ReadDeviceMessageContent *readDeviceContent,
+    const PayloadBuffer &buffer) {
 
   // Try to parse the payload.
   ReadPayload *decodedPayload =
-      this->decodeReadPayload(readDeviceContent->readPayload, magicNumber);
+      this->decodeReadPayload(buffer.slice(readDeviceContent->readPayload()),
+                              readDeviceContent->magicNumber());
   if (!decodedPayload) {
     // Was not able to decode a read payload from the buffer.
     return std::shared_ptr<DeviceMessage>();
   }
 
-  return std::shared_ptr<ReadDeviceMessage>(new ReadDeviceMessage(
+  return Utilities::makePooled<ReadDeviceMessage>(
       sourceId, destinationId,
-      static_cast<ReadDeviceTopic>(readDeviceContent->readDeviceTopic),
-      decodedPayload, nullptr));
+      static_cast<ReadDeviceTopic>(readDeviceContent->readDeviceTopic()),
+      decodedPayload, nullptr);
 }
 
-ReadPayload *
-MessageFactory::decodeReadPayload(std::vector<unsigned char> payload,
-                                  int magicNumber) {
+ReadPayload *MessageFactory::decodeReadPayload(const PayloadBuffer &payload,
+                                               int magicNumber) {
+  PayloadDecoder *payloadDecoder =
+      this->payloadRegistry.getDecoder(magicNumber);
+  if (payloadDecoder) {
+    return payloadDecoder->decodeReadPayload(payload, magicNumber);
+  }
+
   ReadPayload *decodedPayload = nullptr;
-  for (auto payloadDecoder : this->payloadDecoders) {
-    decodedPayload = payloadDecoder->decodeReadPayload(payload, magicNumber);
+  for (auto &fallbackDecoder : this->payloadRegistry.getFallbackDecoders()) {
+    decodedPayload = fallbackDecoder->decodeReadPayload(payload, magicNumber);
     if (decodedPayload != nullptr) {
       break;
     }
@@ -425,13 +486,18 @@ MessageFactory::decodeReadPayload(std::vector<unsigned char> payload,
   return decodedPayload;
 }
 
-WritePayload *
-MessageFactory::decodeWritePayload(std::vector<unsigned char> payload,
-                                   int magicNumber) {
+WritePayload *MessageFactory::decodeWritePayload(const PayloadBuffer &payload,
+                                                 int magicNumber) {
+
+  PayloadDecoder *payloadDecoder =
+      this->payloadRegistry.getDecoder(magicNumber);
+  if (payloadDecoder) {
+    return payloadDecoder->decodeWritePayload(payload, magicNumber);
+  }
 
   WritePayload *decodedPayload = nullptr;
-  for (auto payloadDecoder : this->payloadDecoders) {
-    decodedPayload = payloadDecoder->decodeWritePayload(payload, magicNumber);
+  for (auto &fallbackDecoder : this->payloadRegistry.getFallbackDecoders()) {
+    decodedPayload = fallbackDecoder->decodeWritePayload(payload, magicNumber);
     if (decodedPayload != nullptr) {
       break;
     }
@@ -440,13 +506,18 @@ MessageFactory::decodeWritePayload(std::vector<unsigned char> payload,
   return decodedPayload;
 }
 
-InitPayload *
-MessageFactory::decodeInitPayload(std::vector<unsigned char> payload,
-                                  int magicNumber) {
+InitPayload *MessageFactory::decodeInitPayload(const PayloadBuffer &payload,
+                                               int magicNumber) {
+
+  PayloadDecoder *payloadDecoder =
+      this->payloadRegistry.getDecoder(magicNumber);
+  if (payloadDecoder) {
+    return payloadDecoder->decodeInitPayload(payload, magicNumber);
+  }
 
   InitPayload *decodedPayload = nullptr;
-  for (auto payloadDecoder : this->payloadDecoders) {
-    decodedPayload = payloadDecoder->decodeInitPayload(payload, magicNumber);
+  for (auto &fallbackDecoder : this->payloadRegistry.getFallbackDecoders()) {
+    decodedPayload = fallbackDecoder->decodeInitPayload(payload, magicNumber);
     if (decodedPayload != nullptr) {
       break;
     }
@@ -455,12 +526,18 @@ MessageFactory::decodeInitPayload(std::vector<unsigned char> payload,
   return decodedPayload;
 }
 ConfigurationPayload *
-MessageFactory::decodeConfigurationPayload(std::vector<unsigned char> payload,
+MessageFactory::decodeConfigurationPayload(const PayloadBuffer &payload,
                                            int magicNumber) {
 
+  PayloadDecoder *payloadDecoder =
+      this->payloadRegistry.getDecoder(magicNumber);
+  if (payloadDecoder) {
+    return payloadDecoder->decodeConfigPayload(payload, magicNumber);
+  }
+
   ConfigurationPayload *decodedPayload = nullptr;
-  for (auto payloadDecoder : this->payloadDecoders) {
-    decodedPayload = payloadDecoder->decodeConfigPayload(payload, magicNumber);
+  for (auto &fallbackDecoder : this->payloadRegistry.getFallbackDecoders()) {
+    decodedPayload = fallbackDecoder->decodeConfigPayload(payload, magicNumber);
     if (decodedPayload != nullptr) {
       break;
     }
@@ -471,31 +548,33 @@ MessageFactory::decodeConfigurationPayload(std::vector<unsigned char> payload,
 
 std::shared_ptr<DeviceMessage> MessageFactory::translateMessageContent(
     UserId sourceId, UserId destinationId,
-    const Serialization::Messages::InitDeviceMessageContentT *initDeviceContent,
-    int magicNumber) {
+    const Serialization::Messages::InitDeviceMessageContent *initDeviceContent,
+    const PayloadBuffer &buffer) {
 
   // Try to parse the payload.
   InitPayload *decodedPayload =
-      this->decodeInitPayload(initDeviceContent->initPayoad, magicNumber);
+      this->decodeInitPayload(buffer.slice(initDeviceContent->initPayoad()),
+                              initDeviceContent->magicNumber());
   if (!decodedPayload) {
     // Was not able to decode a read payload from the buffer.
     return std::shared_ptr<DeviceMessage>();
   }
 
-  return std::shared_ptr<InitDeviceMessage>(
-      new InitDeviceMessage(sourceId, destinationId, decodedPayload));
+  return Utilities::makePooled<InitDeviceMessage>(
+      sourceId, destinationId, decodedPayload);
 }
 
 std::shared_ptr<DeviceMessage> MessageFactory::translateMessageContent(
     UserId sourceId, UserId destinationId,
-    const Serialization::Messages::ConfigDeviceMessageContentT
+    const Serialization::Messages::ConfigDeviceMessageContent
         *configDeviceContent,
-    int magicNumber) {
+    const PayloadBuffer &buffer) {
 
   // Try to parse the payload ...
   // ...first, parse the specific parts ...
   ConfigurationPayload *decodedPayload = this->decodeConfigurationPayload(
-      configDeviceContent->configurationPayload, magicNumber);
+      buffer.slice(configDeviceContent->configurationPayload()),
+      configDeviceContent->magicNumber());
   if (!decodedPayload) {
     // Was not able to decode a read payload from the buffer.
     return std::shared_ptr<DeviceMessage>();
@@ -504,21 +583,23 @@ std::shared_ptr<DeviceMessage> MessageFactory::translateMessageContent(
   // ... now parse the more generic parts ...
   // The key mapping.
   KeyMapping keyMapping = Utilities::buildKeyMappingFromFlatbuffers(
-      configDeviceContent->keyMapping);
+      configDeviceContent->keyMapping());
   decodedPayload->setKeyMapping(keyMapping);
   // The spectrum mapping.
   SpectrumMapping spectrumMapping =
       Utilities::buildSpectrumMappingFromFlatbuffers(
-          configDeviceContent->spectrumMapping);
+          configDeviceContent->spectrumMapping());
   decodedPayload->setSpectrumMapping(spectrumMapping);
   // The response ids.
   std::vector<UserId> responseIds;
-  for (auto userIdInt : configDeviceContent->responseIds) {
-    responseIds.emplace_back(UserId(userIdInt));
+  if (configDeviceContent->responseIds()) {
+    for (auto userIdInt : *configDeviceContent->responseIds()) {
+      responseIds.emplace_back(UserId(userIdInt));
+    }
   }
 
-  return std::shared_ptr<DeviceMessage>(new ConfigDeviceMessage(
-      sourceId, destinationId, decodedPayload, responseIds));
+  return Utilities::makePooled<ConfigDeviceMessage>(
+      sourceId, destinationId, decodedPayload, responseIds);
 }
 
 MessageFactory *MessageFactory::createInstace(
@@ -535,6 +616,16 @@ MessageFactory *MessageFactory::getInstace() {
   return MessageFactory::instance;
 }
 
+bool MessageFactory::registerPayloadDecoder(
+    std::shared_ptr<PayloadDecoder> payloadDecoder) {
+  return this->payloadRegistry.registerDecoder(payloadDecoder);
+}
+
+bool MessageFactory::registerPayloadEncoder(int magicNumber,
+                                            PayloadEncoder payloadEncoder) {
+  return this->payloadRegistry.registerEncoder(magicNumber, payloadEncoder);
+}
+
 std::string MessageFactory::getVersion() const {
 #ifdef SCIMON_MESSAGE_LIB_VERSION
   return SCIMON_MESSAGE_LIB_VERSION;
@@ -5,9 +5,12 @@
 #include <easylogging++.h>
 
 // Project includes
+#include <data_manager_session.hpp>
 #include <data_response_payload.hpp>
 #include <key_response_payload.hpp>
+#include <message_distributor.hpp>
 #include <message_interface.hpp>
+#include <message_visitor.hpp>
 #include <request_data_payload.hpp>
 
 namespace Messages {
@@ -16,7 +19,11 @@ MessageInterface::MessageInterface(DeviceType deviceType,
                                    unsigned int dataManagerMeasurementLevel,
                                    DataManagerType dataManagerType)
     : id(UserId(this)), messageDistributor(nullptr),
-      dataManager(DataManager::getDataManager(dataManagerType)),
+      dataManager(DataManager::getDataManager(
+          dataManagerType == DataManagerType::DATAMANAGER_TYPE_HDF &&
+                  SessionStore::isOpen()
+              ? DataManagerType::DATAMANAGER_TYPE_SESSION
+              : dataManagerType)),
       deviceType(deviceType), deviceState(DeviceStatus::UNKNOWN_DEVICE_STATUS),
       dataManagerMeasurementLevel(dataManagerMeasurementLevel) {}
 
@@ -27,85 +34,82 @@ bool MessageInterface::operator==(MessageInterface &other) {
 }
 
 bool MessageInterface::takeMessage(std::shared_ptr<DeviceMessage> message) {
-  // Try to downcast the message.
-  // Is it an init message?
-  auto initDeviceMessage = dynamic_pointer_cast<InitDeviceMessage>(message);
-  if (initDeviceMessage) {
-    // ... it is. Trigger an init call.
-    return this->write(initDeviceMessage);
+  if (!message) {
+    LOG(WARNING) << "Encountered unknown message type. Message will be ignored";
+    return false;
   }
 
-  else {
-    // It is not an init message. Is it a config message?
-    auto configDeviceMessage =
-        dynamic_pointer_cast<ConfigDeviceMessage>(message);
-    if (configDeviceMessage) {
-      // ... it is. Trigger an config call.
-      return this->write(configDeviceMessage);
-    }
-
-    else {
-      // It is not an init and not a config message. Is it a write message?
-      auto writeDeviceMessage =
-          dynamic_pointer_cast<WriteDeviceMessage>(message);
-      if (writeDeviceMessage) {
-        // ... it is. Trigger an write call.
-        return this->write(writeDeviceMessage);
-      }
-
-      else {
-        // It is not an init message, not a config message and not a write
-        // message. Is it a response message?
-        auto readDeviceMessage =
-            dynamic_pointer_cast<ReadDeviceMessage>(message);
-        if (readDeviceMessage) {
-          // ... it is. Trigger an response call.
-          return this->handleResponse(readDeviceMessage);
-        } else {
-          // Unknown message type. Abort here.
-          LOG(WARNING)
-              << "Encountered unknown message type. Message will be ignored";
-          return false;
-        }
-      }
-    }
-  }
+  // Dispatch on the kind of the message.
+  return visitMessage(
+      message,
+      MessageVisitor{
+          // Trigger an init call.
+          [this](std::shared_ptr<InitDeviceMessage> initDeviceMessage) {
+            return this->write(initDeviceMessage);
+          },
+          // Trigger a config call.
+          [this](std::shared_ptr<ConfigDeviceMessage> configDeviceMessage) {
+            return this->write(configDeviceMessage);
+          },
+          // Trigger a write call.
+          [this](std::shared_ptr<WriteDeviceMessage> writeDeviceMessage) {
+            return this->write(writeDeviceMessage);
+          },
+          // Trigger a response call.
+          [this](std::shared_ptr<ReadDeviceMessage> readDeviceMessage) {
+            return this->handleResponse(readDeviceMessage);
+          },
+          // Handshakes are handled by the network workers only.
+          [](std::shared_ptr<HandshakeMessage> handshakeMessage) {
+            LOG(WARNING)
+                << "Encountered unknown message type. Message will be ignored";
+            return false;
+          }});
 }
 
 bool MessageInterface::addProxyId(UserId proxyId) {
-
-  if (this->proxyIds.empty()) {
-    // Always add the given id if the std::list is empty.
-    this->proxyIds.push_back(proxyId);
-    return true;
-  } else {
-    // If the std::list is not empty, check if the id is already in there.
-    auto it = std::find(this->proxyIds.begin(), this->proxyIds.end(), proxyId);
-
-    if (it == this->proxyIds.end()) {
-      this->proxyIds.push_back(proxyId);
-      return true;
-    } else {
+  {
+    std::lock_guard<std::mutex> lock(this->proxyIdsMutex);
+    // Check if the id is already in the std::list.
+    auto it =
+        std::find(this->proxyIds.begin(), this->proxyIds.end(), proxyId);
+    if (it != this->proxyIds.end()) {
       return false;
     }
+    this->proxyIds.push_back(proxyId);
+  }
+
+  // The route is changed without holding the lock, so it is never held
+  // together with the routing table lock of the message distributor.
+  // Let the message distributor route the messages for the id to this object.
+  if (this->messageDistributor) {
+    this->messageDistributor->addRoute(proxyId, this->self);
   }
+  return true;
 }
 
 bool MessageInterface::removeProxyId(UserId proxyId) {
-  auto it = std::find(this->proxyIds.begin(), this->proxyIds.end(), proxyId);
-
-  if (it != this->proxyIds.end()) {
+  {
+    std::lock_guard<std::mutex> lock(this->proxyIdsMutex);
+    auto it =
+        std::find(this->proxyIds.begin(), this->proxyIds.end(), proxyId);
+    if (it == this->proxyIds.end()) {
+      return false;
+    }
     this->proxyIds.erase(it);
-    return true;
-  } else {
-    return false;
   }
+
+  if (this->messageDistributor) {
+    this->messageDistributor->removeRoute(proxyId, this);
+  }
+  return true;
 }
 
 bool MessageInterface::isTarget(UserId id) {
   if (this->getUserId() == id) {
     return true;
   } else {
+    std::lock_guard<std::mutex> lock(this->proxyIdsMutex);
     auto it = find(this->proxyIds.begin(), this->proxyIds.end(), id);
     if (it == this->proxyIds.end()) {
       return false;
@@ -116,43 +120,66 @@ bool MessageInterface::isTarget(UserId id) {
 }
 
 std::list<UserId> MessageInterface::getProxyUserIds() const {
+  std::lock_guard<std::mutex> lock(this->proxyIdsMutex);
   return this->proxyIds;
 }
 
-void MessageInterface::clearProxyIds() { this->proxyIds.clear(); }
+void MessageInterface::clearProxyIds() {
+  std::list<UserId> removedIds;
+  {
+    std::lock_guard<std::mutex> lock(this->proxyIdsMutex);
+    removedIds.swap(this->proxyIds);
+  }
+
+  if (this->messageDistributor) {
+    for (auto &proxyId : removedIds) {
+      this->messageDistributor->removeRoute(proxyId, this);
+    }
+  }
+}
 
 bool MessageInterface::isExactTarget(UserId id) { return this->id == id; }
 
 void MessageInterface::pushMessageQueue(std::shared_ptr<DeviceMessage> msg) {
-  this->messageOutMutex.lock();
-  this->messageOut.push(msg);
-  this->messageOutMutex.unlock();
+  if (!this->messageOut.push(msg)) {
+    LOG(ERROR) << "Message interface can not queue a message, that is null or "
+                  "already queued.";
+    return;
+  }
+  this->notifyMessageDistributor();
 }
 
 void MessageInterface::pushMessageQueue(
     const std::vector<std::shared_ptr<DeviceMessage>> &msg) {
-  this->messageOutMutex.lock();
-  for (auto &singleMsg : msg) {
-    this->messageOut.push(singleMsg);
+  if (!this->messageOut.push(msg)) {
+    LOG(ERROR) << "Message interface can not queue messages, that are null or "
+                  "already queued.";
   }
-  this->messageOutMutex.unlock();
+  this->notifyMessageDistributor();
 }
 
-std::shared_ptr<DeviceMessage> MessageInterface::popMessageQueue() {
-  this->messageOutMutex.lock();
-  if (!messageQueueEmpty()) {
-    std::shared_ptr<DeviceMessage> msg = this->messageOut.front();
-    this->messageOut.pop();
-    this->messageOutMutex.unlock();
+void MessageInterface::notifyMessageDistributor() {
+  if (this->messageDistributor) {
+    this->messageDistributor->notify();
+  }
+}
 
-    return msg;
-  } else {
-    this->messageOutMutex.unlock();
+std::shared_ptr<DeviceMessage> MessageInterface::popMessageQueue() {
+  if (this->messageOutPending.empty()) {
+    this->messageOut.drain(this->messageOutPending);
+  }
+  if (this->messageOutPending.empty()) {
     return std::shared_ptr<DeviceMessage>();
   }
+  std::shared_ptr<DeviceMessage> msg = this->messageOutPending.front();
+  this->messageOutPending.pop_front();
+
+  return msg;
 }
 
-bool MessageInterface::messageQueueEmpty() { return this->messageOut.empty(); }
+bool MessageInterface::messageQueueEmpty() {
+  return this->messageOutPending.empty() && this->messageOut.empty();
+}
 
 DataManagerType MessageInterface::getDataManagerType() const {
   return this->dataManager->getDataManagerType();
@@ -214,26 +241,21 @@ bool MessageInterface::onConfigured(const KeyMapping &keyMapping,
 
 int MessageInterface::removeFromMessageQueue(
     const std::vector<UserId> &destinations) {
+  this->messageOut.drain(this->messageOutPending);
 
-  this->messageOutMutex.lock();
   size_t counter = 0;
-  std::queue<std::shared_ptr<DeviceMessage>> tempQueue;
-  while (!this->messageOut.empty()) {
-    auto msg = this->messageOut.front();
-    this->messageOut.pop();
-
-    auto it = std::find(destinations.begin(), destinations.end(),
-                        msg->getDestination());
+  for (auto it = this->messageOutPending.begin();
+       it != this->messageOutPending.end();) {
+    auto destinationIt = std::find(destinations.begin(), destinations.end(),
+                                   (*it)->getDestination());
 
-    if (it != destinations.end()) {
-      tempQueue.push(msg);
+    if (destinationIt != destinations.end()) {
+      it++;
     } else {
+      it = this->messageOutPending.erase(it);
       counter++;
     }
   }
-  this->messageOut.swap(tempQueue);
-
-  this->messageOutMutex.unlock();
 
   return counter;
 }
@@ -264,14 +286,15 @@ bool MessageInterface::write(std::shared_ptr<WriteDeviceMessage> writeMsg) {
 
   else if (WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE == writeMsg->getTopic()) {
     // Put the device state into the message queue.
-    this->pushMessageQueue(std::shared_ptr<DeviceMessage>(new ReadDeviceMessage(
+    this->pushMessageQueue(Utilities::makePooled<ReadDeviceMessage>(
         this->self->getUserId(), writeMsg->getSource(),
         READ_TOPIC_DEVICE_STATUS,
-        new StatusPayload(this->getUserId(), this->getDeviceStatus(),
-                          this->getProxyUserIds(), this->getDeviceType(),
-                          this->getDeviceTypeName(), this->initPayload,
-                          this->configPayload),
-        writeMsg)));
+        Utilities::makePooled<StatusPayload>(
+            this->getUserId(), this->getDeviceStatus(),
+            this->getProxyUserIds(), this->getDeviceType(),
+            this->getDeviceTypeName(), this->initPayload,
+            this->configPayload),
+        writeMsg));
     return true;
   }
 
@@ -309,10 +332,11 @@ bool MessageInterface::write(std::shared_ptr<WriteDeviceMessage> writeMsg) {
     std::vector<std::shared_ptr<DeviceMessage>> dataResponseMessages;
     dataResponseMessages.reserve(dataResponsePayloads.size());
     for (auto responsePayload : dataResponsePayloads) {
-      dataResponseMessages.emplace_back(std::shared_ptr<DeviceMessage>(
-          new ReadDeviceMessage(this->getUserId(), writeMsg->getSource(),
-                                ReadDeviceTopic::READ_TOPIC_DATA_RESPONSE,
-                                responsePayload, writeMsg)));
+      dataResponseMessages.emplace_back(
+          Utilities::makePooled<ReadDeviceMessage>(
+              this->getUserId(), writeMsg->getSource(),
+              ReadDeviceTopic::READ_TOPIC_DATA_RESPONSE, responsePayload,
+              writeMsg));
     }
     this->pushMessageQueue(dataResponseMessages);
 
@@ -326,10 +350,11 @@ bool MessageInterface::write(std::shared_ptr<WriteDeviceMessage> writeMsg) {
                                this->dataManager->getSpectrumMapping(),
                                this->dataManager->getTimerangeMapping());
 
-    std::shared_ptr<DeviceMessage> responseMsg(
-        new ReadDeviceMessage(this->getUserId(), writeMsg->getSource(),
-                              ReadDeviceTopic::READ_TOPIC_KEY_RESPONSE,
-                              keyResponsePayload, writeMsg));
+    std::shared_ptr<DeviceMessage> responseMsg =
+        Utilities::makePooled<ReadDeviceMessage>(
+            this->getUserId(), writeMsg->getSource(),
+            ReadDeviceTopic::READ_TOPIC_KEY_RESPONSE, keyResponsePayload,
+            writeMsg);
 
     this->pushMessageQueue(responseMsg);
 
@@ -354,7 +379,10 @@ bool MessageInterface::write(std::shared_ptr<InitDeviceMessage> initMsg) {
     return false;
   }
 
-  this->initPayload = initMsg->returnPayload();
+  {
+    std::lock_guard<std::mutex> lock(this->statusMutex);
+    this->initPayload = initMsg->returnPayload();
+  }
   return this->initialize(initMsg->returnPayload());
 }
 
@@ -368,7 +396,10 @@ bool MessageInterface::write(std::shared_ptr<ConfigDeviceMessage> configMsg) {
     return false;
   }
 
-  this->configPayload = configMsg->getConfiguration();
+  {
+    std::lock_guard<std::mutex> lock(this->statusMutex);
+    this->configPayload = configMsg->getConfiguration();
+  }
   this->eventResponseId = configMsg->getResponseIds();
 
   return this->configure(configMsg->getConfiguration());
@@ -379,25 +410,16 @@ MessageInterface::read(TimePoint timestamp) {
   // Call the device-specific read operation.
   std::list<std::shared_ptr<DeviceMessage>> readMessages =
       this->specificRead(timestamp);
-  // Append the message, if it was not empty.
-  if (!readMessages.empty()) {
-    for (auto &message : readMessages) {
-      this->pushMessageQueue(message);
-    }
-  }
 
-  // Pop the queue, if it is not empty.
-  if (this->messageQueueEmpty()) {
-    // Queue is empty. Return an empty std::list.
-    return std::list<std::shared_ptr<DeviceMessage>>();
-  } else {
-    // Pop the queue to a std::list and return it.
-    std::list<std::shared_ptr<DeviceMessage>> retVal;
-    while (!this->messageQueueEmpty()) {
-      retVal.push_back(this->popMessageQueue());
-    }
-    return retVal;
-  }
+  // Take all queued messages at once and append the read messages. They are
+  // not pushed to the queue, as they are returned right away.
+  this->messageOut.drain(this->messageOutPending);
+  std::list<std::shared_ptr<DeviceMessage>> retVal;
+  retVal.swap(this->messageOutPending);
+  retVal.splice(retVal.end(), readMessages);
+  sortByPriority(retVal);
+
+  return retVal;
 }
 
 DeviceStatus MessageInterface::getDeviceStatus() { return this->deviceState; }
@@ -0,0 +1,138 @@
+// Project includes
+#include <message_lanes.hpp>
+
+namespace Messages {
+
+namespace {
+/**
+ * @brief Returns the lane of the given message. Unknown classes are treated
+ * like bulk messages.
+ */
+size_t getLane(const std::shared_ptr<DeviceMessage> &message) {
+  size_t lane = static_cast<size_t>(message->getPriority());
+  if (lane >= MESSAGE_PRIORITY_COUNT) {
+    return MESSAGE_PRIORITY_COUNT - 1;
+  }
+
+  return lane;
+}
+} // namespace
+
+MessageLanes::MessageLanes() : passedOverCounts() {}
+
+void MessageLanes::push(std::shared_ptr<DeviceMessage> message) {
+  if (!message) {
+    return;
+  }
+  this->lanes[getLane(message)].push(message);
+}
+
+std::shared_ptr<DeviceMessage> MessageLanes::pop() {
+  // Serve a lane, that has been passed over too often. Otherwise, serve the
+  // lane of the highest class.
+  size_t servedLane = MESSAGE_PRIORITY_COUNT;
+  for (size_t lane = 0; lane < MESSAGE_PRIORITY_COUNT; lane++) {
+    if (!this->lanes[lane].empty() &&
+        this->passedOverCounts[lane] >= MESSAGE_LANES_STARVATION_LIMIT) {
+      servedLane = lane;
+      break;
+    }
+  }
+  if (MESSAGE_PRIORITY_COUNT == servedLane) {
+    for (size_t lane = 0; lane < MESSAGE_PRIORITY_COUNT; lane++) {
+      if (!this->lanes[lane].empty()) {
+        servedLane = lane;
+        break;
+      }
+    }
+  }
+  if (MESSAGE_PRIORITY_COUNT == servedLane) {
+    return std::shared_ptr<DeviceMessage>();
+  }
+
+  for (size_t lane = 0; lane < MESSAGE_PRIORITY_COUNT; lane++) {
+    if (lane != servedLane && !this->lanes[lane].empty()) {
+      this->passedOverCounts[lane]++;
+    }
+  }
+  this->passedOverCounts[servedLane] = 0;
+
+  std::shared_ptr<DeviceMessage> message = this->lanes[servedLane].front();
+  this->lanes[servedLane].pop();
+
+  return message;
+}
+
+bool MessageLanes::empty() const { return 0 == this->size(); }
+
+size_t MessageLanes::size() const {
+  size_t size = 0;
+  for (auto &lane : this->lanes) {
+    size += lane.size();
+  }
+
+  return size;
+}
+
+void MessageLanes::clear() {
+  for (size_t lane = 0; lane < MESSAGE_PRIORITY_COUNT; lane++) {
+    this->lanes[lane] = std::queue<std::shared_ptr<DeviceMessage>>();
+    this->passedOverCounts[lane] = 0;
+  }
+}
+
+bool MessageMailbox::push(std::shared_ptr<DeviceMessage> message) {
+  if (!message) {
+    return false;
+  }
+
+  return this->lanes[getLane(message)].push(message);
+}
+
+bool MessageMailbox::push(
+    const std::vector<std::shared_ptr<DeviceMessage>> &messages) {
+  // Publish the messages of each class at once.
+  std::vector<std::shared_ptr<DeviceMessage>> laneMessages;
+  bool success = true;
+  for (size_t lane = 0; lane < MESSAGE_PRIORITY_COUNT; lane++) {
+    laneMessages.clear();
+    for (auto &message : messages) {
+      if (!message) {
+        success = false;
+      } else if (getLane(message) == lane) {
+        laneMessages.push_back(message);
+      }
+    }
+    if (!laneMessages.empty() && !this->lanes[lane].push(laneMessages)) {
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+void MessageMailbox::drain(
+    std::list<std::shared_ptr<DeviceMessage>> &messages) {
+  for (auto &lane : this->lanes) {
+    lane.drain(messages);
+  }
+}
+
+bool MessageMailbox::empty() const {
+  for (auto &lane : this->lanes) {
+    if (!lane.empty()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void sortByPriority(std::list<std::shared_ptr<DeviceMessage>> &messages) {
+  // std::list::sort is stable.
+  messages.sort([](const std::shared_ptr<DeviceMessage> &first,
+                   const std::shared_ptr<DeviceMessage> &second) {
+    return first->getPriority() < second->getPriority();
+  });
+}
+} // namespace Messages
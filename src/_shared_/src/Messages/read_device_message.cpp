@@ -7,15 +7,20 @@ ReadDeviceMessage::ReadDeviceMessage(
     UserId source, UserId destination, ReadDeviceTopic topic,
     ReadPayload *readPayloadData,
     std::shared_ptr<WriteDeviceMessage> originalMessage)
-    : DeviceMessage(source, destination), topic(topic),
-      readPayload(readPayloadData), originalMessage(originalMessage) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_READ,
+                    getTopicPriority(topic)),
+      topic(topic),
+      readPayload(Utilities::sharePooled(readPayloadData)),
+      originalMessage(originalMessage) {}
 
 ReadDeviceMessage::ReadDeviceMessage(
     UserId source, UserId destination, ReadDeviceTopic topic,
     std::shared_ptr<ReadPayload> readPayload,
     std::shared_ptr<WriteDeviceMessage> originalMessage)
-    : DeviceMessage(source, destination), topic(topic),
-      readPayload(readPayload), originalMessage(originalMessage) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_READ,
+                    getTopicPriority(topic)),
+      topic(topic), readPayload(readPayload),
+      originalMessage(originalMessage) {}
 
 std::string ReadDeviceMessage::serialize() { return "Read Device Message"; }
 
@@ -29,4 +34,16 @@ std::shared_ptr<WriteDeviceMessage> ReadDeviceMessage::getOriginalMessage() {
 
 ReadDeviceTopic ReadDeviceMessage::getTopic() { return this->topic; }
 
+MessagePriority ReadDeviceMessage::getTopicPriority(ReadDeviceTopic topic) {
+  switch (topic) {
+  case READ_TOPIC_DEVICE_STATUS:
+  case READ_TOPIC_FAILED_RESPONSE:
+    return MESSAGE_PRIORITY_CONTROL;
+  case READ_TOPIC_DATA_RESPONSE:
+    return MESSAGE_PRIORITY_BULK;
+  default:
+    return MESSAGE_PRIORITY_NORMAL;
+  }
+}
+
 } // namespace Messages
\ No newline at end of file
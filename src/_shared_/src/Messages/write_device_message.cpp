@@ -4,29 +4,48 @@
 namespace Messages {
 WriteDeviceMessage::WriteDeviceMessage(UserId source, UserId destination,
                                        WriteDeviceTopic topic)
-    : DeviceMessage(source, destination), topic(topic) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_WRITE,
+                    getTopicPriority(topic)),
+      topic(topic) {}
 
 WriteDeviceMessage::WriteDeviceMessage(UserId source, UserId destination,
                                        WriteDeviceTopic topic,
                                        AdditionalData additionalData)
-    : DeviceMessage(source, destination), topic(topic),
-      additionalData(additionalData) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_WRITE,
+                    getTopicPriority(topic)),
+      topic(topic), additionalData(additionalData) {}
 
 WriteDeviceMessage::WriteDeviceMessage(UserId source, UserId destination,
                                        WriteDeviceTopic topic,
                                        WritePayload *payload)
-    : DeviceMessage(source, destination), payload(payload), topic(topic) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_WRITE,
+                    getTopicPriority(topic)),
+      payload(Utilities::sharePooled(payload)), topic(topic) {}
 
 WriteDeviceMessage::WriteDeviceMessage(UserId source, UserId destination,
                                        WriteDeviceTopic topic,
                                        std::shared_ptr<WritePayload> payload)
-    : DeviceMessage(source, destination), payload(payload), topic(topic) {}
+    : DeviceMessage(source, destination, DEVICE_MESSAGE_KIND_WRITE,
+                    getTopicPriority(topic)),
+      payload(payload), topic(topic) {}
 
 AdditionalData WriteDeviceMessage::getAdditionalData() {
   return this->additionalData;
 }
 WriteDeviceTopic WriteDeviceMessage::getTopic() { return this->topic; }
 
+MessagePriority WriteDeviceMessage::getTopicPriority(WriteDeviceTopic topic) {
+  switch (topic) {
+  case WRITE_TOPIC_RUN:
+  case WRITE_TOPIC_STOP:
+  case WRITE_TOPIC_QUERY_STATE:
+  case WRITE_TOPIC_DEVICE_SPECIFIC:
+    return MESSAGE_PRIORITY_CONTROL;
+  default:
+    return MESSAGE_PRIORITY_NORMAL;
+  }
+}
+
 std::string WriteDeviceMessage::serialize() { return "Write Message"; }
 
 std::shared_ptr<Payload> WriteDeviceMessage::getPayload() {
@@ -0,0 +1,139 @@
+// Standard includes
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+
+// Project includes
+#include <csv_writer.hpp>
+#include <impedance_kernels.hpp>
+
+using namespace Utilities;
+
+/// The maximum length of a formatted number.
+#define MAX_NUMBER_LENGTH 32
+/// The expected length of a formatted number. Used to reserve memory.
+#define EXPECTED_NUMBER_LENGTH 12
+
+CsvWriter::CsvWriter(ThreadPool &threadPool, char separator,
+                     size_t maxPendingBlocks)
+    : threadPool(threadPool), separator(separator),
+      maxPendingBlocks(std::max<size_t>(maxPendingBlocks, 1)) {}
+
+CsvWriter::~CsvWriter() { this->close(); }
+
+bool CsvWriter::open(const std::string &fileName, bool append) {
+  std::error_code errorCode;
+  uintmax_t fileSize = std::filesystem::file_size(fileName, errorCode);
+  this->hasHeader = append && !errorCode && fileSize > 0;
+  this->file.open(fileName,
+                  std::ios::out | (append ? std::ios::app : std::ios::trunc));
+  return this->file.is_open();
+}
+
+bool CsvWriter::writeHeader(const std::vector<std::string> &columns) {
+  if (!this->file.is_open()) {
+    return false;
+  }
+  if (this->hasHeader) {
+    return true;
+  }
+
+  std::string header;
+  for (auto &column : columns) {
+    header += column;
+    header += this->separator;
+  }
+  header += '\n';
+  this->file << header;
+
+  return this->file.good();
+}
+
+bool CsvWriter::writeBlock(std::vector<long long> &&timestamps,
+                           std::vector<double> &&values, size_t width,
+                           bool polar) {
+  if (!this->file.is_open()) {
+    return false;
+  }
+
+  // Make room for the new block first, to keep the memory usage bounded.
+  if (this->pendingBlocks.size() >= this->maxPendingBlocks &&
+      !this->writeFront()) {
+    return false;
+  }
+
+  char separator = this->separator;
+  this->pendingBlocks.push_back(this->threadPool.submit(
+      [timestamps = std::move(timestamps), values = std::move(values), width,
+       polar, separator]() {
+        return CsvWriter::formatBlock(timestamps, values, width, polar,
+                                      separator);
+      }));
+
+  return true;
+}
+
+bool CsvWriter::close() {
+  if (!this->file.is_open()) {
+    return false;
+  }
+
+  bool success = true;
+  while (!this->pendingBlocks.empty()) {
+    success &= this->writeFront();
+  }
+  this->file.close();
+
+  return success;
+}
+
+void CsvWriter::appendNumber(std::string &str, double value) {
+  char buffer[MAX_NUMBER_LENGTH];
+  auto result = std::to_chars(buffer, buffer + MAX_NUMBER_LENGTH, value);
+  str.append(buffer, result.ptr);
+}
+
+void CsvWriter::appendNumber(std::string &str, long long value) {
+  char buffer[MAX_NUMBER_LENGTH];
+  auto result = std::to_chars(buffer, buffer + MAX_NUMBER_LENGTH, value);
+  str.append(buffer, result.ptr);
+}
+
+std::string CsvWriter::formatBlock(const std::vector<long long> &timestamps,
+                                   const std::vector<double> &values,
+                                   size_t width, bool polar, char separator) {
+  std::string block;
+  block.reserve(timestamps.size() * (width + 1) * EXPECTED_NUMBER_LENGTH);
+
+  // Convert the whole block at once, so that the conversion is vectorized.
+  std::vector<double> polarValues;
+  if (polar) {
+    polarValues.resize(values.size());
+    Utilities::cartesianToPolar(values.data(), polarValues.data(),
+                                values.size() / 2);
+  }
+  const std::vector<double> &formattedValues = polar ? polarValues : values;
+
+  for (size_t row = 0; row < timestamps.size(); row++) {
+    CsvWriter::appendNumber(block, timestamps[row]);
+    block += separator;
+
+    const double *rowValues = formattedValues.data() + row * width;
+    for (size_t i = 0; i < width; i++) {
+      CsvWriter::appendNumber(block, rowValues[i]);
+      block += separator;
+    }
+    block += '\n';
+  }
+
+  return block;
+}
+
+bool CsvWriter::writeFront() {
+  std::string block = this->pendingBlocks.front().get();
+  this->pendingBlocks.pop_front();
+  this->file.write(block.data(), block.size());
+
+  return this->file.good();
+}
@@ -1,6 +1,8 @@
 // Project includes
 #include <data_manager.hpp>
+#include <data_manager_columnar.hpp>
 #include <data_manager_hdf.hpp>
+#include <data_manager_session.hpp>
 
 using namespace Utilities;
 
@@ -16,6 +18,10 @@ KeyMapping DataManager::getKeyMapping() const { return this->typeMapping; }
 DataManager *DataManager::getDataManager(DataManagerType dataManagerType) {
   if (DataManagerType::DATAMANAGER_TYPE_HDF == dataManagerType) {
     return new DataManagerHdf();
+  } else if (DataManagerType::DATAMANAGER_TYPE_COLUMNAR == dataManagerType) {
+    return new DataManagerColumnar();
+  } else if (DataManagerType::DATAMANAGER_TYPE_SESSION == dataManagerType) {
+    return new DataManagerSession();
   } else {
     return nullptr;
   }
@@ -0,0 +1,600 @@
+// Standard includes
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <sstream>
+
+// 3rd-party includes
+#include <easylogging++.h>
+
+// Project includes
+#include <data_manager_columnar.hpp>
+
+using namespace Utilities;
+
+const std::string ColumnarArchiveWriter::MANIFEST_FILE_NAME = "manifest.txt";
+const std::string ColumnarArchiveWriter::MANIFEST_HEADER =
+    "SCIMON_COLUMNAR_ARCHIVE 1";
+
+namespace {
+/**
+ * @brief Returns the path of a column file of the key with the given index.
+ */
+std::filesystem::path columnPath(const std::filesystem::path &directory,
+                                 size_t keyIdx, const std::string &column) {
+  return directory / (std::to_string(keyIdx) + "." + column);
+}
+
+/**
+ * @brief Returns whether the values of the given data type are stored as
+ * integers.
+ */
+bool isIntegerColumn(DataManagerDataType dataType) {
+  return DATAMANAGER_DATA_TYPE_INT == dataType ||
+         DATAMANAGER_DATA_TYPE_STRING == dataType;
+}
+
+/**
+ * @brief Reads the frequencies of a spectrum key.
+ * @param path The path of the frequency file.
+ * @param frequencies Will contain the frequencies.
+ * @return TRUE if the file has been read completely. FALSE otherwise.
+ */
+bool readFrequencies(const std::filesystem::path &path,
+                     std::vector<double> &frequencies) {
+  std::error_code errorCode;
+  uintmax_t size = std::filesystem::file_size(path, errorCode);
+  if (errorCode || size % sizeof(double) != 0) {
+    return false;
+  }
+  std::ifstream frequencyStream(path, std::ios::binary);
+  if (!frequencyStream.is_open()) {
+    return false;
+  }
+
+  frequencies.resize(size / sizeof(double));
+  frequencyStream.read(reinterpret_cast<char *>(frequencies.data()), size);
+
+  return frequencyStream.good();
+}
+
+/**
+ * @brief Reads the dictionary of a string key. The length of every entry is
+ * checked against the size of the file.
+ * @param path The path of the dictionary file.
+ * @param dictionary Will contain the entries of the dictionary.
+ * @return TRUE if the file has been read completely. FALSE otherwise.
+ */
+bool readDictionary(const std::filesystem::path &path,
+                    std::vector<std::string> &dictionary) {
+  std::error_code errorCode;
+  uintmax_t remaining = std::filesystem::file_size(path, errorCode);
+  if (errorCode) {
+    return false;
+  }
+  std::ifstream dictionaryStream(path, std::ios::binary);
+  if (!dictionaryStream.is_open()) {
+    return false;
+  }
+
+  while (remaining > 0) {
+    uint32_t length;
+    if (remaining < sizeof(length) ||
+        !dictionaryStream.read(reinterpret_cast<char *>(&length),
+                               sizeof(length))) {
+      return false;
+    }
+    remaining -= sizeof(length);
+    if (length > remaining) {
+      return false;
+    }
+
+    std::string entry(length, '\0');
+    if (!dictionaryStream.read(entry.data(), length)) {
+      return false;
+    }
+    remaining -= length;
+    dictionary.push_back(std::move(entry));
+  }
+
+  return true;
+}
+} // namespace
+
+bool ColumnarArchiveWriter::open(const std::string &directory) {
+  // The column files are written in the native byte order.
+  if constexpr (std::endian::native != std::endian::little) {
+    LOG(ERROR) << "Columnar archives can only be written on little-endian "
+                  "machines.";
+    return false;
+  }
+
+  std::error_code errorCode;
+  std::filesystem::create_directories(directory, errorCode);
+  if (errorCode) {
+    LOG(ERROR) << "Could not create " << directory << ": "
+               << errorCode.message();
+    return false;
+  }
+
+  this->directory = directory;
+  this->entries.clear();
+  this->keyOpen = false;
+
+  return true;
+}
+
+bool ColumnarArchiveWriter::beginKey(const std::string &key,
+                                     DataManagerDataType dataType,
+                                     const std::vector<double> &frequencies) {
+  if (this->keyOpen) {
+    return false;
+  }
+  if (key.find('\n') != std::string::npos) {
+    return false;
+  }
+
+  size_t keyIdx = this->entries.size();
+  this->timestampStream.open(
+      columnPath(this->directory, keyIdx, "timestamps"),
+      std::ios::binary | std::ios::trunc);
+  this->valueStream.open(columnPath(this->directory, keyIdx, "values"),
+                         std::ios::binary | std::ios::trunc);
+  if (!this->timestampStream.is_open() || !this->valueStream.is_open()) {
+    this->timestampStream.close();
+    this->valueStream.close();
+    return false;
+  }
+
+  if (DATAMANAGER_DATA_TYPE_SPECTRUM == dataType) {
+    std::ofstream frequencyStream(
+        columnPath(this->directory, keyIdx, "frequencies"),
+        std::ios::binary | std::ios::trunc);
+    frequencyStream.write(reinterpret_cast<const char *>(frequencies.data()),
+                          frequencies.size() * sizeof(double));
+    if (!frequencyStream) {
+      return false;
+    }
+  }
+
+  this->currentEntry = ManifestEntry{key, dataType, 0, 0, 0};
+  this->keyOpen = true;
+
+  return true;
+}
+
+bool ColumnarArchiveWriter::appendTimestamps(
+    const std::vector<long long> &timestamps) {
+  if (!this->keyOpen) {
+    return false;
+  }
+  if (timestamps.empty()) {
+    return true;
+  }
+
+  if (this->currentEntry.rowCount == 0) {
+    this->currentEntry.firstTimestamp = timestamps.front();
+  }
+  this->currentEntry.lastTimestamp = timestamps.back();
+  this->currentEntry.rowCount += timestamps.size();
+
+  this->timestampStream.write(reinterpret_cast<const char *>(timestamps.data()),
+                              timestamps.size() * sizeof(long long));
+
+  return this->timestampStream.good();
+}
+
+bool ColumnarArchiveWriter::appendValues(const std::vector<int> &values) {
+  if (!this->keyOpen || !isIntegerColumn(this->currentEntry.dataType)) {
+    return false;
+  }
+
+  this->valueStream.write(reinterpret_cast<const char *>(values.data()),
+                          values.size() * sizeof(int));
+
+  return this->valueStream.good();
+}
+
+bool ColumnarArchiveWriter::appendValues(const std::vector<double> &values) {
+  if (!this->keyOpen || isIntegerColumn(this->currentEntry.dataType)) {
+    return false;
+  }
+
+  this->valueStream.write(reinterpret_cast<const char *>(values.data()),
+                          values.size() * sizeof(double));
+
+  return this->valueStream.good();
+}
+
+bool ColumnarArchiveWriter::writeDictionary(
+    const std::vector<std::string> &dictionary) {
+  if (!this->keyOpen ||
+      DATAMANAGER_DATA_TYPE_STRING != this->currentEntry.dataType) {
+    return false;
+  }
+
+  std::ofstream dictionaryStream(
+      columnPath(this->directory, this->entries.size(), "dictionary"),
+      std::ios::binary | std::ios::trunc);
+  for (auto &entry : dictionary) {
+    uint32_t length = static_cast<uint32_t>(entry.size());
+    dictionaryStream.write(reinterpret_cast<const char *>(&length),
+                           sizeof(length));
+    dictionaryStream.write(entry.data(), entry.size());
+  }
+
+  return dictionaryStream.good();
+}
+
+bool ColumnarArchiveWriter::endKey() {
+  if (!this->keyOpen) {
+    return false;
+  }
+
+  this->timestampStream.close();
+  this->valueStream.close();
+  this->entries.push_back(this->currentEntry);
+  this->keyOpen = false;
+
+  return true;
+}
+
+bool ColumnarArchiveWriter::close() {
+  if (this->keyOpen && !this->endKey()) {
+    return false;
+  }
+
+  // The manifest is written last, so an interrupted conversion does not leave
+  // behind an archive that looks complete.
+  std::ofstream manifestStream(this->directory / MANIFEST_FILE_NAME,
+                               std::ios::trunc);
+  manifestStream << MANIFEST_HEADER << "\n";
+  for (size_t i = 0; i < this->entries.size(); i++) {
+    const ManifestEntry &entry = this->entries[i];
+    manifestStream << i << "\t" << static_cast<int>(entry.dataType) << "\t"
+                   << entry.rowCount << "\t" << entry.firstTimestamp << "\t"
+                   << entry.lastTimestamp << "\t" << entry.key << "\n";
+  }
+
+  return manifestStream.good();
+}
+
+DataManagerColumnar::~DataManagerColumnar() { this->close(); }
+
+bool DataManagerColumnar::read(TimePoint timestamp, const std::string &key,
+                               Value &value) {
+  if (!this->isOpen()) {
+    return false;
+  }
+  auto it = this->columns.find(key);
+  if (it == this->columns.end()) {
+    return false;
+  }
+
+  auto [firstRow, rowCount] = this->findRows(*it->second, timestamp, timestamp);
+  if (rowCount == 0) {
+    return false;
+  }
+  value = this->getValue(key, *it->second, firstRow);
+
+  return true;
+}
+
+bool DataManagerColumnar::read(TimePoint from, TimePoint to,
+                               const std::string &key,
+                               std::vector<TimePoint> &timestamps,
+                               std::vector<Value> &value) {
+  if (!this->isOpen()) {
+    return false;
+  }
+  if (from > to) {
+    return false;
+  }
+  auto it = this->columns.find(key);
+  if (it == this->columns.end()) {
+    return false;
+  }
+
+  const Column &column = *it->second;
+  auto [firstRow, rowCount] = this->findRows(column, from, to);
+  std::span<const long long> timestampView =
+      column.timestamps.view<long long>();
+
+  timestamps.reserve(timestamps.size() + rowCount);
+  value.reserve(value.size() + rowCount);
+  for (size_t row = firstRow; row < firstRow + rowCount; row++) {
+    timestamps.emplace_back(
+        TimePoint(std::chrono::milliseconds(timestampView[row])));
+    value.emplace_back(this->getValue(key, column, row));
+  }
+
+  return true;
+}
+
+template <class T>
+bool DataManagerColumnar::readColumns(TimePoint from, TimePoint to,
+                                      const std::string &key,
+                                      std::span<const long long> &timestamps,
+                                      std::span<const T> &values) {
+  if (!this->isOpen()) {
+    return false;
+  }
+  if (from > to) {
+    return false;
+  }
+  auto it = this->columns.find(key);
+  if (it == this->columns.end()) {
+    return false;
+  }
+  // The requested element type has to match the stored element type.
+  if (isIntegerColumn(this->typeMapping[key]) != std::is_same_v<T, int>) {
+    return false;
+  }
+
+  const Column &column = *it->second;
+  auto [firstRow, rowCount] = this->findRows(column, from, to);
+  timestamps = column.timestamps.view<long long>().subspan(firstRow, rowCount);
+  values = column.values.view<T>().subspan(firstRow * column.valueWidth,
+                                           rowCount * column.valueWidth);
+
+  return true;
+}
+
+template bool DataManagerColumnar::readColumns<int>(
+    TimePoint from, TimePoint to, const std::string &key,
+    std::span<const long long> &timestamps, std::span<const int> &values);
+template bool DataManagerColumnar::readColumns<double>(
+    TimePoint from, TimePoint to, const std::string &key,
+    std::span<const long long> &timestamps, std::span<const double> &values);
+
+size_t DataManagerColumnar::getValueWidth(const std::string &key) const {
+  auto it = this->columns.find(key);
+  if (it == this->columns.end()) {
+    return 0;
+  }
+
+  return it->second->valueWidth;
+}
+
+std::vector<std::string>
+DataManagerColumnar::getDictionary(const std::string &key) const {
+  auto it = this->columns.find(key);
+  if (it == this->columns.end()) {
+    return std::vector<std::string>();
+  }
+
+  return it->second->dictionary;
+}
+
+bool DataManagerColumnar::write(TimePoint timestamp, const std::string &key,
+                                const Value &value) {
+  return false;
+}
+
+bool DataManagerColumnar::write(const std::vector<TimePoint> &timestamp,
+                                const std::string &key,
+                                const std::vector<Value> &value) {
+  return false;
+}
+
+bool DataManagerColumnar::open(std::string name) {
+  if (this->isOpen()) {
+    return false;
+  }
+
+  std::filesystem::path directory(name);
+  std::ifstream manifestStream(directory /
+                               ColumnarArchiveWriter::MANIFEST_FILE_NAME);
+  std::string line;
+  if (!std::getline(manifestStream, line) ||
+      line != ColumnarArchiveWriter::MANIFEST_HEADER) {
+    LOG(ERROR) << name << " is not a columnar archive.";
+    return false;
+  }
+
+  while (std::getline(manifestStream, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    // Parse the manifest entry. The key is the last field, as it may contain
+    // arbitrary characters.
+    std::istringstream lineStream(line);
+    size_t keyIdx;
+    int dataTypeRaw;
+    size_t rowCount;
+    long long firstTimestamp;
+    long long lastTimestamp;
+    lineStream >> keyIdx >> dataTypeRaw >> rowCount >> firstTimestamp >>
+        lastTimestamp;
+    lineStream.get();
+    std::string key;
+    std::getline(lineStream, key);
+    if (lineStream.fail() || key.empty()) {
+      LOG(ERROR) << "Malformed manifest entry: " << line;
+      this->close();
+      return false;
+    }
+    if (dataTypeRaw < DATAMANAGER_DATA_TYPE_INT ||
+        dataTypeRaw > DATAMANAGER_DATA_TYPE_SPECTRUM) {
+      LOG(ERROR) << "Unknown data type " << dataTypeRaw << " of key " << key
+                 << ".";
+      this->close();
+      return false;
+    }
+    DataManagerDataType dataType =
+        static_cast<DataManagerDataType>(dataTypeRaw);
+
+    std::unique_ptr<Column> column(new Column());
+    column->rowCount = rowCount;
+    column->valueWidth = 1;
+    if (DATAMANAGER_DATA_TYPE_COMPLEX == dataType) {
+      column->valueWidth = 2;
+    } else if (DATAMANAGER_DATA_TYPE_SPECTRUM == dataType) {
+      std::vector<double> frequencies;
+      if (!readFrequencies(columnPath(directory, keyIdx, "frequencies"),
+                           frequencies)) {
+        LOG(ERROR) << "Frequencies of key " << key
+                   << " are missing or damaged.";
+        this->close();
+        return false;
+      }
+      column->valueWidth = 2 * frequencies.size();
+      this->spectrumMapping[key] = frequencies;
+    } else if (DATAMANAGER_DATA_TYPE_STRING == dataType) {
+      if (!readDictionary(columnPath(directory, keyIdx, "dictionary"),
+                          column->dictionary)) {
+        LOG(ERROR) << "Dictionary of key " << key << " is missing or damaged.";
+        this->close();
+        return false;
+      }
+    }
+
+    // Map the columns and check that their sizes match the manifest. Row
+    // counts, whose column sizes would overflow, can not match any file.
+    size_t elementSize =
+        isIntegerColumn(dataType) ? sizeof(int) : sizeof(double);
+    size_t rowBytes = column->valueWidth * elementSize;
+    if (rowCount > std::numeric_limits<size_t>::max() / sizeof(long long) ||
+        (rowBytes > 0 &&
+         rowCount > std::numeric_limits<size_t>::max() / rowBytes) ||
+        !column->timestamps.open(
+            columnPath(directory, keyIdx, "timestamps").string()) ||
+        !column->values.open(
+            columnPath(directory, keyIdx, "values").string()) ||
+        column->timestamps.size() != rowCount * sizeof(long long) ||
+        column->values.size() != rowCount * rowBytes) {
+      LOG(ERROR) << "Columns of key " << key << " are missing or truncated.";
+      this->close();
+      return false;
+    }
+
+    this->typeMapping[key] = dataType;
+    this->columns[key] = std::move(column);
+  }
+
+  this->openFlag = true;
+
+  return true;
+}
+
+bool DataManagerColumnar::open(std::string name, KeyMapping keyMapping,
+                               bool force) {
+  LOG(ERROR) << "Columnar archives are read-only. Use "
+                "DataManagerHdf::writeToColumnar() to create them.";
+  return false;
+}
+
+bool DataManagerColumnar::close() {
+  bool wasOpen = this->isOpen();
+
+  this->columns.clear();
+  this->typeMapping.clear();
+  this->spectrumMapping.clear();
+  this->openFlag = false;
+
+  return wasOpen;
+}
+
+DataManagerType DataManagerColumnar::getDataManagerType() const {
+  return DataManagerType::DATAMANAGER_TYPE_COLUMNAR;
+}
+
+bool DataManagerColumnar::createKey(std::string key,
+                                    DataManagerDataType dataType) {
+  return false;
+}
+
+bool DataManagerColumnar::createGroup(
+    const std::string &groupName, const std::map<std::string, int> &intProps,
+    const std::map<std::string, double> &doubleProps,
+    const std::map<std::string, std::string> &strProps) {
+  return false;
+}
+
+TimerangeMapping DataManagerColumnar::getTimerangeMapping() const {
+  TimerangeMapping retVal;
+  for (auto &keyValuePair : this->columns) {
+    std::span<const long long> timestampView =
+        keyValuePair.second->timestamps.view<long long>();
+    if (timestampView.empty()) {
+      // Indicate empty keys by zeroes, just like the HDF data manager does.
+      retVal[keyValuePair.first] =
+          std::make_pair(TimePoint(std::chrono::milliseconds(0)),
+                         TimePoint(std::chrono::milliseconds(0)));
+      continue;
+    }
+    retVal[keyValuePair.first] = std::make_pair(
+        TimePoint(std::chrono::milliseconds(timestampView.front())),
+        TimePoint(std::chrono::milliseconds(timestampView.back())));
+  }
+
+  return retVal;
+}
+
+bool DataManagerColumnar::writeToCsv(const std::string &directory,
+                                     const ExportOptions &options) {
+  return false;
+}
+
+bool DataManagerColumnar::setupSpectrumSpecific(
+    std::string key, std::vector<double> frequencies) {
+  return false;
+}
+
+std::pair<size_t, size_t> DataManagerColumnar::findRows(const Column &column,
+                                                        TimePoint from,
+                                                        TimePoint to) const {
+  // The timestamps are ordered, so the time frame can be found by binary
+  // search.
+  std::span<const long long> timestampView =
+      column.timestamps.view<long long>();
+  long long fromRaw = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          from.time_since_epoch())
+                          .count();
+  long long toRaw = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        to.time_since_epoch())
+                        .count();
+  auto first =
+      std::lower_bound(timestampView.begin(), timestampView.end(), fromRaw);
+  auto last = std::upper_bound(first, timestampView.end(), toRaw);
+
+  return std::make_pair(
+      static_cast<size_t>(std::distance(timestampView.begin(), first)),
+      static_cast<size_t>(std::distance(first, last)));
+}
+
+Value DataManagerColumnar::getValue(const std::string &key,
+                                    const Column &column, size_t row) {
+  DataManagerDataType dataType = this->typeMapping[key];
+  if (DATAMANAGER_DATA_TYPE_INT == dataType) {
+    return Value(column.values.view<int>()[row]);
+  } else if (DATAMANAGER_DATA_TYPE_DOUBLE == dataType) {
+    return Value(column.values.view<double>()[row]);
+  } else if (DATAMANAGER_DATA_TYPE_COMPLEX == dataType) {
+    std::span<const double> valueView = column.values.view<double>();
+    return Value(Impedance(valueView[2 * row], valueView[2 * row + 1]));
+  } else if (DATAMANAGER_DATA_TYPE_STRING == dataType) {
+    int code = column.values.view<int>()[row];
+    if (code < 0 || code >= column.dictionary.size()) {
+      LOG(ERROR) << "Invalid dictionary code " << code << " in key " << key
+                 << ".";
+      return Value(std::string());
+    }
+    return Value(column.dictionary[code]);
+  } else if (DATAMANAGER_DATA_TYPE_SPECTRUM == dataType) {
+    const std::vector<double> &frequencies = this->spectrumMapping[key];
+    std::span<const double> rowView =
+        column.values.view<double>().subspan(row * column.valueWidth,
+                                             column.valueWidth);
+    ImpedanceSpectrum spectrum;
+    for (size_t i = 0; i < frequencies.size(); i++) {
+      spectrum.emplace_back(ImpedancePoint(
+          frequencies[i], Impedance(rowView[2 * i], rowView[2 * i + 1])));
+    }
+    return Value(spectrum);
+  } else {
+    LOG(ERROR) << "Key " << key << " has an unknown data type.";
+    return Value();
+  }
+}
@@ -1,12 +1,22 @@
 // Standard includes
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <regex>
+#include <sstream>
 
 // 3rd-party includes
 #include <easylogging++.h>
 
 // Project includes
+#include <data_manager_columnar.hpp>
 #include <data_manager_hdf.hpp>
 
+/// First line of an export checkpoint file. Identifies the format and its
+/// version.
+#define EXPORT_CHECKPOINT_HEADER "SCIMON_EXPORT_CHECKPOINT 1"
+
 using namespace Utilities;
 using namespace HighFive;
 using namespace Core;
@@ -77,7 +87,18 @@ bool DataManagerHdf::read(TimePoint timestamp, const std::string &key,
         } else if (DATAMANAGER_DATA_TYPE_STRING == dataType) {
           DataSet datasetValues =
               this->hdfFile->getDataSet("/data/" + key + "/values");
-          value = datasetValues.select({i, 0}, {1, 1}).read<std::string>();
+          if (!this->isDictionaryEncoded(key)) {
+            value = datasetValues.select({i, 0}, {1, 1}).read<std::string>();
+
+            return true;
+          }
+          std::vector<std::string> decoded;
+          if (!this->decodeStrings(
+                  key, {datasetValues.select({i, 0}, {1, 1}).read<int>()},
+                  decoded)) {
+            return false;
+          }
+          value = decoded.front();
 
           return true;
 
@@ -243,9 +264,19 @@ bool DataManagerHdf::read(TimePoint from, TimePoint to, const std::string &key,
   else if (DATAMANAGER_DATA_TYPE_STRING == dataType) {
     DataSet datasetValues =
         this->hdfFile->getDataSet("/data/" + key + "/values");
-    std::vector<std::string> rawVector =
-        datasetValues.select({idxFrom, 0}, {idxTo - idxFrom + 1, 1})
-            .read<std::vector<std::string>>();
+    std::vector<std::string> rawVector;
+    if (this->isDictionaryEncoded(key)) {
+      // Read the codes and look them up in the dictionary.
+      std::vector<int> codes =
+          datasetValues.select({idxFrom, 0}, {idxTo - idxFrom + 1, 1})
+              .read<std::vector<int>>();
+      if (!this->decodeStrings(key, codes, rawVector)) {
+        return false;
+      }
+    } else {
+      rawVector = datasetValues.select({idxFrom, 0}, {idxTo - idxFrom + 1, 1})
+                      .read<std::vector<std::string>>();
+    }
     value.reserve(rawVector.size());
     for (auto rawVectorValue : rawVector) {
       value.emplace_back(Value(rawVectorValue));
@@ -315,7 +346,8 @@ bool DataManagerHdf::open(std::string name) {
 
   std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
 
-  File *file = new File(name, File::ReadWrite);
+  File *file =
+      new File(name, this->readOnly ? File::ReadOnly : File::ReadWrite);
   if (!file->isValid()) {
     delete file;
     this->openFlag = false;
@@ -339,6 +371,16 @@ bool DataManagerHdf::open(std::string name) {
 
   for (int i = 0; i < keys.size(); i++) {
     this->typeMapping[keys[i]] = static_cast<DataManagerDataType>(types[i]);
+
+    // Spectra, that have already been set up, come with their frequencies.
+    if (types[i] == DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM &&
+        file->exist("/data/" + keys[i] + "/spectrumMapping")) {
+      file->getDataSet("/data/" + keys[i] + "/spectrumMapping")
+          .read(this->spectrumMapping[keys[i]]);
+    }
+    if (types[i] == DataManagerDataType::DATAMANAGER_DATA_TYPE_STRING) {
+      this->loadStringDictionary(keys[i]);
+    }
   }
 
   return true;
@@ -434,11 +476,7 @@ bool DataManagerHdf::open(std::string name, KeyMapping keyMapping, bool force) {
         file->createDataSet("/data/" + keyValuePair.first + "/values",
                             dataspaceValue, create_datatype<double>(), props);
       } else if (keyValuePair.second == DATAMANAGER_DATA_TYPE_STRING) {
-        DataSpace dataspace = DataSpace({0, 1}, {DataSpace::UNLIMITED, 1});
-        file->createDataSet("/data/" + keyValuePair.first + "/timestamps",
-                            dataspace, create_datatype<long long>(), props);
-        file->createDataSet("/data/" + keyValuePair.first + "/values",
-                            dataspace, create_datatype<std::string>(), props);
+        this->createStringDataSets(keyValuePair.first, props);
       } else if (keyValuePair.second == DATAMANAGER_DATA_TYPE_SPECTRUM) {
         // Nothing to do. Datasets will be created in setupSpectrumSpecific().
       } else {
@@ -490,6 +528,10 @@ bool DataManagerHdf::open(std::string name, KeyMapping keyMapping, bool force) {
         dataSetSpectrumMapping.read(spectrum);
         this->spectrumMapping[keys[i]] = spectrum;
       }
+      // If the current key corresponds to a string, read its dictionary.
+      if (types[i] == DataManagerDataType::DATAMANAGER_DATA_TYPE_STRING) {
+        this->loadStringDictionary(keys[i]);
+      }
     }
   }
 
@@ -505,10 +547,32 @@ bool DataManagerHdf::close() {
 
   this->hdfFile.reset();
   this->typeMapping.clear();
+  this->stringDictionaries.clear();
+  this->stringCodes.clear();
+
+  return true;
+}
+
+bool DataManagerHdf::flush() {
+  if (!this->isOpen()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+  if (!this->hdfFile) {
+    return false;
+  }
+  this->hdfFile->flush();
 
   return true;
 }
 
+void DataManagerHdf::setReadOnly(bool readOnly) { this->readOnly = readOnly; }
+
+void DataManagerHdf::setAutoFlush(bool autoFlush) {
+  this->autoFlush = autoFlush;
+}
+
 DataManagerType DataManagerHdf::getDataManagerType() const {
   return DataManagerType::DATAMANAGER_TYPE_HDF;
 }
@@ -554,9 +618,19 @@ bool DataManagerHdf::extendingWrite(const std::vector<TimePoint> &timestamp,
   std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
 
   size_t extendSize = timestamp.size();
+  DataManagerDataType dataType = this->typeMapping[key];
+
+  // Encode the strings before the datasets are extended, so invalid values do
+  // not leave rows without a valid code behind.
+  std::vector<int> codeVector;
+  if (DATAMANAGER_DATA_TYPE_STRING == dataType &&
+      this->isDictionaryEncoded(key)) {
+    if (!this->encodeStrings(key, value, codeVector)) {
+      return false;
+    }
+  }
 
   // Extend the dataset, depending on the held data type.
-  DataManagerDataType dataType = this->typeMapping[key];
   size_t newIdx;
   this->extendDataSet("/data/" + key + "/values", extendSize);
   newIdx = this->extendDataSet("/data/" + key + +"/timestamps", extendSize);
@@ -600,9 +674,13 @@ bool DataManagerHdf::extendingWrite(const std::vector<TimePoint> &timestamp,
 
   else if (DATAMANAGER_DATA_TYPE_STRING == dataType) {
     DataSet dataset = this->hdfFile->getDataSet("/data/" + key + "/values");
-    std::vector<std::string> valueVector;
-    this->transformValueVector(value, valueVector);
-    dataset.select({newIdx, 0}, {extendSize, 1}).write(valueVector);
+    if (this->isDictionaryEncoded(key)) {
+      dataset.select({newIdx, 0}, {extendSize, 1}).write(codeVector);
+    } else {
+      std::vector<std::string> valueVector;
+      this->transformValueVector(value, valueVector);
+      dataset.select({newIdx, 0}, {extendSize, 1}).write(valueVector);
+    }
   }
 
   else if (DATAMANAGER_DATA_TYPE_SPECTRUM == dataType) {
@@ -620,7 +698,9 @@ bool DataManagerHdf::extendingWrite(const std::vector<TimePoint> &timestamp,
     return false;
   }
 
-  this->hdfFile->flush();
+  if (this->autoFlush) {
+    this->hdfFile->flush();
+  }
   return true;
 }
 
@@ -665,11 +745,7 @@ bool DataManagerHdf::createKey(std::string key, DataManagerDataType dataType) {
     this->hdfFile->createDataSet("/data/" + key + "/values", dataspaceValue,
                                  create_datatype<double>(), props);
   } else if (dataType == DATAMANAGER_DATA_TYPE_STRING) {
-    DataSpace dataspace = DataSpace({0, 1}, {DataSpace::UNLIMITED, 1});
-    this->hdfFile->createDataSet("/data/" + key + "/timestamps", dataspace,
-                                 create_datatype<long long>(), props);
-    this->hdfFile->createDataSet("/data/" + key + "/values", dataspace,
-                                 create_datatype<std::string>(), props);
+    this->createStringDataSets(key, props);
   } else if (dataType == DATAMANAGER_DATA_TYPE_SPECTRUM) {
     // Dataset will be created in setupSpectrumSpecific(). For now, create the
     // node.
@@ -693,7 +769,9 @@ bool DataManagerHdf::createKey(std::string key, DataManagerDataType dataType) {
   this->extendDataSet("/struct/types", 1);
   typeDataset.write(types);
 
-  this->hdfFile->flush();
+  if (this->autoFlush) {
+    this->hdfFile->flush();
+  }
 
   return true;
 }
@@ -722,6 +800,143 @@ bool DataManagerHdf::transformTimestampVector(
   return true;
 }
 
+void DataManagerHdf::createStringDataSets(const std::string &key,
+                                          const DataSetCreateProps &props) {
+  // The timestamps and the codes are stored just like an integer key.
+  DataSpace dataspace = DataSpace({0, 1}, {DataSpace::UNLIMITED, 1});
+  this->hdfFile->createDataSet("/data/" + key + "/timestamps", dataspace,
+                               create_datatype<long long>(), props);
+  this->hdfFile->createDataSet("/data/" + key + "/values", dataspace,
+                               create_datatype<int>(), props);
+
+  // The dictionary holds each distinct string exactly once.
+  DataSetCreateProps propsDictionary;
+  propsDictionary.add(
+      Chunking(std::vector<hsize_t>{this->dictionaryChunkingSize, 1}));
+  DataSpace dataspaceDictionary = DataSpace({0, 1}, {DataSpace::UNLIMITED, 1});
+  this->hdfFile->createDataSet("/data/" + key + "/dictionary",
+                               dataspaceDictionary,
+                               create_datatype<std::string>(), propsDictionary);
+
+  this->stringDictionaries[key] = std::vector<std::string>();
+  this->stringCodes[key] = std::unordered_map<std::string, int>();
+}
+
+void DataManagerHdf::loadStringDictionary(const std::string &key) {
+  // Files that have been written before the introduction of dictionaries hold
+  // the strings directly in the value dataset.
+  if (!this->hdfFile->exist("/data/" + key + "/dictionary")) {
+    return;
+  }
+
+  DataSet datasetDictionary =
+      this->hdfFile->getDataSet("/data/" + key + "/dictionary");
+  std::vector<std::string> dictionary;
+  if (datasetDictionary.getElementCount() > 0) {
+    datasetDictionary.read(dictionary);
+  }
+
+  std::unordered_map<std::string, int> codes;
+  codes.reserve(dictionary.size());
+  for (int i = 0; i < dictionary.size(); i++) {
+    codes[dictionary[i]] = i;
+  }
+
+  this->stringDictionaries[key] = std::move(dictionary);
+  this->stringCodes[key] = std::move(codes);
+}
+
+bool DataManagerHdf::encodeStrings(const std::string &key,
+                                   const std::vector<Value> &origVec,
+                                   std::vector<int> &codes) {
+  if (!this->isDictionaryEncoded(key)) {
+    return false;
+  }
+
+  std::vector<std::string> &dictionary = this->stringDictionaries[key];
+  std::unordered_map<std::string, int> &dictionaryCodes =
+      this->stringCodes[key];
+  size_t oldDictionarySize = dictionary.size();
+
+  // Strings, that are not yet part of the dictionary, are collected first and
+  // only added to the dictionary in memory, once they have been written to the
+  // file.
+  std::vector<std::string> newStrings;
+  std::unordered_map<std::string, int> newCodes;
+  codes.reserve(origVec.size());
+  for (auto &origVecValue : origVec) {
+    const std::string *str = std::get_if<std::string>(&origVecValue);
+    if (!str) {
+      LOG(ERROR) << "Value of string key " << key << " is not a string.";
+      return false;
+    }
+
+    auto it = dictionaryCodes.find(*str);
+    if (it != dictionaryCodes.end()) {
+      codes.push_back(it->second);
+      continue;
+    }
+    auto newIt = newCodes.find(*str);
+    if (newIt != newCodes.end()) {
+      codes.push_back(newIt->second);
+      continue;
+    }
+
+    int code = static_cast<int>(oldDictionarySize + newStrings.size());
+    newStrings.push_back(*str);
+    newCodes[*str] = code;
+    codes.push_back(code);
+  }
+
+  // Persist the new strings. The dataset is resized to the size of the
+  // dictionary in memory, so rows of an earlier failed write are overwritten.
+  if (!newStrings.empty()) {
+    try {
+      DataSet datasetDictionary =
+          this->hdfFile->getDataSet("/data/" + key + "/dictionary");
+      datasetDictionary.resize({oldDictionarySize + newStrings.size(), 1});
+      datasetDictionary.select({oldDictionarySize, 0}, {newStrings.size(), 1})
+          .write(newStrings);
+    } catch (HighFive::Exception &e) {
+      LOG(ERROR) << "Could not write the dictionary of key " << key << ": "
+                 << e.what();
+      return false;
+    }
+  }
+
+  dictionary.insert(dictionary.end(),
+                    std::make_move_iterator(newStrings.begin()),
+                    std::make_move_iterator(newStrings.end()));
+  dictionaryCodes.merge(newCodes);
+
+  return true;
+}
+
+bool DataManagerHdf::decodeStrings(const std::string &key,
+                                   const std::vector<int> &codes,
+                                   std::vector<std::string> &strings) {
+  if (!this->isDictionaryEncoded(key)) {
+    return false;
+  }
+
+  const std::vector<std::string> &dictionary = this->stringDictionaries[key];
+  strings.reserve(codes.size());
+  for (int code : codes) {
+    if (code < 0 || code >= dictionary.size()) {
+      LOG(ERROR) << "Invalid dictionary code " << code << " in key " << key
+                 << ".";
+      return false;
+    }
+    strings.push_back(dictionary[code]);
+  }
+
+  return true;
+}
+
+bool DataManagerHdf::isDictionaryEncoded(const std::string &key) const {
+  return this->stringDictionaries.contains(key);
+}
+
 bool DataManagerHdf::setupSpectrumSpecific(std::string key,
                                            std::vector<double> frequencies) {
   if (!this->isOpen()) {
@@ -752,7 +967,9 @@ bool DataManagerHdf::setupSpectrumSpecific(std::string key,
       create_datatype<double>());
 
   datasetSpectrumMapping.write(frequencies);
-  this->hdfFile->flush();
+  if (this->autoFlush) {
+    this->hdfFile->flush();
+  }
 
   return true;
 }
@@ -829,185 +1046,1010 @@ DataManagerHdf::filterMeasurements(std::vector<std::string> &groupNames) {
   return retVal;
 }
 
-void DataManagerHdf::printImpdedanceSpectrum(std::stringstream &ss,
-                                             HighFive::DataSet &spectrumMapping,
-                                             HighFive::DataSet &timestamp,
-                                             HighFive::DataSet &spectra,
-                                             const std::string &impdenaceFormat,
-                                             char separator) {
+template <class T>
+void DataManagerHdf::readRows(DataSet &dataset, size_t offset, size_t count,
+                              std::vector<T> &values) {
+  std::vector<size_t> dimensions;
+  {
+    std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+    dimensions = dataset.getDimensions();
+  }
+
+  size_t elementCount = count;
+  for (size_t i = 1; i < dimensions.size(); i++) {
+    elementCount *= dimensions[i];
+  }
+  values.resize(elementCount);
+  this->readRows(dataset, offset, count, values.data());
+}
+
+template <class T>
+void DataManagerHdf::readRows(DataSet &dataset, size_t offset, size_t count,
+                              T *values) {
+  std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+
+  std::vector<size_t> offsets(dataset.getDimensions().size(), 0);
+  std::vector<size_t> counts = dataset.getDimensions();
+  offsets[0] = offset;
+  counts[0] = count;
+
+  size_t elementCount = 1;
+  for (auto dimension : counts) {
+    elementCount *= dimension;
+  }
+  if (elementCount > 0) {
+    dataset.select(offsets, counts).read(values);
+  }
+}
+
+DataManagerHdf::KeyDataSets::~KeyDataSets() {
+  std::lock_guard<std::mutex> lockGuard(DataManagerHdf::dataManagerMutex);
+  this->timestamps = DataSet();
+  this->values = DataSet();
+}
+
+bool DataManagerHdf::getDataSets(const std::string &key,
+                                 KeyDataSets &dataSets) {
+  if (!this->isOpen() || !this->typeMapping.contains(key)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+  // Spectra only get their datasets, once they have been set up.
+  if (!this->hdfFile->exist("/data/" + key + "/timestamps")) {
+    return false;
+  }
+  dataSets.timestamps =
+      this->hdfFile->getDataSet("/data/" + key + "/timestamps");
+  dataSets.values = this->hdfFile->getDataSet("/data/" + key + "/values");
+
+  return true;
+}
+
+bool DataManagerHdf::findRows(const std::string &key, TimePoint from,
+                              TimePoint to, size_t &firstRow,
+                              size_t &rowCount) {
+  KeyDataSets dataSets;
+  if (!this->getDataSets(key, dataSets)) {
+    return false;
+  }
 
-  std::vector<double> spectrumMappingVec;
-  spectrumMapping.read(spectrumMappingVec);
+  auto [first, end] = this->findRows(dataSets.timestamps, from, to);
+  firstRow = first;
+  rowCount = end - first;
 
-  // Print the header.
+  return true;
+}
 
-  ss << "timestamps" << separator;
-  for (auto spectrumPoint : spectrumMappingVec) {
-    if (impdenaceFormat == "cartesian") {
-      ss << spectrumPoint << "_real" << separator << spectrumPoint << "_imag"
-         << separator;
+bool DataManagerHdf::getRowShape(const std::string &key,
+                                 std::vector<size_t> &shape) {
+  KeyDataSets dataSets;
+  if (!this->getDataSets(key, dataSets)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+  std::vector<size_t> dimensions = dataSets.values.getDimensions();
+  // Scalar values are stored with a trailing dimension of one.
+  if (dimensions.size() == 2 && dimensions[1] == 1) {
+    shape.clear();
+  } else {
+    shape.assign(dimensions.begin() + 1, dimensions.end());
+  }
+
+  return true;
+}
+
+bool DataManagerHdf::readTimestamps(const std::string &key, size_t firstRow,
+                                    size_t rowCount, long long *timestamps) {
+  KeyDataSets dataSets;
+  if (!this->getDataSets(key, dataSets)) {
+    return false;
+  }
+
+  size_t totalRowCount;
+  {
+    std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+    totalRowCount = dataSets.timestamps.getDimensions()[0];
+  }
+  if (firstRow > totalRowCount || rowCount > totalRowCount - firstRow) {
+    LOG(ERROR) << "Rows " << firstRow << " to " << firstRow + rowCount
+               << " of " << key << " do not exist.";
+    return false;
+  }
+
+  this->readRows(dataSets.timestamps, firstRow, rowCount, timestamps);
+  return true;
+}
+
+template <class T>
+bool DataManagerHdf::readValues(const std::string &key, size_t firstRow,
+                                size_t rowCount, T *values) {
+  KeyDataSets dataSets;
+  if (!this->getDataSets(key, dataSets)) {
+    return false;
+  }
+  if (this->typeMapping[key] == DATAMANAGER_DATA_TYPE_STRING) {
+    LOG(ERROR) << "Values of string key " << key
+               << " can not be read into memory.";
+    return false;
+  }
+
+  size_t totalRowCount;
+  {
+    std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+    totalRowCount = dataSets.values.getDimensions()[0];
+  }
+  if (firstRow > totalRowCount || rowCount > totalRowCount - firstRow) {
+    LOG(ERROR) << "Rows " << firstRow << " to " << firstRow + rowCount
+               << " of " << key << " do not exist.";
+    return false;
+  }
+
+  this->readRows(dataSets.values, firstRow, rowCount, values);
+  return true;
+}
+
+template bool DataManagerHdf::readValues<int>(const std::string &, size_t,
+                                              size_t, int *);
+template bool DataManagerHdf::readValues<long long>(const std::string &,
+                                                    size_t, size_t,
+                                                    long long *);
+template bool DataManagerHdf::readValues<double>(const std::string &, size_t,
+                                                 size_t, double *);
+
+size_t DataManagerHdf::lowerBound(DataSet &timestamps, size_t rowCount,
+                                  long long timestamp) {
+  // The timestamps are stored in ascending order, hence a binary search only
+  // has to read a logarithmic count of single timestamps.
+  size_t first = 0;
+  size_t last = rowCount;
+  std::vector<long long> probe;
+  while (first < last) {
+    size_t middle = first + (last - first) / 2;
+    this->readRows(timestamps, middle, 1, probe);
+    if (probe.front() < timestamp) {
+      first = middle + 1;
     } else {
-      ss << spectrumPoint << "_value" << separator << spectrumPoint << "_phase"
-         << separator;
+      last = middle;
     }
   }
-  ss << std::endl;
 
-  auto dims = timestamp.getDimensions();
-  for (size_t i = 0; i < dims[0]; i++) {
+  return first;
+}
 
-    auto timestampInt = timestamp.select({i, 0}, {1, 1}).read<long long>();
-    auto spectrumArray =
-        spectra.select({i, 0, 0}, {1, spectrumMappingVec.size(), 2})
-            .read<std::vector<std::vector<std::vector<double>>>>();
+std::pair<size_t, size_t> DataManagerHdf::findRows(DataSet &timestamps,
+                                                   TimePoint from,
+                                                   TimePoint to) {
+  if (from > to) {
+    return {0, 0};
+  }
+  size_t rowCount;
+  {
+    std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+    rowCount = timestamps.getDimensions()[0];
+  }
 
-    ss << timestampInt << separator;
+  size_t first = 0;
+  if (from != TimePoint::min()) {
+    first =
+        this->lowerBound(timestamps, rowCount, from.time_since_epoch().count());
+  }
+  size_t last = rowCount;
+  if (to != TimePoint::max()) {
+    last = this->lowerBound(timestamps, rowCount,
+                            to.time_since_epoch().count() + 1);
+  }
+
+  return {first, std::max(first, last)};
+}
+
+namespace {
+/**
+ * @brief Returns the size of the blocks, that are read during an export. The
+ * size is a multiple of the decimation factor, so that no block boundary
+ * splits a set of rows, that is decimated into one.
+ * @param options The options of the export.
+ * @return The block size.
+ */
+size_t getExportBlockSize(const ExportOptions &options) {
+  size_t blockSize = std::max<size_t>(options.blockSize, 1);
+  if (options.decimation == EXPORT_DECIMATION_NONE) {
+    return blockSize;
+  }
+
+  size_t factor = std::max<size_t>(options.decimationFactor, 1);
+  return (blockSize + factor - 1) / factor * factor;
+}
+
+/**
+ * @brief Decimates a block of rows in place.
+ * @param timestamps The timestamps of the rows.
+ * @param values The values of the rows. Holds width values per row.
+ * @param width The count of values per row.
+ * @param options The options of the export.
+ */
+void decimateBlock(std::vector<long long> &timestamps,
+                   std::vector<double> &values, size_t width,
+                   const ExportOptions &options) {
+  size_t factor = std::max<size_t>(options.decimationFactor, 1);
+  if (options.decimation == EXPORT_DECIMATION_NONE || factor == 1) {
+    return;
+  }
 
-    if (impdenaceFormat == "cartesian") {
-      for (auto frequencyTuple : spectrumArray[0]) {
-        ss << frequencyTuple[0] << separator << frequencyTuple[1] << separator;
+  size_t rowCount = timestamps.size();
+  size_t decimatedCount = 0;
+  for (size_t row = 0; row < rowCount; row += factor) {
+    timestamps[decimatedCount] = timestamps[row];
+
+    double *decimatedValues = values.data() + decimatedCount * width;
+    const double *rowValues = values.data() + row * width;
+    if (options.decimation == EXPORT_DECIMATION_MEAN) {
+      // The last bucket may be incomplete. Its mean is built from the rows it
+      // actually contains.
+      size_t bucketSize = std::min(factor, rowCount - row);
+      for (size_t i = 0; i < width; i++) {
+        double sum = 0.0;
+        for (size_t j = 0; j < bucketSize; j++) {
+          sum += rowValues[j * width + i];
+        }
+        decimatedValues[i] = sum / bucketSize;
       }
     } else {
-      for (auto frequencyTuple : spectrumArray[0]) {
-        double value = std::sqrt(frequencyTuple[0] * frequencyTuple[0] +
-                                 frequencyTuple[1] * frequencyTuple[1]);
-        double phase = std::atan(frequencyTuple[1] / frequencyTuple[0]);
+      std::copy(rowValues, rowValues + width, decimatedValues);
+    }
+    decimatedCount++;
+  }
 
-        ss << value << separator << phase << separator;
-      }
+  timestamps.resize(decimatedCount);
+  values.resize(decimatedCount * width);
+}
+
+/**
+ * @brief Sequential access to a series of timestamps and values, that is read
+ * block by block.
+ */
+class SeriesCursor {
+public:
+  /// Reads a block of rows, given the offset and count of rows.
+  typedef std::function<void(size_t, size_t, std::vector<long long> &,
+                             std::vector<double> &)>
+      BlockLoader;
+
+  SeriesCursor(size_t firstRow, size_t endRow, size_t blockSize,
+               BlockLoader loader)
+      : endRow(endRow), blockSize(std::max<size_t>(blockSize, 1)),
+        loader(loader), index(firstRow), bufferStart(firstRow) {
+    this->load();
+  }
+
+  bool atEnd() const { return this->index >= this->endRow; }
+
+  long long timestamp() const {
+    return this->timestampBuffer[this->index - this->bufferStart];
+  }
+
+  double value() const {
+    return this->valueBuffer[this->index - this->bufferStart];
+  }
+
+  void next() {
+    this->index++;
+    if (this->index - this->bufferStart >= this->timestampBuffer.size()) {
+      this->load();
+    }
+  }
+
+private:
+  void load() {
+    this->bufferStart = this->index;
+    this->timestampBuffer.clear();
+    this->valueBuffer.clear();
+    if (!this->atEnd()) {
+      this->loader(this->index,
+                   std::min(this->blockSize, this->endRow - this->index),
+                   this->timestampBuffer, this->valueBuffer);
     }
+  }
+
+  size_t endRow;
+  size_t blockSize;
+  BlockLoader loader;
+  size_t index = 0;
+  size_t bufferStart = 0;
+  std::vector<long long> timestampBuffer;
+  std::vector<double> valueBuffer;
+};
+} // namespace
+
+bool DataManagerHdf::exportImpedanceSpectrum(const std::string &measurement,
+                                             CsvWriter &writer,
+                                             const ExportOptions &options,
+                                             long long &lastTimestamp) {
+  std::vector<double> frequencies;
+  DataSet timestamps;
+  DataSet spectra;
+  {
+    std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+    this->hdfFile->getDataSet(measurement + "/spectrumMapping")
+        .read(frequencies);
+    timestamps = this->hdfFile->getDataSet(measurement + "/timestamps");
+    spectra = this->hdfFile->getDataSet(measurement + "/values");
+  }
+
+  bool polar = options.impedanceFormat != "cartesian";
+  std::vector<std::string> columns{"timestamps"};
+  for (auto frequency : frequencies) {
+    std::string frequencyStr;
+    CsvWriter::appendNumber(frequencyStr, frequency);
+    columns.push_back(frequencyStr + (polar ? "_value" : "_real"));
+    columns.push_back(frequencyStr + (polar ? "_phase" : "_imag"));
+  }
+  if (!writer.writeHeader(columns)) {
+    return false;
+  }
 
-    ss << std::endl;
+  auto [firstRow, endRow] =
+      this->findRows(timestamps, options.from, options.to);
+  size_t blockSize = getExportBlockSize(options);
+  for (size_t offset = firstRow; offset < endRow; offset += blockSize) {
+    size_t count = std::min(blockSize, endRow - offset);
+
+    std::vector<long long> timestampBlock;
+    std::vector<double> spectrumBlock;
+    this->readRows(timestamps, offset, count, timestampBlock);
+    this->readRows(spectra, offset, count, spectrumBlock);
+    lastTimestamp = timestampBlock.back();
+    decimateBlock(timestampBlock, spectrumBlock, 2 * frequencies.size(),
+                  options);
+    if (!writer.writeBlock(std::move(timestampBlock), std::move(spectrumBlock),
+                           2 * frequencies.size(), polar)) {
+      return false;
+    }
   }
+
+  return true;
 }
 
-void DataManagerHdf::printPumpData(std::stringstream &ss,
-                                   HighFive::DataSet &currPressureValues,
-                                   HighFive::DataSet &currPressureTimestamps,
-                                   HighFive::DataSet &setPressureValue,
-                                   HighFive::DataSet &setPressureTimestamps,
-                                   char separator) {
+bool DataManagerHdf::exportPumpData(const std::string &channel,
+                                    CsvWriter &writer,
+                                    const ExportOptions &options,
+                                    long long &lastTimestamp) {
+  DataSet currPressureTimestamps;
+  DataSet currPressureValues;
+  DataSet setPressureTimestamps;
+  DataSet setPressureValues;
+  {
+    std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+    currPressureTimestamps =
+        this->hdfFile->getDataSet(channel + "/currPressure/timestamps");
+    currPressureValues =
+        this->hdfFile->getDataSet(channel + "/currPressure/values");
+    setPressureTimestamps =
+        this->hdfFile->getDataSet(channel + "/setpoint/timestamps");
+    setPressureValues = this->hdfFile->getDataSet(channel + "/setpoint/values");
+  }
 
-  // Print the header.
-  ss << "timestamps" << separator << "current_pressure" << separator
-     << "set_pressure" << separator << std::endl;
+  if (!writer.writeHeader({"timestamps", "current_pressure", "set_pressure"})) {
+    return false;
+  }
 
-  const auto currDims = currPressureTimestamps.getDimensions();
-  const auto setDims = setPressureTimestamps.getDimensions();
+  auto makeLoader = [this](DataSet timestamps, DataSet values) {
+    return [this, timestamps, values](
+               size_t offset, size_t count,
+               std::vector<long long> &timestampBlock,
+               std::vector<double> &valueBlock) mutable {
+      this->readRows(timestamps, offset, count, timestampBlock);
+      this->readRows(values, offset, count, valueBlock);
+    };
+  };
+  size_t blockSize = getExportBlockSize(options);
+  auto [firstCurrPressure, endCurrPressure] =
+      this->findRows(currPressureTimestamps, options.from, options.to);
+  auto [firstSetPressure, endSetPressure] =
+      this->findRows(setPressureTimestamps, options.from, options.to);
+  SeriesCursor currPressure(firstCurrPressure, endCurrPressure, blockSize,
+                            makeLoader(currPressureTimestamps,
+                                       currPressureValues));
+  SeriesCursor setPressure(firstSetPressure, endSetPressure, blockSize,
+                           makeLoader(setPressureTimestamps,
+                                      setPressureValues));
+
+  // Start with the values, that have been valid at the start of the time
+  // frame.
   double actualSetPressure = 0.0;
   double actualCurrentPressure = 0.0;
-  size_t actualSetPressureIdx = 0;
-  size_t actualCurrentPressureIdx = 0;
-  auto actualSetPressureTimestamp =
-      setPressureTimestamps.select({actualSetPressureIdx, 0}, {1, 1})
-          .read<long long>();
-  bool noMoreSetTimestamps = false;
+  std::vector<double> initialValue;
+  if (firstCurrPressure > 0) {
+    this->readRows(currPressureValues, firstCurrPressure - 1, 1, initialValue);
+    actualCurrentPressure = initialValue.front();
+  }
+  if (firstSetPressure > 0) {
+    this->readRows(setPressureValues, firstSetPressure - 1, 1, initialValue);
+    actualSetPressure = initialValue.front();
+  }
 
-  // Run as long as there are current pressure values to print.
-  while (actualCurrentPressureIdx < currDims[0]) {
-    // Get the current pressure timestamp.
-    const auto currPressureTimestamp =
-        currPressureTimestamps.select({actualCurrentPressureIdx, 0}, {1, 1})
-            .read<long long>();
+  std::vector<long long> timestampBlock;
+  std::vector<double> valueBlock;
+  auto appendRow = [&](long long timestamp) {
+    lastTimestamp = timestamp;
+    timestampBlock.push_back(timestamp);
+    valueBlock.push_back(actualCurrentPressure);
+    valueBlock.push_back(actualSetPressure);
+    if (timestampBlock.size() < blockSize) {
+      return true;
+    }
+    decimateBlock(timestampBlock, valueBlock, 2, options);
+    bool writeSuccess = writer.writeBlock(std::move(timestampBlock),
+                                          std::move(valueBlock), 2);
+    timestampBlock.clear();
+    valueBlock.clear();
+    return writeSuccess;
+  };
 
+  // Run as long as there are current pressure values to print.
+  while (!currPressure.atEnd()) {
     // Is the current pressure timestamp older than the actual set pressure
     // timestamp?
-    if (currPressureTimestamp <= actualSetPressureTimestamp ||
-        noMoreSetTimestamps) {
-      // It is. Print the actual current pressure value and print set old set
-      // pressure value.
-      actualCurrentPressure =
-          currPressureValues.select({actualCurrentPressureIdx, 0}, {1, 1})
-              .read<double>();
-      ss << currPressureTimestamp << separator << actualCurrentPressure
-         << separator << actualSetPressure << separator << std::endl;
-
-      actualCurrentPressureIdx++;
+    if (setPressure.atEnd() ||
+        currPressure.timestamp() <= setPressure.timestamp()) {
+      // It is. Print the actual current pressure value together with the old
+      // set pressure value.
+      actualCurrentPressure = currPressure.value();
+      if (!appendRow(currPressure.timestamp())) {
+        return false;
+      }
+      currPressure.next();
     } else {
-      // It is not. Fetch a new set pressure and print it. Use the old current
+      // It is not. Print the new set pressure together with the old current
       // pressure value.
-      actualSetPressure =
-          setPressureValue.select({actualSetPressureIdx, 0}, {1, 1})
-              .read<double>();
-      ss << actualSetPressureTimestamp << separator << actualCurrentPressure
-         << separator << actualSetPressure << separator << std::endl;
-
-      if (actualSetPressureIdx < setDims[0] - 1) {
-        actualSetPressureIdx++;
-        actualSetPressureTimestamp =
-            setPressureTimestamps.select({actualSetPressureIdx, 0}, {1, 1})
-                .read<long long>();
-      } else {
-        noMoreSetTimestamps = true;
+      actualSetPressure = setPressure.value();
+      if (!appendRow(setPressure.timestamp())) {
+        return false;
+      }
+      setPressure.next();
+    }
+  }
+
+  if (timestampBlock.empty()) {
+    return true;
+  }
+  decimateBlock(timestampBlock, valueBlock, 2, options);
+  return writer.writeBlock(std::move(timestampBlock), std::move(valueBlock), 2);
+}
+
+namespace {
+/**
+ * @brief Loads the checkpoint of an incremental export.
+ * @param fileName The name of the checkpoint file. A missing file is treated
+ * as empty checkpoint.
+ * @param checkpoint Will contain the last exported timestamp of every output.
+ * @return TRUE if the checkpoint has been loaded. FALSE otherwise.
+ */
+bool loadCheckpoint(const std::string &fileName,
+                    std::map<std::string, long long> &checkpoint) {
+  checkpoint.clear();
+  if (!std::filesystem::exists(fileName)) {
+    return true;
+  }
+
+  std::ifstream checkpointStream(fileName);
+  std::string line;
+  if (!std::getline(checkpointStream, line) ||
+      line != EXPORT_CHECKPOINT_HEADER) {
+    LOG(ERROR) << fileName << " is not an export checkpoint.";
+    return false;
+  }
+
+  while (std::getline(checkpointStream, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    // The output name is the last field, as it may contain arbitrary
+    // characters.
+    std::istringstream lineStream(line);
+    long long lastTimestamp;
+    lineStream >> lastTimestamp;
+    lineStream.get();
+    std::string outputName;
+    std::getline(lineStream, outputName);
+    if (lineStream.fail() || outputName.empty()) {
+      LOG(ERROR) << "Malformed checkpoint entry: " << line;
+      return false;
+    }
+    checkpoint[outputName] = lastTimestamp;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Saves the checkpoint of an incremental export. The file is replaced
+ * atomically, so an interrupted export never leaves a partial checkpoint.
+ * @param fileName The name of the checkpoint file.
+ * @param checkpoint The last exported timestamp of every output.
+ * @return TRUE if the checkpoint has been saved. FALSE otherwise.
+ */
+bool saveCheckpoint(const std::string &fileName,
+                    const std::map<std::string, long long> &checkpoint) {
+  std::string tmpFileName = fileName + ".tmp";
+  {
+    std::ofstream checkpointStream(tmpFileName, std::ios::trunc);
+    checkpointStream << EXPORT_CHECKPOINT_HEADER << "\n";
+    for (auto &entry : checkpoint) {
+      checkpointStream << entry.second << "\t" << entry.first << "\n";
+    }
+    if (!checkpointStream.good()) {
+      LOG(ERROR) << "Could not write " << tmpFileName << ".";
+      return false;
+    }
+  }
+
+  std::error_code errorCode;
+  std::filesystem::rename(tmpFileName, fileName, errorCode);
+  if (errorCode) {
+    LOG(ERROR) << "Could not replace " << fileName << ": "
+               << errorCode.message();
+    return false;
+  }
+
+  return true;
+}
+} // namespace
+
+bool DataManagerHdf::selectMeasurements(
+    const ExportOptions &options,
+    std::map<std::string, Devices::DeviceType> &measurements) {
+  {
+    std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+    Group rootNode = this->hdfFile->getGroup("/data");
+    std::vector<std::string> groupNames;
+    traverseNodes(rootNode, groupNames);
+    measurements = filterMeasurements(groupNames);
+  }
+
+  std::regex keyFilter;
+  try {
+    keyFilter = std::regex(options.keyFilter);
+  } catch (std::regex_error &e) {
+    LOG(ERROR) << "Invalid key filter " << options.keyFilter << ": "
+               << e.what();
+    return false;
+  }
+  std::erase_if(measurements, [&options, &keyFilter](const auto &measurement) {
+    std::string name = measurement.first.substr(std::string("/data/").size());
+    return (options.deviceType != Devices::DeviceType::INVALID &&
+            measurement.second != options.deviceType) ||
+           !std::regex_search(name, keyFilter);
+  });
+
+  return true;
+}
+
+bool DataManagerHdf::writeToCsv(const std::string &directory,
+                                const ExportOptions &options) {
+  if (!this->isOpen()) {
+    return false;
+  }
+
+  std::map<std::string, Devices::DeviceType> measurements;
+  if (!this->selectMeasurements(options, measurements)) {
+    return false;
+  }
+
+  bool incremental = !options.checkpointFile.empty();
+  std::map<std::string, long long> checkpoint;
+  if (incremental && !loadCheckpoint(options.checkpointFile, checkpoint)) {
+    return false;
+  }
+
+  unsigned int jobCount = options.jobCount > 0
+                              ? options.jobCount
+                              : std::thread::hardware_concurrency();
+  ThreadPool threadPool(jobCount);
+  // Allow every thread to work on a block, while the next ones are read.
+  size_t maxPendingBlocks = 2 * threadPool.getThreadCount();
+
+  // Exports one output file. An output, that has been recorded by the
+  // checkpoint, is continued behind its last exported row.
+  typedef std::function<bool(CsvWriter &, const ExportOptions &, long long &)>
+      ExportFunction;
+  size_t fileCount = 0;
+  auto exportFile = [&](const std::string &name,
+                        ExportFunction exportFunction) {
+    std::string fileName =
+        (std::filesystem::path(directory) /
+         (Utilities::split(name, '/').back() + ".csv"))
+            .string();
+    std::string outputName =
+        std::filesystem::path(fileName).filename().string();
+
+    ExportOptions fileOptions = options;
+    long long lastTimestamp = std::numeric_limits<long long>::min();
+    bool append = incremental && checkpoint.contains(outputName) &&
+                  std::filesystem::exists(fileName);
+    if (append) {
+      lastTimestamp = checkpoint[outputName];
+      fileOptions.from =
+          std::max(options.from, TimePoint(Duration(lastTimestamp + 1)));
+    }
+
+    std::error_code errorCode;
+    uintmax_t previousSize =
+        append ? std::filesystem::file_size(fileName, errorCode) : 0;
+    if (errorCode) {
+      LOG(ERROR) << "Could not determine the size of " << fileName << ": "
+                 << errorCode.message();
+      return false;
+    }
+
+    bool exported = false;
+    {
+      CsvWriter writer(threadPool, options.separator, maxPendingBlocks);
+      LOG(INFO) << (append ? "Appending to " : "Writing to ") << fileName;
+      fileCount++;
+      try {
+        exported = writer.open(fileName, append) &&
+                   exportFunction(writer, fileOptions, lastTimestamp) &&
+                   writer.close();
+      } catch (HighFive::Exception &e) {
+        LOG(ERROR) << "Could not export " << name << ": " << e.what();
+      }
+    }
+
+    // Record the output right away, so outputs, that have been exported, are
+    // not appended again, if a later one fails.
+    if (exported && incremental &&
+        lastTimestamp != std::numeric_limits<long long>::min()) {
+      std::map<std::string, long long> previousCheckpoint = checkpoint;
+      checkpoint[outputName] = lastTimestamp;
+      if (!saveCheckpoint(options.checkpointFile, checkpoint)) {
+        checkpoint = previousCheckpoint;
+        exported = false;
+      }
+    }
+
+    // Drop the rows of a failed export, as the checkpoint does not cover them.
+    // Otherwise, the next incremental export would append them again.
+    if (!exported && append) {
+      std::filesystem::resize_file(fileName, previousSize, errorCode);
+      if (errorCode) {
+        LOG(ERROR) << "Could not restore " << fileName << ": "
+                   << errorCode.message();
+      }
+    }
+
+    return exported;
+  };
+
+  bool success = true;
+  for (auto &measurement : measurements) {
+    try {
+      if (measurement.second == Devices::DeviceType::IMPEDANCE_SPECTROMETER) {
+        success &= exportFile(
+            measurement.first,
+            [this, &measurement](CsvWriter &writer,
+                                 const ExportOptions &fileOptions,
+                                 long long &lastTimestamp) {
+              return this->exportImpedanceSpectrum(
+                  measurement.first, writer, fileOptions, lastTimestamp);
+            });
+      } else if (measurement.second == Devices::DeviceType::PUMP_CONTROLLER) {
+        constexpr size_t COUNT_CHANNELS = 4;
+        for (size_t i = 1; i <= COUNT_CHANNELS; i++) {
+          std::string channel =
+              measurement.first + "/channel" + std::to_string(i);
+          success &= exportFile(
+              measurement.first + "_ch" + std::to_string(i),
+              [this, &channel](CsvWriter &writer,
+                               const ExportOptions &fileOptions,
+                               long long &lastTimestamp) {
+                return this->exportPumpData(channel, writer, fileOptions,
+                                            lastTimestamp);
+              });
+        }
       }
+    } catch (HighFive::Exception &e) {
+      LOG(ERROR) << "Could not export " << measurement.first << ": "
+                 << e.what();
+      success = false;
+    }
+  }
+
+  LOG(INFO) << "Wrote to " << fileCount << " files.";
+  return success;
+}
+
+bool DataManagerHdf::exportNumpySeries(NumpyWriter &writer,
+                                       const std::string &prefix,
+                                       DataSet &timestamps, DataSet &values,
+                                       const std::string &descr,
+                                       const std::vector<size_t> &rowShape,
+                                       const ExportOptions &options) {
+  auto [firstRow, endRow] =
+      this->findRows(timestamps, options.from, options.to);
+  size_t blockSize = getExportBlockSize(options);
+  size_t rowCount = endRow - firstRow;
+  if (options.decimation != EXPORT_DECIMATION_NONE) {
+    size_t factor = std::max<size_t>(options.decimationFactor, 1);
+    rowCount = (rowCount + factor - 1) / factor;
+  }
+
+  size_t width = 1;
+  for (size_t i = 1; i < values.getDimensions().size(); i++) {
+    width *= values.getDimensions()[i];
+  }
+  std::vector<size_t> valueShape{rowCount};
+  valueShape.insert(valueShape.end(), rowShape.begin(), rowShape.end());
+
+  // The arrays of an archive are written one after the other, hence the
+  // timestamps are read twice. Reading them is cheap compared to the values.
+  std::vector<long long> timestampBlock;
+  std::vector<double> valueBlock;
+  if (!writer.beginArray(prefix + "timestamps", NumpyWriter::DESCR_INT64,
+                         {rowCount})) {
+    return false;
+  }
+  for (size_t offset = firstRow; offset < endRow; offset += blockSize) {
+    size_t count = std::min(blockSize, endRow - offset);
+    this->readRows(timestamps, offset, count, timestampBlock);
+    valueBlock.clear();
+    decimateBlock(timestampBlock, valueBlock, 0, options);
+    if (!writer.append(timestampBlock)) {
+      return false;
     }
   }
+  if (!writer.endArray()) {
+    return false;
+  }
+
+  if (!writer.beginArray(prefix + "values", descr, valueShape)) {
+    return false;
+  }
+  for (size_t offset = firstRow; offset < endRow; offset += blockSize) {
+    size_t count = std::min(blockSize, endRow - offset);
+    this->readRows(timestamps, offset, count, timestampBlock);
+    this->readRows(values, offset, count, valueBlock);
+    decimateBlock(timestampBlock, valueBlock, width, options);
+    if (!writer.append(valueBlock)) {
+      return false;
+    }
+  }
+
+  return writer.endArray();
 }
 
-bool DataManagerHdf::writeToCsv(std::map<std::string, std::stringstream *> &ss,
-                                char separator,
-                                const std::string &impedanceFormat) {
+bool DataManagerHdf::writeToNumpy(const std::string &directory,
+                                  const ExportOptions &options, bool archive) {
   if (!this->isOpen()) {
     return false;
   }
 
-  Group rootNode = this->hdfFile->getGroup("/data");
-  std::vector<std::string> groupNames;
-  traverseNodes(rootNode, groupNames);
+  std::map<std::string, Devices::DeviceType> measurements;
+  if (!this->selectMeasurements(options, measurements)) {
+    return false;
+  }
 
-  std::map<std::string, Devices::DeviceType> measurements =
-      filterMeasurements(groupNames);
+  auto getName = [&directory, archive](const std::string &name) {
+    return (std::filesystem::path(directory) /
+            (Utilities::split(name, '/').back() + (archive ? ".npz" : "")))
+        .string();
+  };
 
+  bool success = true;
+  size_t fileCount = 0;
   for (auto &measurement : measurements) {
+    try {
+      if (measurement.second == Devices::DeviceType::IMPEDANCE_SPECTROMETER) {
+        std::vector<double> frequencies;
+        DataSet timestamps;
+        DataSet spectra;
+        {
+          std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+          this->hdfFile->getDataSet(measurement.first + "/spectrumMapping")
+              .read(frequencies);
+          timestamps =
+              this->hdfFile->getDataSet(measurement.first + "/timestamps");
+          spectra = this->hdfFile->getDataSet(measurement.first + "/values");
+        }
 
-    if (measurement.second == Devices::DeviceType::IMPEDANCE_SPECTROMETER) {
-      std::stringstream *currentStream = new std::stringstream();
-
-      DataSet spectrumMapping =
-          this->hdfFile->getDataSet(measurement.first + "/spectrumMapping");
-      DataSet timestamps =
-          this->hdfFile->getDataSet(measurement.first + "/timestamps");
-      DataSet spectra =
-          this->hdfFile->getDataSet(measurement.first + "/values");
-      this->printImpdedanceSpectrum(*currentStream, spectrumMapping, timestamps,
-                                    spectra, impedanceFormat, separator);
-
-      ss[measurement.first] = currentStream;
-    } else if (measurement.second == Devices::DeviceType::PUMP_CONTROLLER) {
-
-      constexpr size_t COUNT_CHANNELS = 4;
-      for (size_t i = 1; i <= COUNT_CHANNELS; i++) {
-        std::stringstream *currentStream = new std::stringstream();
-
-        DataSet currPressTimestamps = this->hdfFile->getDataSet(
-            measurement.first + "/channel" + std::to_string(i) +
-            "/currPressure/timestamps");
-        DataSet currPressValues = this->hdfFile->getDataSet(
-            measurement.first + "/channel" + std::to_string(i) +
-            "/currPressure/values");
-        DataSet setPressTimestamps = this->hdfFile->getDataSet(
-            measurement.first + "/channel" + std::to_string(i) +
-            "/setpoint/timestamps");
-        DataSet setPressValues =
-            this->hdfFile->getDataSet(measurement.first + "/channel" +
-                                      std::to_string(i) + "/setpoint/values");
-
-        this->printPumpData(*currentStream, currPressValues,
-                            currPressTimestamps, setPressValues,
-                            setPressTimestamps, separator);
-
-        ss[measurement.first + "_ch" + std::to_string(i)] = currentStream;
+        // The real and imaginary parts of a spectrum are stored interleaved,
+        // which is the memory layout of a NumPy complex matrix.
+        NumpyWriter writer;
+        std::string name = getName(measurement.first);
+        LOG(INFO) << "Writing to " << name;
+        success &= writer.open(name, archive) &&
+                   writer.beginArray("frequencies", NumpyWriter::DESCR_FLOAT64,
+                                     {frequencies.size()}) &&
+                   writer.append(frequencies) && writer.endArray() &&
+                   this->exportNumpySeries(writer, "", timestamps, spectra,
+                                           NumpyWriter::DESCR_COMPLEX128,
+                                           {frequencies.size()}, options) &&
+                   writer.close();
+        fileCount++;
+      } else if (measurement.second == Devices::DeviceType::PUMP_CONTROLLER) {
+        constexpr size_t COUNT_CHANNELS = 4;
+        for (size_t i = 1; i <= COUNT_CHANNELS; i++) {
+          std::string channel =
+              measurement.first + "/channel" + std::to_string(i);
+          DataSet currPressureTimestamps;
+          DataSet currPressureValues;
+          DataSet setPressureTimestamps;
+          DataSet setPressureValues;
+          {
+            std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+            currPressureTimestamps =
+                this->hdfFile->getDataSet(channel + "/currPressure/timestamps");
+            currPressureValues =
+                this->hdfFile->getDataSet(channel + "/currPressure/values");
+            setPressureTimestamps =
+                this->hdfFile->getDataSet(channel + "/setpoint/timestamps");
+            setPressureValues =
+                this->hdfFile->getDataSet(channel + "/setpoint/values");
+          }
+
+          // Both series are exported as they are, as NumPy users can align
+          // them with numpy.searchsorted().
+          NumpyWriter writer;
+          std::string name =
+              getName(measurement.first + "_ch" + std::to_string(i));
+          LOG(INFO) << "Writing to " << name;
+          success &= writer.open(name, archive) &&
+                     this->exportNumpySeries(
+                         writer, "current_pressure_", currPressureTimestamps,
+                         currPressureValues, NumpyWriter::DESCR_FLOAT64, {},
+                         options) &&
+                     this->exportNumpySeries(
+                         writer, "set_pressure_", setPressureTimestamps,
+                         setPressureValues, NumpyWriter::DESCR_FLOAT64, {},
+                         options) &&
+                     writer.close();
+          fileCount++;
+        }
       }
+    } catch (HighFive::Exception &e) {
+      LOG(ERROR) << "Could not export " << measurement.first << ": "
+                 << e.what();
+      success = false;
     }
   }
 
-  return true;
+  LOG(INFO) << "Wrote " << fileCount << " NumPy outputs.";
+  return success;
+}
+
+bool DataManagerHdf::writeToColumnar(const std::string &directory) {
+  if (!this->isOpen()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
+
+  ColumnarArchiveWriter writer;
+  if (!writer.open(directory)) {
+    return false;
+  }
+
+  for (auto &keyValuePair : this->typeMapping) {
+    const std::string &key = keyValuePair.first;
+    DataManagerDataType dataType = keyValuePair.second;
+
+    // Spectrum keys, that have never been set up, do not hold any data.
+    if (!this->hdfFile->exist("/data/" + key + "/timestamps")) {
+      continue;
+    }
+
+    std::vector<double> frequencies;
+    if (DATAMANAGER_DATA_TYPE_SPECTRUM == dataType) {
+      this->hdfFile->getDataSet("/data/" + key + "/spectrumMapping")
+          .read(frequencies);
+    }
+    if (!writer.beginKey(key, dataType, frequencies)) {
+      LOG(ERROR) << "Could not start key " << key << " in " << directory
+                 << ".";
+      return false;
+    }
+
+    DataSet datasetTimestamps =
+        this->hdfFile->getDataSet("/data/" + key + "/timestamps");
+    DataSet datasetValues =
+        this->hdfFile->getDataSet("/data/" + key + "/values");
+    size_t rowCount = datasetTimestamps.getDimensions()[0];
+    size_t frequencyCount = frequencies.size();
+
+    // Strings of files, that predate the dictionary encoding, get a dictionary
+    // built on the fly.
+    bool encodedStrings = this->isDictionaryEncoded(key);
+    std::vector<std::string> dictionary;
+    std::unordered_map<std::string, int> dictionaryCodes;
+
+    bool writeSuccess = true;
+    for (size_t i = 0; i < rowCount && writeSuccess;
+         i += this->defaultChunkingSize) {
+      size_t elementCount = std::min<size_t>(this->defaultChunkingSize,
+                                             rowCount - i);
+
+      std::vector<long long> timestampVector;
+      datasetTimestamps.select({i, 0}, {elementCount, 1})
+          .read(timestampVector);
+      writeSuccess = writer.appendTimestamps(timestampVector);
+
+      if (DATAMANAGER_DATA_TYPE_INT == dataType ||
+          (DATAMANAGER_DATA_TYPE_STRING == dataType && encodedStrings)) {
+        std::vector<int> valueVector;
+        datasetValues.select({i, 0}, {elementCount, 1}).read(valueVector);
+        writeSuccess &= writer.appendValues(valueVector);
+      } else if (DATAMANAGER_DATA_TYPE_DOUBLE == dataType) {
+        std::vector<double> valueVector;
+        datasetValues.select({i, 0}, {elementCount, 1}).read(valueVector);
+        writeSuccess &= writer.appendValues(valueVector);
+      } else if (DATAMANAGER_DATA_TYPE_COMPLEX == dataType) {
+        std::vector<std::vector<double>> valueArray;
+        datasetValues.select({i, 0}, {elementCount, 2}).read(valueArray);
+        std::vector<double> valueVector;
+        valueVector.reserve(2 * elementCount);
+        for (auto &valuePair : valueArray) {
+          valueVector.insert(valueVector.end(), valuePair.begin(),
+                             valuePair.end());
+        }
+        writeSuccess &= writer.appendValues(valueVector);
+      } else if (DATAMANAGER_DATA_TYPE_SPECTRUM == dataType) {
+        std::vector<std::vector<std::vector<double>>> valueArray;
+        datasetValues.select({i, 0, 0}, {elementCount, frequencyCount, 2})
+            .read(valueArray);
+        std::vector<double> valueVector;
+        valueVector.reserve(2 * frequencyCount * elementCount);
+        for (auto &spectrum : valueArray) {
+          for (auto &valuePair : spectrum) {
+            valueVector.insert(valueVector.end(), valuePair.begin(),
+                               valuePair.end());
+          }
+        }
+        writeSuccess &= writer.appendValues(valueVector);
+      } else if (DATAMANAGER_DATA_TYPE_STRING == dataType) {
+        std::vector<std::string> stringVector;
+        datasetValues.select({i, 0}, {elementCount, 1}).read(stringVector);
+        std::vector<int> valueVector;
+        valueVector.reserve(elementCount);
+        for (auto &str : stringVector) {
+          auto it = dictionaryCodes.find(str);
+          if (it == dictionaryCodes.end()) {
+            it = dictionaryCodes.emplace(str, dictionary.size()).first;
+            dictionary.push_back(str);
+          }
+          valueVector.push_back(it->second);
+        }
+        writeSuccess &= writer.appendValues(valueVector);
+      }
+    }
+
+    if (DATAMANAGER_DATA_TYPE_STRING == dataType) {
+      writeSuccess &= writer.writeDictionary(
+          encodedStrings ? this->stringDictionaries[key] : dictionary);
+    }
+
+    if (!writeSuccess || !writer.endKey()) {
+      LOG(ERROR) << "Could not write key " << key << " to " << directory
+                 << ".";
+      return false;
+    }
+  }
+
+  return writer.close();
 }
 
 bool DataManagerHdf::createGroup(
     const std::string &groupName, const std::map<std::string, int> &intProps,
     const std::map<std::string, double> &doubleProps,
     const std::map<std::string, std::string> &strProps) {
+  if (!this->isOpen()) {
+    return false;
+  }
+
+  // The group handle is declared after the lock, so it is released while the
+  // lock is still held.
+  std::lock_guard<std::mutex> lockGuard(this->dataManagerMutex);
 
   // Try to get the group
 
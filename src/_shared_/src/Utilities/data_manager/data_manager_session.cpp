@@ -0,0 +1,340 @@
+// 3rd-party includes
+#include <easylogging++.h>
+
+// Project includes
+#include <data_manager_session.hpp>
+
+using namespace Utilities;
+
+std::mutex SessionStore::instanceMutex = std::mutex();
+std::shared_ptr<SessionStore> SessionStore::instance;
+
+SessionStore::SessionStore(Duration flushInterval)
+    : flushInterval(flushInterval) {}
+
+SessionStore::~SessionStore() {
+  {
+    std::lock_guard<std::mutex> lockGuard(this->flushMutex);
+    this->stopFlag = true;
+  }
+  this->flushCondition.notify_all();
+  if (this->flushThread.joinable()) {
+    this->flushThread.join();
+  }
+
+  // Closing the file writes all pending modifications.
+  this->dataManager.close();
+}
+
+bool SessionStore::open(const std::string &name, Duration flushInterval) {
+  std::lock_guard<std::mutex> lockGuard(SessionStore::instanceMutex);
+  if (SessionStore::instance) {
+    LOG(WARNING) << "The session store is already open.";
+    return false;
+  }
+
+  std::shared_ptr<SessionStore> store(new SessionStore(flushInterval));
+  store->dataManager.setAutoFlush(false);
+  if (!store->dataManager.open(name, KeyMapping())) {
+    LOG(ERROR) << "Could not open session file " << name << ".";
+    return false;
+  }
+  store->flushThread = std::thread(&SessionStore::flushWorker, store.get());
+
+  SessionStore::instance = store;
+  return true;
+}
+
+bool SessionStore::close() {
+  std::lock_guard<std::mutex> lockGuard(SessionStore::instanceMutex);
+  if (!SessionStore::instance) {
+    return false;
+  }
+
+  SessionStore::instance.reset();
+  return true;
+}
+
+bool SessionStore::isOpen() {
+  std::lock_guard<std::mutex> lockGuard(SessionStore::instanceMutex);
+  return SessionStore::instance != nullptr;
+}
+
+std::shared_ptr<SessionStore> SessionStore::getInstance() {
+  std::lock_guard<std::mutex> lockGuard(SessionStore::instanceMutex);
+  return SessionStore::instance;
+}
+
+bool SessionStore::flush() {
+  {
+    std::lock_guard<std::mutex> lockGuard(this->flushMutex);
+    this->dirty = false;
+  }
+
+  // The flush must not overlap with the accesses of the participants.
+  std::lock_guard<std::mutex> lockGuard(this->writerMutex);
+  return this->dataManager.flush();
+}
+
+void SessionStore::flushWorker() {
+  std::unique_lock<std::mutex> lock(this->flushMutex);
+  while (!this->stopFlag) {
+    this->flushCondition.wait_for(lock, this->flushInterval,
+                                  [this] { return this->stopFlag; });
+    if (!this->dirty) {
+      continue;
+    }
+
+    // Flush without holding the lock, so that writers are not blocked by
+    // marking the file as modified. The writer lock keeps the flush from
+    // overlapping with the accesses of the participants.
+    this->dirty = false;
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> writerLock(this->writerMutex);
+      this->dataManager.flush();
+    }
+    lock.lock();
+  }
+}
+
+void SessionStore::markDirty() {
+  std::lock_guard<std::mutex> lockGuard(this->flushMutex);
+  this->dirty = true;
+}
+
+DataManagerSession::~DataManagerSession() { this->close(); }
+
+bool DataManagerSession::read(TimePoint timestamp, const std::string &key,
+                              Value &value) {
+  if (!this->isOpen() || !this->typeMapping.contains(key)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+  return this->store->dataManager.read(timestamp, this->getSessionKey(key),
+                                       value);
+}
+
+bool DataManagerSession::read(TimePoint from, TimePoint to,
+                              const std::string &key,
+                              std::vector<TimePoint> &timestamps,
+                              std::vector<Value> &value) {
+  if (!this->isOpen() || !this->typeMapping.contains(key)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+  return this->store->dataManager.read(from, to, this->getSessionKey(key),
+                                       timestamps, value);
+}
+
+bool DataManagerSession::write(TimePoint timestamp, const std::string &key,
+                               const Value &value) {
+  if (!this->isOpen() || !this->typeMapping.contains(key)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+  if (!this->store->dataManager.write(timestamp, this->getSessionKey(key),
+                                      value)) {
+    return false;
+  }
+  this->store->markDirty();
+
+  return true;
+}
+
+bool DataManagerSession::write(const std::vector<TimePoint> &timestamp,
+                               const std::string &key,
+                               const std::vector<Value> &value) {
+  if (!this->isOpen() || !this->typeMapping.contains(key)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+  if (!this->store->dataManager.write(timestamp, this->getSessionKey(key),
+                                      value)) {
+    return false;
+  }
+  this->store->markDirty();
+
+  return true;
+}
+
+bool DataManagerSession::open(std::string name) {
+  if (this->isOpen()) {
+    return false;
+  }
+
+  std::shared_ptr<SessionStore> store = SessionStore::getInstance();
+  if (!store) {
+    LOG(ERROR) << "Can not open " << name
+               << ", as the session store has not been opened.";
+    return false;
+  }
+
+  this->store = store;
+  this->groupName = name;
+
+  std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+
+  // Take over the keys, that have been created within the group earlier.
+  const std::string prefix = this->groupName + "/";
+  for (auto &keyValuePair : this->store->dataManager.getKeyMapping()) {
+    if (keyValuePair.first.starts_with(prefix)) {
+      this->typeMapping[keyValuePair.first.substr(prefix.size())] =
+          keyValuePair.second;
+    }
+  }
+
+  if (!this->store->dataManager.createGroup(this->groupName)) {
+    this->store.reset();
+    this->typeMapping.clear();
+    return false;
+  }
+
+  this->openFlag = true;
+  return true;
+}
+
+bool DataManagerSession::open(std::string name, KeyMapping keyMapping,
+                              bool force) {
+  if (!this->open(name)) {
+    return false;
+  }
+
+  for (auto &keyValuePair : keyMapping) {
+    if (this->typeMapping.contains(keyValuePair.first)) {
+      if (this->typeMapping[keyValuePair.first] != keyValuePair.second) {
+        LOG(ERROR) << "Key " << keyValuePair.first << " of " << name
+                   << " already exists with a different type.";
+        this->close();
+        return false;
+      }
+      continue;
+    }
+    if (!this->createKey(keyValuePair.first, keyValuePair.second)) {
+      this->close();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool DataManagerSession::close() {
+  if (!this->isOpen()) {
+    return false;
+  }
+
+  // Make sure, that everything written by this participant reaches the file.
+  this->store->flush();
+
+  this->store.reset();
+  this->typeMapping.clear();
+  this->spectrumMapping.clear();
+  this->openFlag = false;
+
+  return true;
+}
+
+DataManagerType DataManagerSession::getDataManagerType() const {
+  return DataManagerType::DATAMANAGER_TYPE_SESSION;
+}
+
+bool DataManagerSession::createKey(std::string key,
+                                   DataManagerDataType dataType) {
+  if (!this->isOpen() || this->typeMapping.contains(key)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+  if (!this->store->dataManager.createKey(this->getSessionKey(key),
+                                          dataType)) {
+    return false;
+  }
+  this->store->markDirty();
+
+  this->typeMapping[key] = dataType;
+  return true;
+}
+
+bool DataManagerSession::createGroup(
+    const std::string &groupName, const std::map<std::string, int> &intProps,
+    const std::map<std::string, double> &doubleProps,
+    const std::map<std::string, std::string> &strProps) {
+  if (!this->isOpen()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+  if (!this->store->dataManager.createGroup(this->getSessionKey(groupName),
+                                            intProps, doubleProps, strProps)) {
+    return false;
+  }
+  this->store->markDirty();
+
+  return true;
+}
+
+TimerangeMapping DataManagerSession::getTimerangeMapping() const {
+  TimerangeMapping retVal;
+  if (!this->isOpen()) {
+    return retVal;
+  }
+
+  TimerangeMapping sessionMapping;
+  {
+    std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+    sessionMapping = this->store->dataManager.getTimerangeMapping();
+  }
+
+  for (auto &keyValuePair : this->typeMapping) {
+    auto it = sessionMapping.find(this->getSessionKey(keyValuePair.first));
+    if (it != sessionMapping.end()) {
+      retVal[keyValuePair.first] = it->second;
+    }
+  }
+
+  return retVal;
+}
+
+bool DataManagerSession::writeToCsv(const std::string &directory,
+                                    const ExportOptions &options) {
+  LOG(WARNING) << "CSV export is not supported for a single participant of "
+                  "a session. Export the session file instead.";
+  return false;
+}
+
+bool DataManagerSession::setupSpectrumSpecific(
+    std::string key, std::vector<double> frequencies) {
+  if (!this->isOpen()) {
+    return false;
+  }
+
+  const std::string sessionKey = this->getSessionKey(key);
+
+  std::lock_guard<std::mutex> lockGuard(this->store->writerMutex);
+  if (this->store->dataManager.isSpectrumSetup(sessionKey)) {
+    // The spectrum has been set up by an earlier run of the session.
+    if (this->store->dataManager.getSpectrumMapping()[sessionKey] !=
+        frequencies) {
+      LOG(ERROR) << "Spectrum " << key << " of " << this->groupName
+                 << " already exists with different frequencies.";
+      return false;
+    }
+    return true;
+  }
+
+  if (!this->store->dataManager.setupSpectrum(sessionKey, frequencies)) {
+    return false;
+  }
+  this->store->markDirty();
+
+  return true;
+}
+
+std::string DataManagerSession::getSessionKey(const std::string &key) const {
+  return this->groupName + "/" + key;
+}
@@ -0,0 +1,328 @@
+// Standard includes
+#include <array>
+#include <bit>
+
+// 3rd-party includes
+#include <easylogging++.h>
+
+// Project includes
+#include <numpy_writer.hpp>
+
+using namespace Utilities;
+
+const std::string NumpyWriter::DESCR_INT64 = "<i8";
+const std::string NumpyWriter::DESCR_FLOAT64 = "<f8";
+const std::string NumpyWriter::DESCR_COMPLEX128 = "<c16";
+
+/// The alignment of the data of a .npy file.
+#define NPY_ALIGNMENT 64
+/// The version of the zip format, that is needed to read ZIP64 archives.
+#define ZIP64_VERSION 45
+/// Marks a field of a zip header, whose value is stored in the ZIP64 extra
+/// field.
+#define ZIP64_MARKER 0xFFFFFFFF
+/// Offset of the CRC within a local file header.
+#define ZIP_LOCAL_CRC_OFFSET 14
+/// Size of a local file header without file name and extra field.
+#define ZIP_LOCAL_HEADER_SIZE 30
+
+namespace {
+/**
+ * @brief Writes an integer in little-endian byte order.
+ * @param stream The stream.
+ * @param value The integer.
+ * @param size The count of bytes, that shall be written.
+ */
+void writeLittleEndian(std::ofstream &stream, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    stream.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+/**
+ * @brief Continues the CRC-32 checksum of a zip archive with the given bytes.
+ * @param crc The checksum of the preceding bytes.
+ * @param data The bytes.
+ * @param size The count of bytes.
+ * @return The checksum.
+ */
+uint32_t updateCrc(uint32_t crc, const char *data, size_t size) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t value = i;
+      for (int bit = 0; bit < 8; bit++) {
+        value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+      }
+      table[i] = value;
+    }
+    return table;
+  }();
+
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+/**
+ * @brief Returns the size of an element with the given type descriptor.
+ */
+size_t getItemSize(const std::string &descr) {
+  return std::stoul(descr.substr(2));
+}
+} // namespace
+
+NumpyWriter::~NumpyWriter() { this->close(); }
+
+bool NumpyWriter::open(const std::string &name, bool archive) {
+  if (this->openFlag) {
+    return false;
+  }
+
+  // The elements are written in the native byte order.
+  if constexpr (std::endian::native != std::endian::little) {
+    LOG(ERROR) << "NumPy arrays can only be written on little-endian "
+                  "machines.";
+    return false;
+  }
+
+  this->archive = archive;
+  this->entries.clear();
+  if (this->archive) {
+    this->stream.open(name, std::ios::binary | std::ios::trunc);
+    if (!this->stream.is_open()) {
+      LOG(ERROR) << "Could not open " << name << ".";
+      return false;
+    }
+  } else {
+    std::error_code errorCode;
+    std::filesystem::create_directories(name, errorCode);
+    if (errorCode) {
+      LOG(ERROR) << "Could not create " << name << ": " << errorCode.message();
+      return false;
+    }
+    this->directory = name;
+  }
+
+  this->openFlag = true;
+  return true;
+}
+
+bool NumpyWriter::beginArray(const std::string &name, const std::string &descr,
+                             const std::vector<size_t> &shape) {
+  if (!this->openFlag || this->arrayOpen) {
+    return false;
+  }
+
+  this->expectedSize = getItemSize(descr);
+  for (auto dimension : shape) {
+    this->expectedSize *= dimension;
+  }
+  this->writtenSize = 0;
+
+  std::string header = NumpyWriter::getHeader(descr, shape);
+  this->currentEntry = {name + ".npy", 0, 0, 0};
+  if (this->archive) {
+    // The sizes and the CRC are not known yet. They are filled in, once the
+    // array has been finished.
+    this->currentEntry.offset = this->stream.tellp();
+    this->currentEntry.crc = updateCrc(0, header.data(), header.size());
+    writeLittleEndian(this->stream, 0x04034b50, 4);
+    writeLittleEndian(this->stream, ZIP64_VERSION, 2);
+    // Flags, compression method, modification time and date (1980-01-01).
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0x21, 2);
+    writeLittleEndian(this->stream, 0, 4);
+    writeLittleEndian(this->stream, ZIP64_MARKER, 4);
+    writeLittleEndian(this->stream, ZIP64_MARKER, 4);
+    writeLittleEndian(this->stream, this->currentEntry.fileName.size(), 2);
+    writeLittleEndian(this->stream, 20, 2);
+    this->stream << this->currentEntry.fileName;
+    // ZIP64 extra field with the uncompressed and compressed size.
+    writeLittleEndian(this->stream, 0x0001, 2);
+    writeLittleEndian(this->stream, 16, 2);
+    writeLittleEndian(this->stream, 0, 8);
+    writeLittleEndian(this->stream, 0, 8);
+  } else {
+    this->stream.open(this->directory / this->currentEntry.fileName,
+                      std::ios::binary | std::ios::trunc);
+    if (!this->stream.is_open()) {
+      LOG(ERROR) << "Could not open " << this->currentEntry.fileName << ".";
+      return false;
+    }
+  }
+  this->stream << header;
+
+  this->arrayOpen = this->stream.good();
+  return this->arrayOpen;
+}
+
+bool NumpyWriter::appendBytes(const char *data, size_t size) {
+  if (!this->arrayOpen || this->writtenSize + size > this->expectedSize) {
+    return false;
+  }
+
+  if (this->archive) {
+    this->currentEntry.crc = updateCrc(this->currentEntry.crc, data, size);
+  }
+  this->stream.write(data, size);
+  this->writtenSize += size;
+
+  return this->stream.good();
+}
+
+bool NumpyWriter::endArray() {
+  if (!this->arrayOpen) {
+    return false;
+  }
+  this->arrayOpen = false;
+
+  if (this->writtenSize != this->expectedSize) {
+    LOG(ERROR) << "Array " << this->currentEntry.fileName << " is incomplete.";
+    return false;
+  }
+
+  if (!this->archive) {
+    this->stream.close();
+    return !this->stream.fail();
+  }
+
+  // Fill in the CRC and the sizes of the local file header.
+  uint64_t end = this->stream.tellp();
+  this->currentEntry.size =
+      end - this->currentEntry.offset - ZIP_LOCAL_HEADER_SIZE -
+      this->currentEntry.fileName.size() - 20;
+  this->stream.seekp(this->currentEntry.offset + ZIP_LOCAL_CRC_OFFSET);
+  writeLittleEndian(this->stream, this->currentEntry.crc, 4);
+  this->stream.seekp(this->currentEntry.offset + ZIP_LOCAL_HEADER_SIZE +
+                     this->currentEntry.fileName.size() + 4);
+  writeLittleEndian(this->stream, this->currentEntry.size, 8);
+  writeLittleEndian(this->stream, this->currentEntry.size, 8);
+  this->stream.seekp(end);
+  this->entries.push_back(this->currentEntry);
+
+  return this->stream.good();
+}
+
+bool NumpyWriter::close() {
+  if (!this->openFlag) {
+    return false;
+  }
+  this->openFlag = false;
+
+  bool success = true;
+  if (this->arrayOpen) {
+    LOG(ERROR) << "Array " << this->currentEntry.fileName
+               << " has not been finished.";
+    this->arrayOpen = false;
+    success = false;
+  }
+  if (this->stream.is_open()) {
+    if (this->archive) {
+      success &= this->writeCentralDirectory();
+    }
+    this->stream.close();
+    success &= !this->stream.fail();
+  }
+
+  return success;
+}
+
+bool NumpyWriter::writeCentralDirectory() {
+  uint64_t directoryOffset = this->stream.tellp();
+  for (auto &entry : this->entries) {
+    writeLittleEndian(this->stream, 0x02014b50, 4);
+    writeLittleEndian(this->stream, ZIP64_VERSION, 2);
+    writeLittleEndian(this->stream, ZIP64_VERSION, 2);
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0x21, 2);
+    writeLittleEndian(this->stream, entry.crc, 4);
+    writeLittleEndian(this->stream, ZIP64_MARKER, 4);
+    writeLittleEndian(this->stream, ZIP64_MARKER, 4);
+    writeLittleEndian(this->stream, entry.fileName.size(), 2);
+    writeLittleEndian(this->stream, 28, 2);
+    // Comment length, disk number, internal and external attributes.
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0, 2);
+    writeLittleEndian(this->stream, 0, 4);
+    writeLittleEndian(this->stream, ZIP64_MARKER, 4);
+    this->stream << entry.fileName;
+    writeLittleEndian(this->stream, 0x0001, 2);
+    writeLittleEndian(this->stream, 24, 2);
+    writeLittleEndian(this->stream, entry.size, 8);
+    writeLittleEndian(this->stream, entry.size, 8);
+    writeLittleEndian(this->stream, entry.offset, 8);
+  }
+  uint64_t directoryEnd = this->stream.tellp();
+
+  // ZIP64 end of central directory record.
+  writeLittleEndian(this->stream, 0x06064b50, 4);
+  writeLittleEndian(this->stream, 44, 8);
+  writeLittleEndian(this->stream, ZIP64_VERSION, 2);
+  writeLittleEndian(this->stream, ZIP64_VERSION, 2);
+  writeLittleEndian(this->stream, 0, 4);
+  writeLittleEndian(this->stream, 0, 4);
+  writeLittleEndian(this->stream, this->entries.size(), 8);
+  writeLittleEndian(this->stream, this->entries.size(), 8);
+  writeLittleEndian(this->stream, directoryEnd - directoryOffset, 8);
+  writeLittleEndian(this->stream, directoryOffset, 8);
+
+  // ZIP64 end of central directory locator.
+  writeLittleEndian(this->stream, 0x07064b50, 4);
+  writeLittleEndian(this->stream, 0, 4);
+  writeLittleEndian(this->stream, directoryEnd, 8);
+  writeLittleEndian(this->stream, 1, 4);
+
+  // End of central directory record, that refers to the ZIP64 records.
+  writeLittleEndian(this->stream, 0x06054b50, 4);
+  writeLittleEndian(this->stream, 0, 2);
+  writeLittleEndian(this->stream, 0, 2);
+  writeLittleEndian(this->stream, 0xFFFF, 2);
+  writeLittleEndian(this->stream, 0xFFFF, 2);
+  writeLittleEndian(this->stream, ZIP64_MARKER, 4);
+  writeLittleEndian(this->stream, ZIP64_MARKER, 4);
+  writeLittleEndian(this->stream, 0, 2);
+
+  return this->stream.good();
+}
+
+std::string NumpyWriter::getHeader(const std::string &descr,
+                                   const std::vector<size_t> &shape) {
+  std::string shapeStr = "(";
+  for (auto dimension : shape) {
+    shapeStr += std::to_string(dimension) + ", ";
+  }
+  if (shape.size() > 1) {
+    shapeStr.resize(shapeStr.size() - 2);
+  } else if (shape.size() == 1) {
+    // A tuple with a single element needs a trailing comma.
+    shapeStr.resize(shapeStr.size() - 1);
+  }
+  shapeStr += ")";
+
+  std::string dictionary = "{'descr': '" + descr +
+                           "', 'fortran_order': False, 'shape': " + shapeStr +
+                           ", }";
+
+  // Magic string, version 1.0 and the length of the dictionary.
+  constexpr size_t PREAMBLE_SIZE = 10;
+  size_t headerSize = PREAMBLE_SIZE + dictionary.size() + 1;
+  headerSize = (headerSize + NPY_ALIGNMENT - 1) / NPY_ALIGNMENT * NPY_ALIGNMENT;
+  dictionary.resize(headerSize - PREAMBLE_SIZE - 1, ' ');
+  dictionary += '\n';
+
+  std::string header = "\x93NUMPY";
+  header += '\x01';
+  header += '\x00';
+  header += static_cast<char>(dictionary.size() & 0xFF);
+  header += static_cast<char>((dictionary.size() >> 8) & 0xFF);
+
+  return header + dictionary;
+}
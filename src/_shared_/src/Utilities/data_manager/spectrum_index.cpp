@@ -0,0 +1,712 @@
+// Standard includes
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <regex>
+#include <set>
+#include <thread>
+
+// 3rd-party includes
+#include <easylogging++.h>
+
+// Project includes
+#include <impedance_kernels.hpp>
+#include <spectrum_index.hpp>
+
+/// The version of the index file format.
+#define SPECTRUM_INDEX_FILE_VERSION 2
+/// The minimal count of feature vectors, that a thread assigns at once.
+#define SPECTRUM_INDEX_MIN_ASSIGN_CHUNK 256
+/// The largest magnitude of a quantized feature.
+#define SPECTRUM_INDEX_CODE_MAX 127
+
+using namespace Utilities;
+
+const std::string SpectrumIndex::FILE_EXTENSION = ".spidx";
+
+namespace {
+/// Identifies an index file.
+constexpr char INDEX_MAGIC[8] = {'S', 'C', 'I', 'M', 'S', 'P', 'I', 'X'};
+
+/**
+ * @brief Calculates the squared euclidean distance of two vectors. Uses
+ * multiple sums, so that the compiler can keep them in vector registers.
+ */
+float squaredDistance(const float *a, const float *b, size_t dimension) {
+  float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  size_t i = 0;
+  for (; i + 4 <= dimension; i += 4) {
+    for (size_t lane = 0; lane < 4; lane++) {
+      float difference = a[i + lane] - b[i + lane];
+      sums[lane] += difference * difference;
+    }
+  }
+  for (; i < dimension; i++) {
+    float difference = a[i] - b[i];
+    sums[0] += difference * difference;
+  }
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+/**
+ * @brief Calculates the squared euclidean distance of a vector and a quantized
+ * vector, whose elements are the codes times the scale.
+ */
+float squaredDistance(const float *a, const int8_t *codes, float scale,
+                      size_t dimension) {
+  float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  size_t i = 0;
+  for (; i + 4 <= dimension; i += 4) {
+    for (size_t lane = 0; lane < 4; lane++) {
+      float difference = a[i + lane] - scale * codes[i + lane];
+      sums[lane] += difference * difference;
+    }
+  }
+  for (; i < dimension; i++) {
+    float difference = a[i] - scale * codes[i];
+    sums[0] += difference * difference;
+  }
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+/**
+ * @brief Multiplies two counts, that have been read from an index file. Fails,
+ * if the product overflows or exceeds the limit.
+ */
+bool multiplyCounts(uint64_t a, uint64_t b, uint64_t limit,
+                    uint64_t &product) {
+  if (0 != b && a > limit / b) {
+    return false;
+  }
+  product = a * b;
+  return true;
+}
+
+/**
+ * @brief Scales a vector to the given length. Vectors of length 0 are left
+ * untouched.
+ */
+void scaleToLength(float *vector, size_t count, double length) {
+  double norm = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    norm += static_cast<double>(vector[i]) * vector[i];
+  }
+  if (norm <= 0.0) {
+    return;
+  }
+  float factor = static_cast<float>(length / std::sqrt(norm));
+  for (size_t i = 0; i < count; i++) {
+    vector[i] *= factor;
+  }
+}
+
+/**
+ * @brief Writes the elements of an array to a stream.
+ */
+template <class T>
+void writeArray(std::ofstream &stream, const T *data, size_t count) {
+  stream.write(reinterpret_cast<const char *>(data), count * sizeof(T));
+}
+
+/**
+ * @brief Writes zeros, until the stream position is a multiple of 8.
+ */
+void writePadding(std::ofstream &stream) {
+  static const char zeros[8] = {};
+  size_t position = static_cast<size_t>(stream.tellp());
+  stream.write(zeros, (8 - position % 8) % 8);
+}
+
+/**
+ * @brief Reads the fields of an index file, that has been mapped into memory.
+ * Every read checks, that the field lies within the file.
+ */
+class IndexReader {
+public:
+  explicit IndexReader(std::span<const std::byte> data) : data(data) {}
+
+  /**
+   * @brief Reads a single value.
+   */
+  template <class T> bool read(T &value) {
+    if (sizeof(T) > this->data.size() - this->position) {
+      return false;
+    }
+    std::memcpy(&value, this->data.data() + this->position, sizeof(T));
+    this->position += sizeof(T);
+    return true;
+  }
+
+  /**
+   * @brief Returns a view of count consecutive values.
+   */
+  template <class T> bool readSpan(size_t count, std::span<const T> &span) {
+    if (this->position % alignof(T) != 0 ||
+        count > (this->data.size() - this->position) / sizeof(T)) {
+      return false;
+    }
+    span = std::span<const T>(
+        reinterpret_cast<const T *>(this->data.data() + this->position), count);
+    this->position += count * sizeof(T);
+    return true;
+  }
+
+  /**
+   * @brief Skips the padding up to the next multiple of 8.
+   */
+  bool skipPadding() {
+    size_t padding = (8 - this->position % 8) % 8;
+    if (padding > this->data.size() - this->position) {
+      return false;
+    }
+    this->position += padding;
+    return true;
+  }
+
+private:
+  /// The content of the file.
+  std::span<const std::byte> data;
+
+  /// The position of the next field.
+  size_t position = 0;
+};
+} // namespace
+
+std::string SpectrumIndex::getIndexFileName(const std::string &hdfFileName) {
+  return hdfFileName + FILE_EXTENSION;
+}
+
+void SpectrumIndex::computeFeatures(const double *spectrum,
+                                    size_t frequencyCount, float *features) {
+  std::vector<double> real(frequencyCount);
+  std::vector<double> imag(frequencyCount);
+  for (size_t i = 0; i < frequencyCount; i++) {
+    real[i] = spectrum[2 * i];
+    imag[i] = spectrum[2 * i + 1];
+  }
+  std::vector<double> decibels(frequencyCount);
+  std::vector<double> phases(frequencyCount);
+  computeMagnitudesDb(real.data(), imag.data(), decibels.data(),
+                      frequencyCount);
+  computePhases(real.data(), imag.data(), phases.data(), frequencyCount);
+
+  // Only the shape of the magnitudes counts, not their level. Impedances of 0
+  // or missing values would dominate the distance, so they do not contribute.
+  double mean = 0.0;
+  size_t finiteCount = 0;
+  for (double decibel : decibels) {
+    if (std::isfinite(decibel)) {
+      mean += decibel;
+      finiteCount++;
+    }
+  }
+  mean = finiteCount > 0 ? mean / finiteCount : 0.0;
+  for (size_t i = 0; i < frequencyCount; i++) {
+    features[i] = std::isfinite(decibels[i])
+                      ? static_cast<float>(decibels[i] - mean)
+                      : 0.0f;
+    features[frequencyCount + i] =
+        std::isfinite(phases[i]) ? static_cast<float>(phases[i]) : 0.0f;
+  }
+
+  scaleToLength(features, frequencyCount, std::sqrt(0.5));
+  scaleToLength(features + frequencyCount, frequencyCount, std::sqrt(0.5));
+}
+
+bool SpectrumIndex::build(DataManagerHdf &dataManager,
+                          const std::string &keyFilter, size_t listCount,
+                          unsigned int jobCount) {
+  if (!dataManager.isOpen()) {
+    LOG(ERROR) << "The data manager has to be opened, before it is indexed.";
+    return false;
+  }
+
+  std::regex filter;
+  try {
+    filter = std::regex(keyFilter);
+  } catch (const std::regex_error &err) {
+    LOG(ERROR) << "Invalid key filter " << keyFilter << ": " << err.what();
+    return false;
+  }
+
+  KeyMapping keyMapping = dataManager.getKeyMapping();
+  SpectrumMapping spectrumMapping = dataManager.getSpectrumMapping();
+  for (auto &[key, dataType] : keyMapping) {
+    if (DATAMANAGER_DATA_TYPE_SPECTRUM != dataType ||
+        (!keyFilter.empty() && !std::regex_search(key, filter))) {
+      continue;
+    }
+
+    size_t firstRow = 0;
+    size_t rowCount = 0;
+    if (!dataManager.findRows(key, TimePoint::min(), TimePoint::max(),
+                              firstRow, rowCount)) {
+      LOG(WARNING) << "Key " << key << " has no spectra and is not indexed.";
+      continue;
+    }
+    const std::vector<double> &frequencies = spectrumMapping[key];
+    std::vector<size_t> rowShape;
+    if (!dataManager.getRowShape(key, rowShape) || rowShape.size() != 2 ||
+        rowShape[0] != frequencies.size()) {
+      LOG(ERROR) << "The spectra of key " << key
+                 << " do not match its frequencies.";
+      return false;
+    }
+
+    // Only the features are kept, the spectra are read block by block.
+    size_t dimension = 2 * frequencies.size();
+    std::vector<long long> timestamps(rowCount);
+    std::vector<float> features(rowCount * dimension);
+    std::vector<double> spectra;
+    for (size_t offset = 0; offset < rowCount;
+         offset += SPECTRUM_INDEX_READ_BLOCK_SIZE) {
+      size_t blockSize = std::min<size_t>(SPECTRUM_INDEX_READ_BLOCK_SIZE,
+                                          rowCount - offset);
+      spectra.resize(blockSize * dimension);
+      if (!dataManager.readTimestamps(key, firstRow + offset, blockSize,
+                                      timestamps.data() + offset) ||
+          !dataManager.readValues(key, firstRow + offset, blockSize,
+                                  spectra.data())) {
+        LOG(ERROR) << "Could not read the spectra of key " << key << ".";
+        return false;
+      }
+      for (size_t row = 0; row < blockSize; row++) {
+        SpectrumIndex::computeFeatures(
+            spectra.data() + row * dimension, frequencies.size(),
+            features.data() + (offset + row) * dimension);
+      }
+    }
+
+    if (!this->addKey(key, frequencies, timestamps, features, listCount,
+                      jobCount)) {
+      return false;
+    }
+    LOG(INFO) << "Indexed " << rowCount << " spectra of key " << key << " in "
+              << this->keys[key]->listCount << " lists.";
+  }
+
+  return true;
+}
+
+bool SpectrumIndex::addKey(const std::string &key,
+                           const std::vector<double> &frequencies,
+                           const std::vector<long long> &timestamps,
+                           const std::vector<float> &features,
+                           size_t listCount, unsigned int jobCount) {
+  size_t dimension = 2 * frequencies.size();
+  size_t rowCount = timestamps.size();
+  if (0 == dimension || features.size() != rowCount * dimension) {
+    LOG(ERROR) << "The features of key " << key
+               << " do not match its frequencies.";
+    return false;
+  }
+
+  if (0 == listCount) {
+    listCount = static_cast<size_t>(
+        std::llround(std::sqrt(static_cast<double>(rowCount))));
+  }
+  listCount = std::clamp<size_t>(listCount, 1, SPECTRUM_INDEX_MAX_LIST_COUNT);
+  listCount = std::min(listCount, std::max<size_t>(rowCount, 1));
+
+  ThreadPool pool(jobCount > 0 ? jobCount
+                               : std::thread::hardware_concurrency());
+  std::unique_ptr<KeyIndex> index(new KeyIndex());
+  index->rowCount = rowCount;
+  index->listCount = listCount;
+  index->dimension = dimension;
+  index->frequencyStorage = frequencies;
+  index->centroidStorage =
+      rowCount > 0 ? SpectrumIndex::trainCentroids(features, rowCount,
+                                                   dimension, listCount, pool)
+                   : std::vector<float>(listCount * dimension, 0.0f);
+  std::vector<uint32_t> lists =
+      SpectrumIndex::assignLists(features.data(), rowCount,
+                                 index->centroidStorage, listCount, dimension,
+                                 pool);
+
+  // Order the spectra by list (counting sort). Within a list, the spectra
+  // keep their chronological order.
+  index->listOffsetStorage.assign(listCount + 1, 0);
+  for (uint32_t list : lists) {
+    index->listOffsetStorage[list + 1]++;
+  }
+  std::partial_sum(index->listOffsetStorage.begin(),
+                   index->listOffsetStorage.end(),
+                   index->listOffsetStorage.begin());
+  std::vector<uint64_t> nextRow(index->listOffsetStorage.begin(),
+                                index->listOffsetStorage.end() - 1);
+  index->timestampStorage.resize(rowCount);
+  std::vector<float> residuals(rowCount * dimension);
+  for (size_t row = 0; row < rowCount; row++) {
+    uint64_t target = nextRow[lists[row]]++;
+    index->timestampStorage[target] = timestamps[row];
+    const float *centroid =
+        index->centroidStorage.data() + lists[row] * dimension;
+    for (size_t d = 0; d < dimension; d++) {
+      residuals[target * dimension + d] =
+          features[row * dimension + d] - centroid[d];
+    }
+  }
+
+  // Quantize the differences to the centroids. The scale of a list maps its
+  // largest difference to the largest code.
+  index->scaleStorage.assign(listCount, 0.0f);
+  index->codeStorage.resize(rowCount * dimension);
+  for (size_t list = 0; list < listCount; list++) {
+    size_t first = index->listOffsetStorage[list] * dimension;
+    size_t last = index->listOffsetStorage[list + 1] * dimension;
+    float maximum = 0.0f;
+    for (size_t i = first; i < last; i++) {
+      maximum = std::max(maximum, std::abs(residuals[i]));
+    }
+    if (maximum <= 0.0f) {
+      std::fill(index->codeStorage.begin() + first,
+                index->codeStorage.begin() + last, int8_t(0));
+      continue;
+    }
+    const float codeMax = SPECTRUM_INDEX_CODE_MAX;
+    float scale = maximum / codeMax;
+    index->scaleStorage[list] = scale;
+    for (size_t i = first; i < last; i++) {
+      float code = std::round(residuals[i] / scale);
+      index->codeStorage[i] =
+          static_cast<int8_t>(std::clamp(code, -codeMax, codeMax));
+    }
+  }
+
+  index->frequencies = index->frequencyStorage;
+  index->listOffsets = index->listOffsetStorage;
+  index->timestamps = index->timestampStorage;
+  index->centroids = index->centroidStorage;
+  index->scales = index->scaleStorage;
+  index->codes = index->codeStorage;
+  this->keys[key] = std::move(index);
+
+  return true;
+}
+
+bool SpectrumIndex::save(const std::string &fileName) const {
+  // The arrays are written in the native byte order.
+  if constexpr (std::endian::native != std::endian::little) {
+    LOG(ERROR) << "Spectrum indexes can only be written on little-endian "
+                  "machines.";
+    return false;
+  }
+
+  std::ofstream stream(fileName, std::ios::binary | std::ios::trunc);
+  if (!stream) {
+    LOG(ERROR) << "Could not create " << fileName << ".";
+    return false;
+  }
+
+  uint32_t version = SPECTRUM_INDEX_FILE_VERSION;
+  uint32_t keyCount = static_cast<uint32_t>(this->keys.size());
+  stream.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+  writeArray(stream, &version, 1);
+  writeArray(stream, &keyCount, 1);
+
+  for (auto &[key, index] : this->keys) {
+    uint32_t nameLength = static_cast<uint32_t>(key.size());
+    writeArray(stream, &nameLength, 1);
+    stream.write(key.data(), key.size());
+    writePadding(stream);
+
+    uint64_t header[3] = {index->frequencies.size(), index->rowCount,
+                          index->listCount};
+    writeArray(stream, header, 3);
+    writeArray(stream, index->frequencies.data(), index->frequencies.size());
+    writeArray(stream, index->listOffsets.data(), index->listOffsets.size());
+    writeArray(stream, index->timestamps.data(), index->timestamps.size());
+    writeArray(stream, index->centroids.data(), index->centroids.size());
+    writeArray(stream, index->scales.data(), index->scales.size());
+    writeArray(stream, index->codes.data(), index->codes.size());
+    writePadding(stream);
+  }
+
+  stream.close();
+  if (stream.fail()) {
+    LOG(ERROR) << "Could not write " << fileName << ".";
+    return false;
+  }
+
+  return true;
+}
+
+bool SpectrumIndex::load(const std::string &fileName) {
+  this->keys.clear();
+  this->mappedFile.reset(new MappedFile());
+  if (!this->mappedFile->open(fileName)) {
+    LOG(ERROR) << "Could not open " << fileName << ".";
+    this->mappedFile.reset();
+    return false;
+  }
+
+  std::span<const std::byte> data = this->mappedFile->view<std::byte>();
+  IndexReader reader(data);
+  char magic[sizeof(INDEX_MAGIC)];
+  uint32_t version = 0;
+  uint32_t keyCount = 0;
+  bool valid = reader.read(magic) && reader.read(version) &&
+               reader.read(keyCount) &&
+               0 == std::memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+  if (valid && version != SPECTRUM_INDEX_FILE_VERSION) {
+    LOG(ERROR) << fileName << " has the unsupported version " << version
+               << ".";
+    valid = false;
+  }
+
+  for (uint32_t keyIdx = 0; valid && keyIdx < keyCount; keyIdx++) {
+    uint32_t nameLength = 0;
+    std::span<const char> name;
+    uint64_t header[3];
+    std::unique_ptr<KeyIndex> index(new KeyIndex());
+    valid = reader.read(nameLength) && reader.readSpan(nameLength, name) &&
+            reader.skipPadding() && reader.read(header);
+    if (!valid) {
+      break;
+    }
+    // Every array holds at least a byte per element, so no count or product
+    // of counts can exceed the size of the file. Checking this first keeps
+    // malformed headers from overflowing the products.
+    uint64_t dimension = 0;
+    uint64_t centroidCount = 0;
+    uint64_t codeCount = 0;
+    valid = header[0] > 0 && header[2] > 0 && header[2] < data.size() &&
+            multiplyCounts(header[0], 2, data.size(), dimension) &&
+            multiplyCounts(header[2], dimension, data.size(), centroidCount) &&
+            multiplyCounts(header[1], dimension, data.size(), codeCount);
+    if (!valid) {
+      break;
+    }
+    index->rowCount = header[1];
+    index->listCount = header[2];
+    index->dimension = dimension;
+    valid = reader.readSpan(header[0], index->frequencies) &&
+            reader.readSpan(index->listCount + 1, index->listOffsets) &&
+            reader.readSpan(index->rowCount, index->timestamps) &&
+            reader.readSpan(centroidCount, index->centroids) &&
+            reader.readSpan(index->listCount, index->scales) &&
+            reader.readSpan(codeCount, index->codes) && reader.skipPadding();
+    // The list offsets have to partition the rows.
+    valid = valid && 0 == index->listOffsets.front() &&
+            index->rowCount == index->listOffsets.back() &&
+            std::is_sorted(index->listOffsets.begin(),
+                           index->listOffsets.end());
+    if (valid) {
+      this->keys[std::string(name.begin(), name.end())] = std::move(index);
+    }
+  }
+
+  if (!valid) {
+    LOG(ERROR) << fileName << " is not a valid spectrum index.";
+    this->keys.clear();
+    this->mappedFile.reset();
+    return false;
+  }
+
+  return true;
+}
+
+std::vector<std::string> SpectrumIndex::getKeys() const {
+  std::vector<std::string> retVal;
+  for (auto &keyIndexPair : this->keys) {
+    retVal.push_back(keyIndexPair.first);
+  }
+  return retVal;
+}
+
+std::vector<double>
+SpectrumIndex::getFrequencies(const std::string &key) const {
+  auto it = this->keys.find(key);
+  if (it == this->keys.end()) {
+    return {};
+  }
+  return std::vector<double>(it->second->frequencies.begin(),
+                             it->second->frequencies.end());
+}
+
+size_t SpectrumIndex::getRowCount(const std::string &key) const {
+  auto it = this->keys.find(key);
+  return it == this->keys.end() ? 0 : it->second->rowCount;
+}
+
+bool SpectrumIndex::query(const std::string &key, const double *spectrum,
+                          const SpectrumQueryOptions &options,
+                          std::vector<SpectrumMatch> &matches) const {
+  matches.clear();
+  auto it = this->keys.find(key);
+  if (it == this->keys.end()) {
+    LOG(ERROR) << "Key " << key << " is not indexed.";
+    return false;
+  }
+  const KeyIndex &index = *it->second;
+
+  std::vector<float> features(index.dimension);
+  SpectrumIndex::computeFeatures(spectrum, index.frequencies.size(),
+                                 features.data());
+
+  // Select the lists, whose centroids are nearest to the query.
+  std::vector<std::pair<float, size_t>> lists(index.listCount);
+  for (size_t list = 0; list < index.listCount; list++) {
+    lists[list] = {squaredDistance(features.data(),
+                                   index.centroids.data() +
+                                       list * index.dimension,
+                                   index.dimension),
+                   list};
+  }
+  size_t probeCount =
+      std::clamp<size_t>(options.probes, 1, index.listCount);
+  std::partial_sort(lists.begin(), lists.begin() + probeCount, lists.end());
+
+  // The spectra are stored relative to the centroid of their list, so the
+  // query is moved the same way.
+  std::vector<SpectrumMatch> candidates;
+  std::vector<float> residual(index.dimension);
+  for (size_t probe = 0; probe < probeCount; probe++) {
+    size_t list = lists[probe].second;
+    const float *centroid = index.centroids.data() + list * index.dimension;
+    for (size_t d = 0; d < index.dimension; d++) {
+      residual[d] = features[d] - centroid[d];
+    }
+    for (uint64_t row = index.listOffsets[list];
+         row < index.listOffsets[list + 1]; row++) {
+      candidates.push_back(
+          {index.timestamps[row],
+           squaredDistance(residual.data(),
+                           index.codes.data() + row * index.dimension,
+                           index.scales[list], index.dimension)});
+    }
+  }
+  auto byDistance = [](const SpectrumMatch &a, const SpectrumMatch &b) {
+    return a.distance < b.distance ||
+           (a.distance == b.distance && a.timestamp < b.timestamp);
+  };
+
+  if (options.minSeparation <= 0) {
+    size_t matchCount = std::min(options.k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + matchCount,
+                      candidates.end(), byDistance);
+    matches.assign(candidates.begin(), candidates.begin() + matchCount);
+    return true;
+  }
+
+  // Take the nearest candidates, that are not too close in time to a better
+  // match.
+  std::sort(candidates.begin(), candidates.end(), byDistance);
+  std::set<long long> selected;
+  for (const SpectrumMatch &candidate : candidates) {
+    if (matches.size() >= options.k) {
+      break;
+    }
+    auto next = selected.lower_bound(candidate.timestamp);
+    if (next != selected.end() &&
+        *next - candidate.timestamp < options.minSeparation) {
+      continue;
+    }
+    if (next != selected.begin() &&
+        candidate.timestamp - *std::prev(next) < options.minSeparation) {
+      continue;
+    }
+    selected.insert(candidate.timestamp);
+    matches.push_back(candidate);
+  }
+
+  return true;
+}
+
+std::vector<float> SpectrumIndex::trainCentroids(
+    const std::vector<float> &features, size_t rowCount, size_t dimension,
+    size_t listCount, ThreadPool &pool) {
+  // Train on evenly spaced spectra. Recordings are ordered by time, so the
+  // sample covers the whole recording.
+  size_t sampleCount =
+      std::min(rowCount, listCount * SPECTRUM_INDEX_SAMPLES_PER_LIST);
+  std::vector<float> sample(sampleCount * dimension);
+  for (size_t i = 0; i < sampleCount; i++) {
+    size_t row = i * rowCount / sampleCount;
+    std::copy_n(features.data() + row * dimension, dimension,
+                sample.data() + i * dimension);
+  }
+  std::vector<float> centroids(listCount * dimension);
+  for (size_t list = 0; list < listCount; list++) {
+    size_t i = list * sampleCount / listCount;
+    std::copy_n(sample.data() + i * dimension, dimension,
+                centroids.data() + list * dimension);
+  }
+
+  std::vector<uint32_t> assignment;
+  for (int iteration = 0; iteration < SPECTRUM_INDEX_KMEANS_ITERATIONS;
+       iteration++) {
+    std::vector<uint32_t> nextAssignment = SpectrumIndex::assignLists(
+        sample.data(), sampleCount, centroids, listCount, dimension, pool);
+    if (nextAssignment == assignment) {
+      break;
+    }
+    assignment = std::move(nextAssignment);
+
+    // Move every centroid to the mean of its spectra. Lists without spectra
+    // keep their centroid.
+    std::vector<double> sums(listCount * dimension, 0.0);
+    std::vector<size_t> counts(listCount, 0);
+    for (size_t i = 0; i < sampleCount; i++) {
+      double *sum = sums.data() + assignment[i] * dimension;
+      const float *vector = sample.data() + i * dimension;
+      for (size_t d = 0; d < dimension; d++) {
+        sum[d] += vector[d];
+      }
+      counts[assignment[i]]++;
+    }
+    for (size_t list = 0; list < listCount; list++) {
+      if (0 == counts[list]) {
+        continue;
+      }
+      for (size_t d = 0; d < dimension; d++) {
+        centroids[list * dimension + d] =
+            static_cast<float>(sums[list * dimension + d] / counts[list]);
+      }
+    }
+  }
+
+  return centroids;
+}
+
+std::vector<uint32_t>
+SpectrumIndex::assignLists(const float *features, size_t rowCount,
+                           const std::vector<float> &centroids,
+                           size_t listCount, size_t dimension,
+                           ThreadPool &pool) {
+  std::vector<uint32_t> lists(rowCount);
+  size_t chunkSize =
+      std::max<size_t>(SPECTRUM_INDEX_MIN_ASSIGN_CHUNK,
+                       rowCount / (4 * pool.getThreadCount()) + 1);
+  std::vector<std::future<void>> futures;
+  for (size_t offset = 0; offset < rowCount; offset += chunkSize) {
+    size_t end = std::min(rowCount, offset + chunkSize);
+    futures.push_back(pool.submit([&, offset, end]() {
+      for (size_t row = offset; row < end; row++) {
+        const float *vector = features + row * dimension;
+        float bestDistance = std::numeric_limits<float>::infinity();
+        uint32_t bestList = 0;
+        for (size_t list = 0; list < listCount; list++) {
+          float distance = squaredDistance(
+              vector, centroids.data() + list * dimension, dimension);
+          if (distance < bestDistance) {
+            bestDistance = distance;
+            bestList = static_cast<uint32_t>(list);
+          }
+        }
+        lists[row] = bestList;
+      }
+    }));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+
+  return lists;
+}
@@ -0,0 +1,254 @@
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+// Project includes
+#include <impedance_kernels.hpp>
+#include <impedance_kernels_simd.hpp>
+
+#ifdef IMPEDANCE_KERNELS_X86
+// OS includes
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <emmintrin.h>
+#endif
+
+/// The count of impedances, that cartesianToPolar() deinterleaves at once.
+#define POLAR_CHUNK_SIZE 256
+
+using namespace Utilities;
+using namespace Utilities::KernelDetail;
+
+namespace {
+void scalarMagnitude(const double *real, const double *imag,
+                     double *magnitudes, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    magnitudes[i] = std::sqrt(real[i] * real[i] + imag[i] * imag[i]);
+  }
+}
+
+void scalarPhase(const double *real, const double *imag, double *phases,
+                 size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    phases[i] = std::atan2(imag[i], real[i]);
+  }
+}
+
+void scalarMagnitudeDb(const double *real, const double *imag,
+                       double *decibels, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    decibels[i] = 10.0 * std::log10(real[i] * real[i] + imag[i] * imag[i]);
+  }
+}
+
+void scalarNormalize(const double *real, const double *imag,
+                     const double *baselineReal, const double *baselineImag,
+                     double *normalizedReal, double *normalizedImag,
+                     size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    double a = real[i];
+    double b = imag[i];
+    double c = baselineReal[i];
+    double d = baselineImag[i];
+    double denominator = c * c + d * d;
+    normalizedReal[i] = (a * c + b * d) / denominator;
+    normalizedImag[i] = (b * c - a * d) / denominator;
+  }
+}
+
+const KernelTable SCALAR_KERNELS = {scalarMagnitude, scalarPhase,
+                                    scalarMagnitudeDb, scalarNormalize};
+
+#ifdef IMPEDANCE_KERNELS_X86
+/**
+ * @brief Vector operations on two doubles. SSE2 is part of every x86-64 CPU.
+ */
+struct Sse2Ops {
+  using Vector = __m128d;
+  static constexpr size_t WIDTH = 2;
+
+  static Vector load(const double *p) { return _mm_loadu_pd(p); }
+  static void store(double *p, Vector a) { _mm_storeu_pd(p, a); }
+  static Vector set1(double a) { return _mm_set1_pd(a); }
+  static Vector add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+  static Vector sub(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+  static Vector mul(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+  static Vector div(Vector a, Vector b) { return _mm_div_pd(a, b); }
+  static Vector sqrt(Vector a) { return _mm_sqrt_pd(a); }
+  static Vector min(Vector a, Vector b) { return _mm_min_pd(a, b); }
+  static Vector max(Vector a, Vector b) { return _mm_max_pd(a, b); }
+  static Vector abs(Vector a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+  static Vector copysign(Vector a, Vector sign) {
+    Vector mask = _mm_set1_pd(-0.0);
+    return _mm_or_pd(_mm_andnot_pd(mask, a), _mm_and_pd(mask, sign));
+  }
+  static Vector cmpgt(Vector a, Vector b) { return _mm_cmpgt_pd(a, b); }
+  static Vector cmpeq(Vector a, Vector b) { return _mm_cmpeq_pd(a, b); }
+  static Vector cmpnge(Vector a, Vector b) { return _mm_cmpnge_pd(a, b); }
+  static Vector cmpunord(Vector a, Vector b) { return _mm_cmpunord_pd(a, b); }
+  static Vector orMask(Vector a, Vector b) { return _mm_or_pd(a, b); }
+  static int movemask(Vector mask) { return _mm_movemask_pd(mask); }
+  /// Returns b where the mask is set and a elsewhere.
+  static Vector blend(Vector a, Vector b, Vector mask) {
+    return _mm_or_pd(_mm_andnot_pd(mask, a), _mm_and_pd(mask, b));
+  }
+  /// Returns the biased exponent of positive, normal numbers.
+  static Vector exponent(Vector a) {
+    // Placing the exponent into the mantissa of 2^52 converts it exactly.
+    __m128i bits = _mm_srli_epi64(_mm_castpd_si128(a), 52);
+    Vector magic = _mm_castsi128_pd(_mm_set1_epi64x(0x4330000000000000));
+    return _mm_sub_pd(_mm_or_pd(_mm_castsi128_pd(bits), magic), magic);
+  }
+  /// Returns the mantissa of positive, normal numbers within [0.5, 1).
+  static Vector mantissa(Vector a) {
+    __m128i bits = _mm_and_si128(_mm_castpd_si128(a),
+                                 _mm_set1_epi64x(0x000FFFFFFFFFFFFF));
+    return _mm_castsi128_pd(
+        _mm_or_si128(bits, _mm_set1_epi64x(0x3FE0000000000000)));
+  }
+};
+
+const KernelTable SSE2_KERNELS = {
+    magnitudeKernel<Sse2Ops>, phaseKernel<Sse2Ops>,
+    magnitudeDbKernel<Sse2Ops>, normalizeKernel<Sse2Ops>};
+
+/**
+ * @brief Checks, whether the CPU and the operating system support AVX2.
+ */
+bool isAvx2Supported() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  // The OS has to save the AVX registers on context switches.
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+/**
+ * @brief Returns the kernels of the given instruction set.
+ */
+const KernelTable *getKernels(KernelInstructionSet instructionSet) {
+  switch (instructionSet) {
+#ifdef IMPEDANCE_KERNELS_X86
+  case KERNEL_INSTRUCTION_SET_AVX2:
+    return &getAvx2Kernels();
+  case KERNEL_INSTRUCTION_SET_SSE2:
+    return &SSE2_KERNELS;
+#endif
+  default:
+    return &SCALAR_KERNELS;
+  }
+}
+
+/**
+ * @brief Returns the instruction set, that is currently used. Initialized on
+ * first use, so that the kernels can be called during static initialization.
+ */
+std::atomic<KernelInstructionSet> &getCurrentInstructionSet() {
+  static std::atomic<KernelInstructionSet> instructionSet =
+      getSupportedKernelInstructionSet();
+  return instructionSet;
+}
+
+/**
+ * @brief Returns the kernels, that are currently used.
+ */
+std::atomic<const KernelTable *> &getCurrentKernels() {
+  static std::atomic<const KernelTable *> kernels =
+      getKernels(getCurrentInstructionSet());
+  return kernels;
+}
+} // namespace
+
+KernelInstructionSet Utilities::getSupportedKernelInstructionSet() {
+#ifdef IMPEDANCE_KERNELS_X86
+  static const KernelInstructionSet supported =
+      isAvx2Supported() ? KERNEL_INSTRUCTION_SET_AVX2
+                        : KERNEL_INSTRUCTION_SET_SSE2;
+  return supported;
+#else
+  return KERNEL_INSTRUCTION_SET_SCALAR;
+#endif
+}
+
+KernelInstructionSet Utilities::getKernelInstructionSet() {
+  return getCurrentInstructionSet();
+}
+
+bool Utilities::setKernelInstructionSet(KernelInstructionSet instructionSet) {
+  if (instructionSet < KERNEL_INSTRUCTION_SET_SCALAR ||
+      instructionSet > getSupportedKernelInstructionSet()) {
+    return false;
+  }
+
+  getCurrentInstructionSet() = instructionSet;
+  getCurrentKernels() = getKernels(instructionSet);
+  return true;
+}
+
+void Utilities::computeMagnitudes(const double *real, const double *imag,
+                                  double *magnitudes, size_t count) {
+  getCurrentKernels().load()->magnitude(real, imag, magnitudes, count);
+}
+
+void Utilities::computePhases(const double *real, const double *imag,
+                              double *phases, size_t count) {
+  getCurrentKernels().load()->phase(real, imag, phases, count);
+}
+
+void Utilities::computeMagnitudesDb(const double *real, const double *imag,
+                                    double *decibels, size_t count) {
+  getCurrentKernels().load()->magnitudeDb(real, imag, decibels, count);
+}
+
+void Utilities::normalizeToBaseline(const double *real, const double *imag,
+                                    const double *baselineReal,
+                                    const double *baselineImag,
+                                    double *normalizedReal,
+                                    double *normalizedImag, size_t count) {
+  getCurrentKernels().load()->normalize(real, imag, baselineReal, baselineImag,
+                                   normalizedReal, normalizedImag, count);
+}
+
+void Utilities::cartesianToPolar(const double *cartesian, double *polar,
+                                 size_t count) {
+  const KernelTable *kernels = getCurrentKernels().load();
+  double real[POLAR_CHUNK_SIZE];
+  double imag[POLAR_CHUNK_SIZE];
+  double magnitudes[POLAR_CHUNK_SIZE];
+  double phases[POLAR_CHUNK_SIZE];
+
+  // The kernels work on separate arrays, so the pairs are split up chunk by
+  // chunk. A chunk is read completely before it is written, which allows to
+  // convert in place.
+  for (size_t offset = 0; offset < count; offset += POLAR_CHUNK_SIZE) {
+    size_t chunkSize = std::min<size_t>(POLAR_CHUNK_SIZE, count - offset);
+    const double *in = cartesian + 2 * offset;
+    for (size_t i = 0; i < chunkSize; i++) {
+      real[i] = in[2 * i];
+      imag[i] = in[2 * i + 1];
+    }
+    kernels->magnitude(real, imag, magnitudes, chunkSize);
+    kernels->phase(real, imag, phases, chunkSize);
+    double *out = polar + 2 * offset;
+    for (size_t i = 0; i < chunkSize; i++) {
+      out[2 * i] = magnitudes[i];
+      out[2 * i + 1] = phases[i];
+    }
+  }
+}
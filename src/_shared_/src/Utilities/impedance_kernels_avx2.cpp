@@ -0,0 +1,102 @@
+// The kernels of this file are compiled for AVX2. They are only called, once
+// the CPU has been checked to support AVX2. MSVC accepts AVX2 intrinsics
+// without further options, GCC and Clang need them to be enabled for the
+// functions, that use them. The standard headers are included beforehand, so
+// that none of their inline functions is compiled for AVX2.
+
+// Standard includes
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) && defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))),                  \
+                             apply_to = function)
+#elif defined(__x86_64__) && defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+// Project includes
+#include <impedance_kernels_simd.hpp>
+
+#ifdef IMPEDANCE_KERNELS_X86
+// OS includes
+#include <immintrin.h>
+
+using namespace Utilities::KernelDetail;
+
+namespace {
+/**
+ * @brief Vector operations on four doubles.
+ */
+struct Avx2Ops {
+  using Vector = __m256d;
+  static constexpr size_t WIDTH = 4;
+
+  static Vector load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, Vector a) { _mm256_storeu_pd(p, a); }
+  static Vector set1(double a) { return _mm256_set1_pd(a); }
+  static Vector add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+  static Vector sub(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+  static Vector mul(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+  static Vector div(Vector a, Vector b) { return _mm256_div_pd(a, b); }
+  static Vector sqrt(Vector a) { return _mm256_sqrt_pd(a); }
+  static Vector min(Vector a, Vector b) { return _mm256_min_pd(a, b); }
+  static Vector max(Vector a, Vector b) { return _mm256_max_pd(a, b); }
+  static Vector abs(Vector a) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);
+  }
+  static Vector copysign(Vector a, Vector sign) {
+    Vector mask = _mm256_set1_pd(-0.0);
+    return _mm256_or_pd(_mm256_andnot_pd(mask, a), _mm256_and_pd(mask, sign));
+  }
+  static Vector cmpgt(Vector a, Vector b) {
+    return _mm256_cmp_pd(a, b, _CMP_GT_OQ);
+  }
+  static Vector cmpeq(Vector a, Vector b) {
+    return _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+  }
+  static Vector cmpnge(Vector a, Vector b) {
+    return _mm256_cmp_pd(a, b, _CMP_NGE_UQ);
+  }
+  static Vector cmpunord(Vector a, Vector b) {
+    return _mm256_cmp_pd(a, b, _CMP_UNORD_Q);
+  }
+  static Vector orMask(Vector a, Vector b) { return _mm256_or_pd(a, b); }
+  static int movemask(Vector mask) { return _mm256_movemask_pd(mask); }
+  /// Returns b where the mask is set and a elsewhere.
+  static Vector blend(Vector a, Vector b, Vector mask) {
+    return _mm256_blendv_pd(a, b, mask);
+  }
+  /// Returns the biased exponent of positive, normal numbers.
+  static Vector exponent(Vector a) {
+    // Placing the exponent into the mantissa of 2^52 converts it exactly.
+    __m256i bits = _mm256_srli_epi64(_mm256_castpd_si256(a), 52);
+    Vector magic = _mm256_castsi256_pd(_mm256_set1_epi64x(0x4330000000000000));
+    return _mm256_sub_pd(_mm256_or_pd(_mm256_castsi256_pd(bits), magic),
+                         magic);
+  }
+  /// Returns the mantissa of positive, normal numbers within [0.5, 1).
+  static Vector mantissa(Vector a) {
+    __m256i bits = _mm256_and_si256(_mm256_castpd_si256(a),
+                                    _mm256_set1_epi64x(0x000FFFFFFFFFFFFF));
+    return _mm256_castsi256_pd(
+        _mm256_or_si256(bits, _mm256_set1_epi64x(0x3FE0000000000000)));
+  }
+};
+} // namespace
+
+const KernelTable &Utilities::KernelDetail::getAvx2Kernels() {
+  static const KernelTable kernels = {
+      magnitudeKernel<Avx2Ops>, phaseKernel<Avx2Ops>,
+      magnitudeDbKernel<Avx2Ops>, normalizeKernel<Avx2Ops>};
+  return kernels;
+}
+#endif
+
+#if defined(__x86_64__) && defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__x86_64__) && defined(__GNUC__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,120 @@
+// OS includes
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Project includes
+#include <mapped_file.hpp>
+
+namespace Utilities {
+
+MappedFile::MappedFile()
+    : mappedData(nullptr), mappedSize(0), openFlag(false),
+#ifdef WIN32
+      fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#else
+      fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile() { this->close(); }
+
+bool MappedFile::open(const std::string &fileName) {
+  if (this->isOpen()) {
+    return false;
+  }
+
+#ifdef WIN32
+  this->fileHandle =
+      CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (this->fileHandle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(this->fileHandle, &fileSize)) {
+    this->close();
+    return false;
+  }
+  this->mappedSize = static_cast<size_t>(fileSize.QuadPart);
+  // Empty files can not be mapped. They are represented by an empty view.
+  if (this->mappedSize > 0) {
+    this->mappingHandle = CreateFileMappingA(this->fileHandle, nullptr,
+                                             PAGE_READONLY, 0, 0, nullptr);
+    if (this->mappingHandle == nullptr) {
+      this->close();
+      return false;
+    }
+    void *view = MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+      this->close();
+      return false;
+    }
+    this->mappedData = static_cast<const std::byte *>(view);
+  }
+#else
+  this->fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+  if (this->fileDescriptor < 0) {
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(this->fileDescriptor, &fileStat) != 0) {
+    this->close();
+    return false;
+  }
+  this->mappedSize = static_cast<size_t>(fileStat.st_size);
+  // Empty files can not be mapped. They are represented by an empty view.
+  if (this->mappedSize > 0) {
+    void *view = mmap(nullptr, this->mappedSize, PROT_READ, MAP_SHARED,
+                      this->fileDescriptor, 0);
+    if (view == MAP_FAILED) {
+      this->close();
+      return false;
+    }
+    this->mappedData = static_cast<const std::byte *>(view);
+  }
+#endif
+
+  this->openFlag = true;
+  return true;
+}
+
+void MappedFile::close() {
+#ifdef WIN32
+  if (this->mappedData != nullptr) {
+    UnmapViewOfFile(this->mappedData);
+  }
+  if (this->mappingHandle != nullptr) {
+    CloseHandle(this->mappingHandle);
+    this->mappingHandle = nullptr;
+  }
+  if (this->fileHandle != INVALID_HANDLE_VALUE) {
+    CloseHandle(this->fileHandle);
+    this->fileHandle = INVALID_HANDLE_VALUE;
+  }
+#else
+  if (this->mappedData != nullptr) {
+    munmap(const_cast<std::byte *>(this->mappedData), this->mappedSize);
+  }
+  if (this->fileDescriptor >= 0) {
+    ::close(this->fileDescriptor);
+    this->fileDescriptor = -1;
+  }
+#endif
+
+  this->mappedData = nullptr;
+  this->mappedSize = 0;
+  this->openFlag = false;
+}
+
+bool MappedFile::isOpen() const { return this->openFlag; }
+
+size_t MappedFile::size() const { return this->mappedSize; }
+
+} // namespace Utilities
@@ -0,0 +1,48 @@
+// Standard includes
+#include <algorithm>
+
+// Project includes
+#include <thread_pool.hpp>
+
+using namespace Utilities;
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+  for (unsigned int i = 0; i < std::max(threadCount, 1u); i++) {
+    this->threads.emplace_back(&ThreadPool::worker, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lockGuard(this->taskMutex);
+    this->stopFlag = true;
+  }
+  this->taskCondition.notify_all();
+
+  for (auto &thread : this->threads) {
+    thread.join();
+  }
+}
+
+unsigned int ThreadPool::getThreadCount() const {
+  return static_cast<unsigned int>(this->threads.size());
+}
+
+void ThreadPool::worker() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(this->taskMutex);
+      this->taskCondition.wait(
+          lock, [this] { return this->stopFlag || !this->tasks.empty(); });
+      if (this->tasks.empty()) {
+        // The pool is stopped and all tasks have been executed.
+        return;
+      }
+      task = std::move(this->tasks.front());
+      this->tasks.pop();
+    }
+
+    task();
+  }
+}
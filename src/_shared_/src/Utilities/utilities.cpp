@@ -1,4 +1,6 @@
+#include <charconv>
 #include <span>
+#include <sstream>
 
 #include <utilities.hpp>
 
@@ -110,6 +112,67 @@ void splitImpedance(const std::vector<Impedance> &impedanceVec,
   }
 }
 
+std::string globToRegex(const std::string &glob) {
+  std::string regex = "^";
+  bool inClass = false;
+  for (size_t i = 0; i < glob.size(); i++) {
+    char c = glob[i];
+    if (inClass) {
+      if (c == ']') {
+        inClass = false;
+      } else if (c == '\\') {
+        regex += '\\';
+      }
+      regex += c;
+      continue;
+    }
+
+    switch (c) {
+    case '*':
+      regex += ".*";
+      break;
+    case '?':
+      regex += '.';
+      break;
+    case '[':
+      // An unterminated class is taken literally.
+      if (glob.find(']', i + 1) == std::string::npos) {
+        regex += "\\[";
+        break;
+      }
+      inClass = true;
+      regex += '[';
+      if (i + 1 < glob.size() && glob[i + 1] == '!') {
+        regex += '^';
+        i++;
+      }
+      break;
+    default:
+      if (std::string("\\^$.|+()[]{}").find(c) != std::string::npos) {
+        regex += '\\';
+      }
+      regex += c;
+    }
+  }
+  regex += '$';
+
+  return regex;
+}
+
+bool parseTimePoint(const std::string &str, TimePoint &timePoint) {
+  long long milliseconds = 0;
+  auto result =
+      std::from_chars(str.data(), str.data() + str.size(), milliseconds);
+  if (result.ec == std::errc() && result.ptr == str.data() + str.size()) {
+    timePoint = TimePoint(Duration(milliseconds));
+    return true;
+  }
+
+  std::istringstream ss(str);
+  ss >> std::chrono::parse("%Y-%m-%dT%H:%M:%S", timePoint);
+  return !ss.fail();
+}
+
 void joinImpedanceSpectrum(
     const std::vector<std::vector<std::vector<double>>> &array,
     const std::vector<double> &spectrumMapping,
@@ -4,30 +4,40 @@
 namespace Utilities {
 
 KeyMapping buildKeyMappingFromFlatbuffers(
-    const std::vector<
-        std::unique_ptr<Serialization::Messages::KeyMappingEntryT>>
-        &fbKeyMapping) {
+    const flatbuffers::Vector<
+        flatbuffers::Offset<Serialization::Messages::KeyMappingEntry>>
+        *fbKeyMapping) {
 
   // The key mapping.
   KeyMapping keyMapping;
-  for (auto &keyMappingEntry : fbKeyMapping) {
-    keyMapping[keyMappingEntry->keys] =
-        static_cast<DataManagerDataType>(keyMappingEntry->dataTypes);
+  if (!fbKeyMapping) {
+    return keyMapping;
+  }
+  for (auto keyMappingEntry : *fbKeyMapping) {
+    keyMapping[flatbuffers::GetString(keyMappingEntry->keys())] =
+        static_cast<DataManagerDataType>(keyMappingEntry->dataTypes());
   }
 
   return keyMapping;
 }
 
 SpectrumMapping buildSpectrumMappingFromFlatbuffers(
-    const std::vector<
-        std::unique_ptr<Serialization::Messages::SpectrumMappingEntryT>>
-        &fbSpectrumMapping) {
+    const flatbuffers::Vector<
+        flatbuffers::Offset<Serialization::Messages::SpectrumMappingEntry>>
+        *fbSpectrumMapping) {
 
   // The spectrum mapping.
   SpectrumMapping spectrumMapping;
-  for (auto &spectrumMappingEntry : fbSpectrumMapping) {
-    spectrumMapping[spectrumMappingEntry->key] =
-        spectrumMappingEntry->frequencies;
+  if (!fbSpectrumMapping) {
+    return spectrumMapping;
+  }
+  for (auto spectrumMappingEntry : *fbSpectrumMapping) {
+    std::vector<double> &frequencies =
+        spectrumMapping[flatbuffers::GetString(spectrumMappingEntry->key())];
+    if (spectrumMappingEntry->frequencies()) {
+      frequencies.assign(spectrumMappingEntry->frequencies()->begin(),
+                         spectrumMappingEntry->frequencies()->end());
+    }
   }
 
   return spectrumMapping;
@@ -2,6 +2,7 @@
 #include <easylogging++.h>
 
 // Project includes
+#include <clock.hpp>
 #include <common.hpp>
 #include <control_worker.hpp>
 #include <data_response_payload.hpp>
@@ -36,9 +37,9 @@ bool ControlWorker::start() {
     this->controlWorkerSubState =
         ControlWorkerSubState::CONTROL_WORKER_SUBSTATE_REMOTE_RUNNING;
     this->deviceState = DeviceStatus::OPERATING;
-    this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-        new WriteDeviceMessage(this->getUserId(), this->getSentryId(),
-                               WriteDeviceTopic::WRITE_TOPIC_RUN)));
+    this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+        this->getUserId(), this->getSentryId(),
+        WriteDeviceTopic::WRITE_TOPIC_RUN));
 
     return true;
   }
@@ -53,9 +54,9 @@ bool ControlWorker::stop() {
     this->controlWorkerSubState =
         ControlWorkerSubState::CONTROL_WORKER_SUBSTATE_REMOTE_STOPPED;
     this->deviceState = DeviceStatus::IDLE;
-    this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-        new WriteDeviceMessage(this->getUserId(), this->getSentryId(),
-                               WriteDeviceTopic::WRITE_TOPIC_STOP)));
+    this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+        this->getUserId(), this->getSentryId(),
+        WriteDeviceTopic::WRITE_TOPIC_STOP));
 
     return true;
   }
@@ -163,10 +164,9 @@ bool ControlWorker::handleResponse(
         this->controlWorkerSubState =
             ControlWorkerSubState::CONTROL_WORKER_SUBSTATE_CONF_EXPLORE;
         for (auto &keyValuePair : this->remoteHostIds) {
-          this->pushMessageQueue(
-              std::shared_ptr<DeviceMessage>(new WriteDeviceMessage(
-                  this->getUserId(), keyValuePair.first,
-                  WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+          this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+              this->getUserId(), keyValuePair.first,
+              WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
         }
 
         return true;
@@ -179,10 +179,9 @@ bool ControlWorker::handleResponse(
               CONTROL_WORKER_SUBSTATE_WAITING_FOR_CONNECTION;
         } else {
           // Time out has not yet elapsed. Send another query state message.
-          this->pushMessageQueue(
-              std::shared_ptr<DeviceMessage>(new WriteDeviceMessage(
-                  this->getUserId(), response->getSource(),
-                  WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+          this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+              this->getUserId(), response->getSource(),
+              WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
         }
         return true;
       }
@@ -243,12 +242,14 @@ bool ControlWorker::handleResponse(
           DeviceStatus::OPERATING) {
         this->controlWorkerSubState =
             ControlWorkerSubState::CONTROL_WORKER_SUBSTATE_CONF_GET_DATA_KEYS;
-        std::shared_ptr<DeviceMessage> requestPumpKeyMsg(new WriteDeviceMessage(
-            this->getUserId(), this->getPumpControllerId(),
-            WriteDeviceTopic::WRITE_TOPIC_REQUEST_KEYS));
-        std::shared_ptr<DeviceMessage> requestSpectrometerKeyMsg(
-            new WriteDeviceMessage(this->getUserId(), this->getSpectrometerId(),
-                                   WriteDeviceTopic::WRITE_TOPIC_REQUEST_KEYS));
+        std::shared_ptr<DeviceMessage> requestPumpKeyMsg =
+            Utilities::makePooled<WriteDeviceMessage>(
+                this->getUserId(), this->getPumpControllerId(),
+                WriteDeviceTopic::WRITE_TOPIC_REQUEST_KEYS);
+        std::shared_ptr<DeviceMessage> requestSpectrometerKeyMsg =
+            Utilities::makePooled<WriteDeviceMessage>(
+                this->getUserId(), this->getSpectrometerId(),
+                WriteDeviceTopic::WRITE_TOPIC_REQUEST_KEYS);
         this->pushMessageQueue(requestPumpKeyMsg);
         this->pushMessageQueue(requestSpectrometerKeyMsg);
 
@@ -275,9 +276,9 @@ bool ControlWorker::handleResponse(
         }
 
         if (statusPayload->getDeviceStatus() == DeviceStatus::INITIALIZED) {
-          this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-              new ConfigDeviceMessage(this->getUserId(), this->getSentryId(),
-                                      this->remoteConfigPayload)));
+          this->pushMessageQueue(Utilities::makePooled<ConfigDeviceMessage>(
+              this->getUserId(), this->getSentryId(),
+              this->remoteConfigPayload));
           this->controlWorkerSubState =
               ControlWorkerSubState::CONTROL_WORKER_SUBSTATE_CONF_REMOTE;
 
@@ -311,13 +312,14 @@ bool ControlWorker::handleResponse(
           spectrometerIt != this->remoteStatus.end()) {
         // Configuration succeeded for the remote devices. Request their data
         // keys by sending corresponding messages.
-        std::shared_ptr<DeviceMessage> requestPumpKeyMsg(
-            new WriteDeviceMessage(this->getUserId(), (*pumpIt)->getDeviceId(),
-                                   WriteDeviceTopic::WRITE_TOPIC_REQUEST_KEYS));
-        std::shared_ptr<DeviceMessage> requestSpectrometerKeyMsg(
-            new WriteDeviceMessage(this->getUserId(),
-                                   (*spectrometerIt)->getDeviceId(),
-                                   WriteDeviceTopic::WRITE_TOPIC_REQUEST_KEYS));
+        std::shared_ptr<DeviceMessage> requestPumpKeyMsg =
+            Utilities::makePooled<WriteDeviceMessage>(
+                this->getUserId(), (*pumpIt)->getDeviceId(),
+                WriteDeviceTopic::WRITE_TOPIC_REQUEST_KEYS);
+        std::shared_ptr<DeviceMessage> requestSpectrometerKeyMsg =
+            Utilities::makePooled<WriteDeviceMessage>(
+                this->getUserId(), (*spectrometerIt)->getDeviceId(),
+                WriteDeviceTopic::WRITE_TOPIC_REQUEST_KEYS);
 
         this->controlWorkerSubState =
             CONTROL_WORKER_SUBSTATE_CONF_GET_DATA_KEYS;
@@ -474,22 +476,23 @@ bool ControlWorker::startConnect(std::string ip, int port) {
             << port;
   this->controlWorkerSubState = CONTROL_WORKER_SUBSTATE_CONNECTING;
   // Send the init, config and start message to the network worker.
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(new InitDeviceMessage(
+  this->pushMessageQueue(Utilities::makePooled<InitDeviceMessage>(
       this->getUserId(), this->networkWorkerId,
       new NetworkWorkerInitPayload(
           NetworkWorkerOperationMode::NETWORK_WORKER_OP_MODE_CLIENT, ip,
-          port))));
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(new ConfigDeviceMessage(
-      this->getUserId(), this->networkWorkerId, nullptr, {this->getUserId()})));
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new WriteDeviceMessage(this->getUserId(), this->networkWorkerId,
-                             WriteDeviceTopic::WRITE_TOPIC_RUN)));
+          port)));
+  this->pushMessageQueue(Utilities::makePooled<ConfigDeviceMessage>(
+      this->getUserId(), this->networkWorkerId, nullptr,
+      std::vector<UserId>{this->getUserId()}));
+  this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+      this->getUserId(), this->networkWorkerId,
+      WriteDeviceTopic::WRITE_TOPIC_RUN));
   // Begin querying the state of the network worker, in order to check if the
   // connection is successfull.
   this->connectionTimeout = Core::getNow();
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new WriteDeviceMessage(this->getUserId(), this->networkWorkerId,
-                             WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+  this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+      this->getUserId(), this->networkWorkerId,
+      WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
 
   return true;
 }
@@ -520,8 +523,8 @@ bool ControlWorker::startConfig(
   this->controlWorkerSubState =
       ControlWorkerSubState::CONTROL_WORKER_SUBSTATE_INIT_REMOTE;
 
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(new InitDeviceMessage(
-      this->getUserId(), this->getSentryId(), this->remoteInitPayload)));
+  this->pushMessageQueue(Utilities::makePooled<InitDeviceMessage>(
+      this->getUserId(), this->getSentryId(), this->remoteInitPayload));
 
   // Logic continues in handleResponse().
   return true;
@@ -557,16 +560,16 @@ void ControlWorker::queryRemoteStateWorker() {
 
       // Send a query state message to each remote id.
       for (auto &keyValuePair : this->remoteHostIds) {
-        this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-            new WriteDeviceMessage(this->getUserId(), keyValuePair.first,
-                                   WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+        this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+            this->getUserId(), keyValuePair.first,
+            WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
       }
 
     } else {
       break;
     }
 
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    Core::sleepFor(std::chrono::seconds(1));
   }
 }
 
@@ -607,8 +610,8 @@ bool ControlWorker::setRemoteWorkerState(UserId remoteId, bool state) {
 
   WriteDeviceTopic enableState = state ? WriteDeviceTopic::WRITE_TOPIC_RUN
                                        : WriteDeviceTopic::WRITE_TOPIC_STOP;
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new WriteDeviceMessage(this->getUserId(), remoteId, enableState)));
+  this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+      this->getUserId(), remoteId, enableState));
   return true;
 }
 
@@ -704,10 +707,9 @@ void ControlWorker::dataQueryWorker() {
 
         std::shared_ptr<RequestDataPayload> requestDataPayload(
             new RequestDataPayload(from, this->lastDataQuery, remoteKey));
-        messageList.emplace_back(std::shared_ptr<DeviceMessage>(
-            new WriteDeviceMessage(this->getUserId(), remoteId,
-                                   WriteDeviceTopic::WRITE_TOPIC_REQUEST_DATA,
-                                   requestDataPayload)));
+        messageList.emplace_back(Utilities::makePooled<WriteDeviceMessage>(
+            this->getUserId(), remoteId,
+            WriteDeviceTopic::WRITE_TOPIC_REQUEST_DATA, requestDataPayload));
       }
       this->pushMessageQueue(messageList);
 
@@ -726,9 +728,9 @@ void ControlWorker::dataQueryWorker() {
               new RequestDataPayload(this->lastDataQuery, now, key.first));
 
           dataQueryMessages.emplace_back(
-              std::shared_ptr<DeviceMessage>(new WriteDeviceMessage(
+              Utilities::makePooled<WriteDeviceMessage>(
                   this->getUserId(), UserId(remoteDataKeyEntry.first),
-                  Messages::WRITE_TOPIC_REQUEST_DATA, dataRequestPayload)));
+                  Messages::WRITE_TOPIC_REQUEST_DATA, dataRequestPayload));
         }
       }
 
@@ -736,7 +738,7 @@ void ControlWorker::dataQueryWorker() {
       this->lastDataQuery = now;
     }
 
-    std::this_thread::sleep_for(this->dataQueryInterval);
+    Core::sleepFor(this->dataQueryInterval);
   }
 }
 
@@ -889,9 +891,10 @@ bool ControlWorker::setPressure(int channel, double pressure) {
 
   std::shared_ptr<SetPressurePayload> setPressurePayload(
       new SetPressurePayload(pressures, PressureUnit::BAR));
-  std::shared_ptr<WriteDeviceMessage> writeMsg(new WriteDeviceMessage(
-      this->getUserId(), this->getPumpControllerId(),
-      WriteDeviceTopic::WRITE_TOPIC_DEVICE_SPECIFIC, setPressurePayload));
+  std::shared_ptr<WriteDeviceMessage> writeMsg =
+      Utilities::makePooled<WriteDeviceMessage>(
+          this->getUserId(), this->getPumpControllerId(),
+          WriteDeviceTopic::WRITE_TOPIC_DEVICE_SPECIFIC, setPressurePayload);
   this->pushMessageQueue(writeMsg);
 
   return true;
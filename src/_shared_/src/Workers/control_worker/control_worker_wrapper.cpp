@@ -2,6 +2,7 @@
 #include <Elveflow64_shim.h>
 
 // Project includes
+#include <clock.hpp>
 #include <control_worker_wrapper.hpp>
 #include <isx3_init_payload.hpp>
 #include <isx3_is_conf_payload.hpp>
@@ -16,7 +17,9 @@ using namespace Devices;
 ControlWorkerWrapper::ControlWorkerWrapper(int messageDistributorInterval,
                                            QObject *parent)
     : QObject(parent),
-      messageDistributor(new MessageDistributor(messageDistributorInterval)),
+      messageDistributor(new MessageDistributor(
+          messageDistributorInterval, MESSAGE_DISTRIBUTOR_MODE_EVENT_DRIVEN,
+          CONTROL_WORKER_WRAPPER_DISTRIBUTOR_WORKER_COUNT)),
       networkWorker(new NetworkWorker()), controlWorker(new ControlWorker()),
       messageThread(nullptr), doPeriodicActions(true),
       recentSpectrumQueryTimestamp(), recentCurrentPressureTimestamp(),
@@ -37,8 +40,8 @@ ControlWorkerWrapper::ControlWorkerWrapper(int messageDistributorInterval,
 
   // Immediatelly send a init message to the control worker.
   this->messageDistributor->takeMessage(
-      std::shared_ptr<DeviceMessage>(new InitDeviceMessage(
-          UserId(), this->controlWorker->getUserId(), nullptr)));
+      Utilities::makePooled<InitDeviceMessage>(
+          UserId(), this->controlWorker->getUserId(), nullptr));
 }
 
 void ControlWorkerWrapper::startStateQuery() {
@@ -118,7 +121,7 @@ void ControlWorkerWrapper::periodicActionsWorker() {
       this->recentCurrentPressureTimestamp = now;
     }
 
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    Core::sleepFor(std::chrono::seconds(1));
   }
 }
 
@@ -93,10 +93,9 @@ bool NetworkWorker::stop() {
 
   // Clear buffers.
   this->socketWrapper->clear();
-  this->readBuffer.clear();
+  this->frameDecoder.clear();
   this->outgoingNetworkMessagesMutex.lock();
-  std::queue<std::shared_ptr<DeviceMessage>> dummy;
-  outgoingNetworkMessages.swap(dummy);
+  this->outgoingNetworkMessages.clear();
   this->outgoingNetworkMessagesMutex.unlock();
 
   // Adjust states.
@@ -131,7 +130,7 @@ bool NetworkWorker::initialize(std::shared_ptr<InitPayload> initPayload) {
     this->listenerThread.reset();
   }
 
-  this->readBuffer.clear();
+  this->frameDecoder.clear();
   this->deviceState = DeviceStatus::INITIALIZED;
   this->initPayload = castedInitPayload;
   return true;
@@ -282,6 +281,8 @@ void NetworkWorker::commWorker() {
 
   LOG(INFO) << "Comm thread of Network Worker started.";
 
+  // Reused by every loop, so that decoding does not allocate the vector again.
+  std::vector<std::shared_ptr<DeviceMessage>> decodedMessages;
   while (this->doComm) {
     if (NetworkWorkerCommState::NETWORK_WOKER_COMM_STATE_STARTING ==
         this->commState) {
@@ -323,10 +324,11 @@ void NetworkWorker::commWorker() {
       if (NetworkWorkerOperationMode::NETWORK_WORKER_OP_MODE_CLIENT ==
           this->initPayload->getOperationMode()) {
         // The client initiates the handshake. Send a handshake message.
-        std::shared_ptr<DeviceMessage> handshakeMsg(
-            new HandshakeMessage(this->self->getUserId(), UserId(),
-                                 this->messageDistributor->getStatus(),
-                                 MessageFactory::getInstace()->getVersion()));
+        std::shared_ptr<DeviceMessage> handshakeMsg =
+            Utilities::makePooled<HandshakeMessage>(
+                this->self->getUserId(), UserId(),
+                this->messageDistributor->getStatus(),
+                MessageFactory::getInstace()->getVersion());
         bool success = this->socketWrapper->write(
             MessageFactory::getInstace()->encodeMessage(handshakeMsg));
         if (success) {
@@ -346,7 +348,7 @@ void NetworkWorker::commWorker() {
         // This state is only relevant if the worker is configured as
         // server. Read from the socket and try to decode a message from
         // that.
-        int readRet = this->socketWrapper->read(this->readBuffer);
+        int readRet = this->receive();
         if (readRet == -1) {
           // Connection got interrupted. Go back to listening.
           LOG(ERROR) << "Connection got interrupted while handshaking. "
@@ -354,7 +356,7 @@ void NetworkWorker::commWorker() {
           this->handleLostConnection();
         }
         std::shared_ptr<DeviceMessage> msg =
-            MessageFactory::getInstace()->decodeMessage(this->readBuffer);
+            MessageFactory::getInstace()->decodeMessage(this->frameDecoder);
 
         // Has a message been decoded?
         if (!msg) {
@@ -363,14 +365,14 @@ void NetworkWorker::commWorker() {
         }
 
         // A message has been decoded. Is it a handshake message?
-        auto handshakeMsg = dynamic_pointer_cast<HandshakeMessage>(msg);
-        if (!handshakeMsg) {
+        if (DEVICE_MESSAGE_KIND_HANDSHAKE != msg->getKind()) {
           // The decoded message is not a handshake message. Ignore it and
           // continue.
           LOG(INFO) << "Network worker expected a handshake message. "
                        "Got another message type instead.";
           continue;
         }
+        auto handshakeMsg = static_pointer_cast<HandshakeMessage>(msg);
 
         // The decoded message is a handshake message. Add the remote ids to
         // the proxy ids of this object and advance to working state.
@@ -379,11 +381,11 @@ void NetworkWorker::commWorker() {
           this->addProxyId(statusPayload->getDeviceId());
         }
         // Send back a handshake message.
-        std::shared_ptr<DeviceMessage> handshakeMsgResponse(
-            new HandshakeMessage(this->self->getUserId(),
-                                 handshakeMsg->getSource(),
-                                 this->messageDistributor->getStatus(),
-                                 MessageFactory::getInstace()->getVersion()));
+        std::shared_ptr<DeviceMessage> handshakeMsgResponse =
+            Utilities::makePooled<HandshakeMessage>(
+                this->self->getUserId(), handshakeMsg->getSource(),
+                this->messageDistributor->getStatus(),
+                MessageFactory::getInstace()->getVersion());
         int writeSuccess = this->socketWrapper->write(
             MessageFactory::getInstace()->encodeMessage(handshakeMsgResponse));
         if (writeSuccess >= 0) {
@@ -391,7 +393,7 @@ void NetworkWorker::commWorker() {
           this->commState =
               NetworkWorkerCommState::NETWORK_WOKER_COMM_STATE_WORKING;
           this->deviceState = DeviceStatus::OPERATING;
-          this->readBuffer.clear();
+          this->frameDecoder.clear();
         } else {
           LOG(ERROR) << "Connection failed during handshaking. Going back to "
                         "listening.";
@@ -415,7 +417,7 @@ void NetworkWorker::commWorker() {
              this->commState) {
       // This state is only relevant if the worker is configured as client.
       // Read from the socket and try to decode a message from that.
-      int readRet = this->socketWrapper->read(this->readBuffer);
+      int readRet = this->receive();
       if (readRet == -1) {
         // Connection got interrupted. Go into error state.
         LOG(ERROR) << "Connection got iterrupted while handshaking. Go into "
@@ -424,7 +426,7 @@ void NetworkWorker::commWorker() {
         break;
       }
       std::shared_ptr<DeviceMessage> msg =
-          MessageFactory::getInstace()->decodeMessage(this->readBuffer);
+          MessageFactory::getInstace()->decodeMessage(this->frameDecoder);
 
       // Has a message been decoded?
       if (!msg) {
@@ -433,14 +435,14 @@ void NetworkWorker::commWorker() {
       }
 
       // A message has been decoded. Is it a handshake message?
-      auto handshakeMsg = dynamic_pointer_cast<HandshakeMessage>(msg);
-      if (!handshakeMsg) {
+      if (DEVICE_MESSAGE_KIND_HANDSHAKE != msg->getKind()) {
         // The decoded message is not a handshake message. Ignore it and
         // continue.
         LOG(INFO) << "Network worker expected a handshake response message. "
                      "Got another message type instead.";
         continue;
       }
+      auto handshakeMsg = static_pointer_cast<HandshakeMessage>(msg);
 
       // The decoded message is a handshake message. Add the remote ids to
       // the proxy ids of this object and advance to working state.
@@ -451,7 +453,7 @@ void NetworkWorker::commWorker() {
       this->commState =
           NetworkWorkerCommState::NETWORK_WOKER_COMM_STATE_WORKING;
       this->deviceState = DeviceStatus::OPERATING;
-      this->readBuffer.clear();
+      this->frameDecoder.clear();
     }
 
     else if (NetworkWorkerCommState::NETWORK_WOKER_COMM_STATE_WORKING ==
@@ -462,7 +464,7 @@ void NetworkWorker::commWorker() {
       // messages meant for the communication partner over.
 
       // Read from socket.
-      int readSuccess = this->socketWrapper->read(this->readBuffer);
+      int readSuccess = this->receive();
       if (readSuccess < 0) {
         // Connection seems to be closed.
         LOG(ERROR) << "Other end point seems to have closed the connection. "
@@ -471,33 +473,38 @@ void NetworkWorker::commWorker() {
         break;
       }
 
-      std::shared_ptr<DeviceMessage> msg =
-          MessageFactory::getInstace()->decodeMessage(this->readBuffer);
-      // If a message could be decoded, push it to the queue.
-      if (msg) {
+      // Push all messages, that have been received completely, to the queue.
+      MessageFactory::getInstace()->decodeMessages(this->frameDecoder,
+                                                   decodedMessages);
+      for (auto &msg : decodedMessages) {
         VLOG(1) << "Network worker decoded a " << msg->serialize() << " from "
                 << msg->getSource().id() << ".";
         this->pushMessageQueue(msg);
       }
 
-      // Write message to socket.
-      this->outgoingNetworkMessagesMutex.lock();
-      while (!this->outgoingNetworkMessages.empty()) {
+      // Write message to socket. The buffer is not locked while writing, so
+      // control messages, that arrive during a bulk transfer, are sent next.
+      while (true) {
+        this->outgoingNetworkMessagesMutex.lock();
         std::shared_ptr<DeviceMessage> message =
-            this->outgoingNetworkMessages.front();
-        this->outgoingNetworkMessages.pop();
-        int sendSuccess = this->socketWrapper->write(
-            MessageFactory::getInstace()->encodeMessage(message));
+            this->outgoingNetworkMessages.pop();
+        this->outgoingNetworkMessagesMutex.unlock();
+        if (!message) {
+          break;
+        }
+        if (!MessageFactory::getInstace()->encodeMessage(
+                message, this->writeBuffer)) {
+          continue;
+        }
+        int sendSuccess = this->socketWrapper->write(this->writeBuffer);
         if (sendSuccess < 0) {
           // Connection seems to be closed.
           LOG(ERROR) << "Other end point seems to have closed the connection. "
                         "Closing down socket.";
           this->handleLostConnection();
-          this->outgoingNetworkMessagesMutex.unlock();
           break;
         }
       }
-      this->outgoingNetworkMessagesMutex.unlock();
 
     }
 
@@ -566,12 +573,10 @@ std::string NetworkWorker::getWorkerName() {
 
 void NetworkWorker::handleLostConnection() {
   // Clear buffers.
-  this->outgoingNetworkMessages = std::queue<std::shared_ptr<DeviceMessage>>();
   this->socketWrapper->clear();
-  this->readBuffer.clear();
+  this->frameDecoder.clear();
   this->outgoingNetworkMessagesMutex.lock();
-  std::queue<std::shared_ptr<DeviceMessage>> dummy;
-  outgoingNetworkMessages.swap(dummy);
+  this->outgoingNetworkMessages.clear();
   this->outgoingNetworkMessagesMutex.unlock();
 
   // Server goes back to listening. Client goes into error state.
@@ -603,13 +608,14 @@ void NetworkWorker::handleLostConnection() {
 
   // Send a state message to the event response ids.
   std::vector<std::shared_ptr<DeviceMessage>> responseMessages;
-  std::shared_ptr<ReadPayload> statePayload(
-      new NetworkWorkerStatePayload(this->commState));
+  std::shared_ptr<ReadPayload> statePayload =
+      Utilities::makePooled<NetworkWorkerStatePayload>(this->commState);
   for (auto &responseId : this->eventResponseId) {
-    std::shared_ptr<DeviceMessage> responseMsg(new ReadDeviceMessage(
-        this->getUserId(), responseId,
-        ReadDeviceTopic::READ_TOPIC_DEVICE_SPECIFIC_MSG, statePayload,
-        std::shared_ptr<WriteDeviceMessage>()));
+    std::shared_ptr<DeviceMessage> responseMsg =
+        Utilities::makePooled<ReadDeviceMessage>(
+            this->getUserId(), responseId,
+            ReadDeviceTopic::READ_TOPIC_DEVICE_SPECIFIC_MSG, statePayload,
+            std::shared_ptr<WriteDeviceMessage>());
     responseMessages.push_back(responseMsg);
   }
   this->pushMessageQueue(responseMessages);
@@ -619,4 +625,13 @@ std::string NetworkWorker::getDeviceTypeName() {
   return NETWORK_WORKER_TYPE_NAME;
 }
 
+int NetworkWorker::receive() {
+  this->readBuffer.clear();
+  int readRet = this->socketWrapper->read(this->readBuffer);
+  if (!this->readBuffer.empty()) {
+    this->frameDecoder.append(this->readBuffer);
+  }
+  return readRet;
+}
+
 } // namespace Workers
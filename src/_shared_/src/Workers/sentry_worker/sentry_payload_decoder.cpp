@@ -4,7 +4,7 @@
 #include <sentry_config_payload.hpp>
 #include <sentry_init_payload.hpp>
 #include <sentry_payload_decoder.hpp>
-#include <utilities_flatbuffers.hpp>>
+#include <utilities_flatbuffers.hpp>
 
 // 3rd party includes
 #include <flatbuffers/flatbuffers.h>
@@ -18,45 +18,75 @@ using namespace Messages;
 using namespace Workers;
 using namespace Utilities;
 
-InitPayload *
-SentryPayloadDecoder::decodeInitPayload(const std::vector<unsigned char> &data,
-                                        int magicNumber) {
+namespace {
+
+/**
+ * @brief Decodes a nested configuration payload together with its key and
+ * spectrum mapping.
+ * @param data The buffer of the enclosing payload.
+ * @param nestedPayload The nested payload.
+ * @return Pointer to the configuration payload. Null if it could not be
+ * decoded.
+ */
+ConfigurationPayload *decodeNestedConfigPayload(
+    const PayloadBuffer &data,
+    const Serialization::Workers::NestedPayload *nestedPayload) {
+  if (!nestedPayload) {
+    return nullptr;
+  }
+  ConfigurationPayload *configPayload =
+      MessageFactory::getInstace()->decodeConfigurationPayload(
+          data.slice(nestedPayload->payload()), nestedPayload->magicNumber());
+  if (!configPayload) {
+    return nullptr;
+  }
+  configPayload->setKeyMapping(
+      Utilities::buildKeyMappingFromFlatbuffers(nestedPayload->keyMapping()));
+  configPayload->setSpectrumMapping(
+      Utilities::buildSpectrumMappingFromFlatbuffers(
+          nestedPayload->spectrumMapping()));
 
-  const unsigned char *buffer = data.data();
+  return configPayload;
+}
 
-  if (MAGIC_NUMBER_SENTRY_INIT_PAYLOAD == magicNumber) {
-    const Serialization::Workers::SentryInitPayloadT *sentryInitPayload =
-        Serialization::Workers::GetSentryInitPayload(buffer)->UnPack();
+/**
+ * @brief Decodes a nested init payload.
+ * @param data The buffer of the enclosing payload.
+ * @param nestedPayload The nested payload.
+ * @return Pointer to the init payload. Null if it could not be decoded.
+ */
+InitPayload *decodeNestedInitPayload(
+    const PayloadBuffer &data,
+    const Serialization::Workers::NestedPayload *nestedPayload) {
+  if (!nestedPayload) {
+    return nullptr;
+  }
 
-    InitPayload *pumpControllerInitPayload =
-        MessageFactory::getInstace()->decodeInitPayload(
-            sentryInitPayload->pumpControllerInitPayload->payload,
-            sentryInitPayload->pumpControllerInitPayload->magicNumber);
+  return MessageFactory::getInstace()->decodeInitPayload(
+      data.slice(nestedPayload->payload()), nestedPayload->magicNumber());
+}
+} // namespace
+
+InitPayload *
+SentryPayloadDecoder::decodeInitPayload(const PayloadBuffer &data,
+                                        int magicNumber) {
+  if (MAGIC_NUMBER_SENTRY_INIT_PAYLOAD == magicNumber) {
+    auto sentryInitPayload =
+        data.getRoot<Serialization::Workers::SentryInitPayload>();
+    if (!sentryInitPayload) {
+      return nullptr;
+    }
+
+    // The nested payloads are decoded from the same buffer.
+    InitPayload *pumpControllerInitPayload = decodeNestedInitPayload(
+        data, sentryInitPayload->pumpControllerInitPayload());
     ConfigurationPayload *pumpControllerConfigPayload =
-        MessageFactory::getInstace()->decodeConfigurationPayload(
-            sentryInitPayload->pumpControllerConfPayload->payload,
-            sentryInitPayload->pumpControllerConfPayload->magicNumber);
-    pumpControllerConfigPayload->setKeyMapping(
-        Utilities::buildKeyMappingFromFlatbuffers(
-            sentryInitPayload->pumpControllerConfPayload->keyMapping));
-    pumpControllerConfigPayload->setSpectrumMapping(
-        Utilities::buildSpectrumMappingFromFlatbuffers(
-            sentryInitPayload->pumpControllerConfPayload->spectrumMapping));
-
-    InitPayload *isInitPayload =
-        MessageFactory::getInstace()->decodeInitPayload(
-            sentryInitPayload->impedanceSpectrometerInitPayload->payload,
-            sentryInitPayload->impedanceSpectrometerInitPayload->magicNumber);
-    ConfigurationPayload *isConfigPayload =
-        MessageFactory::getInstace()->decodeConfigurationPayload(
-            sentryInitPayload->impedanceSpectrometerConfPayload->payload,
-            sentryInitPayload->impedanceSpectrometerConfPayload->magicNumber);
-    isConfigPayload->setKeyMapping(Utilities::buildKeyMappingFromFlatbuffers(
-        sentryInitPayload->impedanceSpectrometerConfPayload->keyMapping));
-    isConfigPayload->setSpectrumMapping(
-        Utilities::buildSpectrumMappingFromFlatbuffers(
-            sentryInitPayload->impedanceSpectrometerConfPayload
-                ->spectrumMapping));
+        decodeNestedConfigPayload(
+            data, sentryInitPayload->pumpControllerConfPayload());
+    InitPayload *isInitPayload = decodeNestedInitPayload(
+        data, sentryInitPayload->impedanceSpectrometerInitPayload());
+    ConfigurationPayload *isConfigPayload = decodeNestedConfigPayload(
+        data, sentryInitPayload->impedanceSpectrometerConfPayload());
 
     return new SentryInitPayload(isInitPayload, isConfigPayload,
                                  pumpControllerInitPayload,
@@ -66,18 +96,20 @@ SentryPayloadDecoder::decodeInitPayload(const std::vector<unsigned char> &data,
   }
 }
 
-ConfigurationPayload *SentryPayloadDecoder::decodeConfigPayload(
-    const std::vector<unsigned char> &data, int magicNumber) {
+ConfigurationPayload *
+SentryPayloadDecoder::decodeConfigPayload(const PayloadBuffer &data,
+                                          int magicNumber) {
   if (MAGIC_NUMBER_SENTRY_CONF_PAYLOAD == magicNumber) {
-    const unsigned char *buffer = data.data();
-
-    const Serialization::Workers::SentryConfigPayloadT *sentryConfigPayload =
-        Serialization::Workers::GetSentryConfigPayload(buffer)->UnPack();
-
-    Duration offTime(sentryConfigPayload->offTime);
-    Duration onTime(sentryConfigPayload->onTime);
+    auto sentryConfigPayload =
+        data.getRoot<Serialization::Workers::SentryConfigPayload>();
+    if (!sentryConfigPayload) {
+      return nullptr;
+    }
+
+    Duration offTime(sentryConfigPayload->offTime());
+    Duration onTime(sentryConfigPayload->onTime());
     SentryWorkerMode sentryWorkerMode =
-        static_cast<SentryWorkerMode>(sentryConfigPayload->sentryWorkerMode);
+        static_cast<SentryWorkerMode>(sentryConfigPayload->sentryWorkerMode());
 
     return new SentryConfigPayload(sentryWorkerMode, onTime, offTime);
 
@@ -87,15 +119,22 @@ ConfigurationPayload *SentryPayloadDecoder::decodeConfigPayload(
 }
 
 ReadPayload *
-SentryPayloadDecoder::decodeReadPayload(const std::vector<unsigned char> &data,
+SentryPayloadDecoder::decodeReadPayload(const PayloadBuffer &data,
                                         int magicNumber) {
 
   return nullptr;
 }
 
 WritePayload *
-SentryPayloadDecoder::decodeWritePayload(const std::vector<unsigned char> &data,
+SentryPayloadDecoder::decodeWritePayload(const PayloadBuffer &data,
                                          int magicNumber) {
 
   return nullptr;
 }
+
+std::span<const int> SentryPayloadDecoder::getMagicNumbers() const {
+  static constexpr int magicNumbers[] = {
+      MAGIC_NUMBER_SENTRY_INIT_PAYLOAD, MAGIC_NUMBER_SENTRY_CONF_PAYLOAD};
+
+  return magicNumbers;
+}
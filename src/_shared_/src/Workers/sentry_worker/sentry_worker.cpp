@@ -2,6 +2,7 @@
 #include <easylogging++.h>
 
 // Project includes
+#include <clock.hpp>
 #include <common.hpp>
 #include <device.hpp>
 #include <isx3_init_payload.hpp>
@@ -25,12 +26,12 @@ void SentryWorker::work(TimePoint timestamp) {
   LOG(INFO) << "SentryWorker starting up.";
 
   // Ensure the devices are in a defined state. Turn them both off.
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new WriteDeviceMessage(this->self->getUserId(), this->spectrometer,
-                             WriteDeviceTopic::WRITE_TOPIC_STOP)));
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new WriteDeviceMessage(this->self->getUserId(), this->pumpController,
-                             WriteDeviceTopic::WRITE_TOPIC_STOP)));
+  this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+      this->self->getUserId(), this->spectrometer,
+      WriteDeviceTopic::WRITE_TOPIC_STOP));
+  this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+      this->self->getUserId(), this->pumpController,
+      WriteDeviceTopic::WRITE_TOPIC_STOP));
 
   while (this->runThread) {
 
@@ -47,16 +48,14 @@ void SentryWorker::work(TimePoint timestamp) {
           LOG(INFO) << "Enabling pump and deactivating impedance measurement.";
 
           // Enable the pump ...
-          this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-              new WriteDeviceMessage(this->self->getUserId(),
-                                     this->pumpController,
-                                     WriteDeviceTopic::WRITE_TOPIC_RUN)));
+          this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+              this->self->getUserId(), this->pumpController,
+              WriteDeviceTopic::WRITE_TOPIC_RUN));
 
           // ... disable the spectrometer ...
-          this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-              new WriteDeviceMessage(this->self->getUserId(),
-                                     this->spectrometer,
-                                     WriteDeviceTopic::WRITE_TOPIC_STOP)));
+          this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+              this->self->getUserId(), this->spectrometer,
+              WriteDeviceTopic::WRITE_TOPIC_STOP));
 
           this->threadWaiting = false;
         }
@@ -64,15 +63,14 @@ void SentryWorker::work(TimePoint timestamp) {
         LOG(INFO) << "Disabling pump and activating impedance measurement.";
 
         // Disable the pump ...
-        this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-            new WriteDeviceMessage(this->self->getUserId(),
-                                   this->pumpController,
-                                   WriteDeviceTopic::WRITE_TOPIC_STOP)));
+        this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+            this->self->getUserId(), this->pumpController,
+            WriteDeviceTopic::WRITE_TOPIC_STOP));
 
         // ... enable the spectrometer ...
-        this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-            new WriteDeviceMessage(this->self->getUserId(), this->spectrometer,
-                                   WriteDeviceTopic::WRITE_TOPIC_RUN)));
+        this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+            this->self->getUserId(), this->spectrometer,
+            WriteDeviceTopic::WRITE_TOPIC_RUN));
 
         // Print out measurement results until on time passes.
         TimePoint now = Core::getNow();
@@ -87,7 +85,7 @@ void SentryWorker::work(TimePoint timestamp) {
 
           this->isPayloadCacheMutex.unlock();
 
-          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+          Core::sleepFor(std::chrono::milliseconds(100));
           now = Core::getNow();
         }
 
@@ -98,7 +96,7 @@ void SentryWorker::work(TimePoint timestamp) {
     else {
     }
 
-    std::this_thread::sleep_for(this->workerThreadInterval);
+    Core::sleepFor(this->workerThreadInterval);
   }
 }
 
@@ -136,12 +134,11 @@ bool SentryWorker::specificWrite(std::shared_ptr<WriteDeviceMessage> writeMsg) {
     }
 
     // Send the start/stop command to the device.
-    this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-        new WriteDeviceMessage(this->getUserId(),
-                               setDeviceStatusPayload->targetId,
-                               setDeviceStatusPayload->setStatus
-                                   ? WriteDeviceTopic::WRITE_TOPIC_RUN
-                                   : WriteDeviceTopic::WRITE_TOPIC_STOP)));
+    this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+        this->getUserId(), setDeviceStatusPayload->targetId,
+        setDeviceStatusPayload->setStatus
+            ? WriteDeviceTopic::WRITE_TOPIC_RUN
+            : WriteDeviceTopic::WRITE_TOPIC_STOP));
 
     return true;
   }
@@ -186,10 +183,9 @@ bool SentryWorker::handleResponse(std::shared_ptr<ReadDeviceMessage> response) {
           this->spectrometerState = DeviceStatus::INITIALIZED;
         } else {
           // Device is not yet ready. Resend the query state message.
-          this->pushMessageQueue(
-              std::shared_ptr<DeviceMessage>(new WriteDeviceMessage(
-                  this->self->getUserId(), response->getSource(),
-                  WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+          this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+              this->self->getUserId(), response->getSource(),
+              WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
 
           return true;
         }
@@ -201,10 +197,9 @@ bool SentryWorker::handleResponse(std::shared_ptr<ReadDeviceMessage> response) {
           this->pumpControllerState = DeviceStatus::INITIALIZED;
         } else {
           // Device is not yet ready. Resend the query state message.
-          this->pushMessageQueue(
-              std::shared_ptr<DeviceMessage>(new WriteDeviceMessage(
-                  this->self->getUserId(), response->getSource(),
-                  WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+          this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+              this->self->getUserId(), response->getSource(),
+              WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
 
           return true;
         }
@@ -218,21 +213,20 @@ bool SentryWorker::handleResponse(std::shared_ptr<ReadDeviceMessage> response) {
           this->pumpControllerState == DeviceStatus::INITIALIZED) {
         // Both devices are initialized. Send the configuration message to
         // both and transition to configure state.
-        this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-            new ConfigDeviceMessage(this->self->getUserId(), this->spectrometer,
-                                    this->initPayload->isSpecConfPayload)));
-        this->pushMessageQueue(
-            std::shared_ptr<DeviceMessage>(new ConfigDeviceMessage(
-                this->self->getUserId(), this->pumpController,
-                this->initPayload->pumpControllerConfigPayload)));
+        this->pushMessageQueue(Utilities::makePooled<ConfigDeviceMessage>(
+            this->self->getUserId(), this->spectrometer,
+            this->initPayload->isSpecConfPayload));
+        this->pushMessageQueue(Utilities::makePooled<ConfigDeviceMessage>(
+            this->self->getUserId(), this->pumpController,
+            this->initPayload->pumpControllerConfigPayload));
         // Also send them state query messages. So that this method keeps
         // getting called.
-        this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-            new WriteDeviceMessage(this->self->getUserId(), spectrometer,
-                                   WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
-        this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-            new WriteDeviceMessage(this->self->getUserId(), pumpController,
-                                   WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+        this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+            this->self->getUserId(), spectrometer,
+            WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
+        this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+            this->self->getUserId(), pumpController,
+            WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
 
         this->initSubState = InitSubState::INIT_SUB_STATE_CONFIGURE;
       }
@@ -255,10 +249,9 @@ bool SentryWorker::handleResponse(std::shared_ptr<ReadDeviceMessage> response) {
           this->spectrometerState = DeviceStatus::IDLE;
         } else {
           // Device is not yet ready. Resend the query state message.
-          this->pushMessageQueue(
-              std::shared_ptr<DeviceMessage>(new WriteDeviceMessage(
-                  this->self->getUserId(), response->getSource(),
-                  WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+          this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+              this->self->getUserId(), response->getSource(),
+              WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
 
           return true;
         }
@@ -271,10 +264,9 @@ bool SentryWorker::handleResponse(std::shared_ptr<ReadDeviceMessage> response) {
           this->pumpControllerState = DeviceStatus::IDLE;
         } else {
           // Device is not yet ready. Resend the query state message.
-          this->pushMessageQueue(
-              std::shared_ptr<DeviceMessage>(new WriteDeviceMessage(
-                  this->self->getUserId(), response->getSource(),
-                  WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+          this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+              this->self->getUserId(), response->getSource(),
+              WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
 
           return true;
         }
@@ -408,19 +400,19 @@ bool SentryWorker::initialize(std::shared_ptr<InitPayload> initPayload) {
   // Set the worker state to INITIALIZING and forward the init messages to the
   // corresponding devices.
   this->deviceState = DeviceStatus::INITIALIZING;
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new InitDeviceMessage(this->self->getUserId(), spectrometer,
-                            this->initPayload->isSpecInitPayload)));
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new InitDeviceMessage(this->self->getUserId(), pumpController,
-                            this->initPayload->pumpControllerInitPayload)));
+  this->pushMessageQueue(Utilities::makePooled<InitDeviceMessage>(
+      this->self->getUserId(), spectrometer,
+      this->initPayload->isSpecInitPayload));
+  this->pushMessageQueue(Utilities::makePooled<InitDeviceMessage>(
+      this->self->getUserId(), pumpController,
+      this->initPayload->pumpControllerInitPayload));
   // Immediatelly send a state query message to the devices.
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new WriteDeviceMessage(this->self->getUserId(), this->spectrometer,
-                             WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
-  this->pushMessageQueue(std::shared_ptr<DeviceMessage>(
-      new WriteDeviceMessage(this->self->getUserId(), this->pumpController,
-                             WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE)));
+  this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+      this->self->getUserId(), this->spectrometer,
+      WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
+  this->pushMessageQueue(Utilities::makePooled<WriteDeviceMessage>(
+      this->self->getUserId(), this->pumpController,
+      WriteDeviceTopic::WRITE_TOPIC_QUERY_STATE));
 
   // Set the configure sub state.
   this->initSubState = InitSubState::INIT_SUB_STATE_INIT;
@@ -17,10 +17,11 @@ Worker::Worker(unsigned int dataManagerMeasurementLevel,
 Worker::~Worker() {}
 
 std::shared_ptr<StatusPayload> Worker::constructStatus() {
-  return std::shared_ptr<StatusPayload>(new StatusPayload(
+  std::lock_guard<std::mutex> lock(this->statusMutex);
+  return Utilities::makePooled<StatusPayload>(
       this->getUserId(), this->deviceState, this->getProxyUserIds(),
       DeviceType::UNSPECIFIED, this->getWorkerName(), this->initPayload,
-      this->configPayload));
+      this->configPayload);
 }
 
 } // namespace Workers
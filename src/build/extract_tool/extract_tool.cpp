@@ -1,4 +1,23 @@
+// OS includes
+#ifdef WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
+
+// Standard includes
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
+#include <future>
+#include <map>
+#include <regex>
+#include <set>
+#include <thread>
 
 // 3rd party includes
 #include <argparse/argparse.hpp>
@@ -6,10 +25,398 @@
 
 // Project includes
 #include "data_manager_hdf.hpp"
+#include "thread_pool.hpp"
 #include "utilities.hpp"
 
+/// The name of the summary, that is written by a batch export.
+#define BATCH_MANIFEST_FILE_NAME "batch_manifest.csv"
+
 INITIALIZE_EASYLOGGINGPP
 
+namespace {
+
+/**
+ * @brief Fills the filters of the export options from the command line.
+ * @param program The parsed command line.
+ * @param options Will contain the filters.
+ * @return TRUE if all filters are valid. FALSE otherwise.
+ */
+bool getFilters(argparse::ArgumentParser &program,
+                Utilities::ExportOptions &options) {
+  if (program.is_used("--key") && program.is_used("--key-regex")) {
+    LOG(ERROR) << "Only one of --key and --key-regex may be given.";
+    return false;
+  }
+  if (program.is_used("--key")) {
+    options.keyFilter =
+        Utilities::globToRegex(program.get<std::string>("--key"));
+  } else if (program.is_used("--key-regex")) {
+    options.keyFilter = program.get<std::string>("--key-regex");
+  }
+
+  auto deviceType = program.get<std::string>("--device-type");
+  if ("impedance-spectrometer" == deviceType) {
+    options.deviceType = Devices::DeviceType::IMPEDANCE_SPECTROMETER;
+  } else if ("pump-controller" == deviceType) {
+    options.deviceType = Devices::DeviceType::PUMP_CONTROLLER;
+  }
+
+  for (auto [argument, timePoint] :
+       {std::make_pair("--from", &options.from),
+        std::make_pair("--to", &options.to)}) {
+    if (program.is_used(argument) &&
+        !Utilities::parseTimePoint(program.get<std::string>(argument),
+                                   *timePoint)) {
+      LOG(ERROR) << "Invalid time given for " << argument << ".";
+      return false;
+    }
+  }
+  if (options.from > options.to) {
+    LOG(ERROR) << "--from has to be before --to.";
+    return false;
+  }
+
+  int decimationFactor = program.get<int>("--decimate");
+  if (decimationFactor < 1) {
+    LOG(ERROR) << "The decimation factor has to be at least 1.";
+    return false;
+  }
+  options.decimationFactor = decimationFactor;
+  if (decimationFactor > 1) {
+    options.decimation =
+        "mean" == program.get<std::string>("--decimation-mode")
+            ? Utilities::EXPORT_DECIMATION_MEAN
+            : Utilities::EXPORT_DECIMATION_NTH;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Exports a single HDF file.
+ * @param program The parsed command line.
+ * @param inputFile The HDF file.
+ * @param outputDirectory The directory the output is written to.
+ * @return The exit code of the tool.
+ */
+int exportFile(argparse::ArgumentParser &program, const std::string &inputFile,
+               const std::string &outputDirectory) {
+  LOG(INFO) << "Trying to open " << inputFile << ".";
+
+  Utilities::DataManagerHdf dataManager;
+  // The source may be the live file of a running sentry. Never compete with
+  // its writer.
+  dataManager.setReadOnly(true);
+  if (!dataManager.open(inputFile)) {
+    LOG(ERROR) << "Could not open" << inputFile << ".";
+    return 1;
+  }
+
+  std::filesystem::create_directories(outputDirectory);
+
+  if ("CSV" == program.get<std::string>("--output-format")) {
+    Utilities::ExportOptions options;
+    options.separator = program.get<std::string>("--csv-separator")[0];
+    options.impedanceFormat = program.get<std::string>("--impedance-format");
+    options.jobCount = std::max(program.get<int>("--jobs"), 1);
+    if (!getFilters(program, options)) {
+      return 1;
+    }
+    if (program.get<bool>("--incremental")) {
+      options.checkpointFile =
+          program.is_used("--checkpoint-file")
+              ? program.get<std::string>("--checkpoint-file")
+              : (std::filesystem::path(outputDirectory) /
+                 (std::filesystem::path(inputFile).stem().string() +
+                  ".checkpoint"))
+                    .string();
+    }
+    if (!dataManager.writeToCsv(outputDirectory, options)) {
+      LOG(ERROR) << "Could not export " << inputFile << ".";
+      return 1;
+    }
+  } else if ("NUMPY" == program.get<std::string>("--output-format")) {
+    Utilities::ExportOptions options;
+    if (!getFilters(program, options)) {
+      return 1;
+    }
+    bool archive = "npz" == program.get<std::string>("--numpy-container");
+    if (!dataManager.writeToNumpy(outputDirectory, options, archive)) {
+      LOG(ERROR) << "Could not export " << inputFile << ".";
+      return 1;
+    }
+  } else if ("COLUMNAR" == program.get<std::string>("--output-format")) {
+    std::string archiveName =
+        (std::filesystem::path(outputDirectory) /
+         (std::filesystem::path(inputFile).stem().string() + ".columnar"))
+            .string();
+    LOG(INFO) << "Writing to " << archiveName;
+    if (!dataManager.writeToColumnar(archiveName)) {
+      LOG(ERROR) << "Could not write " << archiveName << ".";
+      return 1;
+    }
+  } else {
+    LOG(ERROR) << "Invalid output format.";
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Expands the inputs of the command line into HDF files. An input is
+ * either a file, a directory, whose *.hdf files are taken, or a glob pattern
+ * within the file name part of the path.
+ * @param inputs The inputs.
+ * @param inputFiles Will contain the HDF files.
+ * @return TRUE if every input names at least one file. FALSE otherwise.
+ */
+bool expandInputs(const std::vector<std::string> &inputs,
+                  std::vector<std::filesystem::path> &inputFiles) {
+  for (auto &input : inputs) {
+    std::filesystem::path path(input);
+    size_t fileCount = inputFiles.size();
+    if (std::filesystem::is_regular_file(path)) {
+      inputFiles.push_back(path);
+    } else if (std::filesystem::is_directory(path)) {
+      for (auto &entry : std::filesystem::directory_iterator(path)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".hdf") {
+          inputFiles.push_back(entry.path());
+        }
+      }
+    } else {
+      std::filesystem::path directory =
+          path.has_parent_path() ? path.parent_path() : ".";
+      std::regex pattern;
+      try {
+        pattern = std::regex(Utilities::globToRegex(path.filename().string()));
+      } catch (std::regex_error &e) {
+        LOG(ERROR) << "Invalid pattern " << input << ": " << e.what();
+        return false;
+      }
+      std::error_code errorCode;
+      for (auto &entry :
+           std::filesystem::directory_iterator(directory, errorCode)) {
+        if (entry.is_regular_file() &&
+            std::regex_match(entry.path().filename().string(), pattern)) {
+          inputFiles.push_back(entry.path());
+        }
+      }
+    }
+
+    if (inputFiles.size() == fileCount) {
+      LOG(ERROR) << "No HDF file found for " << input << ".";
+      return false;
+    }
+    // Directory iteration has no defined order.
+    std::sort(inputFiles.begin() + fileCount, inputFiles.end());
+  }
+
+  // Overlapping inputs must not export a file twice.
+  std::set<std::filesystem::path> knownFiles;
+  std::erase_if(inputFiles, [&knownFiles](const std::filesystem::path &file) {
+    return !knownFiles.insert(std::filesystem::weakly_canonical(file)).second;
+  });
+
+  return true;
+}
+
+/**
+ * @brief Runs a process and waits for it to finish.
+ * @param arguments The executable and its arguments.
+ * @return The exit code of the process. -1 if it could not be started.
+ */
+int runProcess(const std::vector<std::string> &arguments) {
+#ifdef WIN32
+  // Quote the arguments, so that the runtime of the child splits the command
+  // line back into the same arguments.
+  std::string commandLine;
+  for (auto &argument : arguments) {
+    if (!argument.empty() &&
+        argument.find_first_of(" \t\"") == std::string::npos) {
+      commandLine += argument + " ";
+      continue;
+    }
+    commandLine += '"';
+    size_t backslashCount = 0;
+    for (char c : argument) {
+      if (c == '\\') {
+        backslashCount++;
+        continue;
+      }
+      if (c == '"') {
+        backslashCount = 2 * backslashCount + 1;
+      }
+      commandLine.append(backslashCount, '\\');
+      backslashCount = 0;
+      commandLine += c;
+    }
+    commandLine.append(2 * backslashCount, '\\');
+    commandLine += "\" ";
+  }
+
+  STARTUPINFOA startupInfo{};
+  startupInfo.cb = sizeof(startupInfo);
+  PROCESS_INFORMATION processInfo{};
+  if (!CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, FALSE, 0,
+                      nullptr, nullptr, &startupInfo, &processInfo)) {
+    return -1;
+  }
+  WaitForSingleObject(processInfo.hProcess, INFINITE);
+  DWORD exitCode = 0;
+  GetExitCodeProcess(processInfo.hProcess, &exitCode);
+  CloseHandle(processInfo.hThread);
+  CloseHandle(processInfo.hProcess);
+
+  return static_cast<int>(exitCode);
+#else
+  std::vector<char *> argv;
+  for (auto &argument : arguments) {
+    argv.push_back(const_cast<char *>(argument.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  pid_t pid;
+  if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) !=
+      0) {
+    return -1;
+  }
+  int status = 0;
+  if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) {
+    return -1;
+  }
+
+  return WEXITSTATUS(status);
+#endif
+}
+
+/**
+ * @brief Quotes a field of the batch manifest.
+ */
+std::string quoteCsvField(const std::string &field) {
+  std::string quoted = "\"";
+  for (char c : field) {
+    quoted += c;
+    if (c == '"') {
+      quoted += c;
+    }
+  }
+  return quoted + "\"";
+}
+
+/**
+ * @brief Exports many HDF files at once. Every file is exported by its own
+ * process, as HDF accesses are serialized within a process. The output of a
+ * file is written into a subdirectory named after it. A manifest summarizes
+ * the results.
+ * @param program The parsed command line.
+ * @param executable The path of this tool.
+ * @param inputFiles The HDF files.
+ * @param outputDirectory The directory the outputs are written to.
+ * @return The exit code of the tool.
+ */
+int exportBatch(argparse::ArgumentParser &program,
+                const std::string &executable,
+                const std::vector<std::filesystem::path> &inputFiles,
+                const std::string &outputDirectory) {
+  if (program.is_used("--checkpoint-file")) {
+    LOG(WARNING) << "--checkpoint-file is ignored for multiple input files. "
+                    "Every file keeps its own checkpoint.";
+  }
+
+  // The options, that are passed on to the workers unchanged.
+  std::vector<std::string> commonArguments{executable};
+  for (auto option :
+       {"--output-format", "--numpy-container", "--csv-separator",
+        "--impedance-format", "--key", "--key-regex", "--device-type",
+        "--from", "--to", "--decimation-mode"}) {
+    if (program.is_used(option)) {
+      commonArguments.push_back(option);
+      commonArguments.push_back(program.get<std::string>(option));
+    }
+  }
+  if (program.is_used("--decimate")) {
+    commonArguments.push_back("--decimate");
+    commonArguments.push_back(std::to_string(program.get<int>("--decimate")));
+  }
+  if (program.get<bool>("--incremental")) {
+    commonArguments.push_back("--incremental");
+  }
+
+  // Share the formatting threads among the workers.
+  int parallelCount = std::max(program.get<int>("--parallel"), 1);
+  int jobCount = std::max(program.get<int>("--jobs") / parallelCount, 1);
+  commonArguments.push_back("--jobs");
+  commonArguments.push_back(std::to_string(jobCount));
+
+  struct Result {
+    std::string inputFile;
+    std::string outputDirectory;
+    int exitCode;
+    long long duration;
+  };
+  std::vector<std::future<Result>> results;
+  std::map<std::string, int> stemCount;
+  {
+    Utilities::ThreadPool threadPool(parallelCount);
+    for (auto &inputFile : inputFiles) {
+      // Files of different directories may share a name.
+      std::string stem = inputFile.stem().string();
+      int count = stemCount[stem]++;
+      std::string fileOutputDirectory =
+          (std::filesystem::path(outputDirectory) /
+           (count == 0 ? stem : stem + "_" + std::to_string(count)))
+              .string();
+
+      std::vector<std::string> arguments = commonArguments;
+      arguments.push_back("--output-directory");
+      arguments.push_back(fileOutputDirectory);
+      arguments.push_back(inputFile.string());
+
+      results.push_back(threadPool.submit([arguments, inputFile,
+                                           fileOutputDirectory]() {
+        LOG(INFO) << "Exporting " << inputFile.string() << ".";
+        auto start = std::chrono::steady_clock::now();
+        int exitCode = runProcess(arguments);
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        if (exitCode != 0) {
+          LOG(ERROR) << "Could not export " << inputFile.string()
+                     << " (exit code " << exitCode << ").";
+        }
+        return Result{inputFile.string(), fileOutputDirectory, exitCode,
+                      duration.count()};
+      }));
+    }
+  }
+
+  std::string manifestName =
+      (std::filesystem::path(outputDirectory) / BATCH_MANIFEST_FILE_NAME)
+          .string();
+  std::ofstream manifest(manifestName, std::ios::trunc);
+  manifest << "input_file,output_directory,exit_code,duration_ms\n";
+  size_t failedCount = 0;
+  for (auto &future : results) {
+    Result result = future.get();
+    manifest << quoteCsvField(result.inputFile) << ","
+             << quoteCsvField(result.outputDirectory) << "," << result.exitCode
+             << "," << result.duration << "\n";
+    if (result.exitCode != 0) {
+      failedCount++;
+    }
+  }
+  if (!manifest.good()) {
+    LOG(ERROR) << "Could not write " << manifestName << ".";
+    return 1;
+  }
+
+  LOG(INFO) << "Exported " << inputFiles.size() - failedCount << " of "
+            << inputFiles.size() << " files. Summary written to "
+            << manifestName << ".";
+  return failedCount == 0 ? 0 : 1;
+}
+} // namespace
+
 int main(int argc, char *argv[]) {
   LOG(INFO) << "Starting up extract_tool";
 
@@ -18,56 +425,118 @@ int main(int argc, char *argv[]) {
       "This tool takes HDF files, that have been generated by the SCIMon "
       "software, and converts the contained data into other formats. \n\n "
       "Example: \n extract_tool --output-format CSV --impedance-format polar "
-      "\"C:/Users/Foo/file.hdf\"");
-  program.add_argument("input-file").help("Path to the input HDF file.");
+      "\"C:/Users/Foo/file.hdf\"\n\n"
+      "Given multiple files, directories or glob patterns, the files are "
+      "exported concurrently, each into a subdirectory of the output "
+      "directory. \n\n "
+      "Example: \n extract_tool --parallel 8 -o \"C:/Users/Foo/export\" "
+      "\"C:/Users/Foo/campaign\" \"C:/Users/Foo/other/run_*.hdf\"");
   program.add_argument("-f", "--output-format")
       .default_value(std::string{"CSV"})
-      .choices("CSV")
-      .help("The type of the output format. Allowed options: CSV");
+      .choices("CSV", "COLUMNAR", "NUMPY")
+      .help("The type of the output format. Allowed options: CSV, COLUMNAR, "
+            "NUMPY. COLUMNAR writes a memory-mappable archive directory, that "
+            "can be read with DataManagerColumnar. NUMPY writes the arrays of "
+            "each measurement, that can be loaded with numpy.load().");
+  program.add_argument("--numpy-container")
+      .help("How the arrays are stored, when \"--output-format NUMPY\" is "
+            "given. Allowed options: npz (one archive per measurement), npy "
+            "(one directory of memory-mappable .npy files per measurement)")
+      .default_value(std::string{"npz"})
+      .choices("npz", "npy");
   program.add_argument("--csv-separator")
       .help("The CSV separator, when \"--output-format CSV\" is given. ")
-      .default_value(",");
+      .default_value(std::string{","});
   program.add_argument("--impedance-format")
       .help("The format impedances shall appear in the output file. Allowed "
             "options: cartesian, polar")
       .default_value(std::string{"cartesian"})
       .choices("cartesian", "polar");
+  program.add_argument("-o", "--output-directory")
+      .help("The directory the output is written to.")
+      .default_value(std::string{"."});
+  program.add_argument("-j", "--jobs")
+      .help("The count of threads, that format the output.")
+      .default_value(static_cast<int>(
+          std::max(std::thread::hardware_concurrency(), 1u)))
+      .scan<'i', int>();
+  program.add_argument("--key")
+      .help("Only export measurements, whose name matches the given glob "
+            "pattern, e.g. \"spectrometer/*\". Names are relative to the data "
+            "root. Does not apply to COLUMNAR.");
+  program.add_argument("--key-regex")
+      .help("Only export measurements, whose name contains a match of the "
+            "given regular expression. Does not apply to COLUMNAR.");
+  program.add_argument("--device-type")
+      .help("Only export measurements of the given device type. Allowed "
+            "options: all, impedance-spectrometer, pump-controller. Does not "
+            "apply to COLUMNAR.")
+      .default_value(std::string{"all"})
+      .choices("all", "impedance-spectrometer", "pump-controller");
+  program.add_argument("--from")
+      .help("Only export rows at or after the given time. Either milliseconds "
+            "since epoch or a UTC date like 2024-01-31T12:00:00. Does not "
+            "apply to COLUMNAR.");
+  program.add_argument("--to")
+      .help("Only export rows at or before the given time. Either "
+            "milliseconds since epoch or a UTC date like 2024-01-31T12:00:00. "
+            "Does not apply to COLUMNAR.");
+  program.add_argument("--decimate")
+      .help("Decimates every N consecutive rows into one. Does not apply to "
+            "COLUMNAR.")
+      .default_value(1)
+      .scan<'i', int>();
+  program.add_argument("--decimation-mode")
+      .help("How rows are decimated. Allowed options: nth (keep every N-th "
+            "row), mean (mean of N rows)")
+      .default_value(std::string{"nth"})
+      .choices("nth", "mean");
+  program.add_argument("--incremental")
+      .help("Continues the CSV files of earlier exports by appending only the "
+            "rows, that have been recorded since. The last exported timestamp "
+            "of every file is kept in a checkpoint file.")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--checkpoint-file")
+      .help("The checkpoint file of \"--incremental\". Defaults to "
+            "<output-directory>/<input-file name>.checkpoint.");
+  program.add_argument("-p", "--parallel")
+      .help("The count of files, that are exported at once, when multiple "
+            "input files are given.")
+      .default_value(static_cast<int>(
+          std::max(std::thread::hardware_concurrency(), 1u)))
+      .scan<'i', int>();
+  program.add_argument("input-files")
+      .help("Paths to the input HDF files, to directories containing HDF "
+            "files or glob patterns like \"C:/Users/Foo/run_*.hdf\".")
+      .remaining();
 
+  std::vector<std::string> inputs;
   try {
     program.parse_args(argc, argv);
-  } catch (const std::runtime_error &err) {
+    inputs = program.get<std::vector<std::string>>("input-files");
+  } catch (const std::exception &err) {
     std::cerr << err.what() << std::endl;
     std::cerr << program;
     return 1;
   }
 
-  auto inputFile = program.get<std::string>("input-file");
-
-  LOG(INFO) << "Trying to open " << inputFile << ".";
-
-  Utilities::DataManagerHdf dataManager;
-  if (!dataManager.open(inputFile)) {
-    LOG(ERROR) << "Could not open" << inputFile << ".";
+  std::vector<std::filesystem::path> inputFiles;
+  if (!expandInputs(inputs, inputFiles)) {
     return 1;
   }
 
-  if ("CSV" == program.get<std::string>("output-format")) {
-    std::map<std::string, std::stringstream *> ss;
-    dataManager.writeToCsv(ss, program.get<std::string>("csv-separator")[0],
-                           program.get<std::string>("impedance-format"));
-    for (auto stream : ss) {
-      auto nameSplit = Utilities::split(stream.first, '/');
-      std::string fileName = nameSplit.back() + ".csv";
-      LOG(INFO) << "Writing to " << fileName;
-      std::ofstream fileStream(fileName);
-      fileStream << stream.second->str();
-      fileStream.close();
-    }
-
-    LOG(INFO) << "Wrote to " << ss.size() << " files.";
+  auto outputDirectory = program.get<std::string>("--output-directory");
+  int exitCode = 0;
+  if (inputFiles.size() == 1) {
+    exitCode =
+        exportFile(program, inputFiles.front().string(), outputDirectory);
   } else {
-    LOG(ERROR) << "Invalid output format.";
-    return 1;
+    std::filesystem::create_directories(outputDirectory);
+    exitCode = exportBatch(program, argv[0], inputFiles, outputDirectory);
+  }
+  if (exitCode != 0) {
+    return exitCode;
   }
 
   LOG(INFO) << "Finished. Bye.";
@@ -0,0 +1,253 @@
+// Standard includes
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// 3rd party includes
+#include <argparse/argparse.hpp>
+#include <easylogging++.h>
+
+// Project includes
+#include "data_manager_hdf.hpp"
+#include "spectrum_index.hpp"
+#include "utilities.hpp"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace {
+
+/**
+ * @brief Builds the similarity index of an HDF file.
+ * @param program The parsed command line.
+ * @param dataManager The data manager of the HDF file.
+ * @param indexFile The file the index is written to.
+ * @return The exit code of the tool.
+ */
+int buildIndex(argparse::ArgumentParser &program,
+               Utilities::DataManagerHdf &dataManager,
+               const std::string &indexFile) {
+  std::string keyFilter;
+  if (program.is_used("--key")) {
+    keyFilter = Utilities::globToRegex(program.get<std::string>("--key"));
+  }
+  int listCount = program.get<int>("--lists");
+  if (listCount < 0) {
+    LOG(ERROR) << "The count of lists must not be negative.";
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Utilities::SpectrumIndex index;
+  if (!index.build(dataManager, keyFilter, listCount,
+                   std::max(program.get<int>("--jobs"), 1))) {
+    LOG(ERROR) << "Could not index the spectra.";
+    return 1;
+  }
+  if (index.getKeys().empty()) {
+    LOG(ERROR) << "No spectra have been found, that could be indexed.";
+    return 1;
+  }
+  if (!index.save(indexFile)) {
+    return 1;
+  }
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+  LOG(INFO) << "Wrote " << indexFile << " in " << duration.count() << " ms.";
+
+  return 0;
+}
+
+/**
+ * @brief Searches the spectra, that are most similar to the spectrum at the
+ * given time, and prints them.
+ * @param program The parsed command line.
+ * @param dataManager The data manager of the HDF file.
+ * @param indexFile The file of the index.
+ * @return The exit code of the tool.
+ */
+int queryIndex(argparse::ArgumentParser &program,
+               Utilities::DataManagerHdf &dataManager,
+               const std::string &indexFile) {
+  Utilities::SpectrumIndex index;
+  if (!index.load(indexFile)) {
+    LOG(ERROR) << "Could not load the index. Build it with \"index_tool build"
+                  "\" first.";
+    return 1;
+  }
+
+  // Without a key, the key is taken from the index, if it is unambiguous.
+  std::vector<std::string> keys = index.getKeys();
+  std::string key;
+  if (program.is_used("--key")) {
+    key = program.get<std::string>("--key");
+  } else if (keys.size() == 1) {
+    key = keys.front();
+  } else {
+    LOG(ERROR) << "The index contains multiple keys, select one with --key: "
+               << Utilities::join(keys, ' ');
+    return 1;
+  }
+  if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+    LOG(ERROR) << "Key " << key << " is not indexed.";
+    return 1;
+  }
+
+  TimePoint timestamp;
+  if (!program.is_used("--timestamp") ||
+      !Utilities::parseTimePoint(program.get<std::string>("--timestamp"),
+                                 timestamp)) {
+    LOG(ERROR) << "A valid --timestamp has to be given.";
+    return 1;
+  }
+  int k = program.get<int>("-k");
+  int probes = program.get<int>("--probes");
+  long long separation = program.get<long long>("--separation");
+  if (k < 1 || probes < 1 || separation < 0) {
+    LOG(ERROR) << "-k and --probes have to be positive, --separation must not "
+                  "be negative.";
+    return 1;
+  }
+
+  size_t firstRow = 0;
+  size_t rowCount = 0;
+  if (dataManager.findRows(key, TimePoint::min(), TimePoint::max(), firstRow,
+                           rowCount) &&
+      rowCount != index.getRowCount(key)) {
+    LOG(WARNING) << "The index covers " << index.getRowCount(key) << " of "
+                 << rowCount << " spectra of key " << key
+                 << ". Rebuild it to include recent spectra.";
+  }
+
+  // The query spectrum is the first one at or after the given time.
+  if (!dataManager.findRows(key, timestamp, TimePoint::max(), firstRow,
+                            rowCount) ||
+      0 == rowCount) {
+    LOG(ERROR) << "Key " << key << " has no spectrum at or after "
+               << program.get<std::string>("--timestamp") << ".";
+    return 1;
+  }
+  std::vector<double> spectrum(2 * index.getFrequencies(key).size());
+  long long queryTimestamp = 0;
+  if (!dataManager.readTimestamps(key, firstRow, 1, &queryTimestamp) ||
+      !dataManager.readValues(key, firstRow, 1, spectrum.data())) {
+    LOG(ERROR) << "Could not read the query spectrum.";
+    return 1;
+  }
+
+  Utilities::SpectrumQueryOptions options;
+  options.k = k;
+  options.probes = probes;
+  options.minSeparation = separation;
+  std::vector<Utilities::SpectrumMatch> matches;
+  auto start = std::chrono::steady_clock::now();
+  if (!index.query(key, spectrum.data(), options, matches)) {
+    return 1;
+  }
+  auto duration = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start);
+
+  std::cout << "Spectra of " << key << " similar to the one at "
+            << Core::getTimestampString(TimePoint(Duration(queryTimestamp)))
+            << " (" << std::fixed << std::setprecision(3) << duration.count()
+            << " ms):" << std::endl;
+  std::cout << "rank,timestamp,date,distance" << std::endl;
+  for (size_t rank = 0; rank < matches.size(); rank++) {
+    std::cout << rank + 1 << "," << matches[rank].timestamp << ","
+              << Core::getTimestampString(
+                     TimePoint(Duration(matches[rank].timestamp)))
+              << "," << std::setprecision(6) << matches[rank].distance
+              << std::endl;
+  }
+
+  return 0;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  LOG(INFO) << "Starting up index_tool";
+
+  argparse::ArgumentParser program("index_tool");
+  program.add_description(
+      "This tool builds a similarity index over the spectra of HDF files, "
+      "that have been generated by the SCIMon software, and searches the "
+      "spectra, that look like a given one. The index is stored next to the "
+      "HDF file. \n\n "
+      "Example: \n index_tool build \"C:/Users/Foo/file.hdf\"\n "
+      "index_tool query --timestamp 2024-01-31T12:00:00 -k 20 "
+      "\"C:/Users/Foo/file.hdf\"");
+  program.add_argument("command")
+      .help("build: indexes the spectra of the file. query: prints the "
+            "spectra, that are most similar to the one at --timestamp.")
+      .choices("build", "query");
+  program.add_argument("input-file").help("Path to the input HDF file.");
+  program.add_argument("--index")
+      .help("The index file. Defaults to <input-file>" +
+            Utilities::SpectrumIndex::FILE_EXTENSION + ".");
+  program.add_argument("--key")
+      .help("build: only index keys, whose name matches the given glob "
+            "pattern. query: the key, that is searched. May be omitted, if "
+            "the index contains a single key.");
+  program.add_argument("--lists")
+      .help("build: the count of inverted lists per key. 0 selects the square "
+            "root of the count of spectra.")
+      .default_value(0)
+      .scan<'i', int>();
+  program.add_argument("-j", "--jobs")
+      .help("build: the count of threads, that cluster the spectra.")
+      .default_value(static_cast<int>(
+          std::max(std::thread::hardware_concurrency(), 1u)))
+      .scan<'i', int>();
+  program.add_argument("--timestamp")
+      .help("query: the time of the query spectrum. Either milliseconds since "
+            "epoch or a UTC date like 2024-01-31T12:00:00. The first spectrum "
+            "at or after this time is taken.");
+  program.add_argument("-k")
+      .help("query: the count of similar spectra, that are printed.")
+      .default_value(10)
+      .scan<'i', int>();
+  program.add_argument("--probes")
+      .help("query: the count of inverted lists, that are searched. More "
+            "lists are slower, but miss fewer similar spectra.")
+      .default_value(8)
+      .scan<'i', int>();
+  program.add_argument("--separation")
+      .help("query: the minimal time in milliseconds between two printed "
+            "spectra. Suppresses the neighbours in time of a match.")
+      .default_value(0LL)
+      .scan<'i', long long>();
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto inputFile = program.get<std::string>("input-file");
+  std::string indexFile =
+      program.is_used("--index")
+          ? program.get<std::string>("--index")
+          : Utilities::SpectrumIndex::getIndexFileName(inputFile);
+
+  Utilities::DataManagerHdf dataManager;
+  dataManager.setReadOnly(true);
+  if (!dataManager.open(inputFile)) {
+    LOG(ERROR) << "Could not open " << inputFile << ".";
+    return 1;
+  }
+
+  int exitCode = "build" == program.get<std::string>("command")
+                     ? buildIndex(program, dataManager, indexFile)
+                     : queryIndex(program, dataManager, indexFile);
+  dataManager.close();
+  if (exitCode != 0) {
+    return exitCode;
+  }
+
+  LOG(INFO) << "Finished. Bye.";
+
+  return 0;
+}
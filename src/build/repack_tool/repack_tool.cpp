@@ -0,0 +1,669 @@
+// Standard includes
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <thread>
+
+// 3rd party includes
+#include <argparse/argparse.hpp>
+#include <easylogging++.h>
+#include <highfive/H5File.hpp>
+#include <zlib.h>
+
+// Project includes
+#include "data_manager_hdf.hpp"
+#include "thread_pool.hpp"
+#include "utilities.hpp"
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace HighFive;
+
+/// The size, a chunk of the repacked file shall roughly have.
+#define DEFAULT_TARGET_CHUNK_BYTES (256 * 1024)
+/// The estimated size of a variable length string, used for chunk sizing.
+#define ESTIMATED_STRING_BYTES 32
+/// The count of chunks that are copied at once.
+#define CHUNKS_PER_BLOCK 16
+
+namespace {
+
+/**
+ * @brief The element types that may occur in a SCIMon HDF file.
+ */
+enum class ElementType { INVALID, INT, LONG_LONG, DOUBLE, STRING };
+
+/**
+ * @brief Options that control how datasets are repacked.
+ */
+struct RepackOptions {
+  /// The size in bytes a chunk shall roughly have.
+  size_t targetChunkBytes;
+  /// The deflate compression level. 0 disables compression.
+  unsigned int compressionLevel;
+  /// Whether the written data shall be read back and compared.
+  bool verify;
+};
+
+/**
+ * @brief Determines the element type of the given dataset.
+ * @param dataset The dataset.
+ * @return The element type of the dataset.
+ */
+ElementType getElementType(const DataSet &dataset) {
+  DataType dataType = dataset.getDataType();
+  if (DataTypeClass::Integer == dataType.getClass()) {
+    return dataType.getSize() == sizeof(long long) ? ElementType::LONG_LONG
+                                                   : ElementType::INT;
+  } else if (DataTypeClass::Float == dataType.getClass()) {
+    return ElementType::DOUBLE;
+  } else if (DataTypeClass::String == dataType.getClass()) {
+    return ElementType::STRING;
+  } else {
+    return ElementType::INVALID;
+  }
+}
+
+/**
+ * @brief Copies the attributes of one HDF object to another.
+ * @param src The object the attributes are read from.
+ * @param dst The object the attributes are written to.
+ */
+template <class SrcObj, class DstObj>
+void copyAttributes(const SrcObj &src, DstObj &dst) {
+  for (auto &attributeName : src.listAttributeNames()) {
+    Attribute attribute = src.getAttribute(attributeName);
+    DataType dataType = attribute.getDataType();
+    if (DataTypeClass::Integer == dataType.getClass()) {
+      // Keep the stored width and sign, timestamps need 64 bits.
+      bool isUnsigned = H5T_SGN_NONE == H5Tget_sign(dataType.getId());
+      if (dataType.getSize() > sizeof(int32_t)) {
+        if (isUnsigned) {
+          dst.template createAttribute<uint64_t>(
+              attributeName, attribute.template read<uint64_t>());
+        } else {
+          dst.template createAttribute<int64_t>(
+              attributeName, attribute.template read<int64_t>());
+        }
+      } else if (isUnsigned) {
+        dst.template createAttribute<uint32_t>(
+            attributeName, attribute.template read<uint32_t>());
+      } else {
+        dst.template createAttribute<int32_t>(
+            attributeName, attribute.template read<int32_t>());
+      }
+    } else if (DataTypeClass::Float == dataType.getClass()) {
+      dst.template createAttribute<double>(attributeName,
+                                           attribute.template read<double>());
+    } else if (DataTypeClass::String == dataType.getClass()) {
+      dst.template createAttribute<std::string>(
+          attributeName, attribute.template read<std::string>());
+    } else {
+      LOG(WARNING) << "Skipping attribute " << attributeName
+                   << " with unsupported type.";
+    }
+  }
+}
+
+/**
+ * @brief Compresses a chunk like the shuffle and deflate filters of HDF5 do.
+ * The shuffle groups the n-th bytes of all elements, which lets deflate find
+ * more repetitions.
+ * @param data The chunk.
+ * @param size The size of the chunk in bytes.
+ * @param elementSize The size of an element in bytes.
+ * @param compressionLevel The deflate compression level.
+ * @return The compressed chunk. Empty if the compression failed.
+ */
+std::vector<unsigned char> compressChunk(const unsigned char *data,
+                                         size_t size, size_t elementSize,
+                                         unsigned int compressionLevel) {
+  size_t elementCount = size / elementSize;
+  std::vector<unsigned char> shuffled(size);
+  for (size_t i = 0; i < elementCount; i++) {
+    for (size_t j = 0; j < elementSize; j++) {
+      shuffled[j * elementCount + i] = data[i * elementSize + j];
+    }
+  }
+
+  uLongf compressedSize = compressBound(static_cast<uLong>(size));
+  std::vector<unsigned char> compressed(compressedSize);
+  if (Z_OK != compress2(compressed.data(), &compressedSize, shuffled.data(),
+                        static_cast<uLong>(size),
+                        static_cast<int>(compressionLevel))) {
+    return std::vector<unsigned char>();
+  }
+  compressed.resize(compressedSize);
+
+  return compressed;
+}
+
+/**
+ * @brief Compresses the chunks of a dataset on a thread pool and writes them
+ * directly into the file, past the filter pipeline of HDF5. The chunks are
+ * transformed like the shuffle and deflate filters would do it, so they are
+ * read back through the regular pipeline. Only the compression runs in
+ * parallel, the calls into the HDF5 library are made by the calling thread.
+ */
+class ChunkCompressor {
+public:
+  /**
+   * @brief Creates a compressor for the given dataset.
+   * @param dataset The dataset the chunks are written to. Has to use the
+   * shuffle and deflate filters.
+   * @param dims The dimensions of the dataset.
+   * @param chunkRows The count of rows per chunk.
+   * @param compressionLevel The deflate compression level.
+   * @param threadPool The threads, that compress the chunks.
+   */
+  ChunkCompressor(DataSet &dataset, const std::vector<size_t> &dims,
+                  size_t chunkRows, unsigned int compressionLevel,
+                  Utilities::ThreadPool &threadPool)
+      : dataset(dataset), rank(dims.size()), chunkRows(chunkRows),
+        rowElements(1), compressionLevel(compressionLevel),
+        threadPool(threadPool) {
+    for (size_t i = 1; i < dims.size(); i++) {
+      this->rowElements *= dims[i];
+    }
+  }
+
+  /**
+   * @brief Compresses and writes the given rows.
+   * @param elements The elements of the rows in row-major order.
+   * @param row The index of the first row. Has to start a chunk.
+   * @return TRUE if all chunks have been written. FALSE otherwise.
+   */
+  template <class T> bool write(const std::vector<T> &elements, size_t row) {
+    size_t chunkElements = this->chunkRows * this->rowElements;
+    unsigned int compressionLevel = this->compressionLevel;
+
+    std::vector<std::future<std::vector<unsigned char>>> chunks;
+    for (size_t start = 0; start < elements.size(); start += chunkElements) {
+      // Edge chunks are stored in full size, the rows beyond the end of the
+      // dataset are padded.
+      std::vector<T> chunk(chunkElements, T());
+      std::copy_n(elements.begin() + start,
+                  std::min(chunkElements, elements.size() - start),
+                  chunk.begin());
+      chunks.push_back(this->threadPool.submit(
+          [chunk = std::move(chunk), compressionLevel]() {
+            return compressChunk(
+                reinterpret_cast<const unsigned char *>(chunk.data()),
+                chunk.size() * sizeof(T), sizeof(T), compressionLevel);
+          }));
+    }
+
+    std::vector<hsize_t> offset(this->rank, 0);
+    for (size_t i = 0; i < chunks.size(); i++) {
+      std::vector<unsigned char> compressed = chunks[i].get();
+      if (compressed.empty()) {
+        return false;
+      }
+      offset[0] = row + i * this->chunkRows;
+      if (H5Dwrite_chunk(this->dataset.getId(), H5P_DEFAULT, 0, offset.data(),
+                         compressed.size(), compressed.data()) < 0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief Returns the count of threads, that compress the chunks.
+   * @return The count of threads.
+   */
+  unsigned int getThreadCount() const {
+    return this->threadPool.getThreadCount();
+  }
+
+private:
+  /// The dataset the chunks are written to.
+  DataSet &dataset;
+  /// The rank of the dataset.
+  size_t rank;
+  /// The count of rows per chunk.
+  size_t chunkRows;
+  /// The count of elements per row.
+  size_t rowElements;
+  /// The deflate compression level.
+  unsigned int compressionLevel;
+  /// The threads, that compress the chunks.
+  Utilities::ThreadPool &threadPool;
+};
+
+/**
+ * @brief Appends the elements of a block to a flat vector in row-major order.
+ */
+template <class Container, class T>
+void appendElements(const Container &values, std::vector<T> &elements) {
+  if constexpr (std::is_same_v<Container, std::vector<T>>) {
+    elements.insert(elements.end(), values.begin(), values.end());
+  } else {
+    for (auto &value : values) {
+      appendElements(value, elements);
+    }
+  }
+}
+
+/**
+ * @brief Checks whether the dataset stores its elements exactly like T is
+ * laid out in memory, so its chunks can be written byte by byte.
+ */
+template <class T> bool hasNativeLayout(const DataSet &dataset) {
+  return H5Tequal(dataset.getDataType().getId(),
+                  create_datatype<T>().getId()) > 0;
+}
+
+/**
+ * @brief Walks the hierarchy below the given group and collects the paths of
+ * all groups and datasets.
+ * @param file The file.
+ * @param path The path of the group that shall be walked.
+ * @param groups Will contain the paths of all groups below path.
+ * @param datasets Will contain the paths of all datasets below path.
+ */
+void traverse(File &file, const std::string &path,
+              std::vector<std::string> &groups,
+              std::vector<std::string> &datasets) {
+  Group group = file.getGroup(path);
+  for (auto &childName : group.listObjectNames()) {
+    std::string childPath = (path == "/" ? "" : path) + "/" + childName;
+    ObjectType objectType = file.getObjectType(childPath);
+    if (ObjectType::Group == objectType) {
+      groups.push_back(childPath);
+      traverse(file, childPath, groups, datasets);
+    } else if (ObjectType::Dataset == objectType) {
+      datasets.push_back(childPath);
+    }
+  }
+}
+
+/**
+ * @brief Calculates the count of rows per chunk, so that a chunk roughly has
+ * the target size.
+ * @param dims The dimensions of the dataset.
+ * @param elementSize The size of a single element in bytes.
+ * @param targetChunkBytes The size a chunk shall roughly have.
+ * @return The count of rows per chunk.
+ */
+size_t calcChunkRows(const std::vector<size_t> &dims, size_t elementSize,
+                     size_t targetChunkBytes) {
+  size_t rowBytes = elementSize;
+  for (size_t i = 1; i < dims.size(); i++) {
+    rowBytes *= dims[i];
+  }
+  size_t chunkRows = std::max<size_t>(targetChunkBytes / rowBytes, 1);
+  // A chunk larger than the dataset only wastes space.
+  if (dims[0] > 0) {
+    chunkRows = std::min(chunkRows, dims[0]);
+  }
+
+  return chunkRows;
+}
+
+/**
+ * @brief Copies a dataset block by block and optionally verifies the written
+ * blocks.
+ * @param path The path of the dataset.
+ * @param srcDataset The dataset that shall be copied.
+ * @param dstDataset The dataset that shall be written.
+ * @param dims The dimensions of the dataset.
+ * @param blockRows The count of rows that are copied at once.
+ * @param verify Whether written blocks shall be read back and compared.
+ * @param checkOrder Whether the copied values have to be ordered ascendingly.
+ * @param compressor Compresses and writes the blocks. Null, if the blocks are
+ * written through the filter pipeline of HDF5.
+ * @return TRUE if the copy succeeded. FALSE otherwise.
+ */
+template <class T, class Container>
+bool copyBlocks(const std::string &path, DataSet &srcDataset,
+                DataSet &dstDataset, const std::vector<size_t> &dims,
+                size_t blockRows, bool verify, bool checkOrder,
+                ChunkCompressor *compressor) {
+  std::vector<size_t> offset(dims.size(), 0);
+  std::vector<size_t> count = dims;
+  long long lastTimestamp = std::numeric_limits<long long>::min();
+
+  for (size_t row = 0; row < dims[0]; row += blockRows) {
+    offset[0] = row;
+    count[0] = std::min(blockRows, dims[0] - row);
+
+    Container block;
+    srcDataset.select(offset, count).read(block);
+    if constexpr (std::is_arithmetic_v<T>) {
+      if (compressor) {
+        std::vector<T> elements;
+        appendElements(block, elements);
+        if (!compressor->write(elements, row)) {
+          LOG(ERROR) << "Could not write the chunks of " << path
+                     << " near row " << row << ".";
+          return false;
+        }
+      } else {
+        dstDataset.select(offset, count).write(block);
+      }
+    } else {
+      dstDataset.select(offset, count).write(block);
+    }
+
+    // The data managers assume ascending timestamps for their range reads.
+    if (checkOrder) {
+      if constexpr (std::is_same_v<Container, std::vector<long long>>) {
+        if (!block.empty() &&
+            (block.front() < lastTimestamp ||
+             !std::is_sorted(block.begin(), block.end()))) {
+          LOG(WARNING) << "Timestamps of " << path
+                       << " are not ordered near row " << row << ".";
+        }
+        if (!block.empty()) {
+          lastTimestamp = block.back();
+        }
+      }
+    }
+
+    if (verify) {
+      Container readBack;
+      dstDataset.select(offset, count).read(readBack);
+      if (readBack != block) {
+        LOG(ERROR) << "Verification of " << path << " failed at row " << row
+                   << ".";
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Selects the container that matches the rank of the dataset and copies
+ * it.
+ */
+template <class T>
+bool copyTyped(const std::string &path, DataSet &srcDataset,
+               DataSet &dstDataset, const std::vector<size_t> &dims,
+               size_t blockRows, bool verify, bool checkOrder,
+               ChunkCompressor *compressor) {
+  // Chunks are written byte by byte, which requires the file to store the
+  // elements like the memory does.
+  if (compressor && !hasNativeLayout<T>(dstDataset)) {
+    compressor = nullptr;
+  }
+
+  if (dims.size() == 1 || (dims.size() == 2 && dims[1] == 1)) {
+    return copyBlocks<T, std::vector<T>>(path, srcDataset, dstDataset, dims,
+                                         blockRows, verify, checkOrder,
+                                         compressor);
+  } else if (dims.size() == 2) {
+    return copyBlocks<T, std::vector<std::vector<T>>>(
+        path, srcDataset, dstDataset, dims, blockRows, verify, checkOrder,
+        compressor);
+  } else if (dims.size() == 3) {
+    return copyBlocks<T, std::vector<std::vector<std::vector<T>>>>(
+        path, srcDataset, dstDataset, dims, blockRows, verify, checkOrder,
+        compressor);
+  } else {
+    LOG(ERROR) << "Dataset " << path
+               << " has an unsupported rank of " << dims.size() << ".";
+    return false;
+  }
+}
+
+/**
+ * @brief Rewrites a single dataset into the output file, using chunk sizes
+ * that fit the data and compression.
+ * @param srcFile The file that shall be repacked.
+ * @param dstFile The repacked file.
+ * @param path The path of the dataset.
+ * @param options The repack options.
+ * @param threadPool The threads, that compress the chunks.
+ * @return TRUE if the dataset has been repacked succesfully. FALSE otherwise.
+ */
+bool repackDataSet(File &srcFile, File &dstFile, const std::string &path,
+                   const RepackOptions &options,
+                   Utilities::ThreadPool &threadPool) {
+  DataSet srcDataset = srcFile.getDataSet(path);
+  ElementType elementType = getElementType(srcDataset);
+  std::vector<size_t> dims = srcDataset.getDimensions();
+  if (ElementType::INVALID == elementType || dims.empty()) {
+    LOG(ERROR) << "Dataset " << path << " has an unsupported layout.";
+    return false;
+  }
+
+  size_t elementSize = ElementType::STRING == elementType
+                           ? ESTIMATED_STRING_BYTES
+                           : srcDataset.getDataType().getSize();
+  size_t chunkRows =
+      calcChunkRows(dims, elementSize, options.targetChunkBytes);
+
+  // Rank one datasets hold constant data like the spectrum mapping. They are
+  // not extended later on and are small, so they are kept contiguous.
+  std::vector<size_t> maxDims = dims;
+  DataSetCreateProps props;
+  if (dims.size() > 1) {
+    maxDims[0] = DataSpace::UNLIMITED;
+    std::vector<hsize_t> chunkDims(dims.begin(), dims.end());
+    chunkDims[0] = chunkRows;
+    props.add(Chunking(chunkDims));
+    // Variable length strings are stored in the global heap, compressing
+    // their references would not gain anything.
+    if (options.compressionLevel > 0 && ElementType::STRING != elementType) {
+      props.add(Shuffle());
+      props.add(Deflate(options.compressionLevel));
+    }
+  }
+  DataSet dstDataset = dstFile.createDataSet(
+      path, DataSpace(dims, maxDims), srcDataset.getDataType(), props);
+  copyAttributes(srcDataset, dstDataset);
+
+  // Numeric chunks are compressed on the thread pool. A block holds enough
+  // chunks to keep all threads busy.
+  std::unique_ptr<ChunkCompressor> compressor;
+  size_t blockRows = chunkRows * CHUNKS_PER_BLOCK;
+  if (dims.size() > 1 && options.compressionLevel > 0 &&
+      ElementType::STRING != elementType) {
+    compressor.reset(new ChunkCompressor(dstDataset, dims, chunkRows,
+                                         options.compressionLevel, threadPool));
+    blockRows = chunkRows * std::max<size_t>(CHUNKS_PER_BLOCK,
+                                             compressor->getThreadCount());
+  }
+
+  bool checkOrder = path.ends_with("/timestamps");
+  bool success = false;
+  try {
+    if (ElementType::INT == elementType) {
+      success =
+          copyTyped<int>(path, srcDataset, dstDataset, dims, blockRows,
+                         options.verify, checkOrder, compressor.get());
+    } else if (ElementType::LONG_LONG == elementType) {
+      success =
+          copyTyped<long long>(path, srcDataset, dstDataset, dims, blockRows,
+                               options.verify, checkOrder, compressor.get());
+    } else if (ElementType::DOUBLE == elementType) {
+      success =
+          copyTyped<double>(path, srcDataset, dstDataset, dims, blockRows,
+                            options.verify, checkOrder, compressor.get());
+    } else {
+      success = copyTyped<std::string>(path, srcDataset, dstDataset, dims,
+                                       blockRows, options.verify, checkOrder,
+                                       nullptr);
+    }
+  } catch (HighFive::Exception &e) {
+    LOG(ERROR) << "Could not repack " << path << ": " << e.what();
+  }
+
+  return success;
+}
+
+/**
+ * @brief Compares the SCIMon structure of the original and the repacked file.
+ * @return TRUE if both files describe the same keys and time ranges.
+ */
+bool verifyStructure(const std::string &srcFileName,
+                     const std::string &dstFileName) {
+  Utilities::DataManagerHdf srcDataManager;
+  Utilities::DataManagerHdf dstDataManager;
+  // Verification must not take write access to the original file.
+  srcDataManager.setReadOnly(true);
+  dstDataManager.setReadOnly(true);
+  if (!srcDataManager.open(srcFileName)) {
+    LOG(ERROR) << "Could not open " << srcFileName << " for verification.";
+    return false;
+  }
+  if (!dstDataManager.open(dstFileName)) {
+    LOG(ERROR) << "Could not open " << dstFileName << " for verification.";
+    return false;
+  }
+
+  if (srcDataManager.getKeyMapping() != dstDataManager.getKeyMapping()) {
+    LOG(ERROR) << "Key mapping of the repacked file does not match.";
+    return false;
+  }
+  if (srcDataManager.getTimerangeMapping() !=
+      dstDataManager.getTimerangeMapping()) {
+    LOG(ERROR) << "Time ranges of the repacked file do not match.";
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  LOG(INFO) << "Starting up repack_tool";
+
+  argparse::ArgumentParser program("repack_tool");
+  program.add_description(
+      "This tool takes a finished HDF file, that has been generated by the "
+      "SCIMon software, and rewrites it with chunk sizes that fit the stored "
+      "data and with compression. The chunks are compressed on --jobs "
+      "threads, while the keys are read and written one after another, as "
+      "HDF accesses are serialized within a process. \n\n "
+      "Example: \n repack_tool \"C:/Users/Foo/file.hdf\"");
+  program.add_argument("input-file").help("Path to the input HDF file.");
+  program.add_argument("-o", "--output")
+      .help("Path to the repacked HDF file. Defaults to the input file name "
+            "with a \"_repacked\" suffix.")
+      .default_value(std::string{""});
+  program.add_argument("--compression-level")
+      .help("The deflate compression level (0-9). 0 disables compression.")
+      .default_value(4)
+      .scan<'i', int>();
+  program.add_argument("--chunk-size")
+      .help("The size in kilobytes a chunk shall roughly have.")
+      .default_value(DEFAULT_TARGET_CHUNK_BYTES / 1024)
+      .scan<'i', int>();
+  program.add_argument("-j", "--jobs")
+      .help("The count of threads, that compress the chunks.")
+      .default_value(static_cast<int>(
+          std::max(std::thread::hardware_concurrency(), 1u)))
+      .scan<'i', int>();
+  program.add_argument("--no-verify")
+      .help("Skips reading back and comparing the repacked data.")
+      .default_value(false)
+      .implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto inputFile = program.get<std::string>("input-file");
+  auto outputFile = program.get<std::string>("--output");
+  if (outputFile.empty()) {
+    std::filesystem::path inputPath(inputFile);
+    outputFile = (inputPath.parent_path() /
+                  (inputPath.stem().string() + "_repacked.hdf"))
+                     .string();
+  }
+  if (std::filesystem::exists(outputFile) &&
+      std::filesystem::equivalent(inputFile, outputFile)) {
+    LOG(ERROR) << "Input and output file must not be the same.";
+    return 1;
+  }
+
+  RepackOptions options;
+  options.compressionLevel =
+      std::clamp(program.get<int>("--compression-level"), 0, 9);
+  options.targetChunkBytes =
+      static_cast<size_t>(std::max(program.get<int>("--chunk-size"), 1)) *
+      1024;
+  options.verify = !program.get<bool>("--no-verify");
+
+  LOG(INFO) << "Repacking " << inputFile << " to " << outputFile << ".";
+
+  std::vector<std::string> groups;
+  std::vector<std::string> datasets;
+  std::unique_ptr<File> srcFile;
+  std::unique_ptr<File> dstFile;
+  try {
+    srcFile.reset(new File(inputFile, File::ReadOnly));
+    dstFile.reset(new File(outputFile, File::Overwrite));
+
+    // Recreate the hierarchy with its attributes up front. The datasets are
+    // created per key.
+    traverse(*srcFile, "/", groups, datasets);
+    for (auto &groupPath : groups) {
+      Group dstGroup = dstFile->createGroup(groupPath);
+      copyAttributes(srcFile->getGroup(groupPath), dstGroup);
+    }
+  } catch (HighFive::Exception &e) {
+    LOG(ERROR) << "Could not set up the repacked file: " << e.what();
+    return 1;
+  }
+
+  // Bundle the datasets per key. The datasets of a key share their parent
+  // group.
+  std::map<std::string, std::vector<std::string>> keyJobs;
+  for (auto &datasetPath : datasets) {
+    keyJobs[datasetPath.substr(0, datasetPath.find_last_of('/'))].push_back(
+        datasetPath);
+  }
+
+  // Repack the keys one after another. The HDF5 library serializes its calls,
+  // so only the compression of the chunks runs in parallel.
+  Utilities::ThreadPool threadPool(
+      static_cast<unsigned int>(std::max(program.get<int>("--jobs"), 1)));
+  bool success = true;
+  for (auto &job : keyJobs) {
+    for (auto &datasetPath : job.second) {
+      try {
+        if (!repackDataSet(*srcFile, *dstFile, datasetPath, options,
+                           threadPool)) {
+          success = false;
+        }
+      } catch (HighFive::Exception &e) {
+        LOG(ERROR) << "Could not repack " << datasetPath << ": " << e.what();
+        success = false;
+      }
+    }
+    LOG(INFO) << "Repacked " << job.first << ".";
+  }
+
+  dstFile->flush();
+  dstFile.reset();
+  srcFile.reset();
+
+  if (!success) {
+    LOG(ERROR) << "Repacking failed. " << outputFile << " is incomplete.";
+    return 1;
+  }
+
+  if (options.verify && !verifyStructure(inputFile, outputFile)) {
+    return 1;
+  }
+
+  LOG(INFO) << "Repacked " << keyJobs.size() << " keys. Size went from "
+            << std::filesystem::file_size(inputFile) << " bytes to "
+            << std::filesystem::file_size(outputFile) << " bytes.";
+  LOG(INFO) << "Finished. Bye.";
+
+  return 0;
+}
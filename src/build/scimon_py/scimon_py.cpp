@@ -0,0 +1,289 @@
+// Standard includes
+#include <complex>
+#include <optional>
+#include <stdexcept>
+
+// 3rd party includes
+#include <easylogging++.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+// Project includes
+#include "data_manager_hdf.hpp"
+
+INITIALIZE_EASYLOGGINGPP
+
+namespace py = pybind11;
+using namespace Utilities;
+
+namespace {
+
+/**
+ * @brief Converts an optional time in milliseconds since epoch into a time
+ * point.
+ * @param milliseconds The time. None stands for an open end of a time frame.
+ * @param openEnd The time point, that is used for an open end.
+ * @return The time point.
+ */
+TimePoint toTimePoint(const std::optional<long long> &milliseconds,
+                      TimePoint openEnd) {
+  return milliseconds ? TimePoint(Duration(*milliseconds)) : openEnd;
+}
+
+/**
+ * @brief Read access to a SCIMon HDF file from Python. The rows of a time frame
+ * are located by the time index of DataManagerHdf, and read by the HDF library
+ * directly into the memory of the returned NumPy arrays.
+ */
+class Reader {
+public:
+  /**
+   * @brief Opens the file read-only, so that it can be read while it is
+   * opened by other readers.
+   * @param fileName The name of the file.
+   */
+  explicit Reader(const std::string &fileName) {
+    this->dataManager.setReadOnly(true);
+    if (!this->dataManager.open(fileName)) {
+      throw std::runtime_error("Could not open " + fileName + ".");
+    }
+  }
+
+  /**
+   * @brief Closes the file. Further reads fail.
+   */
+  void close() { this->dataManager.close(); }
+
+  /**
+   * @brief Returns the keys of the file and the names of their types.
+   */
+  std::map<std::string, std::string> keys() const {
+    std::map<std::string, std::string> retVal;
+    for (auto &keyValuePair : this->dataManager.getKeyMapping()) {
+      retVal[keyValuePair.first] = Reader::getTypeName(keyValuePair.second);
+    }
+    return retVal;
+  }
+
+  /**
+   * @brief Returns the frequencies of a spectrum key.
+   */
+  py::array_t<double> frequencies(const std::string &key) {
+    if (this->getDataType(key) != DATAMANAGER_DATA_TYPE_SPECTRUM) {
+      throw py::value_error("Key " + key + " is not a spectrum.");
+    }
+    std::vector<double> frequencies =
+        this->dataManager.getSpectrumMapping()[key];
+    py::array_t<double> retVal(frequencies.size());
+    std::copy(frequencies.begin(), frequencies.end(), retVal.mutable_data());
+    return retVal;
+  }
+
+  /**
+   * @brief Returns the count of rows of a key within a time frame.
+   */
+  size_t count(const std::string &key, std::optional<long long> start,
+               std::optional<long long> stop) {
+    auto [firstRow, rowCount] = this->findRows(key, start, stop);
+    return rowCount;
+  }
+
+  /**
+   * @brief Reads the timestamps and values of a key within a time frame.
+   * @return A tuple of the timestamps in milliseconds since epoch and the
+   * values. Spectra are returned as complex matrix with one row per spectrum,
+   * strings as list.
+   */
+  py::tuple read(const std::string &key, std::optional<long long> start,
+                 std::optional<long long> stop) {
+    DataManagerDataType dataType = this->getDataType(key);
+    auto [firstRow, rowCount] = this->findRows(key, start, stop);
+    std::vector<size_t> rowShape;
+    if (rowCount > 0 && !this->dataManager.getRowShape(key, rowShape)) {
+      throw std::runtime_error("Could not read the shape of " + key + ".");
+    }
+
+    py::array_t<long long> timestamps(rowCount);
+    long long *timestampsData = timestamps.mutable_data();
+    bool success = true;
+    if (rowCount > 0) {
+      py::gil_scoped_release release;
+      success = this->dataManager.readTimestamps(key, firstRow, rowCount,
+                                                 timestampsData);
+    }
+    if (!success) {
+      throw std::runtime_error("Could not read the timestamps of " + key +
+                               ".");
+    }
+
+    py::object values;
+    switch (dataType) {
+    case DATAMANAGER_DATA_TYPE_INT:
+      values = this->readValues<int, int>(key, firstRow, rowCount, {rowCount});
+      break;
+    case DATAMANAGER_DATA_TYPE_DOUBLE:
+      values = this->readValues<double, double>(key, firstRow, rowCount,
+                                                {rowCount});
+      break;
+    case DATAMANAGER_DATA_TYPE_COMPLEX:
+      // Pairs of doubles have the memory layout of complex numbers.
+      values = this->readValues<std::complex<double>, double>(
+          key, firstRow, rowCount, {rowCount});
+      break;
+    case DATAMANAGER_DATA_TYPE_SPECTRUM:
+      values = this->readValues<std::complex<double>, double>(
+          key, firstRow, rowCount,
+          {rowCount, rowShape.empty() ? 0 : rowShape.front()});
+      break;
+    case DATAMANAGER_DATA_TYPE_STRING:
+      values = this->readStrings(key, timestamps);
+      break;
+    default:
+      throw std::runtime_error("Key " + key + " has an unknown type.");
+    }
+
+    return py::make_tuple(timestamps, values);
+  }
+
+private:
+  /**
+   * @brief Returns the name of a data type, as presented to Python.
+   */
+  static std::string getTypeName(DataManagerDataType dataType) {
+    switch (dataType) {
+    case DATAMANAGER_DATA_TYPE_INT:
+      return "int";
+    case DATAMANAGER_DATA_TYPE_DOUBLE:
+      return "double";
+    case DATAMANAGER_DATA_TYPE_COMPLEX:
+      return "complex";
+    case DATAMANAGER_DATA_TYPE_STRING:
+      return "string";
+    case DATAMANAGER_DATA_TYPE_SPECTRUM:
+      return "spectrum";
+    default:
+      return "invalid";
+    }
+  }
+
+  /**
+   * @brief Returns the data type of a key. Raises a KeyError, if the key does
+   * not exist.
+   */
+  DataManagerDataType getDataType(const std::string &key) const {
+    if (!this->dataManager.isOpen()) {
+      throw std::runtime_error("The file has been closed.");
+    }
+    KeyMapping keyMapping = this->dataManager.getKeyMapping();
+    auto it = keyMapping.find(key);
+    if (it == keyMapping.end()) {
+      throw py::key_error(key);
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief Determines the rows of a key within a time frame.
+   * @return The index of the first row and the count of rows. Keys without
+   * data have no rows.
+   */
+  std::pair<size_t, size_t> findRows(const std::string &key,
+                                     std::optional<long long> start,
+                                     std::optional<long long> stop) {
+    this->getDataType(key);
+
+    size_t firstRow = 0;
+    size_t rowCount = 0;
+    py::gil_scoped_release release;
+    if (!this->dataManager.findRows(key, toTimePoint(start, TimePoint::min()),
+                                    toTimePoint(stop, TimePoint::max()),
+                                    firstRow, rowCount)) {
+      return {0, 0};
+    }
+    return {firstRow, rowCount};
+  }
+
+  /**
+   * @brief Reads the values of consecutive rows into a new NumPy array.
+   * @tparam T The element type of the array.
+   * @tparam S The type, that the values are read as. T has to consist of
+   * sizeof(T) / sizeof(S) elements of type S.
+   */
+  template <class T, class S>
+  py::array_t<T> readValues(const std::string &key, size_t firstRow,
+                            size_t rowCount, std::vector<size_t> shape) {
+    py::array_t<T> values(shape);
+    S *data = reinterpret_cast<S *>(values.mutable_data());
+    bool success = true;
+    if (rowCount > 0) {
+      py::gil_scoped_release release;
+      success = this->dataManager.readValues(key, firstRow, rowCount, data);
+    }
+    if (!success) {
+      throw std::runtime_error("Could not read the values of " + key + ".");
+    }
+    return values;
+  }
+
+  /**
+   * @brief Reads the strings of the given timestamps. Strings can not be
+   * read into an array, hence they are decoded into a list.
+   */
+  py::list readStrings(const std::string &key,
+                       const py::array_t<long long> &timestamps) {
+    py::list retVal;
+    if (timestamps.size() == 0) {
+      return retVal;
+    }
+
+    TimePoint from(Duration(timestamps.at(0)));
+    TimePoint to(Duration(timestamps.at(timestamps.size() - 1)));
+    std::vector<TimePoint> readTimestamps;
+    std::vector<Value> values;
+    bool success;
+    {
+      py::gil_scoped_release release;
+      success =
+          this->dataManager.read(from, to, key, readTimestamps, values);
+    }
+    if (!success) {
+      throw std::runtime_error("Could not read the values of " + key + ".");
+    }
+
+    values.resize(std::min<size_t>(values.size(), timestamps.size()));
+    for (auto &value : values) {
+      retVal.append(std::get<std::string>(value));
+    }
+    return retVal;
+  }
+
+  /// The data manager, that reads the file.
+  DataManagerHdf dataManager;
+};
+
+} // namespace
+
+PYBIND11_MODULE(scimon, module) {
+  module.doc() = "Read access to SCIMon HDF files. Timestamps are given in "
+                 "milliseconds since epoch.";
+
+  py::class_<Reader>(module, "File")
+      .def(py::init<const std::string &>(), py::arg("file_name"),
+           "Opens a SCIMon HDF file read-only.")
+      .def("close", &Reader::close, "Closes the file.")
+      .def("keys", &Reader::keys,
+           "Returns a dict, that maps the keys to the names of their types.")
+      .def("frequencies", &Reader::frequencies, py::arg("key"),
+           "Returns the frequencies of a spectrum.")
+      .def("count", &Reader::count, py::arg("key"),
+           py::arg("start") = py::none(), py::arg("stop") = py::none(),
+           "Returns the count of rows within [start, stop].")
+      .def("read", &Reader::read, py::arg("key"),
+           py::arg("start") = py::none(), py::arg("stop") = py::none(),
+           "Returns the timestamps and values within [start, stop]. Spectra "
+           "are returned as complex matrix with one row per spectrum.")
+      .def("__enter__", [](Reader &reader) -> Reader & { return reader; },
+           py::return_value_policy::reference)
+      .def("__exit__", [](Reader &reader, py::args) { reader.close(); });
+}
@@ -7,6 +7,7 @@
 
 // Project includes
 #include <common.hpp>
+#include <data_manager_session.hpp>
 #include <device_isx3.hpp>
 #include <device_ob1_win.hpp>
 #include <isx3_payload_decoder.hpp>
@@ -36,7 +37,12 @@ int main(int argc, char *argv[]) {
       .help("The port to which the network worker listens for connections.");
   program.add_argument("--interval")
       .default_value(DEFAULT_MESSAGE_DISTRIBUTOR_LOOP_INTERVAL)
-      .help("The message distributor interval.");
+      .help("The message distributor interval. Queued messages are delivered "
+            "immediately, the interval only paces the polling of devices.");
+  program.add_argument("--session")
+      .default_value(std::string(""))
+      .help("If set, all devices and workers write into this one session "
+            "file instead of their own files.");
 
   // Try to parse the command line.
   try {
@@ -46,8 +52,18 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
+  // Open the session store before any participant is created, so that all
+  // participants attach to it.
+  std::string sessionName = program.get<std::string>("--session");
+  if (!sessionName.empty() && !Utilities::SessionStore::open(sessionName)) {
+    LOG(ERROR) << "Could not open the session " << sessionName
+               << ". Aborting.";
+    return 1;
+  }
+
   // Create the distributor.
-  MessageDistributor messageDistributor(program.get<int>("--interval"));
+  MessageDistributor messageDistributor(program.get<int>("--interval"),
+                                        MESSAGE_DISTRIBUTOR_MODE_EVENT_DRIVEN);
   // Initialize the message factory.
   MessageFactory::createInstace(
       {std::shared_ptr<PayloadDecoder>(new Ob1PayloadDecoder()),
@@ -68,21 +84,23 @@ int main(int argc, char *argv[]) {
 
   // Immediatelly queue up messages for the network worker, so that it starts
   // listening on startup.
-  messageDistributor.takeMessage(
-      std::shared_ptr<DeviceMessage>(new InitDeviceMessage(
-          UserId(), networkWorker->getUserId(),
-          new NetworkWorkerInitPayload(
-              NetworkWorkerOperationMode::NETWORK_WORKER_OP_MODE_SERVER, "",
-              program.get<int>("--port")))));
-  messageDistributor.takeMessage(
-      std::shared_ptr<DeviceMessage>(new ConfigDeviceMessage(
-          UserId(), networkWorker->getUserId(), nullptr, {})));
-  messageDistributor.takeMessage(std::shared_ptr<DeviceMessage>(
-      new WriteDeviceMessage(UserId(), networkWorker->getUserId(),
-                             WriteDeviceTopic::WRITE_TOPIC_RUN)));
+  messageDistributor.takeMessage(Utilities::makePooled<InitDeviceMessage>(
+      UserId(), networkWorker->getUserId(),
+      new NetworkWorkerInitPayload(
+          NetworkWorkerOperationMode::NETWORK_WORKER_OP_MODE_SERVER, "",
+          program.get<int>("--port"))));
+  messageDistributor.takeMessage(Utilities::makePooled<ConfigDeviceMessage>(
+      UserId(), networkWorker->getUserId(), nullptr, std::vector<UserId>()));
+  messageDistributor.takeMessage(Utilities::makePooled<WriteDeviceMessage>(
+      UserId(), networkWorker->getUserId(), WriteDeviceTopic::WRITE_TOPIC_RUN));
 
   // Start the message distribution.
   messageDistributor.run();
 
+  // Release the session store of the process. It is destroyed, once the
+  // participants have been destroyed, and not during the destruction of static
+  // objects, which it depends on.
+  Utilities::SessionStore::close();
+
   return 0;
 }
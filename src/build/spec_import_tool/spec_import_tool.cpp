@@ -0,0 +1,382 @@
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+// 3rd party includes
+#include <argparse/argparse.hpp>
+#include <easylogging++.h>
+
+// Project includes
+#include "data_manager_hdf.hpp"
+#include "utilities.hpp"
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace Utilities;
+
+/// The file extension of Sciospec spectrum files.
+#define SPEC_FILE_EXTENSION ".spec"
+/// The line of a spectrum file that holds the timestamp.
+#define SPEC_TIMESTAMP_LINE 4
+/// The first line of a spectrum file that holds impedance values.
+#define SPEC_FIRST_DATA_LINE 6
+/// The count of spectra that are written to the data manager at once.
+#define WRITE_BLOCK_SIZE 1024
+
+namespace {
+
+/**
+ * @brief A single spectrum, as parsed from a spectrum file.
+ */
+struct ParsedSpectrum {
+  /// The time of the measurement.
+  TimePoint timestamp;
+  /// The measured frequencies.
+  std::vector<double> frequencies;
+  /// The impedances per frequency.
+  std::vector<Impedance> impedances;
+};
+
+/**
+ * @brief Parses a double from the given string.
+ * @param str The string. Leading and trailing whitespace is ignored.
+ * @param value Will contain the parsed value.
+ * @return TRUE if the string holds a double. FALSE otherwise.
+ */
+bool parseDouble(std::string_view str, double &value) {
+  auto isSpace = [](char c) {
+    return std::isspace(static_cast<unsigned char>(c));
+  };
+  while (!str.empty() && isSpace(str.front())) {
+    str.remove_prefix(1);
+  }
+  while (!str.empty() && isSpace(str.back())) {
+    str.remove_suffix(1);
+  }
+  auto result = std::from_chars(str.data(), str.data() + str.size(), value);
+  return result.ec == std::errc() && result.ptr == str.data() + str.size();
+}
+
+/**
+ * @brief Parses the timestamp of a spectrum file. Sciospec writes local time
+ * in the form "15-Mar-2022 01:23:45:678 PM".
+ * @param str The timestamp string.
+ * @param timestamp Will contain the parsed timestamp.
+ * @return TRUE if the timestamp has been parsed. FALSE otherwise.
+ */
+bool parseTimestamp(const std::string &str, TimePoint &timestamp) {
+  static const std::vector<std::string> months{"jan", "feb", "mar", "apr",
+                                               "may", "jun", "jul", "aug",
+                                               "sep", "oct", "nov", "dec"};
+
+  int day, year, hour, minute, second, millisecond;
+  char monthStr[4] = {0};
+  char meridiemStr[3] = {0};
+  if (std::sscanf(str.c_str(), " %d-%3[A-Za-z]-%d %d:%d:%d:%d %2[AaPpMm]",
+                  &day, monthStr, &year, &hour, &minute, &second,
+                  &millisecond, meridiemStr) != 8) {
+    return false;
+  }
+
+  std::string month(monthStr);
+  std::transform(month.begin(), month.end(), month.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  auto monthIt = std::find(months.begin(), months.end(), month);
+  if (monthIt == months.end() || hour < 1 || hour > 12) {
+    return false;
+  }
+
+  // Convert from the 12 hour clock.
+  bool isPm = std::tolower(meridiemStr[0]) == 'p';
+  hour = hour % 12 + (isPm ? 12 : 0);
+
+  std::tm time = {};
+  time.tm_mday = day;
+  time.tm_mon = static_cast<int>(monthIt - months.begin());
+  time.tm_year = year - 1900;
+  time.tm_hour = hour;
+  time.tm_min = minute;
+  time.tm_sec = second;
+  time.tm_isdst = -1;
+  std::time_t seconds = std::mktime(&time);
+  if (seconds == -1) {
+    return false;
+  }
+
+  timestamp = TimePoint(std::chrono::seconds(seconds)) +
+              std::chrono::milliseconds(millisecond);
+  return true;
+}
+
+/**
+ * @brief Parses a Sciospec spectrum file.
+ * @param path The path of the file.
+ * @param replaceNegative Whether negative real and imaginary parts shall be
+ * replaced by NaN.
+ * @param spectrum Will contain the parsed spectrum.
+ * @return TRUE if the file has been parsed. FALSE otherwise.
+ */
+bool parseSpecFile(const std::filesystem::path &path, bool replaceNegative,
+                   ParsedSpectrum &spectrum) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  std::string line;
+  for (int lineIdx = 0; std::getline(file, line); lineIdx++) {
+    if (lineIdx == SPEC_TIMESTAMP_LINE) {
+      if (!parseTimestamp(line, spectrum.timestamp)) {
+        return false;
+      }
+    } else if (lineIdx >= SPEC_FIRST_DATA_LINE) {
+      auto fields = Utilities::split(line, ',');
+      if (fields.size() == 1 && fields[0].find_first_not_of(" \t\r") ==
+                                    std::string::npos) {
+        // Skip empty lines.
+        continue;
+      }
+
+      double frequency, real, imag;
+      if (fields.size() < 3 || !parseDouble(fields[0], frequency) ||
+          !parseDouble(fields[1], real) || !parseDouble(fields[2], imag)) {
+        return false;
+      }
+      if (replaceNegative && real < 0.0) {
+        real = std::numeric_limits<double>::quiet_NaN();
+      }
+      if (replaceNegative && imag < 0.0) {
+        imag = std::numeric_limits<double>::quiet_NaN();
+      }
+      spectrum.frequencies.push_back(frequency);
+      spectrum.impedances.emplace_back(real, imag);
+    }
+  }
+
+  return !spectrum.frequencies.empty();
+}
+
+/**
+ * @brief Imports all spectrum files of a folder as one spectrum key. The files
+ * are parsed in parallel and written in chronological order.
+ * @param dataManager The data manager the key is written to.
+ * @param folder The folder, that holds the spectrum files.
+ * @param key The name of the key.
+ * @param jobCount The count of threads, that parse files.
+ * @param replaceNegative Whether negative values shall be replaced by NaN.
+ * @return TRUE if the folder has been imported. FALSE otherwise.
+ */
+bool importFolder(DataManagerHdf &dataManager,
+                  const std::filesystem::path &folder, const std::string &key,
+                  int jobCount, bool replaceNegative) {
+  std::vector<std::filesystem::path> files;
+  for (auto &entry : std::filesystem::directory_iterator(folder)) {
+    if (entry.is_regular_file() &&
+        entry.path().extension() == SPEC_FILE_EXTENSION) {
+      files.push_back(entry.path());
+    }
+  }
+  if (files.empty()) {
+    LOG(WARNING) << "No " << SPEC_FILE_EXTENSION << " files found in "
+                 << folder.string() << ".";
+    return false;
+  }
+  LOG(INFO) << "Found " << files.size() << " files in " << folder.string()
+            << ".";
+
+  // Parse the files in parallel. Parsing does not touch the HDF library, so
+  // it scales with the count of threads.
+  std::vector<ParsedSpectrum> spectra(files.size());
+  std::vector<char> parseSuccess(files.size(), false);
+  std::atomic<size_t> nextFile = 0;
+  auto worker = [&]() {
+    size_t fileIdx;
+    while ((fileIdx = nextFile++) < files.size()) {
+      parseSuccess[fileIdx] =
+          parseSpecFile(files[fileIdx], replaceNegative, spectra[fileIdx]);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < std::min<size_t>(jobCount, files.size()); i++) {
+    workers.emplace_back(worker);
+  }
+  for (auto &workerThread : workers) {
+    workerThread.join();
+  }
+
+  // All spectra of a key have to share the frequencies of the first one.
+  std::vector<ParsedSpectrum *> validSpectra;
+  const std::vector<double> *frequencies = nullptr;
+  for (size_t i = 0; i < files.size(); i++) {
+    if (!parseSuccess[i]) {
+      LOG(WARNING) << "Could not parse " << files[i].string() << ". Skipping.";
+      continue;
+    }
+    if (frequencies == nullptr) {
+      frequencies = &spectra[i].frequencies;
+    } else if (spectra[i].frequencies != *frequencies) {
+      LOG(WARNING) << files[i].string()
+                   << " has different frequencies than the other files. "
+                      "Skipping.";
+      continue;
+    }
+    validSpectra.push_back(&spectra[i]);
+  }
+  if (validSpectra.empty()) {
+    LOG(ERROR) << "None of the files in " << folder.string()
+               << " could be parsed.";
+    return false;
+  }
+
+  // Readers expect the timestamps of a key to be ascending.
+  std::stable_sort(validSpectra.begin(), validSpectra.end(),
+                   [](const ParsedSpectrum *a, const ParsedSpectrum *b) {
+                     return a->timestamp < b->timestamp;
+                   });
+
+  // Tag the key like the spectra of a connected spectrometer, so that the
+  // export treats both alike.
+  const std::map<std::string, int> groupProps{
+      {DataManager::DATA_MANAGER_DEVICETYPE_ATTR_NAME,
+       static_cast<int>(Devices::DeviceType::IMPEDANCE_SPECTROMETER)}};
+  if (!dataManager.createKey(key, DATAMANAGER_DATA_TYPE_SPECTRUM) ||
+      !dataManager.createGroup(key, groupProps) ||
+      !dataManager.setupSpectrum(key, *frequencies)) {
+    LOG(ERROR) << "Could not create key " << key
+               << ". Does it already exist in the output file?";
+    return false;
+  }
+
+  for (size_t blockStart = 0; blockStart < validSpectra.size();
+       blockStart += WRITE_BLOCK_SIZE) {
+    size_t blockEnd =
+        std::min<size_t>(blockStart + WRITE_BLOCK_SIZE, validSpectra.size());
+    std::vector<TimePoint> timestamps;
+    std::vector<Value> values;
+    timestamps.reserve(blockEnd - blockStart);
+    values.reserve(blockEnd - blockStart);
+    for (size_t i = blockStart; i < blockEnd; i++) {
+      ImpedanceSpectrum impedanceSpectrum;
+      Utilities::joinImpedanceSpectrum(validSpectra[i]->frequencies,
+                                       validSpectra[i]->impedances,
+                                       impedanceSpectrum);
+      timestamps.push_back(validSpectra[i]->timestamp);
+      values.emplace_back(std::move(impedanceSpectrum));
+    }
+    if (!dataManager.write(timestamps, key, values)) {
+      LOG(ERROR) << "Could not write the spectra of " << key << ".";
+      return false;
+    }
+  }
+
+  LOG(INFO) << "Imported " << validSpectra.size() << " spectra as " << key
+            << ".";
+  return true;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  LOG(INFO) << "Starting up spec_import_tool";
+
+  argparse::ArgumentParser program("spec_import_tool");
+  program.add_description(
+      "This tool imports folders of *.spec files, that have been recorded with "
+      "the Sciospec software, into a SCIMon HDF file. Each folder becomes a "
+      "spectrum key, named after the folder. The files of a folder are parsed "
+      "in parallel. \n\n "
+      "Example: \n spec_import_tool -o \"C:/Users/Foo/import.hdf\" "
+      "\"C:/Users/Foo/run1\" \"C:/Users/Foo/run2\"");
+  program.add_argument("-o", "--output")
+      .help("Path to the HDF file. Defaults to the name of the first input "
+            "folder. An existing file is extended.")
+      .default_value(std::string{""});
+  program.add_argument("-j", "--jobs")
+      .help("The count of threads, that parse files.")
+      .default_value(static_cast<int>(
+          std::max(std::thread::hardware_concurrency(), 1u)))
+      .scan<'i', int>();
+  program.add_argument("-rn", "--replace-negative")
+      .help("Replaces negative real and imaginary parts with NaN.")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("-f", "--force")
+      .help("Overwrites an existing output file.")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("input-folders")
+      .help("Paths to the folders, that hold the *.spec files.")
+      .remaining();
+
+  std::vector<std::string> inputFolders;
+  try {
+    program.parse_args(argc, argv);
+    inputFolders = program.get<std::vector<std::string>>("input-folders");
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  // Strip trailing separators, so that the folder names can be used as keys.
+  std::vector<std::filesystem::path> folders;
+  for (auto &inputFolder : inputFolders) {
+    std::filesystem::path folder =
+        std::filesystem::path(inputFolder).lexically_normal();
+    if (!folder.has_filename()) {
+      folder = folder.parent_path();
+    }
+    if (!std::filesystem::is_directory(folder)) {
+      LOG(ERROR) << inputFolder << " is not a folder.";
+      return 1;
+    }
+    folders.push_back(folder);
+  }
+
+  // The data manager appends the extension itself.
+  std::filesystem::path outputFile(program.get<std::string>("--output"));
+  if (outputFile.empty()) {
+    outputFile = folders.front().filename();
+  }
+  outputFile.replace_extension("");
+
+  DataManagerHdf dataManager;
+  if (!dataManager.open(outputFile.string(), KeyMapping(),
+                        program.get<bool>("--force"))) {
+    LOG(ERROR) << "Could not open " << outputFile.string() << ".hdf.";
+    return 1;
+  }
+  // Flush once at the end instead of after every block.
+  dataManager.setAutoFlush(false);
+
+  int jobCount = std::max(program.get<int>("--jobs"), 1);
+  bool replaceNegative = program.get<bool>("--replace-negative");
+  bool success = true;
+  for (auto &folder : folders) {
+    if (!importFolder(dataManager, folder, folder.filename().string(),
+                      jobCount, replaceNegative)) {
+      success = false;
+    }
+  }
+  dataManager.flush();
+  dataManager.close();
+
+  if (!success) {
+    LOG(ERROR) << "Not all folders could be imported.";
+    return 1;
+  }
+
+  LOG(INFO) << "Imported " << folders.size() << " folders into "
+            << outputFile.string() << ".hdf.";
+  LOG(INFO) << "Finished. Bye.";
+
+  return 0;
+}
@@ -28,10 +28,18 @@ def calc_magnitude(row):
     return ret_val
 
 
+def load_npz(file_name):
+    """Loads a spectrum measurement exported by extract_tool --output-format NUMPY."""
+    arrays = np.load(file_name)
+    df = pd.DataFrame(np.abs(arrays['values']), columns=arrays['frequencies'])
+    df.insert(0, 'timestamp', arrays['timestamps'])
+    return df
+
+
 if __name__ == '__main__':
     parser = argparse.ArgumentParser(
-        description="Takes a CSV file and plots it to a spectrogram.")
-    parser.add_argument('input_file', help="Path to the CSV file that shall be plotted.")
+        description="Takes a CSV or NPZ file and plots it to a spectrogram.")
+    parser.add_argument('input_file', help="Path to the CSV or NPZ file that shall be plotted.")
     parser.add_argument('-o', metavar="output_folder", default='.', help="Path to the output folder")
     parser.add_argument('-s', "--show", help="If given, shows the sepctrogram after it has been created.",
                         action='store_true')
@@ -39,11 +47,15 @@ if __name__ == '__main__':
     args = parser.parse_args()
 
     print("Reading from " + args.input_file + " ...")
-    df = pd.read_csv(args.input_file)
-    print("Read " + str(len(df)) + " lines.")
+    if args.input_file.endswith('.npz'):
+        df_magnitude = load_npz(args.input_file)
+        print("Read " + str(len(df_magnitude)) + " spectra.")
+    else:
+        df = pd.read_csv(args.input_file)
+        print("Read " + str(len(df)) + " lines.")
 
-    print("Converting " + str(len(df)) + " lines ...")
-    df_magnitude = df.apply(calc_magnitude, axis='columns')
+        print("Converting " + str(len(df)) + " lines ...")
+        df_magnitude = df.apply(calc_magnitude, axis='columns')
     df_melted = df_magnitude.melt(id_vars=['timestamp'], value_vars=df_magnitude.columns)
     extent = (
         df_melted['variable'].min(),
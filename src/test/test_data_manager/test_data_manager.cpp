@@ -1,8 +1,15 @@
 // Standard includes
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
 #include <memory>
 #include <sstream>
+#include <thread>
 
 // 3rd party includes
 #define CATCH_CONFIG_MAIN
@@ -11,7 +18,11 @@
 #include <easylogging++.h>
 
 // Project includes
+#include <data_manager_columnar.hpp>
 #include <data_manager_hdf.hpp>
+#include <data_manager_session.hpp>
+#include <numpy_writer.hpp>
+#include <spectrum_index.hpp>
 
 INITIALIZE_EASYLOGGINGPP
 
@@ -451,6 +462,670 @@ TEST_CASE("Test vectorized reads and writes of the HDF data manager") {
   REQUIRE(readTimestampsSpectrum == std::vector<TimePoint>{});
 }
 
+TEST_CASE("Test dictionary encoding of string keys") {
+  std::remove(TestFileNameExt.c_str());
+
+  std::shared_ptr<DataManager> dut =
+      std::shared_ptr<DataManager>(new DataManagerHdf());
+
+  KeyMapping keyMapping;
+  keyMapping["string"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_STRING;
+  REQUIRE(dut->open(TestFileName, keyMapping));
+
+  // Write a repetitive string channel.
+  TimePoint now = getNow();
+  std::vector<TimePoint> timePointVector;
+  std::vector<Value> valueVector;
+  const std::vector<std::string> units{"mbar", "psi", "kPa"};
+  for (int i = 0; i < 300; i++) {
+    timePointVector.emplace_back(now + std::chrono::seconds(i));
+    valueVector.emplace_back(Value(units[i % units.size()]));
+  }
+  REQUIRE(dut->write(timePointVector, "string", valueVector));
+  REQUIRE(dut->write(now + std::chrono::seconds(300), "string",
+                     Value(std::string("bar"))));
+  timePointVector.emplace_back(now + std::chrono::seconds(300));
+  valueVector.emplace_back(Value(std::string("bar")));
+  dut.reset();
+
+  // Each distinct string has to be stored exactly once.
+  {
+    HighFive::File file(TestFileNameExt, HighFive::File::ReadOnly);
+    REQUIRE(file.getDataSet("/data/string/dictionary").getElementCount() == 4);
+    REQUIRE(file.getDataSet("/data/string/values").getElementCount() == 301);
+  }
+
+  // Reopen the file and read the strings back.
+  dut.reset(new DataManagerHdf());
+  REQUIRE(dut->open(TestFileNameExt));
+  std::vector<TimePoint> readTimestamps;
+  std::vector<Value> readValues;
+  REQUIRE(dut->read(now, now + std::chrono::seconds(300), "string",
+                    readTimestamps, readValues));
+  REQUIRE(readTimestamps == timePointVector);
+  REQUIRE(readValues == valueVector);
+
+  // Appending to the reopened file has to continue the existing dictionary.
+  REQUIRE(dut->write(now + std::chrono::seconds(301), "string",
+                     Value(std::string("psi"))));
+  readTimestamps.clear();
+  readValues.clear();
+  REQUIRE(dut->read(now + std::chrono::seconds(301),
+                    now + std::chrono::seconds(301), "string", readTimestamps,
+                    readValues));
+  REQUIRE(readValues == std::vector<Value>{Value(std::string("psi"))});
+
+  // A batch with a value, that is not a string, has to be rejected without
+  // changing the dictionary or the values.
+  REQUIRE_FALSE(dut->write(
+      {now + std::chrono::seconds(302), now + std::chrono::seconds(303)},
+      "string", {Value(std::string("Pa")), Value(1)}));
+  dut.reset();
+  {
+    HighFive::File file(TestFileNameExt, HighFive::File::ReadOnly);
+    REQUIRE(file.getDataSet("/data/string/dictionary").getElementCount() == 4);
+    REQUIRE(file.getDataSet("/data/string/values").getElementCount() == 302);
+  }
+}
+
+TEST_CASE("Test conversion to a columnar archive") {
+  std::remove(TestFileNameExt.c_str());
+  const std::string archiveName = TestFileName + ".columnar";
+  std::filesystem::remove_all(archiveName);
+
+  std::shared_ptr<DataManagerHdf> hdf(new DataManagerHdf());
+
+  KeyMapping keyMapping;
+  keyMapping["int"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_INT;
+  keyMapping["double"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_DOUBLE;
+  keyMapping["string"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_STRING;
+  keyMapping["complex"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_COMPLEX;
+  keyMapping["spectrum"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+
+  std::vector<double> testFrequencies{1.0,     10.0,     100.0,    1000.0,
+                                      10000.0, 100000.0, 1000000.0};
+  std::vector<Impedance> testImpedances{{1.0, 2.0},  {3.0, 4.0},  {5.0, 6.0},
+                                        {7.0, 8.0},  {9.0, 10.0}, {11.0, 12.0},
+                                        {13.0, 14.0}};
+  ImpedanceSpectrum testSpectrum;
+  Utilities::joinImpedanceSpectrum(testFrequencies, testImpedances,
+                                   testSpectrum);
+
+  REQUIRE(hdf->open(TestFileName, keyMapping));
+  REQUIRE(hdf->setupSpectrum("spectrum", testFrequencies));
+
+  // Write more rows than fit into a single chunk.
+  TimePoint now = getNow();
+  std::vector<TimePoint> timePointVector;
+  std::vector<Value> valueVectorInt;
+  std::vector<Value> valueVectorDouble;
+  std::vector<Value> valueVectorString;
+  std::vector<Value> valueVectorComplex;
+  std::vector<Value> valueVectorSpectrum;
+  for (int i = 0; i < 2500; i++) {
+    timePointVector.emplace_back(now + std::chrono::seconds(i));
+    valueVectorInt.emplace_back(Value(i));
+    valueVectorDouble.emplace_back(Value(i * 0.5));
+    valueVectorString.emplace_back(Value(std::to_string(i % 3)));
+    valueVectorComplex.emplace_back(Value(Impedance(i, -i)));
+    valueVectorSpectrum.emplace_back(Value(testSpectrum));
+  }
+  REQUIRE(hdf->write(timePointVector, "int", valueVectorInt));
+  REQUIRE(hdf->write(timePointVector, "double", valueVectorDouble));
+  REQUIRE(hdf->write(timePointVector, "string", valueVectorString));
+  REQUIRE(hdf->write(timePointVector, "complex", valueVectorComplex));
+  REQUIRE(hdf->write(timePointVector, "spectrum", valueVectorSpectrum));
+
+  REQUIRE(hdf->writeToColumnar(archiveName));
+
+  std::shared_ptr<DataManagerColumnar> dut(new DataManagerColumnar());
+  REQUIRE(dut->open(archiveName));
+  REQUIRE(dut->getKeyMapping() == keyMapping);
+  REQUIRE(dut->getSpectrumMapping() ==
+          SpectrumMapping{{"spectrum", testFrequencies}});
+  REQUIRE(dut->getTimerangeMapping() == hdf->getTimerangeMapping());
+
+  // A sub range has to match the original data.
+  TimePoint from = now + std::chrono::seconds(1000);
+  TimePoint to = now + std::chrono::seconds(1999);
+  const std::vector<std::pair<std::string, std::vector<Value> *>> keys{
+      {"int", &valueVectorInt},
+      {"double", &valueVectorDouble},
+      {"string", &valueVectorString},
+      {"complex", &valueVectorComplex},
+      {"spectrum", &valueVectorSpectrum}};
+  for (auto &key : keys) {
+    std::vector<TimePoint> readTimestamps;
+    std::vector<Value> readValues;
+    REQUIRE(dut->read(from, to, key.first, readTimestamps, readValues));
+    REQUIRE(readTimestamps ==
+            std::vector<TimePoint>(timePointVector.begin() + 1000,
+                                   timePointVector.begin() + 2000));
+    REQUIRE(readValues == std::vector<Value>(key.second->begin() + 1000,
+                                             key.second->begin() + 2000));
+  }
+
+  // Single reads.
+  Value readValue;
+  REQUIRE(dut->read(now + std::chrono::seconds(42), "int", readValue));
+  REQUIRE(std::get<int>(readValue) == 42);
+  REQUIRE(!dut->read(now + std::chrono::milliseconds(1), "int", readValue));
+
+  // Zero-copy access.
+  std::span<const long long> timestampView;
+  std::span<const double> complexView;
+  REQUIRE(dut->readColumns(from, to, "complex", timestampView, complexView));
+  REQUIRE(timestampView.size() == 1000);
+  REQUIRE(complexView.size() == 2000);
+  REQUIRE(complexView[0] == 1000.0);
+  REQUIRE(complexView[1] == -1000.0);
+  std::span<const int> intView;
+  REQUIRE(!dut->readColumns(from, to, "complex", timestampView, intView));
+
+  // The archive is read-only.
+  REQUIRE(!dut->write(now, "int", Value(1)));
+  REQUIRE(!dut->createKey("anotherKey", DATAMANAGER_DATA_TYPE_INT));
+  dut.reset();
+
+  // Damaged archives have to be rejected without throwing.
+  const std::filesystem::path manifestPath =
+      std::filesystem::path(archiveName) / "manifest.txt";
+  std::string manifest;
+  {
+    std::ifstream manifestStream(manifestPath);
+    std::stringstream manifestBuffer;
+    manifestBuffer << manifestStream.rdbuf();
+    manifest = manifestBuffer.str();
+  }
+  // An unknown data type in the first entry.
+  size_t typeBegin = manifest.find('\t', manifest.find('\n')) + 1;
+  size_t typeEnd = manifest.find('\t', typeBegin);
+  std::string unknownTypeManifest = manifest;
+  unknownTypeManifest.replace(typeBegin, typeEnd - typeBegin, "99");
+  std::ofstream(manifestPath, std::ios::trunc) << unknownTypeManifest;
+  dut.reset(new DataManagerColumnar());
+  REQUIRE_FALSE(dut->open(archiveName));
+  std::ofstream(manifestPath, std::ios::trunc) << manifest;
+
+  std::filesystem::path dictionaryPath;
+  std::filesystem::path frequencyPath;
+  for (auto &entry : std::filesystem::directory_iterator(archiveName)) {
+    if (entry.path().extension() == ".dictionary") {
+      dictionaryPath = entry.path();
+    } else if (entry.path().extension() == ".frequencies") {
+      frequencyPath = entry.path();
+    }
+  }
+  // A dictionary entry, that is longer than the file.
+  std::filesystem::rename(dictionaryPath, dictionaryPath.string() + ".bak");
+  {
+    std::ofstream dictionaryStream(dictionaryPath, std::ios::binary);
+    uint32_t length = std::numeric_limits<uint32_t>::max();
+    dictionaryStream.write(reinterpret_cast<const char *>(&length),
+                           sizeof(length));
+  }
+  dut.reset(new DataManagerColumnar());
+  REQUIRE_FALSE(dut->open(archiveName));
+  std::filesystem::remove(dictionaryPath);
+  std::filesystem::rename(dictionaryPath.string() + ".bak", dictionaryPath);
+  REQUIRE(dut->open(archiveName));
+  dut.reset(new DataManagerColumnar());
+  // Missing frequencies of a spectrum key.
+  std::filesystem::remove(frequencyPath);
+  REQUIRE_FALSE(dut->open(archiveName));
+  REQUIRE_FALSE(dut->isOpen());
+}
+
+TEST_CASE("Test shared session store") {
+  std::remove(TestFileNameExt.c_str());
+
+  // Without a session store, there is nothing to attach to.
+  std::shared_ptr<DataManager> deviceA(new DataManagerSession());
+  REQUIRE(!deviceA->open("deviceA", KeyMapping()));
+
+  REQUIRE(SessionStore::open(TestFileName));
+  REQUIRE(!SessionStore::open(TestFileName));
+
+  // Both participants use the same key names.
+  KeyMapping keyMapping;
+  keyMapping["int"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_INT;
+  keyMapping["spectrum"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  std::vector<double> testFrequencies{1.0, 10.0, 100.0};
+  std::vector<Impedance> testImpedances{{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}};
+  ImpedanceSpectrum testSpectrum;
+  Utilities::joinImpedanceSpectrum(testFrequencies, testImpedances,
+                                   testSpectrum);
+
+  std::shared_ptr<DataManager> deviceB(
+      DataManager::getDataManager(DATAMANAGER_TYPE_SESSION));
+  REQUIRE(deviceA->open("deviceA", keyMapping));
+  REQUIRE(deviceB->open("deviceB", keyMapping));
+  REQUIRE(deviceA->setupSpectrum("spectrum", testFrequencies));
+  REQUIRE(deviceB->setupSpectrum("spectrum", testFrequencies));
+  REQUIRE(deviceA->getKeyMapping() == keyMapping);
+
+  TimePoint now = getNow();
+  for (int i = 0; i < 100; i++) {
+    REQUIRE(deviceA->write(now + std::chrono::seconds(i), "int", Value(i)));
+    REQUIRE(deviceB->write(now + std::chrono::seconds(i), "int", Value(-i)));
+  }
+  REQUIRE(deviceB->write(now, "spectrum", Value(testSpectrum)));
+
+  // Each participant only sees its own data.
+  std::vector<TimePoint> readTimestamps;
+  std::vector<Value> readValues;
+  REQUIRE(deviceB->read(now + std::chrono::seconds(10),
+                        now + std::chrono::seconds(10), "int", readTimestamps,
+                        readValues));
+  REQUIRE(readValues == std::vector<Value>{Value(-10)});
+  REQUIRE(deviceA->getTimerangeMapping()["int"] ==
+          std::make_pair(now, now + std::chrono::seconds(99)));
+  REQUIRE(deviceA->getTimerangeMapping()["spectrum"].first ==
+          TimePoint(std::chrono::milliseconds(0)));
+
+  // The file stays open until the last participant has detached.
+  REQUIRE(SessionStore::close());
+  REQUIRE(deviceA->write(now + std::chrono::seconds(100), "int", Value(100)));
+  deviceA.reset();
+  deviceB.reset();
+
+  // All participants have been written into one file, each one into its own
+  // group.
+  std::shared_ptr<DataManager> dut(new DataManagerHdf());
+  REQUIRE(dut->open(TestFileNameExt));
+  REQUIRE(dut->getKeyMapping() ==
+          KeyMapping{{"deviceA/int", DATAMANAGER_DATA_TYPE_INT},
+                     {"deviceA/spectrum", DATAMANAGER_DATA_TYPE_SPECTRUM},
+                     {"deviceB/int", DATAMANAGER_DATA_TYPE_INT},
+                     {"deviceB/spectrum", DATAMANAGER_DATA_TYPE_SPECTRUM}});
+  readTimestamps.clear();
+  readValues.clear();
+  REQUIRE(dut->read(now, now + std::chrono::seconds(100), "deviceA/int",
+                    readTimestamps, readValues));
+  REQUIRE(readValues.size() == 101);
+  REQUIRE(std::get<int>(readValues.back()) == 100);
+  dut.reset();
+
+  // A new session continues the existing file.
+  REQUIRE(SessionStore::open(TestFileName));
+  deviceA.reset(new DataManagerSession());
+  REQUIRE(deviceA->open("deviceA", keyMapping));
+  REQUIRE(deviceA->setupSpectrum("spectrum", testFrequencies));
+  REQUIRE(deviceA->getTimerangeMapping()["int"].second ==
+          now + std::chrono::seconds(100));
+  REQUIRE(deviceA->close());
+  REQUIRE(SessionStore::close());
+}
+
+TEST_CASE("Test creating session groups while the session store flushes") {
+  std::remove(TestFileNameExt.c_str());
+
+  // Flush as often as possible, so that the flushes overlap with the creation
+  // of the groups.
+  REQUIRE(SessionStore::open(TestFileName, Duration(1)));
+
+  KeyMapping keyMapping;
+  keyMapping["int"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_INT;
+  const int participantCount = 4;
+  const int groupCount = 50;
+  std::atomic<bool> success(true);
+  std::vector<std::thread> participants;
+  for (int i = 0; i < participantCount; i++) {
+    participants.emplace_back([i, &keyMapping, &success]() {
+      DataManagerSession participant;
+      if (!participant.open("participant" + std::to_string(i), keyMapping)) {
+        success = false;
+        return;
+      }
+      for (int j = 0; j < groupCount; j++) {
+        // Every write marks the file as modified, so the flush thread keeps
+        // flushing.
+        if (!participant.write(TimePoint(std::chrono::milliseconds(j)), "int",
+                               Value(j)) ||
+            !participant.createGroup("group" + std::to_string(j),
+                                     {{"index", j}})) {
+          success = false;
+        }
+      }
+    });
+  }
+  for (int j = 0; j < groupCount; j++) {
+    REQUIRE(SessionStore::getInstance()->flush());
+  }
+  for (auto &participant : participants) {
+    participant.join();
+  }
+  REQUIRE(success);
+  REQUIRE(SessionStore::close());
+
+  // Every group has to be in the file.
+  HighFive::File file(TestFileNameExt, HighFive::File::ReadOnly);
+  for (int i = 0; i < participantCount; i++) {
+    for (int j = 0; j < groupCount; j++) {
+      REQUIRE(file.exist("/data/participant" + std::to_string(i) + "/group" +
+                         std::to_string(j)));
+    }
+  }
+}
+
+TEST_CASE("Test streaming CSV export") {
+  std::remove(TestFileNameExt.c_str());
+  const std::string exportDirectory = TestFileName + "_csv";
+  std::filesystem::remove_all(exportDirectory);
+  std::filesystem::create_directories(exportDirectory);
+
+  std::shared_ptr<DataManagerHdf> dut(new DataManagerHdf());
+  KeyMapping keyMapping;
+  keyMapping["spectrumMeasurement"] =
+      DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  REQUIRE(dut->open(TestFileName, keyMapping));
+
+  std::vector<double> testFrequencies{10.0, 1000000.0};
+  std::vector<Impedance> testImpedances{{1.5, -2.0}, {3.0, 4.25}};
+  ImpedanceSpectrum testSpectrum;
+  Utilities::joinImpedanceSpectrum(testFrequencies, testImpedances,
+                                   testSpectrum);
+  REQUIRE(dut->setupSpectrum("spectrumMeasurement", testFrequencies));
+  REQUIRE(dut->createGroup(
+      "spectrumMeasurement",
+      {{DataManager::DATA_MANAGER_DEVICETYPE_ATTR_NAME,
+        static_cast<int>(Devices::DeviceType::IMPEDANCE_SPECTROMETER)}}));
+
+  // Write more rows than fit into a single block.
+  std::vector<TimePoint> timePointVector;
+  std::vector<Value> valueVector;
+  for (int i = 0; i < 2500; i++) {
+    timePointVector.emplace_back(std::chrono::milliseconds(1000 + i));
+    valueVector.emplace_back(Value(testSpectrum));
+  }
+  REQUIRE(dut->write(timePointVector, "spectrumMeasurement", valueVector));
+
+  ExportOptions options;
+  options.separator = ';';
+  options.jobCount = 3;
+  options.blockSize = 1000;
+  REQUIRE(dut->writeToCsv(exportDirectory, options));
+
+  // The rows have to be written completely and in order.
+  std::ifstream file(exportDirectory + "/spectrumMeasurement.csv");
+  REQUIRE(file.is_open());
+  std::string line;
+  REQUIRE(std::getline(file, line));
+  REQUIRE(line == "timestamps;10_real;10_imag;1000000_real;1000000_imag;");
+  for (int i = 0; i < 2500; i++) {
+    REQUIRE(std::getline(file, line));
+    REQUIRE(line == std::to_string(1000 + i) + ";1.5;-2;3;4.25;");
+  }
+  REQUIRE(!std::getline(file, line));
+}
+
+TEST_CASE("Test filtered CSV export") {
+  std::remove(TestFileNameExt.c_str());
+  const std::string exportDirectory = TestFileName + "_csv";
+  std::filesystem::remove_all(exportDirectory);
+  std::filesystem::create_directories(exportDirectory);
+
+  std::shared_ptr<DataManagerHdf> dut(new DataManagerHdf());
+  KeyMapping keyMapping;
+  keyMapping["spectrumMeasurement"] =
+      DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  keyMapping["otherMeasurement"] =
+      DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  REQUIRE(dut->open(TestFileName, keyMapping));
+
+  std::vector<double> testFrequencies{10.0};
+  std::vector<TimePoint> timePointVector;
+  std::vector<Value> valueVector;
+  for (int i = 0; i < 300; i++) {
+    std::vector<Impedance> testImpedances{Impedance(i, 1.0)};
+    ImpedanceSpectrum testSpectrum;
+    Utilities::joinImpedanceSpectrum(testFrequencies, testImpedances,
+                                     testSpectrum);
+    timePointVector.emplace_back(std::chrono::milliseconds(1000 + i));
+    valueVector.emplace_back(Value(testSpectrum));
+  }
+  for (auto &key : {"spectrumMeasurement", "otherMeasurement"}) {
+    REQUIRE(dut->setupSpectrum(key, testFrequencies));
+    REQUIRE(dut->createGroup(
+        key,
+        {{DataManager::DATA_MANAGER_DEVICETYPE_ATTR_NAME,
+          static_cast<int>(Devices::DeviceType::IMPEDANCE_SPECTROMETER)}}));
+    REQUIRE(dut->write(timePointVector, key, valueVector));
+  }
+
+  ExportOptions options;
+  options.keyFilter = Utilities::globToRegex("spectrum*");
+  options.from = TimePoint(std::chrono::milliseconds(1100));
+  options.to = TimePoint(std::chrono::milliseconds(1199));
+  // Not a multiple of the decimation factor.
+  options.blockSize = 25;
+  options.decimationFactor = 10;
+
+  auto checkExport = [&](const std::string &directory, double offset) {
+    std::filesystem::create_directories(directory);
+    REQUIRE(dut->writeToCsv(directory, options));
+    REQUIRE(!std::filesystem::exists(directory + "/otherMeasurement.csv"));
+
+    std::ifstream file(directory + "/spectrumMeasurement.csv");
+    REQUIRE(file.is_open());
+    std::string line;
+    REQUIRE(std::getline(file, line));
+    for (int i = 100; i < 200; i += 10) {
+      std::string value;
+      CsvWriter::appendNumber(value, i + offset);
+      REQUIRE(std::getline(file, line));
+      REQUIRE(line == std::to_string(1000 + i) + "," + value + ",1,");
+    }
+    REQUIRE(!std::getline(file, line));
+  };
+
+  options.decimation = EXPORT_DECIMATION_NTH;
+  checkExport(exportDirectory + "/nth", 0.0);
+
+  options.decimation = EXPORT_DECIMATION_MEAN;
+  checkExport(exportDirectory + "/mean", 4.5);
+
+  // No measurement is of the given device type.
+  options.deviceType = Devices::DeviceType::PUMP_CONTROLLER;
+  std::filesystem::create_directories(exportDirectory + "/none");
+  REQUIRE(dut->writeToCsv(exportDirectory + "/none", options));
+  REQUIRE(std::filesystem::is_empty(exportDirectory + "/none"));
+}
+
+TEST_CASE("Test incremental CSV export") {
+  std::remove(TestFileNameExt.c_str());
+  const std::string exportDirectory = TestFileName + "_csv";
+  const std::string checkpointFile = exportDirectory + "/export.checkpoint";
+  std::filesystem::remove_all(exportDirectory);
+  std::filesystem::create_directories(exportDirectory);
+
+  std::shared_ptr<DataManagerHdf> dut(new DataManagerHdf());
+  KeyMapping keyMapping;
+  keyMapping["spectrumMeasurement"] =
+      DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  REQUIRE(dut->open(TestFileName, keyMapping));
+
+  std::vector<double> testFrequencies{10.0};
+  REQUIRE(dut->setupSpectrum("spectrumMeasurement", testFrequencies));
+  REQUIRE(dut->createGroup(
+      "spectrumMeasurement",
+      {{DataManager::DATA_MANAGER_DEVICETYPE_ATTR_NAME,
+        static_cast<int>(Devices::DeviceType::IMPEDANCE_SPECTROMETER)}}));
+
+  auto writeRows = [&](int first, int last) {
+    std::vector<TimePoint> timePointVector;
+    std::vector<Value> valueVector;
+    for (int i = first; i < last; i++) {
+      std::vector<Impedance> testImpedances{Impedance(i, 1.0)};
+      ImpedanceSpectrum testSpectrum;
+      Utilities::joinImpedanceSpectrum(testFrequencies, testImpedances,
+                                       testSpectrum);
+      timePointVector.emplace_back(std::chrono::milliseconds(1000 + i));
+      valueVector.emplace_back(Value(testSpectrum));
+    }
+    REQUIRE(dut->write(timePointVector, "spectrumMeasurement", valueVector));
+  };
+
+  ExportOptions options;
+  options.blockSize = 16;
+  options.checkpointFile = checkpointFile;
+
+  writeRows(0, 100);
+  REQUIRE(dut->writeToCsv(exportDirectory, options));
+  // Nothing new has been recorded, so nothing is appended.
+  REQUIRE(dut->writeToCsv(exportDirectory, options));
+  writeRows(100, 150);
+  REQUIRE(dut->writeToCsv(exportDirectory, options));
+
+  std::ifstream file(exportDirectory + "/spectrumMeasurement.csv");
+  std::string line;
+  REQUIRE(std::getline(file, line));
+  REQUIRE(line == "timestamps,10_real,10_imag,");
+  for (int i = 0; i < 150; i++) {
+    REQUIRE(std::getline(file, line));
+    REQUIRE(line == std::to_string(1000 + i) + "," + std::to_string(i) + ",1,");
+  }
+  REQUIRE(!std::getline(file, line));
+
+  std::ifstream checkpoint(checkpointFile);
+  REQUIRE(std::getline(checkpoint, line));
+  REQUIRE(std::getline(checkpoint, line));
+  REQUIRE(line == "1149\tspectrumMeasurement.csv");
+}
+
+TEST_CASE("Test resuming a failed incremental CSV export") {
+  std::remove(TestFileNameExt.c_str());
+  const std::string exportDirectory = TestFileName + "_csv";
+  const std::string checkpointFile = exportDirectory + "/export.checkpoint";
+  std::filesystem::remove_all(exportDirectory);
+  std::filesystem::create_directories(exportDirectory);
+
+  std::shared_ptr<DataManagerHdf> dut(new DataManagerHdf());
+  KeyMapping keyMapping;
+  keyMapping["spectrumMeasurement"] =
+      DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  REQUIRE(dut->open(TestFileName, keyMapping));
+
+  std::vector<double> testFrequencies{10.0};
+  REQUIRE(dut->setupSpectrum("spectrumMeasurement", testFrequencies));
+  REQUIRE(dut->createGroup(
+      "spectrumMeasurement",
+      {{DataManager::DATA_MANAGER_DEVICETYPE_ATTR_NAME,
+        static_cast<int>(Devices::DeviceType::IMPEDANCE_SPECTROMETER)}}));
+
+  auto writeRows = [&](int first, int last) {
+    std::vector<TimePoint> timePointVector;
+    std::vector<Value> valueVector;
+    for (int i = first; i < last; i++) {
+      std::vector<Impedance> testImpedances{Impedance(i, 1.0)};
+      ImpedanceSpectrum testSpectrum;
+      Utilities::joinImpedanceSpectrum(testFrequencies, testImpedances,
+                                       testSpectrum);
+      timePointVector.emplace_back(std::chrono::milliseconds(1000 + i));
+      valueVector.emplace_back(Value(testSpectrum));
+    }
+    REQUIRE(dut->write(timePointVector, "spectrumMeasurement", valueVector));
+  };
+  auto checkRows = [&](int count) {
+    std::ifstream file(exportDirectory + "/spectrumMeasurement.csv");
+    std::string line;
+    REQUIRE(std::getline(file, line));
+    for (int i = 0; i < count; i++) {
+      REQUIRE(std::getline(file, line));
+      REQUIRE(line ==
+              std::to_string(1000 + i) + "," + std::to_string(i) + ",1,");
+    }
+    REQUIRE(!std::getline(file, line));
+  };
+
+  ExportOptions options;
+  options.blockSize = 16;
+  options.checkpointFile = checkpointFile;
+
+  writeRows(0, 100);
+  REQUIRE(dut->writeToCsv(exportDirectory, options));
+  checkRows(100);
+
+  // The new rows are appended, but the checkpoint can not be saved. The export
+  // fails and the appended rows are dropped again.
+  writeRows(100, 150);
+  std::filesystem::create_directories(checkpointFile + ".tmp");
+  REQUIRE(!dut->writeToCsv(exportDirectory, options));
+  checkRows(100);
+
+  // The next export continues behind the rows of the first one.
+  std::filesystem::remove_all(checkpointFile + ".tmp");
+  REQUIRE(dut->writeToCsv(exportDirectory, options));
+  checkRows(150);
+}
+
+TEST_CASE("Test NumPy export") {
+  std::remove(TestFileNameExt.c_str());
+  const std::string exportDirectory = TestFileName + "_numpy";
+  std::filesystem::remove_all(exportDirectory);
+
+  std::shared_ptr<DataManagerHdf> dut(new DataManagerHdf());
+  KeyMapping keyMapping;
+  keyMapping["spectrumMeasurement"] =
+      DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  REQUIRE(dut->open(TestFileName, keyMapping));
+
+  std::vector<double> testFrequencies{10.0, 1000000.0};
+  std::vector<TimePoint> timePointVector;
+  std::vector<Value> valueVector;
+  for (int i = 0; i < 3; i++) {
+    std::vector<Impedance> testImpedances{Impedance(i, -1.0),
+                                          Impedance(2.0, i)};
+    ImpedanceSpectrum testSpectrum;
+    Utilities::joinImpedanceSpectrum(testFrequencies, testImpedances,
+                                     testSpectrum);
+    timePointVector.emplace_back(std::chrono::milliseconds(1000 + i));
+    valueVector.emplace_back(Value(testSpectrum));
+  }
+  REQUIRE(dut->setupSpectrum("spectrumMeasurement", testFrequencies));
+  REQUIRE(dut->createGroup(
+      "spectrumMeasurement",
+      {{DataManager::DATA_MANAGER_DEVICETYPE_ATTR_NAME,
+        static_cast<int>(Devices::DeviceType::IMPEDANCE_SPECTROMETER)}}));
+  REQUIRE(dut->write(timePointVector, "spectrumMeasurement", valueVector));
+
+  ExportOptions options;
+  options.blockSize = 2;
+  REQUIRE(dut->writeToNumpy(exportDirectory, options, false));
+  REQUIRE(dut->writeToNumpy(exportDirectory, options, true));
+
+  auto readFile = [](const std::string &fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+  };
+  auto checkArray = [&](const std::string &name, const std::string &descr,
+                        const std::vector<size_t> &shape, const auto &values) {
+    std::string content =
+        readFile(exportDirectory + "/spectrumMeasurement/" + name + ".npy");
+    std::string header = NumpyWriter::getHeader(descr, shape);
+    REQUIRE(content.substr(0, header.size()) == header);
+    REQUIRE(content.size() ==
+            header.size() + values.size() * sizeof(values[0]));
+    REQUIRE(std::memcmp(content.data() + header.size(), values.data(),
+                        values.size() * sizeof(values[0])) == 0);
+  };
+  checkArray("frequencies", NumpyWriter::DESCR_FLOAT64, {2}, testFrequencies);
+  checkArray("timestamps", NumpyWriter::DESCR_INT64, {3},
+             std::vector<long long>{1000, 1001, 1002});
+  checkArray("values", NumpyWriter::DESCR_COMPLEX128, {3, 2},
+             std::vector<Impedance>{{0.0, -1.0},
+                                    {2.0, 0.0},
+                                    {1.0, -1.0},
+                                    {2.0, 1.0},
+                                    {2.0, -1.0},
+                                    {2.0, 2.0}});
+
+  // The archive is a zip file, that stores the same arrays.
+  std::string archive = readFile(exportDirectory + "/spectrumMeasurement.npz");
+  REQUIRE(archive.substr(0, 4) == std::string("PK\x03\x04"));
+  REQUIRE(archive.find("values.npy") != std::string::npos);
+}
+
 void writeWorker(bool *doWork, std::shared_ptr<DataManagerHdf> dataManager) {
   std::vector<double> testFrequencies{1.0,     10.0,     100.0,    1000.0,
                                       10000.0, 100000.0, 1000000.0};
@@ -482,6 +1157,216 @@ void readWorker(bool *doWork, std::shared_ptr<DataManagerHdf> dataManager) {
 }
 
 #define THREAD_COUNT 10
+TEST_CASE("Test raw range reads") {
+  std::remove(TestFileNameExt.c_str());
+
+  KeyMapping keyMapping;
+  keyMapping["int"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_INT;
+  keyMapping["complex"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_COMPLEX;
+  keyMapping["spectrum"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  keyMapping["string"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_STRING;
+  keyMapping["empty"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  std::vector<double> testFrequencies{10.0, 100.0, 1000.0};
+  {
+    DataManagerHdf dut;
+    REQUIRE(dut.open(TestFileName, keyMapping));
+    REQUIRE(dut.setupSpectrum("spectrum", testFrequencies));
+
+    std::vector<TimePoint> timestamps;
+    std::vector<Value> ints;
+    std::vector<Value> impedances;
+    std::vector<Value> spectra;
+    for (int i = 0; i < 100; i++) {
+      timestamps.emplace_back(std::chrono::milliseconds(1000 + 10 * i));
+      ints.emplace_back(i);
+      impedances.emplace_back(Impedance(i, -i));
+      ImpedanceSpectrum spectrum;
+      for (size_t j = 0; j < testFrequencies.size(); j++) {
+        spectrum.emplace_back(testFrequencies[j], Impedance(i, j));
+      }
+      spectra.emplace_back(spectrum);
+    }
+    REQUIRE(dut.write(timestamps, "int", ints));
+    REQUIRE(dut.write(timestamps, "complex", impedances));
+    REQUIRE(dut.write(timestamps, "spectrum", spectra));
+    REQUIRE(dut.write(timestamps[0], "string", Value(std::string("a"))));
+  }
+
+  DataManagerHdf dut;
+  dut.setReadOnly(true);
+  REQUIRE(dut.open(TestFileNameExt));
+  // Spectra are available after opening an existing file.
+  REQUIRE(dut.getSpectrumMapping()["spectrum"] == testFrequencies);
+
+  size_t firstRow = 0;
+  size_t rowCount = 0;
+  REQUIRE(dut.findRows("int", TimePoint(std::chrono::milliseconds(1015)),
+                       TimePoint(std::chrono::milliseconds(1050)), firstRow,
+                       rowCount));
+  REQUIRE(firstRow == 2);
+  REQUIRE(rowCount == 4);
+  REQUIRE(dut.findRows("int", TimePoint::min(), TimePoint::max(), firstRow,
+                       rowCount));
+  REQUIRE(firstRow == 0);
+  REQUIRE(rowCount == 100);
+  REQUIRE(dut.findRows("int", TimePoint(std::chrono::milliseconds(5000)),
+                       TimePoint::max(), firstRow, rowCount));
+  REQUIRE(rowCount == 0);
+  REQUIRE_FALSE(
+      dut.findRows("missing", TimePoint::min(), TimePoint::max(), firstRow,
+                   rowCount));
+  // Spectra, that have not been set up, have no datasets.
+  REQUIRE_FALSE(dut.findRows("empty", TimePoint::min(), TimePoint::max(),
+                             firstRow, rowCount));
+
+  std::vector<size_t> shape;
+  REQUIRE(dut.getRowShape("int", shape));
+  REQUIRE(shape.empty());
+  REQUIRE(dut.getRowShape("complex", shape));
+  REQUIRE(shape == std::vector<size_t>{2});
+  REQUIRE(dut.getRowShape("spectrum", shape));
+  REQUIRE(shape == std::vector<size_t>{3, 2});
+
+  std::vector<long long> timestamps(4);
+  REQUIRE(dut.readTimestamps("int", 2, 4, timestamps.data()));
+  REQUIRE(timestamps == std::vector<long long>{1020, 1030, 1040, 1050});
+  REQUIRE_FALSE(dut.readTimestamps("int", 98, 4, timestamps.data()));
+
+  std::vector<int> ints(4);
+  REQUIRE(dut.readValues("int", 2, 4, ints.data()));
+  REQUIRE(ints == std::vector<int>{2, 3, 4, 5});
+  // Values are converted into the requested type.
+  std::vector<double> doubles(4);
+  REQUIRE(dut.readValues("int", 2, 4, doubles.data()));
+  REQUIRE(doubles == std::vector<double>{2.0, 3.0, 4.0, 5.0});
+
+  std::vector<double> impedances(2 * 2);
+  REQUIRE(dut.readValues("complex", 10, 2, impedances.data()));
+  REQUIRE(impedances == std::vector<double>{10.0, -10.0, 11.0, -11.0});
+
+  std::vector<double> spectra(2 * 3 * 2);
+  REQUIRE(dut.readValues("spectrum", 50, 2, spectra.data()));
+  REQUIRE(spectra == std::vector<double>{50.0, 0.0, 50.0, 1.0, 50.0, 2.0,
+                                         51.0, 0.0, 51.0, 1.0, 51.0, 2.0});
+
+  // Strings are not stored contiguously.
+  REQUIRE_FALSE(dut.readValues("string", 0, 1, ints.data()));
+}
+
+TEST_CASE("Test spectrum similarity index") {
+  std::remove(TestFileNameExt.c_str());
+  std::string indexFileName = SpectrumIndex::getIndexFileName(TestFileNameExt);
+  std::remove(indexFileName.c_str());
+
+  KeyMapping keyMapping;
+  keyMapping["spectrum"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_SPECTRUM;
+  keyMapping["int"] = DataManagerDataType::DATAMANAGER_DATA_TYPE_INT;
+  std::vector<double> testFrequencies;
+  for (int j = 0; j < 16; j++) {
+    testFrequencies.push_back(100.0 * std::pow(2.0, j / 2.0));
+  }
+  // Every 100 spectra, the recording switches between a resistor and an RC
+  // element, whose spectra have a different shape.
+  auto isResistive = [](int i) { return (i / 100) % 2 == 0; };
+  auto makeSpectrum = [&](int i) {
+    double resistance = 1000.0 + i;
+    double capacitance = isResistive(i) ? 0.0 : 1e-6;
+    ImpedanceSpectrum spectrum;
+    for (double frequency : testFrequencies) {
+      Impedance admittance(1.0 / resistance,
+                           2 * 3.14159265358979 * frequency * capacitance);
+      spectrum.emplace_back(frequency, 1.0 / admittance);
+    }
+    return spectrum;
+  };
+  {
+    DataManagerHdf dut;
+    REQUIRE(dut.open(TestFileName, keyMapping));
+    REQUIRE(dut.setupSpectrum("spectrum", testFrequencies));
+
+    std::vector<TimePoint> timestamps;
+    std::vector<Value> spectra;
+    for (int i = 0; i < 1000; i++) {
+      timestamps.emplace_back(std::chrono::milliseconds(1000 * i));
+      spectra.emplace_back(makeSpectrum(i));
+    }
+    REQUIRE(dut.write(timestamps, "spectrum", spectra));
+    REQUIRE(dut.write(timestamps[0], "int", Value(1)));
+  }
+
+  DataManagerHdf dataManager;
+  dataManager.setReadOnly(true);
+  REQUIRE(dataManager.open(TestFileNameExt));
+  {
+    SpectrumIndex index;
+    REQUIRE(index.build(dataManager, "", 10, 2));
+    // Only spectrum keys are indexed.
+    REQUIRE(index.getKeys() == std::vector<std::string>{"spectrum"});
+    REQUIRE(index.getRowCount("spectrum") == 1000);
+    REQUIRE(index.save(indexFileName));
+    SpectrumIndex filtered;
+    REQUIRE(filtered.build(dataManager, "^other$"));
+    REQUIRE(filtered.getKeys().empty());
+  }
+
+  SpectrumIndex index;
+  REQUIRE(index.load(indexFileName));
+  REQUIRE(index.getKeys() == std::vector<std::string>{"spectrum"});
+  REQUIRE(index.getRowCount("spectrum") == 1000);
+  REQUIRE(index.getFrequencies("spectrum") == testFrequencies);
+
+  std::vector<double> spectrum;
+  for (auto &[frequency, impedance] : makeSpectrum(350)) {
+    spectrum.push_back(impedance.real());
+    spectrum.push_back(impedance.imag());
+  }
+  SpectrumQueryOptions options;
+  options.k = 20;
+  options.probes = 10;
+  std::vector<SpectrumMatch> matches;
+  REQUIRE(index.query("spectrum", spectrum.data(), options, matches));
+  REQUIRE(matches.size() == 20);
+  REQUIRE(matches.front().timestamp == 350000);
+  REQUIRE(matches.front().distance == Approx(0.0).margin(1e-6));
+  for (size_t i = 0; i < matches.size(); i++) {
+    REQUIRE_FALSE(isResistive(matches[i].timestamp / 1000));
+    if (i > 0) {
+      REQUIRE(matches[i - 1].distance <= matches[i].distance);
+    }
+  }
+
+  // Matches keep their distance in time.
+  options.k = 5;
+  options.minSeparation = 100000;
+  REQUIRE(index.query("spectrum", spectrum.data(), options, matches));
+  REQUIRE(matches.size() == 5);
+  for (size_t i = 0; i < matches.size(); i++) {
+    REQUIRE_FALSE(isResistive(matches[i].timestamp / 1000));
+    for (size_t j = 0; j < i; j++) {
+      REQUIRE(std::abs(matches[i].timestamp - matches[j].timestamp) >=
+              100000);
+    }
+  }
+
+  REQUIRE_FALSE(index.query("int", spectrum.data(), options, matches));
+  REQUIRE_FALSE(index.load(TestFileNameExt));
+  REQUIRE(index.getKeys().empty());
+
+  // A row count, whose features would not fit into any file, is rejected
+  // before it is multiplied.
+  {
+    std::fstream file(indexFileName,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    // Magic, version, key count, name length and "spectrum" take 28 bytes and
+    // are padded to 32. The frequency count follows, then the row count.
+    file.seekp(40);
+    uint64_t rowCount = std::numeric_limits<uint64_t>::max() / 2;
+    file.write(reinterpret_cast<const char *>(&rowCount), sizeof(rowCount));
+  }
+  REQUIRE_FALSE(index.load(indexFileName));
+  REQUIRE(index.getKeys().empty());
+}
+
 TEST_CASE("Test multi-threaded operation") {
 
   for (int i = 0; i < THREAD_COUNT; i++) {
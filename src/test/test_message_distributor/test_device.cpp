@@ -0,0 +1,84 @@
+// Standard includes
+#include <stdexcept>
+
+// Project includes
+#include <test_device.hpp>
+
+using namespace Devices;
+
+const std::string TestDevice::TEST_DEVICE_TYPE_NAME = "Test Device";
+
+TestDevice::TestDevice()
+    : Device(DeviceType::UNSPECIFIED, 1), throwing(false) {
+  this->deviceState = DeviceStatus::OPERATING;
+}
+
+TestDevice::~TestDevice() {}
+
+std::string TestDevice::getDeviceTypeName() {
+  return TestDevice::TEST_DEVICE_TYPE_NAME;
+}
+
+bool TestDevice::specificWrite(std::shared_ptr<WriteDeviceMessage> writeMsg) {
+  if (this->throwing) {
+    throw std::runtime_error("Test device has been set to throw.");
+  }
+
+  std::lock_guard<std::mutex> lock(this->receivedMutex);
+  this->receivedMessages.push_back(writeMsg);
+
+  return true;
+}
+
+std::list<std::shared_ptr<DeviceMessage>>
+TestDevice::specificRead(TimePoint timestamp) {
+  return std::list<std::shared_ptr<DeviceMessage>>();
+}
+
+bool TestDevice::handleResponse(std::shared_ptr<ReadDeviceMessage> response) {
+  std::lock_guard<std::mutex> lock(this->receivedMutex);
+  this->receivedResponses.push_back(response);
+
+  return true;
+}
+
+bool TestDevice::configure(
+    std::shared_ptr<ConfigurationPayload> deviceConfiguration) {
+  return true;
+}
+
+bool TestDevice::initialize(std::shared_ptr<InitPayload> initPayload) {
+  return true;
+}
+
+bool TestDevice::start() { return true; }
+
+bool TestDevice::stop() { return true; }
+
+std::string TestDevice::getDeviceSerialNumber() { return "Test Device"; }
+
+void TestDevice::send(std::shared_ptr<DeviceMessage> message) {
+  this->pushMessageQueue(message);
+}
+
+bool TestDevice::addProxy(UserId proxyId) { return this->addProxyId(proxyId); }
+
+bool TestDevice::removeProxy(UserId proxyId) {
+  return this->removeProxyId(proxyId);
+}
+
+void TestDevice::clearProxies() { this->clearProxyIds(); }
+
+void TestDevice::setThrowing(bool throwing) { this->throwing = throwing; }
+
+std::vector<std::shared_ptr<WriteDeviceMessage>>
+TestDevice::getReceivedMessages() {
+  std::lock_guard<std::mutex> lock(this->receivedMutex);
+  return this->receivedMessages;
+}
+
+std::vector<std::shared_ptr<ReadDeviceMessage>>
+TestDevice::getReceivedResponses() {
+  std::lock_guard<std::mutex> lock(this->receivedMutex);
+  return this->receivedResponses;
+}
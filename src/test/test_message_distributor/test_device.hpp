@@ -0,0 +1,161 @@
+#ifndef TEST_DEVICE_HPP
+#define TEST_DEVICE_HPP
+
+// Standard includes
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Project includes
+#include <device.hpp>
+
+using namespace Utilities;
+
+namespace Devices {
+
+/**
+ * @brief Depicts a dummy device, that records the messages it takes. Can be
+ * used to test the delivery of messages by the message distributor.
+ */
+class TestDevice : public Device {
+public:
+  /**
+   * @brief Constructs the test device.
+   */
+  TestDevice();
+
+  /**
+   * @brief Destroys the test device.
+   */
+  virtual ~TestDevice() override;
+
+  /**
+   * @brief Return the name of the device type.
+   * @return The device type name.
+   */
+  virtual std::string getDeviceTypeName() override;
+
+  /**
+   * @brief Records the given message. Throws, if the device has been set to
+   * throw.
+   * @param writeMsg The specific message.
+   * @return Always TRUE.
+   */
+  virtual bool
+  specificWrite(std::shared_ptr<WriteDeviceMessage> writeMsg) override;
+
+  /**
+   * @brief Does nothing, as the test device sends its messages with send().
+   * @param timestamp The timestamp with which this operation is called.
+   * @return An empty list.
+   */
+  virtual std::list<std::shared_ptr<DeviceMessage>>
+  specificRead(TimePoint timestamp) override;
+
+  /**
+   * @brief Records the given response.
+   * @param response The response to a write message that has been sent earlier.
+   * @return Always TRUE.
+   */
+  virtual bool
+  handleResponse(std::shared_ptr<ReadDeviceMessage> response) override;
+
+  /**
+   * @brief Accepts any configuration.
+   * @param deviceConfiguration The configuration.
+   * @return Always TRUE.
+   */
+  virtual bool
+  configure(std::shared_ptr<ConfigurationPayload> deviceConfiguration) override;
+
+  /**
+   * @brief Accepts any initialization.
+   * @param initPayload The initialization.
+   * @return Always TRUE.
+   */
+  virtual bool initialize(std::shared_ptr<InitPayload> initPayload) override;
+
+  /**
+   * @brief Does nothing.
+   * @return Always TRUE.
+   */
+  virtual bool start() override;
+
+  /**
+   * @brief Does nothing.
+   * @return Always TRUE.
+   */
+  virtual bool stop() override;
+
+  /**
+   * @brief Returns the serial number of the device.
+   * @return The serial number of the device.
+   */
+  virtual std::string getDeviceSerialNumber() override;
+
+  /**
+   * @brief Queues the given message, so that it is sent by the message
+   * distributor. May be called from any thread.
+   * @param message The message.
+   */
+  void send(std::shared_ptr<DeviceMessage> message);
+
+  /**
+   * @brief Makes the test device the proxy of the given id.
+   * @param proxyId The proxy id.
+   * @return True if the id has been added. False otherwise.
+   */
+  bool addProxy(UserId proxyId);
+
+  /**
+   * @brief Removes the given proxy id.
+   * @param proxyId The proxy id.
+   * @return True if the id has been removed. False otherwise.
+   */
+  bool removeProxy(UserId proxyId);
+
+  /**
+   * @brief Removes all proxy ids.
+   */
+  void clearProxies();
+
+  /**
+   * @brief Sets whether the device throws on taking specific messages. May be
+   * called from any thread.
+   * @param throwing True if the device shall throw. False otherwise.
+   */
+  void setThrowing(bool throwing);
+
+  /**
+   * @brief Returns the specific messages, that have been taken, in the order
+   * they have been taken. May be called from any thread.
+   * @return The taken messages.
+   */
+  std::vector<std::shared_ptr<WriteDeviceMessage>> getReceivedMessages();
+
+  /**
+   * @brief Returns the responses, that have been taken. May be called from
+   * any thread.
+   * @return The taken responses.
+   */
+  std::vector<std::shared_ptr<ReadDeviceMessage>> getReceivedResponses();
+
+private:
+  /// String that identifies this type of device.
+  static const std::string TEST_DEVICE_TYPE_NAME;
+
+  /// The specific messages, that have been taken.
+  std::vector<std::shared_ptr<WriteDeviceMessage>> receivedMessages;
+
+  /// The responses, that have been taken.
+  std::vector<std::shared_ptr<ReadDeviceMessage>> receivedResponses;
+
+  /// Guards the taken messages, as they are read by the test thread.
+  std::mutex receivedMutex;
+
+  /// Set if the device throws on taking specific messages.
+  std::atomic<bool> throwing;
+};
+} // namespace Devices
+
+#endif
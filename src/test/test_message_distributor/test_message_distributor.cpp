@@ -1,20 +1,299 @@
+// Standard includes
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
 // 3rd party includes
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
 #include <easylogging++.h>
 
 // Project includes
-#include <device_isx3.hpp>
-#include <device_ob1.hpp>
+#include <clock.hpp>
 #include <message_distributor.hpp>
+#include <test_device.hpp>
+#include <write_device_message.hpp>
 
 INITIALIZE_EASYLOGGINGPP
 
 using namespace Messages;
+using namespace Devices;
+
+/**
+ * @brief Runs the given message distributor on a thread, until it is
+ * destroyed.
+ */
+struct DistributorRunner {
+  DistributorRunner(MessageDistributor &distributor)
+      : distributor(distributor), finished(false),
+        thread([this]() {
+          this->distributor.run();
+          this->finished = true;
+        }) {}
+
+  ~DistributorRunner() {
+    // Stop again until run() returns, as run() sets the flag to run, once it
+    // has been started.
+    while (!this->finished) {
+      this->distributor.stop();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    this->thread.join();
+  }
+
+  MessageDistributor &distributor;
+  std::atomic<bool> finished;
+  std::thread thread;
+};
+
+/**
+ * @brief Waits until the given condition holds.
+ * @param condition The condition.
+ * @return TRUE if the condition holds. FALSE if it did not hold within a few
+ * seconds.
+ */
+bool waitFor(std::function<bool()> condition) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return true;
+}
+
+TEST_CASE("Testing the routing of the message distributor",
+          "[Messages::MessageDistributor]") {
+  // Route the same way, whether the participants are run on the thread of
+  // run() or as actors.
+  for (unsigned int workerCount : {0u, 2u}) {
+    INFO("Worker count: " << workerCount);
+
+    MessageDistributor distributor(10, MESSAGE_DISTRIBUTOR_MODE_POLLING,
+                                   workerCount);
+    auto sender = std::make_shared<TestDevice>();
+    auto proxy = std::make_shared<TestDevice>();
+    auto other = std::make_shared<TestDevice>();
+    UserId earlyProxyId(1000001);
+    UserId proxyId(1000002);
+    UserId unknownId(1000003);
+
+    // Proxy ids, that have been added before the participant, are routed,
+    // too.
+    REQUIRE(proxy->addProxy(earlyProxyId));
+    REQUIRE(distributor.addParticipant(sender));
+    REQUIRE(distributor.addParticipant(proxy));
+    REQUIRE(distributor.addParticipant(other));
+    REQUIRE_FALSE(distributor.addParticipant(proxy));
+    REQUIRE(proxy->addProxy(proxyId));
+    REQUIRE_FALSE(proxy->addProxy(proxyId));
+
+    DistributorRunner runner(distributor);
+    auto sendTo = [&sender](UserId destination, WriteDeviceTopic topic) {
+      sender->send(std::make_shared<WriteDeviceMessage>(sender->getUserId(),
+                                                        destination, topic));
+    };
+
+    // Messages to the proxy ids reach the proxy.
+    sendTo(proxyId, WRITE_TOPIC_DEVICE_SPECIFIC);
+    sendTo(earlyProxyId, WRITE_TOPIC_DEVICE_SPECIFIC);
+    REQUIRE(waitFor(
+        [&proxy]() { return proxy->getReceivedMessages().size() == 2; }));
+    auto received = proxy->getReceivedMessages();
+    REQUIRE(received[0]->getDestination() == proxyId);
+    REQUIRE(received[1]->getDestination() == earlyProxyId);
+
+    // Another participant can not take over the route of a proxy id. Neither
+    // can it remove the route, as the route does not lead to it.
+    REQUIRE(other->addProxy(proxyId));
+    sendTo(proxyId, WRITE_TOPIC_DEVICE_SPECIFIC);
+    REQUIRE(waitFor(
+        [&proxy]() { return proxy->getReceivedMessages().size() == 3; }));
+    REQUIRE(other->removeProxy(proxyId));
+    sendTo(proxyId, WRITE_TOPIC_DEVICE_SPECIFIC);
+    REQUIRE(waitFor(
+        [&proxy]() { return proxy->getReceivedMessages().size() == 4; }));
+    REQUIRE(other->getReceivedMessages().empty());
+    REQUIRE(distributor.getMisroutedMessageCount() == 0);
+
+    // Removed proxy ids are not routed anymore. The sender gets a failed
+    // response for each misrouted message.
+    REQUIRE(proxy->removeProxy(proxyId));
+    REQUIRE_FALSE(proxy->removeProxy(proxyId));
+    sendTo(proxyId, WRITE_TOPIC_DEVICE_SPECIFIC);
+    REQUIRE(waitFor([&distributor]() {
+      return distributor.getMisroutedMessageCount() == 1;
+    }));
+    proxy->clearProxies();
+    sendTo(earlyProxyId, WRITE_TOPIC_DEVICE_SPECIFIC);
+    REQUIRE(waitFor([&distributor]() {
+      return distributor.getMisroutedMessageCount() == 2;
+    }));
+    REQUIRE(proxy->getProxyUserIds().empty());
+
+    // Messages to unknown ids are misrouted, too.
+    sendTo(unknownId, WRITE_TOPIC_DEVICE_SPECIFIC);
+    REQUIRE(waitFor([&distributor]() {
+      return distributor.getMisroutedMessageCount() == 3;
+    }));
+    REQUIRE(waitFor(
+        [&sender]() { return sender->getReceivedResponses().size() == 3; }));
+    for (auto &response : sender->getReceivedResponses()) {
+      REQUIRE(response->getTopic() == READ_TOPIC_FAILED_RESPONSE);
+    }
+    REQUIRE(proxy->getReceivedMessages().size() == 4);
+
+    // The own id is still routed. A message, that the participant can not
+    // process, is counted as failed delivery.
+    REQUIRE(distributor.getFailedDeliveryCount() == 0);
+    sendTo(proxy->getUserId(), WRITE_TOPIC_INVALID);
+    REQUIRE(waitFor([&distributor]() {
+      return distributor.getFailedDeliveryCount() == 1;
+    }));
+    sendTo(proxy->getUserId(), WRITE_TOPIC_DEVICE_SPECIFIC);
+    REQUIRE(waitFor(
+        [&proxy]() { return proxy->getReceivedMessages().size() == 5; }));
+    REQUIRE(distributor.getMisroutedMessageCount() == 3);
+  }
+}
+
+TEST_CASE("Testing the event-driven mode of the message distributor",
+          "[Messages::MessageDistributor]") {
+  // The time only moves, when the test advances it. So any cycle, that runs,
+  // has been triggered by a wakeup and not by the loop interval.
+  const Core::TimePoint start =
+      std::chrono::sys_days(std::chrono::year(2024) / 1 / 1);
+  auto clock = std::make_shared<Core::SimulatedClock>(start);
+  Core::setClock(clock);
+
+  {
+    MessageDistributor distributor(std::chrono::hours(1),
+                                   MESSAGE_DISTRIBUTOR_MODE_EVENT_DRIVEN);
+    auto sender = std::make_shared<TestDevice>();
+    auto receiver = std::make_shared<TestDevice>();
+    REQUIRE(distributor.addParticipant(sender));
+    REQUIRE(distributor.addParticipant(receiver));
+
+    DistributorRunner runner(distributor);
+
+    // A message, that is queued while the distributor waits, triggers a
+    // cycle right away.
+    REQUIRE(waitFor([&clock]() { return clock->getWaitingCount() == 1; }));
+    sender->send(std::make_shared<WriteDeviceMessage>(
+        sender->getUserId(), receiver->getUserId(),
+        WRITE_TOPIC_DEVICE_SPECIFIC));
+    REQUIRE(waitFor(
+        [&receiver]() { return receiver->getReceivedMessages().size() == 1; }));
+    REQUIRE(clock->now() == start);
+
+    // Stopping wakes up the distributor, too.
+    REQUIRE(waitFor([&clock]() { return clock->getWaitingCount() == 1; }));
+    distributor.stop();
+    REQUIRE(waitFor([&runner]() { return runner.finished.load(); }));
+    REQUIRE(clock->getWaitingCount() == 0);
+    REQUIRE(clock->now() == start);
+  }
+
+  // Restore the system clock.
+  Core::setClock(nullptr);
+}
+
+TEST_CASE("Testing the actors of the message distributor",
+          "[Messages::MessageDistributor]") {
+  MessageDistributor distributor(1, MESSAGE_DISTRIBUTOR_MODE_EVENT_DRIVEN, 4);
+  std::vector<std::shared_ptr<TestDevice>> senders;
+  std::vector<std::shared_ptr<TestDevice>> receivers;
+  for (int i = 0; i < 3; i++) {
+    senders.push_back(std::make_shared<TestDevice>());
+    REQUIRE(distributor.addParticipant(senders.back()));
+    receivers.push_back(std::make_shared<TestDevice>());
+    REQUIRE(distributor.addParticipant(receivers.back()));
+  }
+
+  DistributorRunner runner(distributor);
+
+  SECTION("Messages are taken in the order they have been sent") {
+    // Each sender queues its messages to all receivers from its own thread,
+    // while the senders and receivers run concurrently on the workers.
+    const int messageCount = 300;
+    std::map<std::pair<size_t, size_t>,
+             std::vector<std::shared_ptr<WriteDeviceMessage>>>
+        sentMessages;
+    for (auto &sender : senders) {
+      for (auto &receiver : receivers) {
+        auto &messages = sentMessages[{sender->getUserId().id(),
+                                       receiver->getUserId().id()}];
+        for (int i = 0; i < messageCount; i++) {
+          messages.push_back(std::make_shared<WriteDeviceMessage>(
+              sender->getUserId(), receiver->getUserId(),
+              WRITE_TOPIC_DEVICE_SPECIFIC));
+        }
+      }
+    }
+    std::vector<std::thread> sendingThreads;
+    for (auto &sender : senders) {
+      sendingThreads.emplace_back([&sender, &receivers, &sentMessages]() {
+        for (int i = 0; i < messageCount; i++) {
+          for (auto &receiver : receivers) {
+            sender->send(sentMessages[{sender->getUserId().id(),
+                                       receiver->getUserId().id()}][i]);
+          }
+        }
+      });
+    }
+    for (auto &thread : sendingThreads) {
+      thread.join();
+    }
+
+    // Per sender, each receiver takes the messages in the order they have
+    // been sent.
+    for (auto &receiver : receivers) {
+      REQUIRE(waitFor([&receiver, &senders]() {
+        return receiver->getReceivedMessages().size() ==
+               senders.size() * messageCount;
+      }));
+      std::map<size_t, std::vector<std::shared_ptr<WriteDeviceMessage>>>
+          receivedMessages;
+      for (auto &message : receiver->getReceivedMessages()) {
+        receivedMessages[message->getSource().id()].push_back(message);
+      }
+      for (auto &sender : senders) {
+        REQUIRE(receivedMessages[sender->getUserId().id()] ==
+                sentMessages[{sender->getUserId().id(),
+                              receiver->getUserId().id()}]);
+      }
+    }
+    REQUIRE(distributor.getFailedDeliveryCount() == 0);
+    REQUIRE(distributor.getMisroutedMessageCount() == 0);
+  }
+
+  SECTION("A participant, that throws, keeps taking messages") {
+    auto &sender = senders[0];
+    auto &receiver = receivers[0];
+    auto sendToReceiver = [&sender, &receiver]() {
+      sender->send(std::make_shared<WriteDeviceMessage>(
+          sender->getUserId(), receiver->getUserId(),
+          WRITE_TOPIC_DEVICE_SPECIFIC));
+    };
 
-TEST_CASE("") {
-  MessageDistributor dut;
+    receiver->setThrowing(true);
+    sendToReceiver();
+    REQUIRE(waitFor([&distributor]() {
+      return distributor.getFailedDeliveryCount() == 1;
+    }));
 
-  dut.addParticipant std::shared_ptr<MessageInterface>(new Devices::));
-  dut.addParticipant();
+    // The actor of the receiver is not stuck.
+    receiver->setThrowing(false);
+    sendToReceiver();
+    sendToReceiver();
+    REQUIRE(waitFor(
+        [&receiver]() { return receiver->getReceivedMessages().size() == 2; }));
+    REQUIRE(distributor.getFailedDeliveryCount() == 1);
+  }
 }
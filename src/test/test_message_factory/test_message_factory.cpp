@@ -1,5 +1,8 @@
 // Standard includes
+#include <algorithm>
 #include <format>
+#include <span>
+#include <vector>
 
 // 3rd party includes
 #define CATCH_CONFIG_MAIN
@@ -7,9 +10,17 @@
 #include <easylogging++.h>
 
 // Project includes
+#include <common.hpp>
+#include <data_response_payload.hpp>
 #include <dummy_device.hpp>
+#include <dummy_message.hpp>
+#include <frame_decoder.hpp>
 #include <handshake_message.hpp>
 #include <message_factory.hpp>
+#include <message_lanes.hpp>
+#include <message_visitor.hpp>
+#include <payload_registry.hpp>
+#include <read_device_message.hpp>
 
 INITIALIZE_EASYLOGGINGPP
 
@@ -59,3 +70,486 @@ TEST_CASE("Test the encoding and decoding of messages") {
     }
   }
 }
+
+/**
+ * @brief Builds a frame with the given message type and content.
+ */
+std::vector<unsigned char>
+buildFrame(MessageType messageType, const std::vector<unsigned char> &content) {
+  std::vector<unsigned char> frame;
+  frame.push_back(messageType);
+  for (int i = 0; i < 4; i++) {
+    frame.push_back((content.size() >> (8 * i)) & 0xFF);
+  }
+  frame.insert(frame.end(), content.begin(), content.end());
+  frame.push_back(messageType);
+  return frame;
+}
+
+TEST_CASE("Test the frame decoder") {
+  std::vector<unsigned char> frame1 =
+      buildFrame(WRITE_DEVICE_MESSAGE, {0x10, 0x11, 0x12});
+  std::vector<unsigned char> frame2 =
+      buildFrame(READ_DEVICE_MESSAGE, std::vector<unsigned char>(1000, 0x02));
+  std::vector<unsigned char> frame3 = buildFrame(HANDSHAKE_MESSAGE, {});
+
+  SECTION("Multiple frames per call") {
+    FrameDecoder dut;
+    std::vector<unsigned char> bytes;
+    bytes.insert(bytes.end(), frame1.begin(), frame1.end());
+    bytes.insert(bytes.end(), frame2.begin(), frame2.end());
+    bytes.insert(bytes.end(), frame3.begin(), frame3.end());
+    dut.append(bytes);
+
+    std::vector<std::span<const unsigned char>> frames;
+    REQUIRE(dut.extractFrames(frames) == 3);
+    REQUIRE(std::equal(frames[0].begin(), frames[0].end(), frame1.begin(),
+                       frame1.end()));
+    REQUIRE(std::equal(frames[1].begin(), frames[1].end(), frame2.begin(),
+                       frame2.end()));
+    REQUIRE(std::equal(frames[2].begin(), frames[2].end(), frame3.begin(),
+                       frame3.end()));
+    REQUIRE(dut.getBufferedByteCount() == 0);
+    REQUIRE(dut.extractFrames(frames) == 0);
+  }
+
+  SECTION("Frames split across reads") {
+    // A small capacity forces the buffer to compact and to grow.
+    FrameDecoder dut(16);
+    std::vector<unsigned char> bytes;
+    for (int i = 0; i < 10; i++) {
+      bytes.insert(bytes.end(), frame1.begin(), frame1.end());
+      bytes.insert(bytes.end(), frame2.begin(), frame2.end());
+    }
+
+    std::vector<std::vector<unsigned char>> received;
+    std::vector<std::span<const unsigned char>> frames;
+    for (size_t offset = 0; offset < bytes.size(); offset += 7) {
+      size_t count = std::min<size_t>(7, bytes.size() - offset);
+      std::span<unsigned char> target = dut.prepare(count);
+      std::copy_n(bytes.begin() + offset, count, target.begin());
+      dut.commit(count);
+      dut.extractFrames(frames);
+      for (auto &frame : frames) {
+        received.emplace_back(frame.begin(), frame.end());
+      }
+    }
+    REQUIRE(received.size() == 20);
+    for (size_t i = 0; i < received.size(); i++) {
+      REQUIRE(received[i] == (i % 2 == 0 ? frame1 : frame2));
+    }
+    REQUIRE(dut.getDiscardedByteCount() == 0);
+  }
+
+  SECTION("Garbage between frames") {
+    FrameDecoder dut;
+    // 0x07 is no message type tag. The 0x01 starts no valid frame, as its
+    // closing tag is missing.
+    std::vector<unsigned char> bytes{0x07, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00,
+                                     0x07};
+    bytes.insert(bytes.end(), frame1.begin(), frame1.end());
+    bytes.push_back(0x07);
+    bytes.insert(bytes.end(), frame3.begin(), frame3.end());
+    dut.append(bytes);
+
+    std::vector<std::span<const unsigned char>> frames;
+    REQUIRE(dut.extractFrames(frames) == 2);
+    REQUIRE(std::equal(frames[0].begin(), frames[0].end(), frame1.begin(),
+                       frame1.end()));
+    REQUIRE(std::equal(frames[1].begin(), frames[1].end(), frame3.begin(),
+                       frame3.end()));
+    REQUIRE(dut.getDiscardedByteCount() == 9);
+  }
+
+  SECTION("Corrupted length") {
+    FrameDecoder dut;
+    // A length beyond the maximum must not stall the stream.
+    std::vector<unsigned char> bytes{0x02, 0xFF, 0xFF, 0xFF, 0xFF};
+    bytes.insert(bytes.end(), frame1.begin(), frame1.end());
+    dut.append(bytes);
+
+    std::span<const unsigned char> frame;
+    REQUIRE(dut.extractFrame(frame));
+    REQUIRE(std::equal(frame.begin(), frame.end(), frame1.begin(),
+                       frame1.end()));
+  }
+
+  SECTION("Clearing") {
+    FrameDecoder dut;
+    dut.append(std::span<const unsigned char>(frame2.data(), 100));
+    std::span<const unsigned char> frame;
+    REQUIRE_FALSE(dut.extractFrame(frame));
+    REQUIRE(dut.getBufferedByteCount() == 100);
+    dut.clear();
+    REQUIRE(dut.getBufferedByteCount() == 0);
+    dut.append(frame1);
+    REQUIRE(dut.extractFrame(frame));
+    REQUIRE(std::equal(frame.begin(), frame.end(), frame1.begin(),
+                       frame1.end()));
+  }
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+  // A backlog of many frames, that is received in chunks of 4 KiB.
+  std::vector<unsigned char> stream;
+  for (int i = 0; i < 1000; i++) {
+    stream.insert(stream.end(), frame2.begin(), frame2.end());
+  }
+  BENCHMARK("Extract 1000 frames from 4 KiB reads") {
+    FrameDecoder dut;
+    std::vector<std::span<const unsigned char>> frames;
+    size_t frameCount = 0;
+    for (size_t offset = 0; offset < stream.size(); offset += 4096) {
+      dut.append(std::span<const unsigned char>(
+          stream.data() + offset,
+          std::min<size_t>(4096, stream.size() - offset)));
+      frameCount += dut.extractFrames(frames);
+    }
+    return frameCount;
+  };
+#endif
+}
+
+/**
+ * @brief Creates a read message with a data response of the given count of
+ * values.
+ */
+std::shared_ptr<DeviceMessage> buildDataResponseMessage(size_t count) {
+  std::vector<TimePoint> timestamps;
+  std::vector<Value> values;
+  for (size_t i = 0; i < count; i++) {
+    timestamps.push_back(TimePoint(Duration(1000 * i)));
+    values.push_back(Value(0.5 * i));
+  }
+  std::vector<DataResponsePayload *> payloads =
+      DataResponsePayload::constructDataResponsePayload(
+          timestamps.front(), timestamps.back(), "Key", timestamps, values);
+  return std::shared_ptr<DeviceMessage>(
+      new ReadDeviceMessage(UserId(1), UserId(2), READ_TOPIC_DATA_RESPONSE,
+                            payloads.front(), nullptr));
+}
+
+/**
+ * @brief Encodes a read message with a data response of the given count of
+ * values.
+ */
+std::vector<unsigned char> buildDataResponse(MessageFactory *factory,
+                                             size_t count) {
+  return factory->encodeMessage(buildDataResponseMessage(count));
+}
+
+TEST_CASE("Test decoding of data responses") {
+  MessageFactory::createInstace(std::list<std::shared_ptr<PayloadDecoder>>());
+  MessageFactory *dut = MessageFactory::getInstace();
+  REQUIRE(dut);
+  std::vector<unsigned char> frame =
+      buildDataResponse(dut, SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH);
+
+  SECTION("Valid message") {
+    FrameDecoder frameDecoder;
+    frameDecoder.append(frame);
+    auto msg = dynamic_pointer_cast<ReadDeviceMessage>(
+        dut->decodeMessage(frameDecoder));
+    REQUIRE(msg);
+    REQUIRE(msg->getSource() == UserId(1));
+    REQUIRE(msg->getTopic() == READ_TOPIC_DATA_RESPONSE);
+    auto payload =
+        dynamic_pointer_cast<DataResponsePayload>(msg->getReadPaylod());
+    REQUIRE(payload);
+    REQUIRE(payload->key == "Key");
+    REQUIRE(payload->count == SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH);
+    REQUIRE(payload->timestamps.size() == payload->count);
+    REQUIRE(payload->values.size() == payload->count);
+    for (size_t i = 0; i < payload->count; i++) {
+      REQUIRE(payload->timestamps[i] == TimePoint(Duration(1000 * i)));
+      REQUIRE(std::get<double>(payload->values[i]) == 0.5 * i);
+    }
+  }
+
+  SECTION("Malformed message") {
+    // Let the root offset of the flatbuffer point outside of the buffer. The
+    // verifier has to reject the message, before any field is read.
+    std::fill_n(frame.begin() + 5, 4, 0xFF);
+    FrameDecoder frameDecoder;
+    frameDecoder.append(frame);
+    REQUIRE_FALSE(dut->decodeMessage(frameDecoder));
+    REQUIRE(frameDecoder.getBufferedByteCount() == 0);
+  }
+
+  SECTION("Malformed payload") {
+    // Corrupt the end of the flatbuffer, where the nested payload is stored.
+    std::fill_n(frame.end() - 64, 63, 0xFF);
+    FrameDecoder frameDecoder;
+    frameDecoder.append(frame);
+    REQUIRE_FALSE(dut->decodeMessage(frameDecoder));
+  }
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+  BENCHMARK("Decode a data response of 1024 values") {
+    FrameDecoder frameDecoder;
+    frameDecoder.append(frame);
+    return dut->decodeMessage(frameDecoder);
+  };
+#endif
+}
+
+TEST_CASE("Test encoding of data responses") {
+  MessageFactory::createInstace(std::list<std::shared_ptr<PayloadDecoder>>());
+  MessageFactory *dut = MessageFactory::getInstace();
+  REQUIRE(dut);
+  std::shared_ptr<DeviceMessage> msg =
+      buildDataResponseMessage(SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH);
+
+  SECTION("Frame layout") {
+    std::vector<unsigned char> frame;
+    REQUIRE(dut->encodeMessage(msg, frame));
+    REQUIRE(frame.size() > FRAME_DECODER_FRAME_OVERHEAD);
+    REQUIRE(frame.front() == READ_DEVICE_MESSAGE);
+    REQUIRE(frame.back() == READ_DEVICE_MESSAGE);
+    size_t length = static_cast<size_t>(frame[1]) |
+                    (static_cast<size_t>(frame[2]) << 8) |
+                    (static_cast<size_t>(frame[3]) << 16) |
+                    (static_cast<size_t>(frame[4]) << 24);
+    REQUIRE(length + FRAME_DECODER_FRAME_OVERHEAD == frame.size());
+  }
+
+  SECTION("Reused frame") {
+    // Encoding into a used frame must yield the same bytes as a new frame.
+    std::vector<unsigned char> frame;
+    REQUIRE(dut->encodeMessage(buildDataResponseMessage(1), frame));
+    REQUIRE(dut->encodeMessage(msg, frame));
+    REQUIRE(frame == dut->encodeMessage(msg));
+  }
+
+  SECTION("Round trip") {
+    std::vector<unsigned char> frame;
+    REQUIRE(dut->encodeMessage(msg, frame));
+    FrameDecoder frameDecoder;
+    frameDecoder.append(frame);
+    auto decodedMsg = dynamic_pointer_cast<ReadDeviceMessage>(
+        dut->decodeMessage(frameDecoder));
+    REQUIRE(decodedMsg);
+    auto payload =
+        dynamic_pointer_cast<DataResponsePayload>(decodedMsg->getReadPaylod());
+    REQUIRE(payload);
+    REQUIRE(payload->key == "Key");
+    REQUIRE(payload->values.size() ==
+            SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH);
+    REQUIRE(std::get<double>(payload->values.back()) ==
+            0.5 * (SCIMON_RESPONSE_PAYLOAD_MAX_MESSAGE_LENGTH - 1));
+  }
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+  BENCHMARK("Encode a data response of 1024 values") {
+    return dut->encodeMessage(msg);
+  };
+
+  std::vector<unsigned char> frame;
+  BENCHMARK("Encode a data response of 1024 values into a reused frame") {
+    return dut->encodeMessage(msg, frame);
+  };
+#endif
+}
+
+/**
+ * @brief A decoder, that decodes nothing and lists the given magic numbers.
+ */
+class TestPayloadDecoder : public PayloadDecoder {
+public:
+  TestPayloadDecoder(std::vector<int> magicNumbers)
+      : magicNumbers(magicNumbers) {}
+
+  virtual InitPayload *decodeInitPayload(const PayloadBuffer &data,
+                                         int magicNumber = 0) override {
+    return nullptr;
+  }
+
+  virtual ConfigurationPayload *
+  decodeConfigPayload(const PayloadBuffer &data, int magicNumber = 0) override {
+    return nullptr;
+  }
+
+  virtual ReadPayload *decodeReadPayload(const PayloadBuffer &data,
+                                         int magicNumber = 0) override {
+    return nullptr;
+  }
+
+  virtual WritePayload *
+  decodeWritePayload(const PayloadBuffer &data, int magicNumber = 0) override {
+    return nullptr;
+  }
+
+  virtual std::span<const int> getMagicNumbers() const override {
+    return this->magicNumbers;
+  }
+
+private:
+  std::vector<int> magicNumbers;
+};
+
+TEST_CASE("Test the payload registry") {
+  PayloadRegistry dut;
+  std::shared_ptr<PayloadDecoder> decoder(
+      new TestPayloadDecoder({MAGIC_NUMBER_OB1_CONF_PAYLOAD, 0x0A01}));
+
+  SECTION("Decoders") {
+    REQUIRE(dut.registerDecoder(decoder));
+    REQUIRE(dut.getDecoder(MAGIC_NUMBER_OB1_CONF_PAYLOAD) == decoder.get());
+    REQUIRE(dut.getDecoder(0x0A01) == decoder.get());
+    REQUIRE_FALSE(dut.getDecoder(MAGIC_NUMBER_OB1_INIT_PAYLOAD));
+    REQUIRE_FALSE(dut.getDecoder(0x0A02));
+    REQUIRE_FALSE(dut.getDecoder(-1));
+    REQUIRE(dut.getFallbackDecoders().empty());
+  }
+
+  SECTION("Conflicting decoders") {
+    // The decoder, that has been registered first, is kept.
+    std::shared_ptr<PayloadDecoder> otherDecoder(
+        new TestPayloadDecoder({MAGIC_NUMBER_OB1_CONF_PAYLOAD}));
+    REQUIRE(dut.registerDecoder(decoder));
+    REQUIRE_FALSE(dut.registerDecoder(otherDecoder));
+    REQUIRE(dut.getDecoder(MAGIC_NUMBER_OB1_CONF_PAYLOAD) == decoder.get());
+  }
+
+  SECTION("Fallback decoders") {
+    std::shared_ptr<PayloadDecoder> fallbackDecoder(
+        new TestPayloadDecoder({}));
+    REQUIRE(dut.registerDecoder(fallbackDecoder));
+    REQUIRE(dut.getFallbackDecoders().size() == 1);
+    REQUIRE_FALSE(dut.getDecoder(MAGIC_NUMBER_OB1_CONF_PAYLOAD));
+  }
+
+  SECTION("Out of range") {
+    std::shared_ptr<PayloadDecoder> invalidDecoder(
+        new TestPayloadDecoder({PAYLOAD_REGISTRY_MAX_MAGIC_NUMBER + 1}));
+    REQUIRE_FALSE(dut.registerDecoder(invalidDecoder));
+    REQUIRE_FALSE(dut.registerEncoder(-1, PayloadEncoder()));
+  }
+
+  SECTION("Encoders") {
+    REQUIRE_FALSE(dut.getEncoder(MAGIC_NUMBER_DATA_RESPONSE_PAYLOAD));
+    REQUIRE(dut.registerEncoder(
+        MAGIC_NUMBER_DATA_RESPONSE_PAYLOAD,
+        [](Payload &, flatbuffers::FlatBufferBuilder &) { return false; }));
+    REQUIRE(dut.getEncoder(MAGIC_NUMBER_DATA_RESPONSE_PAYLOAD));
+  }
+}
+
+TEST_CASE("Test the dispatch on message kinds") {
+  auto visitor = MessageVisitor{
+      [](std::shared_ptr<WriteDeviceMessage>) { return 1; },
+      [](std::shared_ptr<ReadDeviceMessage>) { return 2; },
+      [](std::shared_ptr<HandshakeMessage>) { return 3; },
+      [](std::shared_ptr<InitDeviceMessage>) { return 4; },
+      [](std::shared_ptr<ConfigDeviceMessage>) { return 5; }};
+
+  std::shared_ptr<DeviceMessage> writeMsg(new WriteDeviceMessage(
+      UserId(1), UserId(2), WRITE_TOPIC_QUERY_STATE));
+  REQUIRE(writeMsg->getKind() == DEVICE_MESSAGE_KIND_WRITE);
+  REQUIRE(visitMessage(writeMsg, visitor) == 1);
+
+  std::shared_ptr<DeviceMessage> readMsg(
+      new ReadDeviceMessage(UserId(1), UserId(2), READ_TOPIC_DEVICE_STATUS,
+                            std::shared_ptr<ReadPayload>(), nullptr));
+  REQUIRE(readMsg->getKind() == DEVICE_MESSAGE_KIND_READ);
+  REQUIRE(visitMessage(readMsg, visitor) == 2);
+
+  std::shared_ptr<DeviceMessage> handshakeMsg(
+      new HandshakeMessage(UserId(1), UserId(2),
+                           std::list<std::shared_ptr<StatusPayload>>(), "1"));
+  REQUIRE(handshakeMsg->getKind() == DEVICE_MESSAGE_KIND_HANDSHAKE);
+  REQUIRE(visitMessage(handshakeMsg, visitor) == 3);
+
+  // Messages, that derive from a message type, have the kind of their base.
+  std::shared_ptr<DeviceMessage> dummyMsg(new DummyMessage());
+  REQUIRE(visitMessage(dummyMsg, visitor) == 1);
+
+  // A generic handler catches the remaining kinds.
+  auto writeOnlyVisitor =
+      MessageVisitor{[](std::shared_ptr<WriteDeviceMessage>) { return true; },
+                     [](std::shared_ptr<DeviceMessage>) { return false; }};
+  REQUIRE(visitMessage(writeMsg, writeOnlyVisitor));
+  REQUIRE_FALSE(visitMessage(readMsg, writeOnlyVisitor));
+}
+
+TEST_CASE("Test the priority lanes") {
+  auto makeWriteMessage = [](WriteDeviceTopic topic) {
+    return std::shared_ptr<DeviceMessage>(
+        new WriteDeviceMessage(UserId(1), UserId(2), topic));
+  };
+  auto makeDataResponse = []() {
+    return std::shared_ptr<DeviceMessage>(
+        new ReadDeviceMessage(UserId(2), UserId(1), READ_TOPIC_DATA_RESPONSE,
+                              std::shared_ptr<ReadPayload>(), nullptr));
+  };
+
+  SECTION("Priority classes") {
+    REQUIRE(makeWriteMessage(WRITE_TOPIC_STOP)->getPriority() ==
+            MESSAGE_PRIORITY_CONTROL);
+    REQUIRE(makeWriteMessage(WRITE_TOPIC_REQUEST_DATA)->getPriority() ==
+            MESSAGE_PRIORITY_NORMAL);
+    REQUIRE(makeDataResponse()->getPriority() == MESSAGE_PRIORITY_BULK);
+    std::shared_ptr<DeviceMessage> handshakeMsg(
+        new HandshakeMessage(UserId(1), UserId(2),
+                             std::list<std::shared_ptr<StatusPayload>>(), "1"));
+    REQUIRE(handshakeMsg->getPriority() == MESSAGE_PRIORITY_CONTROL);
+  }
+
+  SECTION("Control messages overtake bulk messages") {
+    MessageLanes lanes;
+    std::vector<std::shared_ptr<DeviceMessage>> bulkMessages;
+    for (int i = 0; i < 4; i++) {
+      bulkMessages.push_back(makeDataResponse());
+      lanes.push(bulkMessages.back());
+    }
+    auto stopMsg = makeWriteMessage(WRITE_TOPIC_STOP);
+    lanes.push(stopMsg);
+    REQUIRE(lanes.size() == 5);
+
+    REQUIRE(lanes.pop() == stopMsg);
+    for (auto &bulkMessage : bulkMessages) {
+      REQUIRE(lanes.pop() == bulkMessage);
+    }
+    REQUIRE(lanes.empty());
+    REQUIRE(!lanes.pop());
+  }
+
+  SECTION("Bulk messages do not starve") {
+    MessageLanes lanes;
+    auto bulkMsg = makeDataResponse();
+    lanes.push(bulkMsg);
+    for (int i = 0; i < 2 * MESSAGE_LANES_STARVATION_LIMIT; i++) {
+      lanes.push(makeWriteMessage(WRITE_TOPIC_QUERY_STATE));
+    }
+
+    for (int i = 0; i < MESSAGE_LANES_STARVATION_LIMIT; i++) {
+      REQUIRE(lanes.pop()->getPriority() == MESSAGE_PRIORITY_CONTROL);
+    }
+    REQUIRE(lanes.pop() == bulkMsg);
+  }
+
+  SECTION("Mailbox") {
+    MessageMailbox mailbox;
+    auto bulkMsg = makeDataResponse();
+    auto requestMsg = makeWriteMessage(WRITE_TOPIC_REQUEST_DATA);
+    auto stopMsg = makeWriteMessage(WRITE_TOPIC_STOP);
+    REQUIRE(mailbox.push(bulkMsg));
+    REQUIRE(mailbox.push(
+        std::vector<std::shared_ptr<DeviceMessage>>{requestMsg, stopMsg}));
+    REQUIRE(!mailbox.empty());
+
+    std::list<std::shared_ptr<DeviceMessage>> messages;
+    mailbox.drain(messages);
+    REQUIRE(mailbox.empty());
+    REQUIRE(messages ==
+            std::list<std::shared_ptr<DeviceMessage>>{stopMsg, requestMsg,
+                                                       bulkMsg});
+
+    // Sorting keeps the order within a class.
+    auto secondStopMsg = makeWriteMessage(WRITE_TOPIC_STOP);
+    messages.push_back(secondStopMsg);
+    sortByPriority(messages);
+    REQUIRE(messages ==
+            std::list<std::shared_ptr<DeviceMessage>>{stopMsg, secondStopMsg,
+                                                       requestMsg, bulkMsg});
+  }
+}
@@ -1,8 +1,26 @@
+// Standard includes
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <regex>
+#include <thread>
+
 // 3rd party includes
 #define CATCH_CONFIG_MAIN
+// #define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include <catch2/catch.hpp>
 #include <easylogging++.h>
 
+#include <clock.hpp>
+#include <impedance_kernels.hpp>
+#include <mpsc_queue.hpp>
+#include <object_pool.hpp>
+#include <thread_pool.hpp>
 #include <utilities.hpp>
 
 INITIALIZE_EASYLOGGINGPP
@@ -39,3 +57,537 @@ TEST_CASE("Testing utility functions", "[Utilities::split()]") {
     REQUIRE(targetResult == result);
   }
 }
+
+TEST_CASE("Testing glob patterns", "[Utilities::globToRegex()]") {
+  auto matches = [](const std::string &glob, const std::string &str) {
+    return std::regex_match(str, std::regex(Utilities::globToRegex(glob)));
+  };
+
+  REQUIRE(matches("*", "spectrometer/spectrum"));
+  REQUIRE(matches("spectrometer/*", "spectrometer/spectrum"));
+  REQUIRE_FALSE(matches("spectrometer/*", "pump/channel1"));
+  REQUIRE(matches("pump?", "pump1"));
+  REQUIRE_FALSE(matches("pump?", "pump12"));
+  REQUIRE(matches("pump[12]", "pump2"));
+  REQUIRE_FALSE(matches("pump[!12]", "pump2"));
+  REQUIRE(matches("a.b+(c)", "a.b+(c)"));
+  REQUIRE_FALSE(matches("a.b", "axb"));
+  REQUIRE(matches("[abc", "[abc"));
+}
+
+TEST_CASE("Testing the thread pool", "[Utilities::ThreadPool]") {
+  std::vector<std::future<int>> results;
+  std::atomic<int> executedTasks = 0;
+  {
+    Utilities::ThreadPool threadPool(4);
+    REQUIRE(threadPool.getThreadCount() == 4);
+
+    for (int i = 0; i < 100; i++) {
+      results.push_back(threadPool.submit([i, &executedTasks]() {
+        executedTasks++;
+        return i * i;
+      }));
+    }
+
+    for (int i = 0; i < 100; i++) {
+      REQUIRE(results[i].get() == i * i);
+    }
+
+    // Tasks, that are still queued, are executed before the pool is
+    // destroyed.
+    for (int i = 0; i < 100; i++) {
+      threadPool.submit([&executedTasks]() { executedTasks++; });
+    }
+  }
+  REQUIRE(executedTasks == 200);
+
+  // At least one thread is started.
+  Utilities::ThreadPool singleThreadPool(0);
+  REQUIRE(singleThreadPool.getThreadCount() == 1);
+  REQUIRE(singleThreadPool.submit([]() { return 1; }).get() == 1);
+}
+
+namespace {
+/**
+ * @brief An element, that can be queued in a MpscQueue.
+ */
+struct QueueElement : Utilities::MpscQueueHook<QueueElement> {
+  QueueElement(int producer, int value) : producer(producer), value(value) {}
+  int producer;
+  int value;
+};
+} // namespace
+
+TEST_CASE("Testing the MPSC queue", "[Utilities::MpscQueue]") {
+  Utilities::MpscQueue<QueueElement> queue;
+  REQUIRE(queue.empty());
+
+  SECTION("Order of a single producer") {
+    auto first = std::make_shared<QueueElement>(0, 1);
+    REQUIRE(queue.push(first));
+    REQUIRE(queue.push(std::vector<std::shared_ptr<QueueElement>>{
+        std::make_shared<QueueElement>(0, 2),
+        std::make_shared<QueueElement>(0, 3)}));
+    REQUIRE(!queue.empty());
+
+    // An element can only be queued once at a time.
+    REQUIRE(!queue.push(first));
+    REQUIRE(!queue.push(std::shared_ptr<QueueElement>()));
+
+    std::list<std::shared_ptr<QueueElement>> elements = queue.drain();
+    REQUIRE(queue.empty());
+    REQUIRE(elements.size() == 3);
+    int expectedValue = 1;
+    for (auto &element : elements) {
+      REQUIRE(element->value == expectedValue++);
+    }
+
+    // Drained elements can be queued again.
+    REQUIRE(queue.push(first));
+    queue.drain(elements);
+    REQUIRE(elements.size() == 4);
+    REQUIRE(elements.back() == first);
+  }
+
+  SECTION("Multiple producers") {
+    const int producerCount = 4;
+    const int elementCount = 10000;
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < producerCount; producer++) {
+      producers.emplace_back([&queue, producer]() {
+        for (int i = 0; i < elementCount; i++) {
+          queue.push(std::make_shared<QueueElement>(producer, i));
+        }
+      });
+    }
+
+    // Drain while the producers are still pushing. The elements of each
+    // producer have to arrive in order.
+    std::vector<int> nextValues(producerCount, 0);
+    int receivedCount = 0;
+    while (receivedCount < producerCount * elementCount) {
+      for (auto &element : queue.drain()) {
+        REQUIRE(element->value == nextValues[element->producer]);
+        nextValues[element->producer]++;
+        receivedCount++;
+      }
+    }
+    for (auto &producer : producers) {
+      producer.join();
+    }
+    REQUIRE(queue.empty());
+  }
+}
+
+namespace {
+/**
+ * @brief An object, that is allocated from the object pool.
+ */
+struct PooledElement : Utilities::PoolAllocated {
+  PooledElement(int value) : value(value) {}
+  virtual ~PooledElement() {}
+  int value;
+};
+
+/**
+ * @brief An object, that is too large for the object pool.
+ */
+struct LargeElement {
+  char data[OBJECT_POOL_MAX_BLOCK_SIZE + 1];
+};
+} // namespace
+
+TEST_CASE("Testing the object pool", "[Utilities::allocatePooled()]") {
+  const int elementCount = 1000;
+
+  SECTION("Steady state") {
+    std::vector<std::shared_ptr<PooledElement>> elements;
+    auto allocateAndRelease = [&elements, elementCount]() {
+      for (int i = 0; i < elementCount; i++) {
+        elements.push_back(Utilities::makePooled<PooledElement>(i));
+      }
+      for (int i = 0; i < elementCount; i++) {
+        REQUIRE(elements[i]->value == i);
+      }
+      elements.clear();
+    };
+
+    // Warm up the pool. Afterwards, the heap must not be touched anymore.
+    allocateAndRelease();
+    Utilities::ObjectPoolStatistics before =
+        Utilities::getObjectPoolStatistics();
+    for (int round = 0; round < 10; round++) {
+      allocateAndRelease();
+    }
+    Utilities::ObjectPoolStatistics after =
+        Utilities::getObjectPoolStatistics();
+    REQUIRE(after.heapAllocations == before.heapAllocations);
+    REQUIRE(after.allocations - before.allocations == 10 * elementCount);
+    REQUIRE(after.deallocations - before.deallocations == 10 * elementCount);
+  }
+
+  SECTION("Release on another thread") {
+    std::vector<PooledElement *> elements;
+    auto allocateAndRelease = [&elements, elementCount]() {
+      std::thread allocator([&elements, elementCount]() {
+        for (int i = 0; i < elementCount; i++) {
+          elements.push_back(new PooledElement(i));
+        }
+      });
+      allocator.join();
+      std::thread releaser([&elements]() {
+        for (auto element : elements) {
+          delete element;
+        }
+      });
+      releaser.join();
+      elements.clear();
+    };
+
+    // Blocks, that are released by another thread, have to be reused.
+    allocateAndRelease();
+    size_t heapAllocations =
+        Utilities::getObjectPoolStatistics().heapAllocations;
+    for (int round = 0; round < 10; round++) {
+      allocateAndRelease();
+    }
+    REQUIRE(Utilities::getObjectPoolStatistics().heapAllocations ==
+            heapAllocations);
+  }
+
+  SECTION("Containers and shared pointers") {
+    Utilities::ObjectPoolStatistics before =
+        Utilities::getObjectPoolStatistics();
+    {
+      std::list<int, Utilities::PoolAllocator<int>> list;
+      for (int i = 0; i < elementCount; i++) {
+        list.push_back(i);
+      }
+      REQUIRE(list.size() == elementCount);
+      REQUIRE(list.back() == elementCount - 1);
+    }
+    Utilities::ObjectPoolStatistics after =
+        Utilities::getObjectPoolStatistics();
+    REQUIRE(after.allocations - before.allocations == elementCount);
+    REQUIRE(after.deallocations - before.deallocations == elementCount);
+
+    // Null pointers do not allocate.
+    REQUIRE(!Utilities::sharePooled<PooledElement>(nullptr));
+    std::shared_ptr<PooledElement> element =
+        Utilities::sharePooled(new PooledElement(5));
+    REQUIRE(element->value == 5);
+
+    // Large objects are passed to the heap.
+    std::shared_ptr<LargeElement> largeElement =
+        Utilities::makePooled<LargeElement>();
+    REQUIRE(Utilities::getObjectPoolStatistics().unpooledAllocations ==
+            after.unpooledAllocations + 1);
+  }
+}
+
+TEST_CASE("Testing the simulated clock", "[Core::SimulatedClock]") {
+  const Core::TimePoint start =
+      std::chrono::sys_days(std::chrono::year(2024) / 1 / 1);
+  const Core::Duration hour = std::chrono::hours(1);
+
+  SECTION("Manual advance") {
+    Core::SimulatedClock clock(start);
+    REQUIRE(clock.now() == start);
+
+    std::thread sleeper([&clock, start, hour]() {
+      clock.sleepUntil(start + hour);
+    });
+    while (clock.getWaitingCount() == 0) {
+      std::this_thread::yield();
+    }
+
+    // The sleeper keeps waiting, until its time point has been reached.
+    clock.advance(hour / 2);
+    REQUIRE(clock.getWaitingCount() == 1);
+    clock.advanceTo(start + hour);
+    sleeper.join();
+    REQUIRE(clock.getWaitingCount() == 0);
+    REQUIRE(clock.now() == start + hour);
+
+    // Time points in the past are ignored.
+    clock.advanceTo(start);
+    REQUIRE(clock.now() == start + hour);
+  }
+
+  SECTION("Automatic advance") {
+    // A schedule of eight hours with a single thread.
+    Core::SimulatedClock clock(start, 1);
+    for (int i = 0; i < 8 * 3600 * 10; i++) {
+      clock.sleepFor(std::chrono::milliseconds(100));
+    }
+    REQUIRE(clock.now() == start + 8 * hour);
+
+    // Two threads with different periods. Each one wakes up exactly at its
+    // time points.
+    clock.setThreadCount(2);
+    std::vector<Core::TimePoint> fastWakeups;
+    std::vector<Core::TimePoint> slowWakeups;
+    auto runPeriodically = [&clock](Core::Duration period, int count,
+                                    std::vector<Core::TimePoint> &wakeups) {
+      for (int i = 0; i < count; i++) {
+        clock.sleepFor(period);
+        wakeups.push_back(clock.now());
+      }
+    };
+    Core::TimePoint threadStart = clock.now();
+    std::thread fast(runPeriodically, std::chrono::seconds(1), 300,
+                     std::ref(fastWakeups));
+    std::thread slow(runPeriodically, std::chrono::seconds(3), 100,
+                     std::ref(slowWakeups));
+    fast.join();
+    slow.join();
+    for (int i = 0; i < 300; i++) {
+      REQUIRE(fastWakeups[i] == threadStart + std::chrono::seconds(i + 1));
+    }
+    for (int i = 0; i < 100; i++) {
+      REQUIRE(slowWakeups[i] == threadStart + std::chrono::seconds(3 * i + 3));
+    }
+  }
+
+  SECTION("Wakeup by the predicate") {
+    Core::SimulatedClock clock(start);
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool flag = false;
+    bool result = false;
+
+    // The predicate is fulfilled before the time point has been reached.
+    std::thread waiter([&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      result = clock.waitUntil(lock, condition, start + hour,
+                               [&flag] { return flag; });
+    });
+    while (clock.getWaitingCount() == 0) {
+      std::this_thread::yield();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      flag = true;
+    }
+    condition.notify_all();
+    waiter.join();
+    REQUIRE(result);
+    REQUIRE(clock.getWaitingCount() == 0);
+    REQUIRE(clock.now() == start);
+  }
+
+  SECTION("Clock of the process") {
+    auto clock = std::make_shared<Core::SimulatedClock>(start, 1);
+    Core::setClock(clock);
+    REQUIRE(Core::getNow() == start);
+    Core::sleepFor(8 * hour);
+    REQUIRE(Core::getNow() == start + 8 * hour);
+
+    // Restore the system clock.
+    Core::setClock(nullptr);
+    REQUIRE(Core::getNow() > start + 8 * hour);
+  }
+}
+
+namespace {
+/**
+ * @brief Generates impedances over many orders of magnitude in all quadrants,
+ * including zeros, signed zeros, infinities and NaN.
+ */
+void generateImpedances(size_t count, std::vector<double> &real,
+                        std::vector<double> &imag) {
+  std::mt19937_64 generator(42);
+  std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+  std::uniform_int_distribution<int> exponent(-150, 150);
+  real.resize(count);
+  imag.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    real[i] = mantissa(generator) * std::pow(10.0, exponent(generator));
+    imag[i] = mantissa(generator) * std::pow(10.0, exponent(generator));
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const std::vector<std::pair<double, double>> specialValues = {
+      {0.0, 0.0},   {-0.0, 0.0},  {0.0, -0.0}, {-0.0, -0.0}, {0.0, 1.0},
+      {0.0, -1.0},  {-1.0, 0.0},  {-1.0, -0.0}, {1.0, 0.0},  {inf, 1.0},
+      {-inf, 1.0},  {1.0, -inf},  {inf, inf},  {-inf, -inf}, {nan, 1.0},
+      {1.0, nan},   {1e-310, 0.0}, {1e200, 1e200}, {-3.0, 3.0}, {2.0, 2.0}};
+  for (size_t i = 0; i < specialValues.size() && i < count; i++) {
+    // Spread the special values, so that they end up in different lanes.
+    size_t index = (i * 7) % count;
+    real[index] = specialValues[i].first;
+    imag[index] = specialValues[i].second;
+  }
+}
+
+/**
+ * @brief Checks, whether a value matches the reference within the given
+ * tolerance. NaN and infinities have to match exactly.
+ */
+bool matchesReference(double value, double reference, double tolerance) {
+  if (std::isnan(reference)) {
+    return std::isnan(value);
+  }
+  if (std::isinf(reference) || reference == 0.0) {
+    return value == reference &&
+           std::signbit(value) == std::signbit(reference);
+  }
+  return std::abs(value - reference) <= tolerance * std::abs(reference);
+}
+} // namespace
+
+TEST_CASE("Testing the impedance kernels", "[Utilities::computeMagnitudes()]") {
+  // An odd count, so that the scalar remainder of the vector kernels is used.
+  const size_t count = 1027;
+  std::vector<double> real;
+  std::vector<double> imag;
+  generateImpedances(count, real, imag);
+  // Use the impedances in reverse order as baseline.
+  std::vector<double> baselineReal(real.rbegin(), real.rend());
+  std::vector<double> baselineImag(imag.rbegin(), imag.rend());
+
+  const Utilities::KernelInstructionSet previousInstructionSet =
+      Utilities::getKernelInstructionSet();
+  REQUIRE(Utilities::getKernelInstructionSet() ==
+          Utilities::getSupportedKernelInstructionSet());
+
+  for (auto instructionSet :
+       {Utilities::KERNEL_INSTRUCTION_SET_SCALAR,
+        Utilities::KERNEL_INSTRUCTION_SET_SSE2,
+        Utilities::KERNEL_INSTRUCTION_SET_AVX2}) {
+    if (instructionSet > Utilities::getSupportedKernelInstructionSet()) {
+      REQUIRE_FALSE(Utilities::setKernelInstructionSet(instructionSet));
+      continue;
+    }
+    REQUIRE(Utilities::setKernelInstructionSet(instructionSet));
+    INFO("Instruction set " << instructionSet);
+
+    std::vector<double> magnitudes(count);
+    std::vector<double> phases(count);
+    std::vector<double> decibels(count);
+    std::vector<double> normalizedReal(count);
+    std::vector<double> normalizedImag(count);
+    Utilities::computeMagnitudes(real.data(), imag.data(), magnitudes.data(),
+                                 count);
+    Utilities::computePhases(real.data(), imag.data(), phases.data(), count);
+    Utilities::computeMagnitudesDb(real.data(), imag.data(), decibels.data(),
+                                   count);
+    Utilities::normalizeToBaseline(real.data(), imag.data(),
+                                   baselineReal.data(), baselineImag.data(),
+                                   normalizedReal.data(), normalizedImag.data(),
+                                   count);
+
+    std::vector<double> polar(2 * count);
+    for (size_t i = 0; i < count; i++) {
+      polar[2 * i] = real[i];
+      polar[2 * i + 1] = imag[i];
+    }
+    Utilities::cartesianToPolar(polar.data(), polar.data(), count);
+
+    for (size_t i = 0; i < count; i++) {
+      INFO("Impedance " << real[i] << " + i * " << imag[i]);
+      double squaredMagnitude = real[i] * real[i] + imag[i] * imag[i];
+      REQUIRE(matchesReference(magnitudes[i], std::sqrt(squaredMagnitude),
+                               1e-15));
+      REQUIRE(matchesReference(phases[i], std::atan2(imag[i], real[i]),
+                               1e-15));
+      REQUIRE(matchesReference(decibels[i],
+                               10.0 * std::log10(squaredMagnitude), 1e-14));
+
+      double denominator = baselineReal[i] * baselineReal[i] +
+                           baselineImag[i] * baselineImag[i];
+      REQUIRE(matchesReference(
+          normalizedReal[i],
+          (real[i] * baselineReal[i] + imag[i] * baselineImag[i]) /
+              denominator,
+          1e-15));
+      REQUIRE(matchesReference(
+          normalizedImag[i],
+          (imag[i] * baselineReal[i] - real[i] * baselineImag[i]) /
+              denominator,
+          1e-15));
+
+      REQUIRE(matchesReference(polar[2 * i], magnitudes[i], 0.0));
+      REQUIRE(matchesReference(polar[2 * i + 1], phases[i], 0.0));
+    }
+
+    // Normalizing a spectrum to itself yields ones.
+    std::vector<double> finiteReal = {1.0, -2.0, 3e-5, 4e7, -5.0};
+    std::vector<double> finiteImag = {0.5, 2.0, -1e-5, 0.0, -5.0};
+    std::vector<double> ones(finiteReal.size());
+    std::vector<double> zeros(finiteReal.size());
+    Utilities::normalizeToBaseline(finiteReal.data(), finiteImag.data(),
+                                   finiteReal.data(), finiteImag.data(),
+                                   ones.data(), zeros.data(), ones.size());
+    for (size_t i = 0; i < ones.size(); i++) {
+      REQUIRE(ones[i] == Approx(1.0));
+      REQUIRE(zeros[i] == Approx(0.0).margin(1e-15));
+    }
+  }
+
+  REQUIRE(Utilities::setKernelInstructionSet(previousInstructionSet));
+}
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+TEST_CASE("Benchmark the impedance kernels") {
+  // Impedances as measured by a spectrometer. Extreme ratios of real and
+  // imaginary part would favour the scalar code, as atan2() takes a shortcut.
+  const size_t count = 1 << 16;
+  std::mt19937_64 generator(42);
+  std::uniform_real_distribution<double> resistance(1.0, 1e4);
+  std::uniform_real_distribution<double> reactance(-1e4, 0.0);
+  std::vector<double> real(count);
+  std::vector<double> imag(count);
+  for (size_t i = 0; i < count; i++) {
+    real[i] = resistance(generator);
+    imag[i] = reactance(generator);
+  }
+  std::vector<double> first(count);
+  std::vector<double> second(count);
+  std::vector<double> polar(2 * count);
+
+  const Utilities::KernelInstructionSet previousInstructionSet =
+      Utilities::getKernelInstructionSet();
+  for (auto instructionSet :
+       {Utilities::KERNEL_INSTRUCTION_SET_SCALAR,
+        Utilities::KERNEL_INSTRUCTION_SET_SSE2,
+        Utilities::KERNEL_INSTRUCTION_SET_AVX2}) {
+    if (!Utilities::setKernelInstructionSet(instructionSet)) {
+      continue;
+    }
+    std::string name = " (instruction set " +
+                       std::to_string(static_cast<int>(instructionSet)) + ")";
+
+    BENCHMARK("Magnitudes" + name) {
+      Utilities::computeMagnitudes(real.data(), imag.data(), first.data(),
+                                   count);
+      return first[0];
+    };
+    BENCHMARK("Phases" + name) {
+      Utilities::computePhases(real.data(), imag.data(), first.data(), count);
+      return first[0];
+    };
+    BENCHMARK("Magnitudes in decibel" + name) {
+      Utilities::computeMagnitudesDb(real.data(), imag.data(), first.data(),
+                                     count);
+      return first[0];
+    };
+    BENCHMARK("Baseline normalization" + name) {
+      Utilities::normalizeToBaseline(real.data(), imag.data(), imag.data(),
+                                     real.data(), first.data(), second.data(),
+                                     count);
+      return first[0];
+    };
+    BENCHMARK("Cartesian to polar" + name) {
+      for (size_t i = 0; i < count; i++) {
+        polar[2 * i] = real[i];
+        polar[2 * i + 1] = imag[i];
+      }
+      Utilities::cartesianToPolar(polar.data(), polar.data(), count);
+      return polar[0];
+    };
+  }
+  Utilities::setKernelInstructionSet(previousInstructionSet);
+}
+#endif